@@ -0,0 +1,197 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/admission_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/log/absl_log.h"
+#include "absl/strings/str_format.h"
+
+namespace cloud_kms {
+
+AdmissionController::Permit::Permit(Permit&& other)
+    : controller_(other.controller_), admitted_at_(other.admitted_at_) {
+  other.controller_ = nullptr;
+}
+
+AdmissionController::Permit& AdmissionController::Permit::operator=(
+    Permit&& other) {
+  if (this != &other) {
+    if (controller_) {
+      controller_->Release(nullptr, admitted_at_);
+    }
+    controller_ = other.controller_;
+    admitted_at_ = other.admitted_at_;
+    other.controller_ = nullptr;
+  }
+  return *this;
+}
+
+AdmissionController::Permit::~Permit() {
+  if (controller_) {
+    controller_->Release(nullptr, admitted_at_);
+  }
+}
+
+void AdmissionController::Permit::Complete(const absl::Status& rpc_status) {
+  if (controller_) {
+    controller_->Release(&rpc_status, admitted_at_);
+    controller_ = nullptr;
+  }
+}
+
+AdmissionController::AdmissionController(Options options)
+    : options_(std::move(options)),
+      tokens_(std::max(options_.burst, 1)),
+      last_refill_(options_.clock()),
+      last_decrease_(absl::InfinitePast()),
+      limit_(std::clamp<double>(options_.initial_limit,
+                                std::max(options_.min_limit, 1),
+                                std::max(options_.max_limit, 1))) {}
+
+AdmissionController::~AdmissionController() {
+  Stats s = stats();
+  if (s.admitted > 0 || s.rejected > 0) {
+    ABSL_LOG(INFO) << absl::StrFormat(
+        "RPC admission: admitted=%d rejected=%d max_queue_depth=%d "
+        "final_limit=%.1f",
+        s.admitted, s.rejected, s.max_queue_depth, s.limit);
+  }
+}
+
+absl::StatusOr<AdmissionController::Permit> AdmissionController::Acquire() {
+  absl::MutexLock lock(&mutex_);
+  absl::Time now = options_.clock();
+  if (waiters_.empty()) {
+    RefillLocked(now);
+    if (AdmissionDelayLocked() == absl::ZeroDuration()) {
+      return AdmitLocked(now);
+    }
+  }
+  if (static_cast<int64_t>(waiters_.size()) >= options_.max_queue_depth) {
+    rejected_++;
+    return absl::ResourceExhaustedError(absl::StrFormat(
+        "RPC admission queue is full (%d waiters)", waiters_.size()));
+  }
+
+  Waiter self;
+  auto position = waiters_.insert(waiters_.end(), &self);
+  max_queue_depth_ =
+      std::max(max_queue_depth_, static_cast<int64_t>(waiters_.size()));
+  const absl::Time deadline = now + options_.max_queue_wait;
+
+  while (true) {
+    absl::Duration wait = deadline - now;
+    // Only the oldest waiter is eligible, so that permits are granted in
+    // arrival order.
+    if (waiters_.front() == &self) {
+      RefillLocked(now);
+      absl::Duration delay = AdmissionDelayLocked();
+      if (delay == absl::ZeroDuration()) {
+        waiters_.erase(position);
+        cond_.SignalAll();
+        return AdmitLocked(now);
+      }
+      wait = std::min(wait, delay);
+    }
+
+    if (now >= deadline) {
+      waiters_.erase(position);
+      rejected_++;
+      cond_.SignalAll();
+      return absl::ResourceExhaustedError(
+          absl::StrFormat("timed out after %s waiting for RPC admission",
+                          absl::FormatDuration(options_.max_queue_wait)));
+    }
+    cond_.WaitWithTimeout(&mutex_, wait);
+    now = options_.clock();
+  }
+}
+
+AdmissionController::Stats AdmissionController::stats() const {
+  absl::MutexLock lock(&mutex_);
+  Stats stats;
+  stats.queue_depth = waiters_.size();
+  stats.max_queue_depth = max_queue_depth_;
+  stats.in_flight = in_flight_;
+  stats.limit = limit_;
+  stats.admitted = admitted_;
+  stats.rejected = rejected_;
+  return stats;
+}
+
+void AdmissionController::RefillLocked(absl::Time now) {
+  if (options_.requests_per_second <= 0 || now <= last_refill_) {
+    return;
+  }
+  tokens_ = std::min<double>(
+      std::max(options_.burst, 1),
+      tokens_ + absl::ToDoubleSeconds(now - last_refill_) *
+                    options_.requests_per_second);
+  last_refill_ = now;
+}
+
+absl::Duration AdmissionController::AdmissionDelayLocked() const {
+  if (in_flight_ >= static_cast<int64_t>(std::floor(limit_))) {
+    // Wait for a permit to be released.
+    return absl::InfiniteDuration();
+  }
+  if (options_.requests_per_second > 0 && tokens_ < 1) {
+    return absl::Seconds((1 - tokens_) / options_.requests_per_second);
+  }
+  return absl::ZeroDuration();
+}
+
+AdmissionController::Permit AdmissionController::AdmitLocked(absl::Time now) {
+  if (options_.requests_per_second > 0) {
+    tokens_ -= 1;
+  }
+  in_flight_++;
+  admitted_++;
+  return Permit(this, now);
+}
+
+void AdmissionController::Release(const absl::Status* rpc_status,
+                                   absl::Time admitted_at) {
+  absl::MutexLock lock(&mutex_);
+  in_flight_--;
+  cond_.SignalAll();
+  if (!rpc_status) {
+    return;
+  }
+
+  absl::Time now = options_.clock();
+  bool overloaded =
+      rpc_status->code() == absl::StatusCode::kResourceExhausted ||
+      (options_.latency_threshold > absl::ZeroDuration() &&
+       now - admitted_at > options_.latency_threshold);
+  if (overloaded) {
+    // RPCs that were already in flight when the limit was last cut reflect
+    // the old limit, so they do not cut it again.
+    if (admitted_at > last_decrease_) {
+      limit_ = std::max<double>(std::max(options_.min_limit, 1),
+                                limit_ * options_.backoff_ratio);
+      last_decrease_ = now;
+    }
+    return;
+  }
+  if (rpc_status->ok()) {
+    limit_ = std::min<double>(std::max(options_.max_limit, 1),
+                              limit_ + 1 / limit_);
+  }
+}
+
+}  // namespace cloud_kms
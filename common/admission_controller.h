@@ -0,0 +1,147 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMMON_ADMISSION_CONTROLLER_H_
+#define COMMON_ADMISSION_CONTROLLER_H_
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace cloud_kms {
+
+// AdmissionController bounds the rate and concurrency of outgoing RPCs.
+//
+// A caller must obtain a Permit before sending an RPC. Permits are granted in
+// arrival order, once the token bucket holds a token and the number of RPCs in
+// flight is below the concurrency limit. The limit adapts in the AIMD style:
+// it grows by roughly one for each limit's worth of successful RPCs, and is
+// cut by `backoff_ratio` when an RPC fails with RESOURCE_EXHAUSTED or takes
+// longer than `latency_threshold`.
+class AdmissionController {
+ public:
+  struct Options {
+    // The sustained rate of admitted RPCs. 0 means that the rate is unlimited.
+    double requests_per_second = 0;
+    // The number of RPCs that may be admitted in a burst above the sustained
+    // rate.
+    int burst = 100;
+    // Bounds on the adaptive concurrency limit, and its starting value.
+    int initial_limit = 64;
+    int min_limit = 1;
+    int max_limit = 1024;
+    // The factor applied to the limit when an overload signal is observed.
+    double backoff_ratio = 0.5;
+    // RPCs slower than this are treated as an overload signal. 0 means that
+    // latency is not considered.
+    absl::Duration latency_threshold = absl::ZeroDuration();
+    // A caller that cannot be admitted immediately is rejected if this many
+    // callers are already waiting.
+    int max_queue_depth = 1024;
+    // The longest time a caller waits for a permit before it is rejected.
+    absl::Duration max_queue_wait = absl::Seconds(30);
+    // The clock used for rate limiting and latency measurement.
+    std::function<absl::Time()> clock = &absl::Now;
+  };
+
+  struct Stats {
+    // The number of callers currently waiting for a permit.
+    int64_t queue_depth;
+    // The largest queue depth observed.
+    int64_t max_queue_depth;
+    // The number of permits currently held.
+    int64_t in_flight;
+    // The current concurrency limit.
+    double limit;
+    // The total number of permits granted and of callers rejected.
+    uint64_t admitted;
+    uint64_t rejected;
+  };
+
+  // A Permit represents one admitted RPC. The outcome of the RPC should be
+  // reported with Complete(); a Permit that is destroyed without being
+  // completed releases its slot without adjusting the limit.
+  class Permit {
+   public:
+    // Constructs a permit that is not tied to any controller.
+    Permit() = default;
+    Permit(Permit&& other);
+    Permit& operator=(Permit&& other);
+    ~Permit();
+
+    // Releases the permit, using `rpc_status` and the elapsed time since
+    // admission to adjust the controller's concurrency limit.
+    void Complete(const absl::Status& rpc_status);
+
+   private:
+    friend class AdmissionController;
+    Permit(AdmissionController* controller, absl::Time admitted_at)
+        : controller_(controller), admitted_at_(admitted_at) {}
+
+    AdmissionController* controller_ = nullptr;
+    absl::Time admitted_at_;
+  };
+
+  explicit AdmissionController(Options options);
+  ~AdmissionController();
+
+  // Blocks until a permit is available. Returns RESOURCE_EXHAUSTED if the
+  // queue is full, or if no permit became available within `max_queue_wait`.
+  absl::StatusOr<Permit> Acquire();
+
+  Stats stats() const;
+
+ private:
+  struct Waiter {};
+
+  // Adds tokens accrued since the last refill to the bucket.
+  void RefillLocked(absl::Time now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Returns the time until the next token is available, or zero if the
+  // caller may be admitted now.
+  absl::Duration AdmissionDelayLocked() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Grants a permit to a caller that is eligible for admission.
+  Permit AdmitLocked(absl::Time now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns a permit that was granted at `admitted_at`. `rpc_status` is null
+  // if the outcome of the RPC is unknown.
+  void Release(const absl::Status* rpc_status, absl::Time admitted_at);
+
+  const Options options_;
+
+  mutable absl::Mutex mutex_;
+  absl::CondVar cond_;
+  std::list<Waiter*> waiters_ ABSL_GUARDED_BY(mutex_);
+  double tokens_ ABSL_GUARDED_BY(mutex_);
+  absl::Time last_refill_ ABSL_GUARDED_BY(mutex_);
+  absl::Time last_decrease_ ABSL_GUARDED_BY(mutex_);
+  double limit_ ABSL_GUARDED_BY(mutex_);
+  int64_t in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t max_queue_depth_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t admitted_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t rejected_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace cloud_kms
+
+#endif  // COMMON_ADMISSION_CONTROLLER_H_
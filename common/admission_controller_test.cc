@@ -0,0 +1,231 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/admission_controller.h"
+
+#include <thread>
+
+#include "absl/synchronization/notification.h"
+#include "common/test/matchers.h"
+#include "common/test/test_status_macros.h"
+#include "gmock/gmock.h"
+
+namespace cloud_kms {
+namespace {
+
+using ::testing::DoubleEq;
+using ::testing::Field;
+using ::testing::Gt;
+
+class AdmissionControllerTest : public testing::Test {
+ protected:
+  // Returns options with a fake clock, and without queueing, so that callers
+  // that cannot be admitted immediately are rejected.
+  AdmissionController::Options NewOptions() {
+    AdmissionController::Options options;
+    options.clock = [this] { return now_; };
+    options.max_queue_wait = absl::ZeroDuration();
+    return options;
+  }
+
+  absl::Time now_ = absl::FromUnixSeconds(1700000000);
+};
+
+TEST_F(AdmissionControllerTest, ConcurrencyIsBoundedByLimit) {
+  AdmissionController::Options options = NewOptions();
+  options.initial_limit = 2;
+  AdmissionController controller(options);
+
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p1, controller.Acquire());
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p2, controller.Acquire());
+  EXPECT_THAT(controller.Acquire(),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::in_flight, 2));
+
+  p1.Complete(absl::OkStatus());
+  EXPECT_OK(controller.Acquire());
+}
+
+TEST_F(AdmissionControllerTest, DestroyedPermitReleasesSlot) {
+  AdmissionController::Options options = NewOptions();
+  options.initial_limit = 1;
+  AdmissionController controller(options);
+
+  { ASSERT_OK(controller.Acquire()); }
+  EXPECT_OK(controller.Acquire());
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, DoubleEq(1)));
+}
+
+TEST_F(AdmissionControllerTest, ResourceExhaustedCutsLimitOncePerWindow) {
+  AdmissionController::Options options = NewOptions();
+  options.initial_limit = 8;
+  AdmissionController controller(options);
+
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p1, controller.Acquire());
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p2, controller.Acquire());
+  now_ += absl::Milliseconds(1);
+
+  p1.Complete(absl::ResourceExhaustedError("quota"));
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, DoubleEq(4)));
+
+  // p2 was admitted before the cut, so it does not cut the limit again.
+  p2.Complete(absl::ResourceExhaustedError("quota"));
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, DoubleEq(4)));
+
+  now_ += absl::Milliseconds(1);
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p3, controller.Acquire());
+  now_ += absl::Milliseconds(1);
+  p3.Complete(absl::ResourceExhaustedError("quota"));
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, DoubleEq(2)));
+}
+
+TEST_F(AdmissionControllerTest, LimitIsBoundedByMinLimit) {
+  AdmissionController::Options options = NewOptions();
+  options.initial_limit = 2;
+  options.min_limit = 2;
+  AdmissionController controller(options);
+
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p, controller.Acquire());
+  now_ += absl::Milliseconds(1);
+  p.Complete(absl::ResourceExhaustedError("quota"));
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, DoubleEq(2)));
+}
+
+TEST_F(AdmissionControllerTest, SlowRpcCutsLimit) {
+  AdmissionController::Options options = NewOptions();
+  options.initial_limit = 8;
+  options.latency_threshold = absl::Seconds(1);
+  AdmissionController controller(options);
+
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p, controller.Acquire());
+  now_ += absl::Seconds(2);
+  p.Complete(absl::OkStatus());
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, DoubleEq(4)));
+}
+
+TEST_F(AdmissionControllerTest, SuccessGrowsLimitUpToMaxLimit) {
+  AdmissionController::Options options = NewOptions();
+  options.initial_limit = 4;
+  options.max_limit = 5;
+  AdmissionController controller(options);
+
+  for (int i = 0; i < 4; i++) {
+    ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p, controller.Acquire());
+    p.Complete(absl::OkStatus());
+  }
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, Gt(4.5)));
+
+  for (int i = 0; i < 20; i++) {
+    ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p, controller.Acquire());
+    p.Complete(absl::OkStatus());
+  }
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, DoubleEq(5)));
+}
+
+TEST_F(AdmissionControllerTest, OtherErrorsDoNotChangeLimit) {
+  AdmissionController::Options options = NewOptions();
+  options.initial_limit = 4;
+  AdmissionController controller(options);
+
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit p, controller.Acquire());
+  now_ += absl::Milliseconds(1);
+  p.Complete(absl::NotFoundError("not found"));
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::limit, DoubleEq(4)));
+}
+
+TEST_F(AdmissionControllerTest, TokenBucketBoundsRate) {
+  AdmissionController::Options options = NewOptions();
+  options.requests_per_second = 10;
+  options.burst = 2;
+  AdmissionController controller(options);
+
+  EXPECT_OK(controller.Acquire());
+  EXPECT_OK(controller.Acquire());
+  EXPECT_THAT(controller.Acquire(),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  now_ += absl::Milliseconds(100);
+  EXPECT_OK(controller.Acquire());
+  EXPECT_THAT(controller.Acquire(),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  EXPECT_THAT(controller.stats(),
+              Field(&AdmissionController::Stats::rejected, 2));
+}
+
+TEST(AdmissionControllerQueueTest, WaiterIsAdmittedWhenPermitIsReleased) {
+  AdmissionController::Options options;
+  options.initial_limit = 1;
+  AdmissionController controller(options);
+
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit held, controller.Acquire());
+
+  absl::Notification admitted;
+  std::thread waiter([&] {
+    EXPECT_OK(controller.Acquire());
+    admitted.Notify();
+  });
+
+  while (controller.stats().queue_depth == 0) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  EXPECT_FALSE(admitted.HasBeenNotified());
+
+  held.Complete(absl::OkStatus());
+  admitted.WaitForNotification();
+  waiter.join();
+
+  AdmissionController::Stats stats = controller.stats();
+  EXPECT_EQ(stats.queue_depth, 0);
+  EXPECT_EQ(stats.max_queue_depth, 1);
+  EXPECT_EQ(stats.admitted, 2);
+}
+
+TEST(AdmissionControllerQueueTest, FullQueueRejectsImmediately) {
+  AdmissionController::Options options;
+  options.initial_limit = 1;
+  options.max_queue_depth = 0;
+  AdmissionController controller(options);
+
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit held, controller.Acquire());
+  EXPECT_THAT(controller.Acquire(),
+              StatusIs(absl::StatusCode::kResourceExhausted,
+                       testing::HasSubstr("queue is full")));
+}
+
+TEST(AdmissionControllerQueueTest, WaiterTimesOut) {
+  AdmissionController::Options options;
+  options.initial_limit = 1;
+  options.max_queue_wait = absl::Milliseconds(20);
+  AdmissionController controller(options);
+
+  ASSERT_OK_AND_ASSIGN(AdmissionController::Permit held, controller.Acquire());
+  EXPECT_THAT(controller.Acquire(),
+              StatusIs(absl::StatusCode::kResourceExhausted,
+                       testing::HasSubstr("timed out")));
+  EXPECT_EQ(controller.stats().queue_depth, 0);
+}
+
+}  // namespace
+}  // namespace cloud_kms
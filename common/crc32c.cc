@@ -0,0 +1,104 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/crc32c.h"
+
+#include "absl/base/call_once.h"
+#include "absl/crc/crc32c.h"
+#include "absl/log/absl_log.h"
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace cloud_kms {
+namespace {
+
+bool CpuSupportsHardwareCRC32C() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul");
+#elif defined(_M_X64) || defined(_M_IX86)
+  int regs[4];
+  __cpuid(regs, 1);
+  constexpr int kPclmulqdq = 1 << 1, kSse42 = 1 << 20;
+  return (regs[2] & kPclmulqdq) && (regs[2] & kSse42);
+#elif defined(__aarch64__) && defined(__linux__)
+  unsigned long hwcap = getauxval(AT_HWCAP);
+  return (hwcap & HWCAP_CRC32) && (hwcap & HWCAP_PMULL);
+#elif defined(__aarch64__) && defined(__APPLE__)
+  // Every Apple arm64 CPU implements both extensions.
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Mirrors the conditions under which Abseil compiles its accelerated CRC32C
+// implementation.
+constexpr bool kBuildEnablesHardwareCRC32C =
+#if (defined(__SSE4_2__) && defined(__PCLMUL__)) ||  \
+    (defined(__ARM_FEATURE_CRC32) && defined(__ARM_FEATURE_CRYPTO))
+    true;
+#else
+    false;
+#endif
+
+}  // namespace
+
+uint32_t ComputeCRC32C(std::string_view data) {
+  return static_cast<uint32_t>(absl::ComputeCrc32c(data));
+}
+
+bool CRC32CMatches(std::string_view data, uint32_t crc32c) {
+  return crc32c == ComputeCRC32C(data);
+}
+
+uint32_t AssignWithCRC32C(absl::Span<const uint8_t> data, std::string* dest) {
+  dest->resize(data.size());
+  return static_cast<uint32_t>(
+      absl::MemcpyCrc32c(dest->data(), data.data(), data.size()));
+}
+
+CRC32CSupport GetCRC32CSupport() {
+  static const CRC32CSupport kSupport{
+      .cpu_supported = CpuSupportsHardwareCRC32C(),
+      .build_enabled = kBuildEnablesHardwareCRC32C,
+  };
+  return kSupport;
+}
+
+void ReportCRC32CSupport() {
+  static absl::once_flag reported;
+  absl::call_once(reported, [] {
+    CRC32CSupport support = GetCRC32CSupport();
+    if (support.hardware()) {
+      ABSL_LOG(INFO) << "CRC32C checksums are computed with hardware "
+                        "instructions";
+    } else if (support.cpu_supported) {
+      // This is the case for default builds on most x86 hosts, so it isn't
+      // worth a warning. See BUILDING.md for enabling hardware CRC32C.
+      ABSL_LOG(INFO) << "CRC32C checksums are computed in software; this "
+                        "CPU supports hardware CRC32C, but this library was "
+                        "built without it";
+    } else {
+      ABSL_LOG(INFO) << "this CPU doesn't support hardware CRC32C; CRC32C "
+                        "checksums are computed in software";
+    }
+  });
+}
+
+}  // namespace cloud_kms
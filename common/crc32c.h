@@ -0,0 +1,61 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMMON_CRC32C_H_
+#define COMMON_CRC32C_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/types/span.h"
+
+namespace cloud_kms {
+
+// Returns the CRC32C checksum of `data`.
+uint32_t ComputeCRC32C(std::string_view data);
+
+// Returns true if `crc32c` is the CRC32C checksum of `data`.
+bool CRC32CMatches(std::string_view data, uint32_t crc32c);
+
+// Replaces the contents of `dest` with `data`, and returns the CRC32C checksum
+// of `data`. The checksum is computed as the data is copied, so that request
+// payloads are read once rather than twice.
+uint32_t AssignWithCRC32C(absl::Span<const uint8_t> data, std::string* dest);
+
+// Describes the CRC32C implementation in use in this process.
+struct CRC32CSupport {
+  // True if the CPU implements the instructions that accelerate CRC32C:
+  // SSE4.2 and PCLMULQDQ on x86, or the CRC32 and PMULL extensions on ARMv8.
+  bool cpu_supported;
+  // True if this binary was compiled to use those instructions. Abseil only
+  // uses them when they are enabled at compile time.
+  bool build_enabled;
+
+  bool hardware() const { return cpu_supported && build_enabled; }
+};
+
+// Returns the CRC32C implementation in use in this process.
+CRC32CSupport GetCRC32CSupport();
+
+// Logs the CRC32C implementation in use at INFO level, noting whether the CPU
+// could use hardware CRC32C in a build that enables it. Only the first call in
+// a process logs anything.
+void ReportCRC32CSupport();
+
+}  // namespace cloud_kms
+
+#endif  // COMMON_CRC32C_H_
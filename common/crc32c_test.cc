@@ -0,0 +1,57 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/crc32c.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace cloud_kms {
+namespace {
+
+TEST(ComputeCRC32CTest, KnownValues) {
+  // Check values from RFC 3720, section B.4.
+  EXPECT_EQ(ComputeCRC32C(std::string(32, '\x00')), 0x8A9136AA);
+  EXPECT_EQ(ComputeCRC32C(std::string(32, '\xff')), 0x62A8AB43);
+  EXPECT_EQ(ComputeCRC32C("123456789"), 0xE3069283);
+  EXPECT_EQ(ComputeCRC32C(""), 0);
+}
+
+TEST(CRC32CMatchesTest, MatchesOnlyCorrectChecksum) {
+  EXPECT_TRUE(CRC32CMatches("123456789", 0xE3069283));
+  EXPECT_FALSE(CRC32CMatches("123456789", 0xE3069282));
+}
+
+TEST(AssignWithCRC32CTest, CopiesDataAndReturnsChecksum) {
+  // Large enough to cover the accelerated paths, with a ragged tail.
+  std::vector<uint8_t> data(64 * 1024 + 7);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<uint8_t>(i * 31 + 7);
+  }
+  std::string expected(data.begin(), data.end());
+
+  std::string dest = "previous contents";
+  EXPECT_EQ(AssignWithCRC32C(data, &dest), ComputeCRC32C(expected));
+  EXPECT_EQ(dest, expected);
+}
+
+TEST(AssignWithCRC32CTest, EmptyDataClearsDestination) {
+  std::string dest = "previous contents";
+  EXPECT_EQ(AssignWithCRC32C({}, &dest), 0);
+  EXPECT_TRUE(dest.empty());
+}
+
+}  // namespace
+}  // namespace cloud_kms
@@ -0,0 +1,98 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/hedge_policy.h"
+
+#include <algorithm>
+
+namespace cloud_kms {
+namespace {
+
+// The number of latencies that must be observed before the delay is derived
+// from them.
+constexpr size_t kMinSamples = 32;
+
+// The largest number of hedges that may be sent back to back, after a long
+// run of requests that were not hedged.
+constexpr double kMaxBudget = 10;
+
+}  // namespace
+
+HedgePolicy::HedgePolicy(Options options)
+    : options_(options),
+      delay_(std::clamp(options.initial_delay, options.min_delay,
+                        options.max_delay)) {
+  latencies_.reserve(std::max(options_.window_size, 1));
+}
+
+absl::Duration HedgePolicy::StartRequest() {
+  absl::MutexLock lock(&mutex_);
+  requests_++;
+  budget_ = std::min(kMaxBudget, budget_ + options_.max_hedge_fraction);
+  return delay_;
+}
+
+bool HedgePolicy::TryStartHedge() {
+  absl::MutexLock lock(&mutex_);
+  if (budget_ < 1) {
+    return false;
+  }
+  budget_ -= 1;
+  hedges_++;
+  return true;
+}
+
+void HedgePolicy::RecordResult(absl::Duration latency, bool hedge_won) {
+  absl::MutexLock lock(&mutex_);
+  if (hedge_won) {
+    hedge_wins_++;
+  }
+
+  const size_t window_size = std::max(options_.window_size, 1);
+  if (latencies_.size() < window_size) {
+    latencies_.push_back(latency);
+  } else {
+    latencies_[next_latency_] = latency;
+  }
+  next_latency_ = (next_latency_ + 1) % window_size;
+
+  // Selecting the percentile is linear in the window size, so it is amortized
+  // over a number of samples.
+  if (latencies_.size() >= kMinSamples &&
+      ++samples_since_update_ >= std::max<size_t>(latencies_.size() / 16, 1)) {
+    UpdateDelayLocked();
+    samples_since_update_ = 0;
+  }
+}
+
+HedgePolicy::Stats HedgePolicy::stats() const {
+  absl::MutexLock lock(&mutex_);
+  Stats stats;
+  stats.requests = requests_;
+  stats.hedges = hedges_;
+  stats.hedge_wins = hedge_wins_;
+  stats.delay = delay_;
+  return stats;
+}
+
+void HedgePolicy::UpdateDelayLocked() {
+  std::vector<absl::Duration> sorted = latencies_;
+  size_t index = std::min(
+      static_cast<size_t>(options_.delay_percentile * sorted.size()),
+      sorted.size() - 1);
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+  delay_ = std::clamp(sorted[index], options_.min_delay, options_.max_delay);
+}
+
+}  // namespace cloud_kms
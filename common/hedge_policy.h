@@ -0,0 +1,93 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMMON_HEDGE_POLICY_H_
+#define COMMON_HEDGE_POLICY_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace cloud_kms {
+
+// HedgePolicy decides when a duplicate ("hedged") RPC should be sent for a
+// request that has not completed. The hedge delay tracks a percentile of
+// recently observed latencies, and hedges are budgeted so that they make up at
+// most a fixed fraction of all requests.
+class HedgePolicy {
+ public:
+  struct Options {
+    // The percentile of recent latencies after which a request is hedged.
+    double delay_percentile = 0.95;
+    // Bounds on the hedge delay.
+    absl::Duration min_delay = absl::Milliseconds(5);
+    absl::Duration max_delay = absl::Seconds(5);
+    // The hedge delay used until enough latencies have been observed.
+    absl::Duration initial_delay = absl::Milliseconds(100);
+    // The maximum number of hedges, as a fraction of all requests.
+    double max_hedge_fraction = 0.05;
+    // The number of recent latencies that the delay is derived from.
+    int window_size = 1024;
+  };
+
+  struct Stats {
+    uint64_t requests;
+    // The number of hedges sent, and the number whose response was used.
+    uint64_t hedges;
+    uint64_t hedge_wins;
+    absl::Duration delay;
+  };
+
+  explicit HedgePolicy(Options options);
+
+  // Records a new request, and returns the time after which it should be
+  // hedged if it has not completed.
+  absl::Duration StartRequest();
+
+  // Returns true if the budget allows a hedge to be sent, and deducts it.
+  bool TryStartHedge();
+
+  // Records the latency of a completed request, and whether the response that
+  // was used came from a hedge.
+  void RecordResult(absl::Duration latency, bool hedge_won);
+
+  Stats stats() const;
+
+ private:
+  // Recomputes the hedge delay from the latency window.
+  void UpdateDelayLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Options options_;
+
+  mutable absl::Mutex mutex_;
+  // A ring buffer of recent latencies.
+  std::vector<absl::Duration> latencies_ ABSL_GUARDED_BY(mutex_);
+  size_t next_latency_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t samples_since_update_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::Duration delay_ ABSL_GUARDED_BY(mutex_);
+  // Each request adds `max_hedge_fraction` to the budget, and each hedge
+  // consumes one unit.
+  double budget_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t requests_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t hedges_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t hedge_wins_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace cloud_kms
+
+#endif  // COMMON_HEDGE_POLICY_H_
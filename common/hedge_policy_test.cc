@@ -0,0 +1,129 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/hedge_policy.h"
+
+#include "gmock/gmock.h"
+
+namespace cloud_kms {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Ge;
+using ::testing::Le;
+
+TEST(HedgePolicyTest, InitialDelayIsUsedUntilLatenciesAreObserved) {
+  HedgePolicy::Options options;
+  options.initial_delay = absl::Milliseconds(40);
+  HedgePolicy policy(options);
+
+  EXPECT_EQ(policy.StartRequest(), absl::Milliseconds(40));
+  for (int i = 0; i < 10; i++) {
+    policy.RecordResult(absl::Milliseconds(1), false);
+  }
+  EXPECT_EQ(policy.StartRequest(), absl::Milliseconds(40));
+}
+
+TEST(HedgePolicyTest, DelayTracksLatencyPercentile) {
+  HedgePolicy::Options options;
+  options.delay_percentile = 0.9;
+  options.min_delay = absl::ZeroDuration();
+  options.window_size = 100;
+  HedgePolicy policy(options);
+
+  // Latencies of 1ms through 100ms. The delay is recomputed periodically, so
+  // it may not yet reflect the last few samples.
+  for (int i = 1; i <= 100; i++) {
+    policy.RecordResult(absl::Milliseconds(i), false);
+  }
+  EXPECT_THAT(policy.StartRequest(),
+              AllOf(Ge(absl::Milliseconds(85)), Le(absl::Milliseconds(91))));
+}
+
+TEST(HedgePolicyTest, DelayReflectsOnlyRecentLatencies) {
+  HedgePolicy::Options options;
+  options.delay_percentile = 0.5;
+  options.min_delay = absl::ZeroDuration();
+  options.window_size = 64;
+  HedgePolicy policy(options);
+
+  for (int i = 0; i < 64; i++) {
+    policy.RecordResult(absl::Milliseconds(500), false);
+  }
+  for (int i = 0; i < 64; i++) {
+    policy.RecordResult(absl::Milliseconds(10), false);
+  }
+  EXPECT_EQ(policy.StartRequest(), absl::Milliseconds(10));
+}
+
+TEST(HedgePolicyTest, DelayIsClamped) {
+  HedgePolicy::Options options;
+  options.min_delay = absl::Milliseconds(20);
+  options.max_delay = absl::Milliseconds(50);
+  HedgePolicy policy(options);
+
+  for (int i = 0; i < 100; i++) {
+    policy.RecordResult(absl::Milliseconds(1), false);
+  }
+  EXPECT_EQ(policy.StartRequest(), absl::Milliseconds(20));
+
+  for (int i = 0; i < 1024; i++) {
+    policy.RecordResult(absl::Seconds(1), false);
+  }
+  EXPECT_EQ(policy.StartRequest(), absl::Milliseconds(50));
+}
+
+TEST(HedgePolicyTest, HedgesAreCappedAsFractionOfRequests) {
+  HedgePolicy::Options options;
+  options.max_hedge_fraction = 0.25;
+  HedgePolicy policy(options);
+
+  int hedges = 0;
+  for (int i = 0; i < 100; i++) {
+    policy.StartRequest();
+    if (policy.TryStartHedge()) {
+      hedges++;
+    }
+  }
+  EXPECT_EQ(hedges, 25);
+
+  HedgePolicy::Stats stats = policy.stats();
+  EXPECT_EQ(stats.requests, 100);
+  EXPECT_EQ(stats.hedges, 25);
+}
+
+TEST(HedgePolicyTest, UnusedBudgetIsBounded) {
+  HedgePolicy::Options options;
+  options.max_hedge_fraction = 0.5;
+  HedgePolicy policy(options);
+
+  for (int i = 0; i < 1000; i++) {
+    policy.StartRequest();
+  }
+  int hedges = 0;
+  while (policy.TryStartHedge()) {
+    hedges++;
+  }
+  EXPECT_EQ(hedges, 10);
+}
+
+TEST(HedgePolicyTest, StatsCountHedgeWins) {
+  HedgePolicy policy(HedgePolicy::Options{});
+  policy.RecordResult(absl::Milliseconds(1), true);
+  policy.RecordResult(absl::Milliseconds(1), false);
+  EXPECT_EQ(policy.stats().hedge_wins, 1);
+}
+
+}  // namespace
+}  // namespace cloud_kms
@@ -14,22 +14,28 @@
 
 #include "common/kms_client.h"
 
-#include "absl/crc/crc32c.h"
+#include <algorithm>
+
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "cloudkms_grpc_service_config.h"
 #include "common/backoff.h"
+#include "common/crc32c.h"
 #include "common/openssl.h"
 #include "common/platform.h"
 #include "common/source_location.h"
 #include "common/status_macros.h"
 #include "grpcpp/client_context.h"
+#include "grpcpp/completion_queue.h"
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
 
 namespace cloud_kms {
 namespace {
 
+// A channel argument that is unique to each channel in a client's pool.
+constexpr char kChannelIndexArg[] = "cloud_kms.channel_index";
+
 // clang-format off
 // Sample value:
 // `cloud-kms-pkcs11/0.21 (amd64; BoringSSL; Linux/4.15.0-1096-gcp-x86_64; glibc/2.23)`
@@ -69,12 +75,229 @@ absl::StatusOr<std::string> GetDigestString(const kms_v1::Digest& digest) {
   }
 }
 
-uint32_t ComputeCRC32C(std::string_view data) {
-  return static_cast<uint32_t>(absl::ComputeCrc32c(data));
+absl::Status ResponseChecksumMismatchError(
+    const SourceLocation& source_location) {
+  return absl::InternalError(absl::StrFormat(
+      "at %s: the response crc32c did not match the expected checksum value",
+      source_location.ToString()));
+}
+
+absl::Status RequestChecksumNotVerifiedError(
+    const SourceLocation& source_location) {
+  return absl::InternalError(
+      absl::StrFormat("at %s: the server did not verify the checksum values "
+                      "provided in the request",
+                      source_location.ToString()));
+}
+
+// The SetRequestChecksums overloads compute and attach the CRC32C checksums of
+// each checksummed request field, and the VerifyResponseChecksums overloads
+// check the response fields and the server's acknowledgement of the request
+// checksums. They are shared by the synchronous and asynchronous code paths.
+// The checksum of a bulk payload (RawEncrypt plaintext, RawDecrypt ciphertext)
+// is kept if the caller already set it, which it can do in the same pass that
+// copies the payload into the request with AssignWithCRC32C.
+
+void SetRequestChecksums(kms_v1::AsymmetricDecryptRequest& request) {
+  request.mutable_ciphertext_crc32c()->set_value(
+      ComputeCRC32C(request.ciphertext()));
+}
+
+absl::Status VerifyResponseChecksums(
+    const kms_v1::AsymmetricDecryptResponse& response) {
+  if (!CRC32CMatches(response.plaintext(),
+                     response.plaintext_crc32c().value())) {
+    return ResponseChecksumMismatchError(SOURCE_LOCATION);
+  }
+  if (!response.verified_ciphertext_crc32c()) {
+    return RequestChecksumNotVerifiedError(SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SetRequestChecksums(kms_v1::AsymmetricSignRequest& request) {
+  if (!request.data().empty()) {
+    request.mutable_data_crc32c()->set_value(ComputeCRC32C(request.data()));
+    return absl::OkStatus();
+  }
+  ASSIGN_OR_RETURN(std::string digest_string,
+                   GetDigestString(request.digest()));
+  request.mutable_digest_crc32c()->set_value(ComputeCRC32C(digest_string));
+  return absl::OkStatus();
+}
+
+absl::Status VerifyResponseChecksums(
+    const kms_v1::AsymmetricSignResponse& response, bool use_data) {
+  if (!CRC32CMatches(response.signature(),
+                     response.signature_crc32c().value())) {
+    return ResponseChecksumMismatchError(SOURCE_LOCATION);
+  }
+  if (use_data && !response.verified_data_crc32c()) {
+    return RequestChecksumNotVerifiedError(SOURCE_LOCATION);
+  }
+  if (!use_data && !response.verified_digest_crc32c()) {
+    return RequestChecksumNotVerifiedError(SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+void SetRequestChecksums(kms_v1::MacSignRequest& request) {
+  request.mutable_data_crc32c()->set_value(ComputeCRC32C(request.data()));
+}
+
+absl::Status VerifyResponseChecksums(const kms_v1::MacSignResponse& response) {
+  if (!CRC32CMatches(response.mac(), response.mac_crc32c().value())) {
+    return ResponseChecksumMismatchError(SOURCE_LOCATION);
+  }
+  if (!response.verified_data_crc32c()) {
+    return RequestChecksumNotVerifiedError(SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+void SetRequestChecksums(kms_v1::MacVerifyRequest& request) {
+  request.mutable_data_crc32c()->set_value(ComputeCRC32C(request.data()));
+  request.mutable_mac_crc32c()->set_value(ComputeCRC32C(request.mac()));
 }
 
-bool CRC32CMatches(std::string_view data, uint32_t crc32c) {
-  return crc32c == ComputeCRC32C(data);
+absl::Status VerifyResponseChecksums(
+    const kms_v1::MacVerifyResponse& response) {
+  if (response.success() != response.verified_success_integrity()) {
+    return ResponseChecksumMismatchError(SOURCE_LOCATION);
+  }
+  if (!response.verified_data_crc32c() || !response.verified_mac_crc32c()) {
+    return RequestChecksumNotVerifiedError(SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+void SetRequestChecksums(kms_v1::RawDecryptRequest& request) {
+  if (!request.has_ciphertext_crc32c()) {
+    request.mutable_ciphertext_crc32c()->set_value(
+        ComputeCRC32C(request.ciphertext()));
+  }
+  request.mutable_initialization_vector_crc32c()->set_value(
+      ComputeCRC32C(request.initialization_vector()));
+  request.mutable_additional_authenticated_data_crc32c()->set_value(
+      ComputeCRC32C(request.additional_authenticated_data()));
+}
+
+absl::Status VerifyResponseChecksums(
+    const kms_v1::RawDecryptResponse& response) {
+  if (!CRC32CMatches(response.plaintext(),
+                     response.plaintext_crc32c().value())) {
+    return ResponseChecksumMismatchError(SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+void SetRequestChecksums(kms_v1::RawEncryptRequest& request) {
+  if (!request.has_plaintext_crc32c()) {
+    request.mutable_plaintext_crc32c()->set_value(
+        ComputeCRC32C(request.plaintext()));
+  }
+  request.mutable_additional_authenticated_data_crc32c()->set_value(
+      ComputeCRC32C(request.additional_authenticated_data()));
+  request.mutable_initialization_vector_crc32c()->set_value(
+      ComputeCRC32C(request.initialization_vector()));
+}
+
+absl::Status VerifyResponseChecksums(
+    const kms_v1::RawEncryptResponse& response) {
+  if (!CRC32CMatches(response.ciphertext(),
+                     response.ciphertext_crc32c().value())) {
+    return ResponseChecksumMismatchError(SOURCE_LOCATION);
+  }
+  if (!response.verified_plaintext_crc32c() ||
+      !response.verified_additional_authenticated_data_crc32c() ||
+      !response.verified_initialization_vector_crc32c()) {
+    return RequestChecksumNotVerifiedError(SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+// An RPC started on a completion queue. The address of the call is used as its
+// completion queue tag, and the poller that dequeues the tag owns the call.
+class AsyncCall {
+ public:
+  virtual ~AsyncCall() {}
+
+  // Invoked on a poller thread once the RPC has finished.
+  virtual void Complete() = 0;
+};
+
+template <typename Response>
+class UnaryAsyncCall : public AsyncCall {
+ public:
+  // Receives the status of the RPC and the message its response was read into.
+  using DoneCallback = std::function<void(absl::Status, Response*)>;
+
+  // The response is read into `response` if it is set, and into a message
+  // owned by the call otherwise.
+  UnaryAsyncCall(DoneCallback done, Response* response = nullptr)
+      : done_(std::move(done)),
+        response_(response ? response : &owned_response_) {}
+
+  grpc::ClientContext* context() { return &ctx_; }
+
+  void Start(std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> rpc) {
+    rpc_ = std::move(rpc);
+    rpc_->StartCall();
+    rpc_->Finish(response_, &status_, this);
+  }
+
+  void Complete() override { done_(ToStatus(status_), response_); }
+
+ private:
+  DoneCallback done_;
+  grpc::ClientContext ctx_;
+  std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> rpc_;
+  Response owned_response_;
+  Response* response_;
+  grpc::Status status_;
+};
+
+// The state shared between a hedged call and its RPCs.
+template <typename Response>
+struct HedgedCallState {
+  static constexpr int kMaxAttempts = 2;
+
+  absl::Mutex mutex;
+  // The context of each RPC that is still in flight. A context is cleared
+  // before its RPC is destroyed, so it may be cancelled while `mutex` is held.
+  grpc::ClientContext* contexts[kMaxAttempts] ABSL_GUARDED_BY(mutex) = {};
+  int started ABSL_GUARDED_BY(mutex) = 0;
+  int finished ABSL_GUARDED_BY(mutex) = 0;
+  // The attempt whose response passed verification first, or -1.
+  int response_attempt ABSL_GUARDED_BY(mutex) = -1;
+  absl::Status error ABSL_GUARDED_BY(mutex);
+
+  bool Done() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return response_attempt >= 0 || finished == started;
+  }
+  bool AllFinished() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return finished == started;
+  }
+};
+
+std::string RpcCodeLabel(int64_t code) {
+  return absl::StatusCodeToString(static_cast<absl::StatusCode>(code));
+}
+
+const MetricsRegistry::Family kRpcLatency = {
+    "cloud_kms_rpc_latency_seconds",
+    "Latency of Cloud KMS RPCs, by method and status code.", "method", "code",
+    &RpcCodeLabel};
+
+void PollCompletionQueue(grpc::CompletionQueue* cq) {
+  void* tag;
+  bool ok;
+  // Next returns false only once the queue is shut down and fully drained, so
+  // every started call is completed before the poller exits.
+  while (cq->Next(&tag, &ok)) {
+    std::unique_ptr<AsyncCall> call(static_cast<AsyncCall*>(tag));
+    call->Complete();
+  }
 }
 
 }  // namespace
@@ -103,251 +326,576 @@ absl::Status KmsClient::DecorateStatus(absl::Status& status) const {
   return status;
 }
 
+template <typename Rpc>
+absl::Status KmsClient::TimedRpc(const char* method_name, Rpc rpc) const {
+  if (!metrics_) {
+    return ToStatus(rpc());
+  }
+  absl::Time start = absl::Now();
+  absl::Status result = ToStatus(rpc());
+  RecordRpcLatency(method_name, result, start);
+  return result;
+}
+
+void KmsClient::RecordRpcLatency(const char* method_name,
+                                 const absl::Status& result,
+                                 absl::Time start) const {
+  if (metrics_) {
+    metrics_->RecordLatency(kRpcLatency, method_name,
+                            static_cast<int64_t>(result.code()),
+                            absl::Now() - start);
+  }
+}
+
+AdmissionController* KmsClient::AdmissionControllerFor(
+    std::string_view resource_name) const {
+  if (!key_ring_admission_controllers_.empty()) {
+    std::string_view key_ring_name = resource_name.substr(
+        0, resource_name.find("/cryptoKeys/"));
+    auto it = key_ring_admission_controllers_.find(key_ring_name);
+    if (it != key_ring_admission_controllers_.end()) {
+      return it->second.get();
+    }
+  }
+  return admission_controller_.get();
+}
+
+absl::StatusOr<AdmissionController::Permit> KmsClient::Admit(
+    std::string_view resource_name) const {
+  AdmissionController* controller = AdmissionControllerFor(resource_name);
+  if (!controller) {
+    return AdmissionController::Permit();
+  }
+  return controller->Acquire();
+}
+
 KmsClient::KmsClient(const Options& options)
     : rpc_timeout_(options.rpc_timeout),
       rpc_feature_flags_(options.rpc_feature_flags),
       user_project_override_(options.user_project_override),
-      error_decorator_(options.error_decorator) {
+      error_decorator_(options.error_decorator),
+      metrics_(options.metrics),
+      async_poller_threads_(std::max(options.async_poller_threads, 1)) {
+  ReportCRC32CSupport();
+
   grpc::ChannelArguments args;
   args.SetUserAgentPrefix(ComputeUserAgentPrefix(
       options.user_agent, options.version_major, options.version_minor));
   args.SetServiceConfigJSON(std::string(kDefaultCloudKmsGrpcServiceConfig));
 
-  std::shared_ptr<grpc::Channel> channel = grpc::CreateCustomChannel(
-      std::string(options.endpoint_address), options.creds, args);
+  int channel_count = std::max(options.channel_pool_size, 1);
+  kms_stubs_.reserve(channel_count);
+  for (int i = 0; i < channel_count; i++) {
+    // gRPC shares subchannels (and thus TCP connections) between channels
+    // with identical arguments, so a distinct argument is required for each
+    // channel in the pool to get a connection of its own.
+    grpc::ChannelArguments channel_args = args;
+    channel_args.SetInt(kChannelIndexArg, i);
+
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateCustomChannel(
+        std::string(options.endpoint_address), options.creds, channel_args);
+    kms_stubs_.push_back(kms_v1::KeyManagementService::NewStub(channel));
+  }
+
+  if (options.mac_verify_cache.has_value()) {
+    mac_verify_cache_ =
+        std::make_unique<MacVerifyCache>(*options.mac_verify_cache);
+  }
+  if (options.hedging.has_value()) {
+    hedge_policy_ = std::make_unique<HedgePolicy>(*options.hedging);
+  }
+  if (options.admission_control.has_value()) {
+    admission_controller_ =
+        std::make_unique<AdmissionController>(*options.admission_control);
+  }
+  for (const auto& [key_ring_name, admission_options] :
+       options.key_ring_admission_control) {
+    key_ring_admission_controllers_[key_ring_name] =
+        std::make_unique<AdmissionController>(admission_options);
+  }
+}
+
+KmsClient::~KmsClient() {
+  for (std::unique_ptr<grpc::CompletionQueue>& cq : completion_queues_) {
+    cq->Shutdown();
+  }
+  for (std::thread& poller : pollers_) {
+    poller.join();
+  }
+}
+
+kms_v1::KeyManagementService::Stub* KmsClient::NextStub() const {
+  if (kms_stubs_.size() == 1) {
+    return kms_stubs_.front().get();
+  }
+  size_t i = next_stub_.fetch_add(1, std::memory_order_relaxed);
+  return kms_stubs_[i % kms_stubs_.size()].get();
+}
+
+grpc::CompletionQueue* KmsClient::NextCompletionQueue() const {
+  absl::call_once(pollers_started_, [this] {
+    for (int i = 0; i < async_poller_threads_; i++) {
+      completion_queues_.push_back(std::make_unique<grpc::CompletionQueue>());
+      pollers_.emplace_back(&PollCompletionQueue,
+                            completion_queues_.back().get());
+    }
+  });
+  size_t i = next_completion_queue_.fetch_add(1, std::memory_order_relaxed);
+  return completion_queues_[i % completion_queues_.size()].get();
+}
+
+template <typename Request, typename Response>
+void KmsClient::StartAsyncCall(
+    PrepareAsyncMethod<Request, Response> method, const char* method_name,
+    const Request& request, std::function<absl::Status(const Response&)> verify,
+    AsyncCallback<Response> callback) const {
+  auto* call = new UnaryAsyncCall<Response>(
+      [this, method_name, start = absl::Now(), verify = std::move(verify),
+       callback = std::move(callback)](absl::Status rpc_result,
+                                       Response* response) {
+        RecordRpcLatency(method_name, rpc_result, start);
+        if (rpc_result.ok()) {
+          rpc_result = verify(*response);
+        }
+        if (!rpc_result.ok()) {
+          callback(DecorateStatus(rpc_result));
+          return;
+        }
+        callback(std::move(*response));
+      });
+  AddContextSettings(call->context(), "name", request.name());
+  call->Start((NextStub()->*method)(call->context(), request,
+                                    NextCompletionQueue()));
+}
+
+template <typename Request, typename Response>
+absl::Status KmsClient::HedgedCall(
+    PrepareAsyncMethod<Request, Response> method, const char* method_name,
+    const Request& request,
+    std::function<absl::Status(const Response&)> verify,
+    Response* response) const {
+  using State = HedgedCallState<Response>;
+  auto state = std::make_shared<State>();
+  const absl::Time start = absl::Now();
+  const absl::Time deadline = start + rpc_timeout_;
+
+  // The first attempt reads its response straight into `response`. A hedge
+  // reads into a message on the same arena, which is swapped into `response`
+  // without a copy if the hedge wins.
+  google::protobuf::Arena* arena = response->GetArena();
+  Response* hedge_response =
+      google::protobuf::Arena::CreateMessage<Response>(arena);
+  std::unique_ptr<Response> owned_hedge_response(arena ? nullptr
+                                                       : hedge_response);
+  Response* responses[State::kMaxAttempts] = {response, hedge_response};
+
+  auto start_attempt = [&](int attempt) {
+    auto* call = new UnaryAsyncCall<Response>(
+        [state, attempt, verify](absl::Status rpc_result,
+                                 Response* attempt_response) {
+          if (rpc_result.ok()) {
+            rpc_result = verify(*attempt_response);
+          }
+          absl::MutexLock lock(&state->mutex);
+          state->contexts[attempt] = nullptr;
+          state->finished++;
+          if (state->response_attempt >= 0) {
+            return;  // The other attempt won.
+          }
+          if (rpc_result.ok()) {
+            state->response_attempt = attempt;
+          } else if (state->error.ok()) {
+            state->error = rpc_result;
+          }
+        },
+        responses[attempt]);
+    AddContextSettings(call->context(), "name", request.name(), deadline);
+    state->contexts[attempt] = call->context();
+    state->started++;
+    call->Start((NextStub()->*method)(call->context(), request,
+                                      NextCompletionQueue()));
+  };
+
+  absl::Duration hedge_delay = hedge_policy_->StartRequest();
+  absl::MutexLock lock(&state->mutex);
+  start_attempt(0);
+  if (!state->mutex.AwaitWithTimeout(absl::Condition(state.get(), &State::Done),
+                                     hedge_delay) &&
+      hedge_policy_->TryStartHedge()) {
+    start_attempt(1);
+  }
+  state->mutex.Await(absl::Condition(state.get(), &State::Done));
 
-  kms_stub_ = kms_v1::KeyManagementService::NewStub(channel);
+  if (state->response_attempt < 0) {
+    RecordRpcLatency(method_name, state->error, start);
+    return state->error;
+  }
+  RecordRpcLatency(method_name, absl::OkStatus(), start);
+  absl::Duration latency = absl::Now() - start;
+  for (grpc::ClientContext* ctx : state->contexts) {
+    if (ctx) {
+      ctx->TryCancel();
+    }
+  }
+  // Both attempts read into messages owned by the caller, so the cancelled
+  // attempt must complete before they are handed back.
+  state->mutex.Await(absl::Condition(state.get(), &State::AllFinished));
+  hedge_policy_->RecordResult(latency, state->response_attempt > 0);
+  if (state->response_attempt > 0) {
+    response->Swap(hedge_response);
+  }
+  return absl::OkStatus();
+}
+
+std::optional<HedgePolicy::Stats> KmsClient::HedgingStats() const {
+  if (!hedge_policy_) {
+    return std::nullopt;
+  }
+  return hedge_policy_->stats();
 }
 
 absl::StatusOr<kms_v1::AsymmetricDecryptResponse> KmsClient::AsymmetricDecrypt(
     kms_v1::AsymmetricDecryptRequest& request) const {
+  absl::StatusOr<AdmissionController::Permit> permit = Admit(request.name());
+  if (!permit.ok()) {
+    absl::Status admission_result = permit.status();
+    return DecorateStatus(admission_result);
+  }
+
   grpc::ClientContext ctx;
   AddContextSettings(&ctx, "name", request.name());
 
-  request.mutable_ciphertext_crc32c()->set_value(
-      ComputeCRC32C(request.ciphertext()));
+  SetRequestChecksums(request);
 
   kms_v1::AsymmetricDecryptResponse response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->AsymmetricDecrypt(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("AsymmetricDecrypt", [&] {
+    return NextStub()->AsymmetricDecrypt(&ctx, request, &response);
+  });
+  permit->Complete(rpc_result);
+  if (rpc_result.ok()) {
+    rpc_result = VerifyResponseChecksums(response);
+  }
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
+  return response;
+}
 
-  if (!CRC32CMatches(response.plaintext(),
-                     response.plaintext_crc32c().value())) {
-    rpc_result = absl::InternalError(absl::StrFormat(
-        "at %s: the response crc32c did not match the expected checksum value",
-        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
-  }
+void KmsClient::AsymmetricDecryptAsync(
+    kms_v1::AsymmetricDecryptRequest request,
+    AsyncCallback<kms_v1::AsymmetricDecryptResponse> callback) const {
+  SetRequestChecksums(request);
+  StartAsyncCall<kms_v1::AsymmetricDecryptRequest,
+                 kms_v1::AsymmetricDecryptResponse>(
+      &kms_v1::KeyManagementService::Stub::PrepareAsyncAsymmetricDecrypt,
+      "AsymmetricDecrypt", request,
+      [](const kms_v1::AsymmetricDecryptResponse& response) {
+        return VerifyResponseChecksums(response);
+      },
+      std::move(callback));
+}
 
-  if (!response.verified_ciphertext_crc32c()) {
-    rpc_result = absl::InternalError(
-        absl::StrFormat("at %s: the server did not verify the checksum values "
-                        "provided in the request",
-                        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
-  }
+absl::StatusOr<kms_v1::AsymmetricSignResponse> KmsClient::AsymmetricSign(
+    kms_v1::AsymmetricSignRequest& request) const {
+  kms_v1::AsymmetricSignResponse response;
+  RETURN_IF_ERROR(AsymmetricSignInto(request, &response));
+  return response;
+}
 
+absl::StatusOr<kms_v1::AsymmetricSignResponse*> KmsClient::AsymmetricSign(
+    kms_v1::AsymmetricSignRequest& request,
+    google::protobuf::Arena* arena) const {
+  auto* response =
+      google::protobuf::Arena::CreateMessage<kms_v1::AsymmetricSignResponse>(
+          arena);
+  RETURN_IF_ERROR(AsymmetricSignInto(request, response));
   return response;
 }
 
-absl::StatusOr<kms_v1::AsymmetricSignResponse> KmsClient::AsymmetricSign(
-    kms_v1::AsymmetricSignRequest& request) const {
-  grpc::ClientContext ctx;
-  AddContextSettings(&ctx, "name", request.name());
+absl::Status KmsClient::AsymmetricSignInto(
+    kms_v1::AsymmetricSignRequest& request,
+    kms_v1::AsymmetricSignResponse* response) const {
+  absl::StatusOr<AdmissionController::Permit> permit = Admit(request.name());
+  if (!permit.ok()) {
+    absl::Status admission_result = permit.status();
+    return DecorateStatus(admission_result);
+  }
 
-  bool use_data = false;
-  if (!request.data().empty()) {
-    use_data = true;
-    request.mutable_data_crc32c()->set_value(ComputeCRC32C(request.data()));
-  } else {
-    absl::StatusOr<std::string> digest_string =
-        GetDigestString(request.digest());
-    if (!digest_string.ok()) {
-      absl::Status status = digest_string.status();
-      return DecorateStatus(status);
+  absl::Status checksum_result = SetRequestChecksums(request);
+  if (!checksum_result.ok()) {
+    return DecorateStatus(checksum_result);
+  }
+
+  if (hedge_policy_) {
+    absl::Status rpc_result = HedgedCall<kms_v1::AsymmetricSignRequest,
+                                         kms_v1::AsymmetricSignResponse>(
+        &kms_v1::KeyManagementService::Stub::PrepareAsyncAsymmetricSign,
+        "AsymmetricSign", request,
+        [use_data = !request.data().empty()](
+            const kms_v1::AsymmetricSignResponse& response) {
+          return VerifyResponseChecksums(response, use_data);
+        },
+        response);
+    permit->Complete(rpc_result);
+    if (!rpc_result.ok()) {
+      return DecorateStatus(rpc_result);
     }
-    request.mutable_digest_crc32c()->set_value(ComputeCRC32C(*digest_string));
+    return absl::OkStatus();
   }
 
-  kms_v1::AsymmetricSignResponse response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->AsymmetricSign(&ctx, request, &response));
+  grpc::ClientContext ctx;
+  AddContextSettings(&ctx, "name", request.name());
+
+  absl::Status rpc_result = TimedRpc("AsymmetricSign", [&] {
+    return NextStub()->AsymmetricSign(&ctx, request, response);
+  });
+  permit->Complete(rpc_result);
+  if (rpc_result.ok()) {
+    rpc_result = VerifyResponseChecksums(*response, !request.data().empty());
+  }
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
+  return absl::OkStatus();
+}
 
-  if (!CRC32CMatches(response.signature(),
-                     response.signature_crc32c().value())) {
-    rpc_result = absl::InternalError(absl::StrFormat(
-        "at %s: the response crc32c did not match the expected checksum value",
-        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
+std::optional<AdmissionController::Stats> KmsClient::AdmissionControlStats(
+    std::string_view key_ring_name) const {
+  AdmissionController* controller = AdmissionControllerFor(key_ring_name);
+  if (!controller) {
+    return std::nullopt;
   }
+  return controller->stats();
+}
 
-  if (use_data && !response.verified_data_crc32c()) {
-    rpc_result = absl::InternalError(
-        absl::StrFormat("at %s: the server did not verify the checksum values "
-                        "provided in the request",
-                        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
-  }
-  if (!use_data && !response.verified_digest_crc32c()) {
-    rpc_result = absl::InternalError(
-        absl::StrFormat("at %s: the server did not verify the checksum values "
-                        "provided in the request",
-                        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
+void KmsClient::InvalidateMacVerifyCache(
+    std::string_view key_version_name) const {
+  if (mac_verify_cache_) {
+    mac_verify_cache_->Invalidate(key_version_name);
   }
+}
 
-  return response;
+void KmsClient::AsymmetricSignAsync(
+    kms_v1::AsymmetricSignRequest request,
+    AsyncCallback<kms_v1::AsymmetricSignResponse> callback) const {
+  absl::Status checksum_result = SetRequestChecksums(request);
+  if (!checksum_result.ok()) {
+    callback(DecorateStatus(checksum_result));
+    return;
+  }
+  StartAsyncCall<kms_v1::AsymmetricSignRequest, kms_v1::AsymmetricSignResponse>(
+      &kms_v1::KeyManagementService::Stub::PrepareAsyncAsymmetricSign,
+      "AsymmetricSign", request,
+      [use_data = !request.data().empty()](
+          const kms_v1::AsymmetricSignResponse& response) {
+        return VerifyResponseChecksums(response, use_data);
+      },
+      std::move(callback));
 }
 
 absl::StatusOr<kms_v1::MacSignResponse> KmsClient::MacSign(
     kms_v1::MacSignRequest& request) const {
-  grpc::ClientContext ctx;
-  AddContextSettings(&ctx, "name", request.name());
+  kms_v1::MacSignResponse response;
+  RETURN_IF_ERROR(MacSignInto(request, &response));
+  return response;
+}
 
-  request.mutable_data_crc32c()->set_value(ComputeCRC32C(request.data()));
+absl::StatusOr<kms_v1::MacSignResponse*> KmsClient::MacSign(
+    kms_v1::MacSignRequest& request, google::protobuf::Arena* arena) const {
+  auto* response =
+      google::protobuf::Arena::CreateMessage<kms_v1::MacSignResponse>(arena);
+  RETURN_IF_ERROR(MacSignInto(request, response));
+  return response;
+}
 
-  kms_v1::MacSignResponse response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->MacSign(&ctx, request, &response));
-  if (!rpc_result.ok()) {
-    return DecorateStatus(rpc_result);
+absl::Status KmsClient::MacSignInto(kms_v1::MacSignRequest& request,
+                                    kms_v1::MacSignResponse* response) const {
+  absl::StatusOr<AdmissionController::Permit> permit = Admit(request.name());
+  if (!permit.ok()) {
+    absl::Status admission_result = permit.status();
+    return DecorateStatus(admission_result);
   }
 
-  if (!CRC32CMatches(response.mac(), response.mac_crc32c().value())) {
-    rpc_result = absl::InternalError(absl::StrFormat(
-        "at %s: the response crc32c did not match the expected checksum value",
-        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
+  SetRequestChecksums(request);
+
+  if (hedge_policy_) {
+    absl::Status rpc_result =
+        HedgedCall<kms_v1::MacSignRequest, kms_v1::MacSignResponse>(
+            &kms_v1::KeyManagementService::Stub::PrepareAsyncMacSign,
+            "MacSign", request,
+            [](const kms_v1::MacSignResponse& response) {
+              return VerifyResponseChecksums(response);
+            },
+            response);
+    permit->Complete(rpc_result);
+    if (!rpc_result.ok()) {
+      return DecorateStatus(rpc_result);
+    }
+    return absl::OkStatus();
   }
 
-  if (!response.verified_data_crc32c()) {
-    rpc_result = absl::InternalError(
-        absl::StrFormat("at %s: the server did not verify the checksum values "
-                        "provided in the request",
-                        SOURCE_LOCATION.ToString()));
+  grpc::ClientContext ctx;
+  AddContextSettings(&ctx, "name", request.name());
+
+  absl::Status rpc_result = TimedRpc("MacSign", [&] {
+    return NextStub()->MacSign(&ctx, request, response);
+  });
+  permit->Complete(rpc_result);
+  if (rpc_result.ok()) {
+    rpc_result = VerifyResponseChecksums(*response);
+  }
+  if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
+  return absl::OkStatus();
+}
 
-  return response;
+void KmsClient::MacSignAsync(
+    kms_v1::MacSignRequest request,
+    AsyncCallback<kms_v1::MacSignResponse> callback) const {
+  SetRequestChecksums(request);
+  StartAsyncCall<kms_v1::MacSignRequest, kms_v1::MacSignResponse>(
+      &kms_v1::KeyManagementService::Stub::PrepareAsyncMacSign,
+      "MacSign", request,
+      [](const kms_v1::MacSignResponse& response) {
+        return VerifyResponseChecksums(response);
+      },
+      std::move(callback));
 }
 
 absl::StatusOr<kms_v1::MacVerifyResponse> KmsClient::MacVerify(
     kms_v1::MacVerifyRequest& request) const {
+  if (mac_verify_cache_ &&
+      mac_verify_cache_->Contains(request.name(), request.data(),
+                                  request.mac())) {
+    kms_v1::MacVerifyResponse response;
+    response.set_name(request.name());
+    response.set_success(true);
+    response.set_verified_data_crc32c(true);
+    response.set_verified_mac_crc32c(true);
+    response.set_verified_success_integrity(true);
+    return response;
+  }
+
+  absl::StatusOr<AdmissionController::Permit> permit = Admit(request.name());
+  if (!permit.ok()) {
+    absl::Status admission_result = permit.status();
+    return DecorateStatus(admission_result);
+  }
+
   grpc::ClientContext ctx;
   AddContextSettings(&ctx, "name", request.name());
 
-  request.mutable_data_crc32c()->set_value(ComputeCRC32C(request.data()));
-  request.mutable_mac_crc32c()->set_value(ComputeCRC32C(request.mac()));
+  SetRequestChecksums(request);
 
   kms_v1::MacVerifyResponse response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->MacVerify(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("MacVerify", [&] {
+    return NextStub()->MacVerify(&ctx, request, &response);
+  });
+  permit->Complete(rpc_result);
+  if (rpc_result.ok()) {
+    rpc_result = VerifyResponseChecksums(response);
+  }
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
-
-  if (response.success() != response.verified_success_integrity()) {
-    rpc_result = absl::InternalError(absl::StrFormat(
-        "at %s: the response crc32c did not match the expected checksum value",
-        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
+  // Only positive results are cached; a failed verification is always
+  // rechecked with Cloud KMS.
+  if (mac_verify_cache_ && response.success()) {
+    mac_verify_cache_->Insert(request.name(), request.data(), request.mac());
   }
-
-  if (!response.verified_data_crc32c() || !response.verified_mac_crc32c()) {
-    rpc_result = absl::InternalError(
-        absl::StrFormat("at %s: the server did not verify the checksum values "
-                        "provided in the request",
-                        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
-  }
-
   return response;
 }
 
 absl::StatusOr<kms_v1::RawDecryptResponse> KmsClient::RawDecrypt(
     kms_v1::RawDecryptRequest& request) const {
+  absl::StatusOr<AdmissionController::Permit> permit = Admit(request.name());
+  if (!permit.ok()) {
+    absl::Status admission_result = permit.status();
+    return DecorateStatus(admission_result);
+  }
+
   grpc::ClientContext ctx;
   AddContextSettings(&ctx, "name", request.name());
 
-  request.mutable_ciphertext_crc32c()->set_value(
-      ComputeCRC32C(request.ciphertext()));
-  request.mutable_initialization_vector_crc32c()->set_value(
-      ComputeCRC32C(request.initialization_vector()));
-  request.mutable_additional_authenticated_data_crc32c()->set_value(
-      ComputeCRC32C(request.additional_authenticated_data()));
+  SetRequestChecksums(request);
 
   kms_v1::RawDecryptResponse response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->RawDecrypt(&ctx, request, &response));
-  if (!rpc_result.ok()) {
-    return DecorateStatus(rpc_result);
+  absl::Status rpc_result = TimedRpc("RawDecrypt", [&] {
+    return NextStub()->RawDecrypt(&ctx, request, &response);
+  });
+  permit->Complete(rpc_result);
+  if (rpc_result.ok()) {
+    rpc_result = VerifyResponseChecksums(response);
   }
-
-  if (!CRC32CMatches(response.plaintext(),
-                     response.plaintext_crc32c().value())) {
-    rpc_result = absl::InternalError(absl::StrFormat(
-        "at %s: the response crc32c did not match the expected checksum value",
-        SOURCE_LOCATION.ToString()));
+  if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
-
   return response;
 }
 
+void KmsClient::RawDecryptAsync(
+    kms_v1::RawDecryptRequest request,
+    AsyncCallback<kms_v1::RawDecryptResponse> callback) const {
+  SetRequestChecksums(request);
+  StartAsyncCall<kms_v1::RawDecryptRequest, kms_v1::RawDecryptResponse>(
+      &kms_v1::KeyManagementService::Stub::PrepareAsyncRawDecrypt,
+      "RawDecrypt", request,
+      [](const kms_v1::RawDecryptResponse& response) {
+        return VerifyResponseChecksums(response);
+      },
+      std::move(callback));
+}
+
 absl::StatusOr<kms_v1::RawEncryptResponse> KmsClient::RawEncrypt(
     kms_v1::RawEncryptRequest& request) const {
+  absl::StatusOr<AdmissionController::Permit> permit = Admit(request.name());
+  if (!permit.ok()) {
+    absl::Status admission_result = permit.status();
+    return DecorateStatus(admission_result);
+  }
+
   grpc::ClientContext ctx;
   AddContextSettings(&ctx, "name", request.name());
 
-  request.mutable_plaintext_crc32c()->set_value(
-      ComputeCRC32C(request.plaintext()));
-  request.mutable_additional_authenticated_data_crc32c()->set_value(
-      ComputeCRC32C(request.additional_authenticated_data()));
-  request.mutable_initialization_vector_crc32c()->set_value(
-      ComputeCRC32C(request.initialization_vector()));
+  SetRequestChecksums(request);
 
   kms_v1::RawEncryptResponse response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->RawEncrypt(&ctx, request, &response));
-  if (!rpc_result.ok()) {
-    return DecorateStatus(rpc_result);
+  absl::Status rpc_result = TimedRpc("RawEncrypt", [&] {
+    return NextStub()->RawEncrypt(&ctx, request, &response);
+  });
+  permit->Complete(rpc_result);
+  if (rpc_result.ok()) {
+    rpc_result = VerifyResponseChecksums(response);
   }
-
-  if (!CRC32CMatches(response.ciphertext(),
-                     response.ciphertext_crc32c().value())) {
-    rpc_result = absl::InternalError(absl::StrFormat(
-        "at %s: the response crc32c did not match the expected checksum value",
-        SOURCE_LOCATION.ToString()));
-    return DecorateStatus(rpc_result);
-  }
-
-  if (!response.verified_plaintext_crc32c() ||
-      !response.verified_additional_authenticated_data_crc32c() ||
-      !response.verified_initialization_vector_crc32c()) {
-    rpc_result = absl::InternalError(
-        absl::StrFormat("at %s: the server did not verify the checksum values "
-                        "provided in the request",
-                        SOURCE_LOCATION.ToString()));
+  if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
-
   return response;
 }
 
+void KmsClient::RawEncryptAsync(
+    kms_v1::RawEncryptRequest request,
+    AsyncCallback<kms_v1::RawEncryptResponse> callback) const {
+  SetRequestChecksums(request);
+  StartAsyncCall<kms_v1::RawEncryptRequest, kms_v1::RawEncryptResponse>(
+      &kms_v1::KeyManagementService::Stub::PrepareAsyncRawEncrypt,
+      "RawEncrypt", request,
+      [](const kms_v1::RawEncryptResponse& response) {
+        return VerifyResponseChecksums(response);
+      },
+      std::move(callback));
+}
+
 absl::StatusOr<kms_v1::CryptoKey> KmsClient::CreateCryptoKey(
     const kms_v1::CreateCryptoKeyRequest& request) const {
   grpc::ClientContext ctx;
   AddContextSettings(&ctx, "parent", request.parent());
 
   kms_v1::CryptoKey response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->CreateCryptoKey(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("CreateCryptoKey", [&] {
+    return NextStub()->CreateCryptoKey(&ctx, request, &response);
+  });
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
@@ -373,8 +921,9 @@ KmsClient::CreateCryptoKeyAndWaitForFirstVersion(
     kms_v1::GetCryptoKeyVersionRequest get_ckv_req;
     get_ckv_req.set_name(name);
 
-    absl::Status rpc_result =
-        ToStatus(kms_stub_->GetCryptoKeyVersion(&ctx, get_ckv_req, &ckv));
+    absl::Status rpc_result = TimedRpc("GetCryptoKeyVersion", [&] {
+      return NextStub()->GetCryptoKeyVersion(&ctx, get_ckv_req, &ckv);
+    });
     if (!rpc_result.ok()) {
       return DecorateStatus(rpc_result);
     }
@@ -393,8 +942,9 @@ KmsClient::CreateCryptoKeyVersionAndWait(
   AddContextSettings(&ctx, "parent", request.parent(), deadline);
 
   kms_v1::CryptoKeyVersion response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->CreateCryptoKeyVersion(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("CreateCryptoKeyVersion", [&] {
+    return NextStub()->CreateCryptoKeyVersion(&ctx, request, &response);
+  });
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
@@ -408,8 +958,9 @@ absl::StatusOr<kms_v1::CryptoKeyVersion> KmsClient::DestroyCryptoKeyVersion(
   AddContextSettings(&ctx, "name", request.name());
 
   kms_v1::CryptoKeyVersion response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->DestroyCryptoKeyVersion(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("DestroyCryptoKeyVersion", [&] {
+    return NextStub()->DestroyCryptoKeyVersion(&ctx, request, &response);
+  });
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
@@ -422,8 +973,9 @@ absl::StatusOr<kms_v1::CryptoKey> KmsClient::GetCryptoKey(
   AddContextSettings(&ctx, "name", request.name());
 
   kms_v1::CryptoKey response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->GetCryptoKey(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("GetCryptoKey", [&] {
+    return NextStub()->GetCryptoKey(&ctx, request, &response);
+  });
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
@@ -436,8 +988,9 @@ absl::StatusOr<kms_v1::CryptoKeyVersion> KmsClient::GetCryptoKeyVersion(
   AddContextSettings(&ctx, "name", request.name());
 
   kms_v1::CryptoKeyVersion response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->GetCryptoKeyVersion(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("GetCryptoKeyVersion", [&] {
+    return NextStub()->GetCryptoKeyVersion(&ctx, request, &response);
+  });
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
@@ -450,8 +1003,9 @@ absl::StatusOr<kms_v1::PublicKey> KmsClient::GetPublicKey(
   AddContextSettings(&ctx, "name", request.name());
 
   kms_v1::PublicKey response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->GetPublicKey(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("GetPublicKey", [&] {
+    return NextStub()->GetPublicKey(&ctx, request, &response);
+  });
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
@@ -468,8 +1022,9 @@ CryptoKeysRange KmsClient::ListCryptoKeys(
         AddContextSettings(&ctx, "parent", request.parent());
 
         kms_v1::ListCryptoKeysResponse response;
-        absl::Status rpc_result =
-            ToStatus(kms_stub_->ListCryptoKeys(&ctx, request, &response));
+        absl::Status rpc_result = TimedRpc("ListCryptoKeys", [&] {
+          return NextStub()->ListCryptoKeys(&ctx, request, &response);
+        });
         if (!rpc_result.ok()) {
           return DecorateStatus(rpc_result);
         }
@@ -494,8 +1049,9 @@ CryptoKeyVersionsRange KmsClient::ListCryptoKeyVersions(
         AddContextSettings(&ctx, "parent", request.parent());
 
         kms_v1::ListCryptoKeyVersionsResponse response;
-        absl::Status rpc_result = ToStatus(
-            kms_stub_->ListCryptoKeyVersions(&ctx, request, &response));
+        absl::Status rpc_result = TimedRpc("ListCryptoKeyVersions", [&] {
+          return NextStub()->ListCryptoKeyVersions(&ctx, request, &response);
+        });
         if (!rpc_result.ok()) {
           return DecorateStatus(rpc_result);
         }
@@ -518,8 +1074,9 @@ KmsClient::GenerateRandomBytes(
   AddContextSettings(&ctx, "location", request.location());
 
   kms_v1::GenerateRandomBytesResponse response;
-  absl::Status rpc_result =
-      ToStatus(kms_stub_->GenerateRandomBytes(&ctx, request, &response));
+  absl::Status rpc_result = TimedRpc("GenerateRandomBytes", [&] {
+    return NextStub()->GenerateRandomBytes(&ctx, request, &response);
+  });
   if (!rpc_result.ok()) {
     return DecorateStatus(rpc_result);
   }
@@ -542,8 +1099,9 @@ absl::Status KmsClient::WaitForGeneration(kms_v1::CryptoKeyVersion& ckv,
 
     kms_v1::GetCryptoKeyVersionRequest req;
     req.set_name(ckv.name());
-    absl::Status rpc_result =
-        ToStatus(kms_stub_->GetCryptoKeyVersion(&ctx, req, &ckv));
+    absl::Status rpc_result = TimedRpc("GetCryptoKeyVersion", [&] {
+      return NextStub()->GetCryptoKeyVersion(&ctx, req, &ckv);
+    });
     if (!rpc_result.ok()) {
       return DecorateStatus(rpc_result);
     }
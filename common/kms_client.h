@@ -17,14 +17,25 @@
 #ifndef COMMON_KMS_CLIENT_H_
 #define COMMON_KMS_CLIENT_H_
 
+#include <atomic>
 #include <functional>
 #include <string_view>
+#include <thread>
+#include <vector>
 
+#include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "common/admission_controller.h"
+#include "common/hedge_policy.h"
 #include "common/kms_v1.h"
+#include "common/mac_verify_cache.h"
+#include "common/metrics.h"
 #include "common/pagination_range.h"
+#include "google/protobuf/arena.h"
+#include "grpcpp/completion_queue.h"
 #include "grpcpp/security/credentials.h"
 
 namespace cloud_kms {
@@ -48,8 +59,46 @@ struct CryptoKeyAndVersion {
   kms_v1::CryptoKeyVersion crypto_key_version;
 };
 
+// An arena for the messages of a single KMS call. Its first block is part of
+// the object, so a call whose messages are allocated here and that lives on
+// the stack doesn't allocate message objects on the heap.
+class CallArena {
+ public:
+  CallArena() : arena_(InitialBlockOptions(initial_block_)) {}
+
+  CallArena(const CallArena&) = delete;
+  CallArena& operator=(const CallArena&) = delete;
+
+  google::protobuf::Arena* get() { return &arena_; }
+
+  // Allocates a message of type T on the arena.
+  template <typename T>
+  T* Create() {
+    return google::protobuf::Arena::CreateMessage<T>(&arena_);
+  }
+
+ private:
+  // Large enough for a sign request and response with a resource name and a
+  // signature of a 4096-bit key.
+  static constexpr size_t kInitialBlockSize = 2048;
+
+  static google::protobuf::ArenaOptions InitialBlockOptions(char* block) {
+    google::protobuf::ArenaOptions options;
+    options.initial_block = block;
+    options.initial_block_size = kInitialBlockSize;
+    return options;
+  }
+
+  alignas(8) char initial_block_[kInitialBlockSize];
+  google::protobuf::Arena arena_;
+};
+
 class KmsClient {
  public:
+  // A callback that receives the result of an asynchronous RPC.
+  template <typename T>
+  using AsyncCallback = std::function<void(absl::StatusOr<T>)>;
+
   // Configuration Options for Constructing a new KmsClient.
   struct Options {
     std::string endpoint_address = "";
@@ -62,11 +111,40 @@ class KmsClient {
     std::optional<ErrorDecorator> error_decorator = std::nullopt;
     std::string rpc_feature_flags = "";
     std::string user_project_override = "";
+    // The number of threads that drive the completion queues used by the
+    // asynchronous methods. The threads are started on the first asynchronous
+    // call.
+    int async_poller_threads = 2;
+    // The number of gRPC channels (and thus HTTP/2 connections) in the pool.
+    // RPCs are distributed across the channels in round-robin order.
+    int channel_pool_size = 1;
+    // If set, successful MacVerify results are cached, and repeated
+    // verifications of the same MAC are answered without an RPC.
+    std::optional<MacVerifyCache::Options> mac_verify_cache = std::nullopt;
+    // If set, synchronous cryptographic RPCs wait for a permit from a shared
+    // admission controller before they are sent.
+    std::optional<AdmissionController::Options> admission_control =
+        std::nullopt;
+    // Admission control settings for individual key rings, keyed by key ring
+    // name. RPCs for keys in these key rings are admitted by a controller of
+    // their own, rather than by the shared one.
+    absl::flat_hash_map<std::string, AdmissionController::Options>
+        key_ring_admission_control;
+    // If set, an AsymmetricSign or MacSign RPC that has not completed within
+    // the hedge delay is duplicated on another channel, and the first
+    // successful response is used.
+    std::optional<HedgePolicy::Options> hedging = std::nullopt;
+    // If set, the latency and outcome of each RPC is recorded in this
+    // registry, which must outlive the client.
+    MetricsRegistry* metrics = nullptr;
   };
 
   KmsClient(const Options& options);
+  ~KmsClient();
 
-  kms_v1::KeyManagementService::Stub* kms_stub() { return kms_stub_.get(); }
+  kms_v1::KeyManagementService::Stub* kms_stub() {
+    return kms_stubs_.front().get();
+  }
 
   absl::StatusOr<kms_v1::AsymmetricDecryptResponse> AsymmetricDecrypt(
       kms_v1::AsymmetricDecryptRequest& request) const;
@@ -77,6 +155,16 @@ class KmsClient {
   absl::StatusOr<kms_v1::MacSignResponse> MacSign(
       kms_v1::MacSignRequest& request) const;
 
+  // Variants of the signing operations above whose response is allocated on
+  // `arena`, and is owned by it. Allocating the request on the same arena
+  // (e.g. a CallArena) keeps both messages off the heap.
+  absl::StatusOr<kms_v1::AsymmetricSignResponse*> AsymmetricSign(
+      kms_v1::AsymmetricSignRequest& request,
+      google::protobuf::Arena* arena) const;
+
+  absl::StatusOr<kms_v1::MacSignResponse*> MacSign(
+      kms_v1::MacSignRequest& request, google::protobuf::Arena* arena) const;
+
   absl::StatusOr<kms_v1::MacVerifyResponse> MacVerify(
       kms_v1::MacVerifyRequest& request) const;
 
@@ -86,6 +174,43 @@ class KmsClient {
   absl::StatusOr<kms_v1::RawEncryptResponse> RawEncrypt(
       kms_v1::RawEncryptRequest& request) const;
 
+  // Returns hedging statistics, or nullopt if hedging is not enabled.
+  std::optional<HedgePolicy::Stats> HedgingStats() const;
+
+  // Returns the state of the admission controller that admits RPCs for keys
+  // in the named key ring, or nullopt if those RPCs are not subject to
+  // admission control.
+  std::optional<AdmissionController::Stats> AdmissionControlStats(
+      std::string_view key_ring_name) const;
+
+  // Discards any cached MacVerify results for the named CryptoKeyVersion. This
+  // should be called when the state of the key version may have changed.
+  void InvalidateMacVerifyCache(std::string_view key_version_name) const;
+
+  // Asynchronous variants of the cryptographic operations above. Checksums
+  // are added to the request and verified on the response exactly as for the
+  // synchronous methods. `callback` is invoked exactly once, on one of the
+  // client's poller threads (or on the calling thread if the request could not
+  // be sent), and should not block.
+  void AsymmetricDecryptAsync(
+      kms_v1::AsymmetricDecryptRequest request,
+      AsyncCallback<kms_v1::AsymmetricDecryptResponse> callback) const;
+
+  void AsymmetricSignAsync(
+      kms_v1::AsymmetricSignRequest request,
+      AsyncCallback<kms_v1::AsymmetricSignResponse> callback) const;
+
+  void MacSignAsync(kms_v1::MacSignRequest request,
+                    AsyncCallback<kms_v1::MacSignResponse> callback) const;
+
+  void RawDecryptAsync(
+      kms_v1::RawDecryptRequest request,
+      AsyncCallback<kms_v1::RawDecryptResponse> callback) const;
+
+  void RawEncryptAsync(
+      kms_v1::RawEncryptRequest request,
+      AsyncCallback<kms_v1::RawEncryptResponse> callback) const;
+
   absl::StatusOr<kms_v1::CryptoKey> CreateCryptoKey(
       const kms_v1::CreateCryptoKeyRequest& request) const;
 
@@ -122,6 +247,34 @@ class KmsClient {
 
   absl::Status DecorateStatus(absl::Status& status) const;
 
+  // Implement the synchronous signing operations, writing the result to
+  // `response`.
+  absl::Status AsymmetricSignInto(
+      kms_v1::AsymmetricSignRequest& request,
+      kms_v1::AsymmetricSignResponse* response) const;
+  absl::Status MacSignInto(kms_v1::MacSignRequest& request,
+                           kms_v1::MacSignResponse* response) const;
+
+  // Invokes `rpc`, which returns a grpc::Status, and records its latency
+  // under `method_name` if metrics are enabled.
+  template <typename Rpc>
+  absl::Status TimedRpc(const char* method_name, Rpc rpc) const;
+
+  // Records the latency of an RPC that started at `start`, if metrics are
+  // enabled.
+  void RecordRpcLatency(const char* method_name, const absl::Status& result,
+                        absl::Time start) const;
+
+  // Returns the admission controller for RPCs that act on `resource_name`, or
+  // nullptr if admission control does not apply.
+  AdmissionController* AdmissionControllerFor(
+      std::string_view resource_name) const;
+
+  // Waits for permission to send an RPC that acts on `resource_name`. The
+  // returned permit is empty if admission control does not apply.
+  absl::StatusOr<AdmissionController::Permit> Admit(
+      std::string_view resource_name) const;
+
   void AddContextSettings(grpc::ClientContext* ctx,
                           std::string_view relative_resource,
                           std::string_view resource_name,
@@ -134,11 +287,59 @@ class KmsClient {
                               absl::Now() + rpc_timeout_);
   }
 
-  std::unique_ptr<kms_v1::KeyManagementService::Stub> kms_stub_;
+  template <typename Request, typename Response>
+  using PrepareAsyncMethod =
+      std::unique_ptr<grpc::ClientAsyncResponseReader<Response>> (
+          kms_v1::KeyManagementService::Stub::*)(grpc::ClientContext*,
+                                                 const Request&,
+                                                 grpc::CompletionQueue*);
+
+  // Starts an asynchronous call of `method`, whose latency is recorded under
+  // `method_name`. Once the call completes, `verify` is applied to a
+  // successful response before it is passed to `callback`.
+  template <typename Request, typename Response>
+  void StartAsyncCall(PrepareAsyncMethod<Request, Response> method,
+                      const char* method_name, const Request& request,
+                      std::function<absl::Status(const Response&)> verify,
+                      AsyncCallback<Response> callback) const;
+
+  // Calls `method` with a hedge: if no response has arrived after the hedge
+  // delay, and the hedge budget allows, the request is sent again on the next
+  // channel in the pool. The first response that passes `verify` is written
+  // to `response`, and the other RPC is cancelled.
+  template <typename Request, typename Response>
+  absl::Status HedgedCall(PrepareAsyncMethod<Request, Response> method,
+                          const char* method_name, const Request& request,
+                          std::function<absl::Status(const Response&)> verify,
+                          Response* response) const;
+
+  // Returns the stub for the next RPC, cycling through the channel pool.
+  kms_v1::KeyManagementService::Stub* NextStub() const;
+
+  // Returns the completion queue for the next asynchronous call, starting the
+  // poller threads if necessary.
+  grpc::CompletionQueue* NextCompletionQueue() const;
+
+  std::vector<std::unique_ptr<kms_v1::KeyManagementService::Stub>> kms_stubs_;
+  mutable std::atomic<size_t> next_stub_{0};
   const absl::Duration rpc_timeout_;
   const std::string rpc_feature_flags_;
   const std::string user_project_override_;
   const std::optional<ErrorDecorator> error_decorator_;
+  MetricsRegistry* const metrics_;
+
+  std::unique_ptr<MacVerifyCache> mac_verify_cache_;
+  std::unique_ptr<HedgePolicy> hedge_policy_;
+  std::unique_ptr<AdmissionController> admission_controller_;
+  absl::flat_hash_map<std::string, std::unique_ptr<AdmissionController>>
+      key_ring_admission_controllers_;
+
+  const int async_poller_threads_;
+  mutable absl::once_flag pollers_started_;
+  mutable std::vector<std::unique_ptr<grpc::CompletionQueue>>
+      completion_queues_;
+  mutable std::vector<std::thread> pollers_;
+  mutable std::atomic<size_t> next_completion_queue_{0};
 };
 
 }  // namespace cloud_kms
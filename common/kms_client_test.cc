@@ -14,6 +14,11 @@
 
 #include "common/kms_client.h"
 
+#include <future>
+#include <thread>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "common/openssl.h"
 #include "common/test/matchers.h"
@@ -28,6 +33,8 @@
 namespace cloud_kms {
 namespace {
 
+using ::testing::HasSubstr;
+using ::testing::Property;
 using ::testing::SizeIs;
 
 // TODO(b/270419822): Clean up these using statements once crypto_utils has
@@ -44,6 +51,18 @@ std::unique_ptr<KmsClient> NewClient(
       .endpoint_address = std::string(listen_addr), .rpc_timeout = rpc_timeout});
 }
 
+// Starts an asynchronous call using `start`, and blocks until its callback has
+// been invoked.
+template <typename T>
+absl::StatusOr<T> AwaitAsync(
+    std::function<void(KmsClient::AsyncCallback<T>)> start) {
+  std::promise<absl::StatusOr<T>> result;
+  start([&result](absl::StatusOr<T> response) {
+    result.set_value(std::move(response));
+  });
+  return result.get_future().get();
+}
+
 TEST(KmsClientTest, ListCryptoKeysSuccess) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
                        fakekms::Server::New());
@@ -279,6 +298,67 @@ TEST(KmsClientTest, AsymmetricSignSuccess) {
   EXPECT_OK(EcdsaVerifyP1363(ec_key, EVP_sha256(), digest, p1363_sig));
 }
 
+TEST(KmsClientTest, AsymmetricSignOnArenaSuccess) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::ASYMMETRIC_SIGN);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(client->kms_stub(), ck.name(), ckv);
+  ckv = WaitForEnablement(client->kms_stub(), ckv);
+
+  kms_v1::GetPublicKeyRequest pub_req;
+  pub_req.set_name(ckv.name());
+  ASSERT_OK_AND_ASSIGN(kms_v1::PublicKey pk, client->GetPublicKey(pub_req));
+
+  ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> pub,
+                       ParseX509PublicKeyPem(pk.pem()));
+
+  std::string data = "Here is some data to authenticate";
+  uint8_t digest[32];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+
+  CallArena arena;
+  kms_v1::AsymmetricSignRequest* sign_req =
+      arena.Create<kms_v1::AsymmetricSignRequest>();
+  sign_req->set_name(ckv.name());
+  sign_req->mutable_digest()->set_sha256(digest, sizeof(digest));
+
+  ASSERT_OK_AND_ASSIGN(kms_v1::AsymmetricSignResponse * sign_resp,
+                       client->AsymmetricSign(*sign_req, arena.get()));
+  EXPECT_EQ(sign_resp->GetArena(), arena.get());
+
+  EC_KEY* ec_key = EVP_PKEY_get0_EC_KEY(pub.get());
+  ASSERT_OK_AND_ASSIGN(
+      std::vector<uint8_t> p1363_sig,
+      EcdsaSigAsn1ToP1363(sign_resp->signature(), EC_KEY_get0_group(ec_key)));
+
+  EXPECT_OK(EcdsaVerifyP1363(ec_key, EVP_sha256(), digest, p1363_sig));
+}
+
+TEST(KmsClientTest, AsymmetricSignOnArenaFailureInvalidName) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  CallArena arena;
+  kms_v1::AsymmetricSignRequest* req =
+      arena.Create<kms_v1::AsymmetricSignRequest>();
+  req->set_name("foo");
+  req->set_data("bar");
+  EXPECT_THAT(client->AsymmetricSign(*req, arena.get()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST(KmsClientTest, AsymmetricSignFailureInvalidName) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
                        fakekms::Server::New());
@@ -291,6 +371,85 @@ TEST(KmsClientTest, AsymmetricSignFailureInvalidName) {
               StatusIs(absl::StatusCode::kInvalidArgument));
 }
 
+TEST(KmsClientTest, AsymmetricSignAsyncSuccess) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::ASYMMETRIC_SIGN);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(client->kms_stub(), ck.name(), ckv);
+  ckv = WaitForEnablement(client->kms_stub(), ckv);
+
+  kms_v1::GetPublicKeyRequest pub_req;
+  pub_req.set_name(ckv.name());
+  ASSERT_OK_AND_ASSIGN(kms_v1::PublicKey pk, client->GetPublicKey(pub_req));
+
+  ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> pub,
+                       ParseX509PublicKeyPem(pk.pem()));
+
+  std::string data = "Here is some data to authenticate";
+  uint8_t digest[32];
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(), digest);
+
+  kms_v1::AsymmetricSignRequest sign_req;
+  sign_req.set_name(ckv.name());
+  sign_req.mutable_digest()->set_sha256(digest, sizeof(digest));
+
+  ASSERT_OK_AND_ASSIGN(
+      kms_v1::AsymmetricSignResponse sign_resp,
+      AwaitAsync<kms_v1::AsymmetricSignResponse>(
+          [&](KmsClient::AsyncCallback<kms_v1::AsymmetricSignResponse> cb) {
+            client->AsymmetricSignAsync(sign_req, std::move(cb));
+          }));
+
+  EC_KEY* ec_key = EVP_PKEY_get0_EC_KEY(pub.get());
+  ASSERT_OK_AND_ASSIGN(
+      std::vector<uint8_t> p1363_sig,
+      EcdsaSigAsn1ToP1363(sign_resp.signature(), EC_KEY_get0_group(ec_key)));
+
+  EXPECT_OK(EcdsaVerifyP1363(ec_key, EVP_sha256(), digest, p1363_sig));
+}
+
+TEST(KmsClientTest, AsymmetricSignAsyncFailureInvalidName) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::AsymmetricSignRequest req;
+  req.set_name("foo");
+  req.set_data("bar");
+  EXPECT_THAT(
+      AwaitAsync<kms_v1::AsymmetricSignResponse>(
+          [&](KmsClient::AsyncCallback<kms_v1::AsymmetricSignResponse> cb) {
+            client->AsymmetricSignAsync(req, std::move(cb));
+          }),
+      StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(KmsClientTest, AsymmetricSignAsyncFailureMissingDigest) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::AsymmetricSignRequest req;
+  req.set_name("foo");
+  EXPECT_THAT(
+      AwaitAsync<kms_v1::AsymmetricSignResponse>(
+          [&](KmsClient::AsyncCallback<kms_v1::AsymmetricSignResponse> cb) {
+            client->AsymmetricSignAsync(req, std::move(cb));
+          }),
+      StatusIs(absl::StatusCode::kInternal));
+}
+
 TEST(KmsClientTest, MacSignVerifySuccess) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
                        fakekms::Server::New());
@@ -328,6 +487,41 @@ TEST(KmsClientTest, MacSignVerifySuccess) {
   EXPECT_TRUE(verify_resp.success());
 }
 
+TEST(KmsClientTest, MacSignOnArenaMatchesMacSign) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::MAC);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::HMAC_SHA256);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(client->kms_stub(), ck.name(), ckv);
+  ckv = WaitForEnablement(client->kms_stub(), ckv);
+
+  kms_v1::MacSignRequest sign_req;
+  sign_req.set_name(ckv.name());
+  sign_req.set_data("Here is some data to authenticate");
+  ASSERT_OK_AND_ASSIGN(kms_v1::MacSignResponse sign_resp,
+                       client->MacSign(sign_req));
+
+  CallArena arena;
+  kms_v1::MacSignRequest* arena_req = arena.Create<kms_v1::MacSignRequest>();
+  arena_req->set_name(ckv.name());
+  arena_req->set_data("Here is some data to authenticate");
+  ASSERT_OK_AND_ASSIGN(kms_v1::MacSignResponse * arena_resp,
+                       client->MacSign(*arena_req, arena.get()));
+
+  EXPECT_EQ(arena_resp->GetArena(), arena.get());
+  EXPECT_EQ(arena_resp->mac(), sign_resp.mac());
+}
+
 TEST(KmsClientTest, MacSignFailureInvalidName) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
                        fakekms::Server::New());
@@ -389,6 +583,100 @@ TEST(KmsClientTest, RawEncryptDecryptSuccess) {
   EXPECT_EQ(decrypt_resp.plaintext(), data);
 }
 
+TEST(KmsClientTest, MacSignAsyncManyConcurrentCalls) {
+  constexpr int kCallCount = 64;
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::MAC);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::HMAC_SHA256);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(client->kms_stub(), ck.name(), ckv);
+  ckv = WaitForEnablement(client->kms_stub(), ckv);
+
+  kms_v1::MacSignRequest req;
+  req.set_name(ckv.name());
+  req.set_data("Here is some data to authenticate");
+
+  kms_v1::MacSignRequest sync_req = req;
+  ASSERT_OK_AND_ASSIGN(kms_v1::MacSignResponse want, client->MacSign(sync_req));
+
+  absl::Mutex mu;
+  std::vector<absl::StatusOr<kms_v1::MacSignResponse>> results;
+  absl::BlockingCounter done(kCallCount);
+  for (int i = 0; i < kCallCount; i++) {
+    client->MacSignAsync(
+        req, [&](absl::StatusOr<kms_v1::MacSignResponse> response) {
+          {
+            absl::MutexLock lock(&mu);
+            results.push_back(std::move(response));
+          }
+          done.DecrementCount();
+        });
+  }
+  done.Wait();
+
+  ASSERT_THAT(results, SizeIs(kCallCount));
+  for (const absl::StatusOr<kms_v1::MacSignResponse>& result : results) {
+    ASSERT_OK(result);
+    EXPECT_EQ(result->mac(), want.mac());
+  }
+}
+
+TEST(KmsClientTest, RawEncryptDecryptAsyncSuccess) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::AES_256_GCM);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(client->kms_stub(), ck.name(), ckv);
+  ckv = WaitForEnablement(client->kms_stub(), ckv);
+
+  std::string data = "Here is some data to encrypt";
+
+  kms_v1::RawEncryptRequest encrypt_req;
+  encrypt_req.set_name(ckv.name());
+  encrypt_req.set_plaintext(data);
+
+  ASSERT_OK_AND_ASSIGN(
+      kms_v1::RawEncryptResponse encrypt_resp,
+      AwaitAsync<kms_v1::RawEncryptResponse>(
+          [&](KmsClient::AsyncCallback<kms_v1::RawEncryptResponse> cb) {
+            client->RawEncryptAsync(encrypt_req, std::move(cb));
+          }));
+
+  kms_v1::RawDecryptRequest decrypt_req;
+  decrypt_req.set_name(ckv.name());
+  decrypt_req.set_ciphertext(encrypt_resp.ciphertext());
+  decrypt_req.set_initialization_vector(encrypt_resp.initialization_vector());
+
+  ASSERT_OK_AND_ASSIGN(
+      kms_v1::RawDecryptResponse decrypt_resp,
+      AwaitAsync<kms_v1::RawDecryptResponse>(
+          [&](KmsClient::AsyncCallback<kms_v1::RawDecryptResponse> cb) {
+            client->RawDecryptAsync(decrypt_req, std::move(cb));
+          }));
+  EXPECT_EQ(decrypt_resp.plaintext(), data);
+}
+
 TEST(KmsClientTest, RawEncryptFailureInvalidName) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
                        fakekms::Server::New());
@@ -787,6 +1075,279 @@ TEST(KmsClientTest, ClientRetriesTransparentlyOnServerDeadlineExceeded) {
   EXPECT_THAT(got_ck, EqualsProto(ck));
 }
 
+TEST(KmsClientTest, ServerRateLimitReturnsResourceExhausted) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::ENCRYPT_DECRYPT);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), RandomId(), ck,
+                            false);
+
+  AddRateLimitOrDie(*fake, 0.001, 1, "GetCryptoKey");
+
+  kms_v1::GetCryptoKeyRequest req;
+  req.set_name(ck.name());
+  EXPECT_OK(client->GetCryptoKey(req));
+  EXPECT_THAT(client->GetCryptoKey(req),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  ClearShapingRulesOrDie(*fake);
+  EXPECT_OK(client->GetCryptoKey(req));
+}
+
+TEST(KmsClientTest, ServerLatencyProfileDelaysEveryRequest) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  std::unique_ptr<KmsClient> client = NewClient(fake->listen_addr());
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::ENCRYPT_DECRYPT);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), RandomId(), ck,
+                            false);
+
+  AddLatencyProfileOrDie(
+      *fake, fakekms::FixedLatencyProfile(absl::Milliseconds(100)),
+      "GetCryptoKey");
+
+  // Unlike a fault, a shaping rule is not consumed by the first request.
+  kms_v1::GetCryptoKeyRequest req;
+  req.set_name(ck.name());
+  for (int i = 0; i < 2; i++) {
+    absl::Time start = absl::Now();
+    EXPECT_OK(client->GetCryptoKey(req));
+    EXPECT_GE(absl::Now() - start, absl::Milliseconds(100));
+  }
+}
+
+TEST(KmsClientTest, ChannelPoolServesRequests) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  auto client = std::make_unique<KmsClient>(
+      KmsClient::Options{.endpoint_address = fake->listen_addr(),
+                         .rpc_timeout = absl::Milliseconds(500),
+                         .channel_pool_size = 4});
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::ENCRYPT_DECRYPT);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), RandomId(), ck,
+                            false);
+
+  // Issue enough requests that each channel in the pool is used more than
+  // once.
+  for (int i = 0; i < 10; i++) {
+    kms_v1::GetCryptoKeyRequest req;
+    req.set_name(ck.name());
+    ASSERT_OK_AND_ASSIGN(kms_v1::CryptoKey got_ck, client->GetCryptoKey(req));
+    EXPECT_THAT(got_ck, EqualsProto(ck));
+  }
+}
+
+TEST(KmsClientTest, CachedMacVerifySkipsRpcUntilInvalidated) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  auto client = std::make_unique<KmsClient>(KmsClient::Options{
+      .endpoint_address = fake->listen_addr(),
+      .rpc_timeout = absl::Milliseconds(500),
+      .mac_verify_cache = MacVerifyCache::Options{}});
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::MAC);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::HMAC_SHA256);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(client->kms_stub(), ck.name(), ckv);
+  ckv = WaitForEnablement(client->kms_stub(), ckv);
+
+  kms_v1::MacSignRequest sign_req;
+  sign_req.set_name(ckv.name());
+  sign_req.set_data("Here is some data to authenticate");
+  ASSERT_OK_AND_ASSIGN(kms_v1::MacSignResponse sign_resp,
+                       client->MacSign(sign_req));
+
+  kms_v1::MacVerifyRequest verify_req;
+  verify_req.set_name(ckv.name());
+  verify_req.set_data(sign_req.data());
+  verify_req.set_mac(sign_resp.mac());
+  EXPECT_THAT(client->MacVerify(verify_req),
+              IsOkAndHolds(
+                  Property(&kms_v1::MacVerifyResponse::success, true)));
+
+  kms_v1::MacVerifyRequest bad_verify_req = verify_req;
+  bad_verify_req.set_mac(std::string(sign_resp.mac().size(), 'x'));
+  EXPECT_THAT(
+      client->MacVerify(bad_verify_req),
+      IsOkAndHolds(Property(&kms_v1::MacVerifyResponse::success, false)));
+
+  // Disable the key version. The cached result is still returned, since no RPC
+  // is made.
+  ckv.set_state(kms_v1::CryptoKeyVersion::DISABLED);
+  google::protobuf::FieldMask update_mask;
+  update_mask.add_paths("state");
+  UpdateCryptoKeyVersionOrDie(client->kms_stub(), ckv, update_mask);
+
+  EXPECT_THAT(client->MacVerify(verify_req),
+              IsOkAndHolds(
+                  Property(&kms_v1::MacVerifyResponse::success, true)));
+  EXPECT_THAT(client->MacVerify(bad_verify_req),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+
+  client->InvalidateMacVerifyCache(ckv.name());
+  EXPECT_THAT(client->MacVerify(verify_req),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(KmsClientTest, AdmissionControlIsAppliedPerKeyRing) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  auto setup_client = std::make_unique<KmsClient>(
+      KmsClient::Options{.endpoint_address = fake->listen_addr(),
+                         .rpc_timeout = absl::Milliseconds(500)});
+
+  auto create_hmac_key_version = [&](const kms_v1::KeyRing& kr) {
+    kms_v1::CryptoKey ck;
+    ck.set_purpose(kms_v1::CryptoKey::MAC);
+    ck.mutable_version_template()->set_algorithm(
+        kms_v1::CryptoKeyVersion::HMAC_SHA256);
+    ck = CreateCryptoKeyOrDie(setup_client->kms_stub(), kr.name(), "ck", ck,
+                              true);
+    kms_v1::CryptoKeyVersion ckv;
+    ckv = CreateCryptoKeyVersionOrDie(setup_client->kms_stub(), ck.name(), ckv);
+    return WaitForEnablement(setup_client->kms_stub(), ckv);
+  };
+
+  kms_v1::KeyRing kr1;
+  kr1 = CreateKeyRingOrDie(setup_client->kms_stub(), kTestLocation, RandomId(),
+                           kr1);
+  kms_v1::CryptoKeyVersion ckv1 = create_hmac_key_version(kr1);
+  kms_v1::KeyRing kr2;
+  kr2 = CreateKeyRingOrDie(setup_client->kms_stub(), kTestLocation, RandomId(),
+                           kr2);
+  kms_v1::CryptoKeyVersion ckv2 = create_hmac_key_version(kr2);
+
+  // The shared budget admits a single RPC, and does not queue.
+  AdmissionController::Options shared;
+  shared.requests_per_second = 0.001;
+  shared.burst = 1;
+  shared.max_queue_wait = absl::ZeroDuration();
+  auto client = std::make_unique<KmsClient>(KmsClient::Options{
+      .endpoint_address = fake->listen_addr(),
+      .rpc_timeout = absl::Milliseconds(500),
+      .admission_control = shared,
+      .key_ring_admission_control = {{kr2.name(), {}}}});
+
+  kms_v1::MacSignRequest req1;
+  req1.set_name(ckv1.name());
+  req1.set_data("Here is some data to authenticate");
+  EXPECT_OK(client->MacSign(req1));
+  EXPECT_THAT(client->MacSign(req1),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  // Keys in the second key ring have a budget of their own.
+  kms_v1::MacSignRequest req2 = req1;
+  req2.set_name(ckv2.name());
+  EXPECT_OK(client->MacSign(req2));
+  EXPECT_OK(client->MacSign(req2));
+
+  std::optional<AdmissionController::Stats> stats1 =
+      client->AdmissionControlStats(kr1.name());
+  ASSERT_TRUE(stats1.has_value());
+  EXPECT_EQ(stats1->admitted, 1);
+  EXPECT_EQ(stats1->rejected, 1);
+
+  std::optional<AdmissionController::Stats> stats2 =
+      client->AdmissionControlStats(kr2.name());
+  ASSERT_TRUE(stats2.has_value());
+  EXPECT_EQ(stats2->admitted, 2);
+  EXPECT_EQ(stats2->in_flight, 0);
+
+  EXPECT_FALSE(setup_client->AdmissionControlStats(kr1.name()).has_value());
+}
+
+TEST(KmsClientTest, HedgedMacSignAvoidsSlowResponse) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  HedgePolicy::Options hedging;
+  hedging.initial_delay = absl::Milliseconds(200);
+  hedging.max_hedge_fraction = 1;
+  auto client = std::make_unique<KmsClient>(
+      KmsClient::Options{.endpoint_address = fake->listen_addr(),
+                         .rpc_timeout = absl::Seconds(5),
+                         .channel_pool_size = 2,
+                         .hedging = hedging});
+
+  kms_v1::KeyRing kr;
+  kr = CreateKeyRingOrDie(client->kms_stub(), kTestLocation, RandomId(), kr);
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::MAC);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::HMAC_SHA256);
+  ck = CreateCryptoKeyOrDie(client->kms_stub(), kr.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(client->kms_stub(), ck.name(), ckv);
+  ckv = WaitForEnablement(client->kms_stub(), ckv);
+
+  kms_v1::MacSignRequest req;
+  req.set_name(ckv.name());
+  req.set_data("Here is some data to authenticate");
+
+  // Only the first MacSign is delayed, so the hedge responds first. Its
+  // response is still written to the caller's arena.
+  AddDelayOrDie(*fake, absl::Seconds(2), "MacSign");
+  CallArena arena;
+  absl::Time start = absl::Now();
+  ASSERT_OK_AND_ASSIGN(kms_v1::MacSignResponse * hedged_resp,
+                       client->MacSign(req, arena.get()));
+  EXPECT_LT(absl::Now() - start, absl::Seconds(1));
+  EXPECT_EQ(hedged_resp->GetArena(), arena.get());
+
+  // A fast response is not hedged.
+  ASSERT_OK_AND_ASSIGN(kms_v1::MacSignResponse resp, client->MacSign(req));
+  EXPECT_EQ(hedged_resp->mac(), resp.mac());
+
+  std::optional<HedgePolicy::Stats> stats = client->HedgingStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(stats->requests, 2);
+  EXPECT_EQ(stats->hedges, 1);
+  EXPECT_EQ(stats->hedge_wins, 1);
+}
+
+TEST(KmsClientTest, RpcLatencyIsRecordedByMethodAndCode) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake,
+                       fakekms::Server::New());
+  MetricsRegistry metrics;
+  auto client = std::make_unique<KmsClient>(
+      KmsClient::Options{.endpoint_address = fake->listen_addr(),
+                         .rpc_timeout = absl::Seconds(1),
+                         .metrics = &metrics});
+
+  kms_v1::GetCryptoKeyRequest req;
+  req.set_name(absl::StrCat(kTestLocation, "/keyRings/foo/cryptoKeys/bar"));
+  EXPECT_THAT(client->GetCryptoKey(req), StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(client->GetCryptoKey(req), StatusIs(absl::StatusCode::kNotFound));
+
+  EXPECT_THAT(metrics.ToOpenMetrics(),
+              HasSubstr("cloud_kms_rpc_latency_seconds_count{"
+                        "method=\"GetCryptoKey\",code=\"NOT_FOUND\"} 2\n"));
+}
+
 TEST(KmsClientTest, GenerateRandomBytesSuccess) {
   constexpr size_t kByteLength = 64;
 
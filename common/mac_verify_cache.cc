@@ -0,0 +1,128 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/mac_verify_cache.h"
+
+#include "absl/log/absl_log.h"
+#include "common/openssl.h"
+
+namespace cloud_kms {
+namespace {
+
+// Returns SHA-256(len(data) || data || mac), where len(data) is a 64-bit
+// big-endian integer, so that distinct (data, mac) pairs have distinct inputs.
+std::string Digest(std::string_view data, std::string_view mac) {
+  std::string input;
+  input.reserve(8 + data.size() + mac.size());
+  uint64_t data_length = data.size();
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    input.push_back(static_cast<char>((data_length >> shift) & 0xff));
+  }
+  input.append(data);
+  input.append(mac);
+
+  std::string digest(EVP_MAX_MD_SIZE, '\0');
+  unsigned int digest_length = 0;
+  if (!EVP_Digest(input.data(), input.size(),
+                  reinterpret_cast<uint8_t*>(digest.data()), &digest_length,
+                  EVP_sha256(), nullptr)) {
+    ABSL_LOG(FATAL) << "failed to compute SHA-256 digest";
+  }
+  digest.resize(digest_length);
+  return digest;
+}
+
+}  // namespace
+
+bool MacVerifyCache::Contains(std::string_view key_version_name,
+                              std::string_view data, std::string_view mac) {
+  std::string digest = Digest(data, mac);
+
+  absl::MutexLock lock(&mutex_);
+  auto key_it = entries_.find(key_version_name);
+  if (key_it == entries_.end()) {
+    return false;
+  }
+  auto it = key_it->second.find(digest);
+  if (it == key_it->second.end()) {
+    return false;
+  }
+  if (it->second.expiry <= options_.clock()) {
+    EraseLocked(key_version_name, key_it->second, it);
+    return false;
+  }
+  return true;
+}
+
+void MacVerifyCache::Insert(std::string_view key_version_name,
+                            std::string_view data, std::string_view mac) {
+  if (options_.max_entries == 0) {
+    return;
+  }
+  std::string digest = Digest(data, mac);
+  absl::Time expiry = options_.clock() + options_.ttl;
+
+  absl::MutexLock lock(&mutex_);
+  absl::flat_hash_map<std::string, Entry>& key_entries =
+      entries_[key_version_name];
+  if (auto it = key_entries.find(digest); it != key_entries.end()) {
+    // Refresh the expiry, and move the entry to the back of the queue.
+    it->second.expiry = expiry;
+    insertion_order_.splice(insertion_order_.end(), insertion_order_,
+                            it->second.position);
+    return;
+  }
+
+  insertion_order_.emplace_back(std::string(key_version_name), digest);
+  key_entries.emplace(std::move(digest),
+                      Entry{expiry, std::prev(insertion_order_.end())});
+
+  while (insertion_order_.size() > options_.max_entries) {
+    // Copy the name, since EraseLocked destroys the list element.
+    std::string oldest_name = insertion_order_.front().first;
+    auto oldest_key_it = entries_.find(oldest_name);
+    EraseLocked(oldest_name, oldest_key_it->second,
+                oldest_key_it->second.find(insertion_order_.front().second));
+  }
+}
+
+void MacVerifyCache::Invalidate(std::string_view key_version_name) {
+  absl::MutexLock lock(&mutex_);
+  auto key_it = entries_.find(key_version_name);
+  if (key_it == entries_.end()) {
+    return;
+  }
+  for (const auto& [digest, entry] : key_it->second) {
+    insertion_order_.erase(entry.position);
+  }
+  entries_.erase(key_it);
+}
+
+size_t MacVerifyCache::size() const {
+  absl::MutexLock lock(&mutex_);
+  return insertion_order_.size();
+}
+
+void MacVerifyCache::EraseLocked(
+    std::string_view key_version_name,
+    absl::flat_hash_map<std::string, Entry>& key_entries,
+    absl::flat_hash_map<std::string, Entry>::iterator it) {
+  insertion_order_.erase(it->second.position);
+  key_entries.erase(it);
+  if (key_entries.empty()) {
+    entries_.erase(key_version_name);
+  }
+}
+
+}  // namespace cloud_kms
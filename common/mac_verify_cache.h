@@ -0,0 +1,89 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMMON_MAC_VERIFY_CACHE_H_
+#define COMMON_MAC_VERIFY_CACHE_H_
+
+#include <functional>
+#include <list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace cloud_kms {
+
+// MacVerifyCache remembers successful MacVerify results, so that verifying the
+// same (CryptoKeyVersion, data, MAC) triple again does not require an RPC.
+// Only positive results are stored. Entries are identified by a SHA-256 digest
+// of the data and MAC, so neither is retained. The cache is bounded in size
+// (the oldest entries are evicted first) and entries expire after a fixed TTL.
+class MacVerifyCache {
+ public:
+  struct Options {
+    // The maximum number of results that are retained.
+    size_t max_entries = 10000;
+    // How long a result remains valid after it was returned by Cloud KMS.
+    absl::Duration ttl = absl::Minutes(5);
+    // The clock used to evaluate entry expiry.
+    std::function<absl::Time()> clock = &absl::Now;
+  };
+
+  explicit MacVerifyCache(Options options) : options_(std::move(options)) {}
+
+  // Returns true if `mac` was recently verified for `data` under the named
+  // CryptoKeyVersion.
+  bool Contains(std::string_view key_version_name, std::string_view data,
+                std::string_view mac);
+
+  // Records that `mac` was successfully verified for `data` under the named
+  // CryptoKeyVersion.
+  void Insert(std::string_view key_version_name, std::string_view data,
+              std::string_view mac);
+
+  // Removes all results for the named CryptoKeyVersion.
+  void Invalidate(std::string_view key_version_name);
+
+  size_t size() const;
+
+ private:
+  using EntryId = std::pair<std::string, std::string>;  // (name, digest)
+  struct Entry {
+    absl::Time expiry;
+    std::list<EntryId>::iterator position;
+  };
+
+  void EraseLocked(std::string_view key_version_name,
+                   absl::flat_hash_map<std::string, Entry>& key_entries,
+                   absl::flat_hash_map<std::string, Entry>::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Options options_;
+
+  mutable absl::Mutex mutex_;
+  // Entries for each CryptoKeyVersion, keyed by digest.
+  absl::flat_hash_map<std::string, absl::flat_hash_map<std::string, Entry>>
+      entries_ ABSL_GUARDED_BY(mutex_);
+  // All entries, from oldest to newest.
+  std::list<EntryId> insertion_order_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace cloud_kms
+
+#endif  // COMMON_MAC_VERIFY_CACHE_H_
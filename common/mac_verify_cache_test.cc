@@ -0,0 +1,123 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/mac_verify_cache.h"
+
+#include "gmock/gmock.h"
+
+namespace cloud_kms {
+namespace {
+
+class MacVerifyCacheTest : public testing::Test {
+ protected:
+  MacVerifyCache::Options NewOptions() {
+    MacVerifyCache::Options options;
+    options.clock = [this] { return now_; };
+    return options;
+  }
+
+  absl::Time now_ = absl::FromUnixSeconds(1700000000);
+};
+
+TEST_F(MacVerifyCacheTest, ContainsInsertedEntry) {
+  MacVerifyCache cache(NewOptions());
+  EXPECT_FALSE(cache.Contains("key1", "data", "mac"));
+
+  cache.Insert("key1", "data", "mac");
+  EXPECT_TRUE(cache.Contains("key1", "data", "mac"));
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST_F(MacVerifyCacheTest, EntryIsSpecificToKeyDataAndMac) {
+  MacVerifyCache cache(NewOptions());
+  cache.Insert("key1", "data", "mac");
+
+  EXPECT_FALSE(cache.Contains("key2", "data", "mac"));
+  EXPECT_FALSE(cache.Contains("key1", "data2", "mac"));
+  EXPECT_FALSE(cache.Contains("key1", "data", "mac2"));
+  // The data length is part of the digest input, so moving bytes between the
+  // data and the MAC does not produce a match.
+  EXPECT_FALSE(cache.Contains("key1", "datam", "ac"));
+}
+
+TEST_F(MacVerifyCacheTest, EntryExpiresAfterTtl) {
+  MacVerifyCache::Options options = NewOptions();
+  options.ttl = absl::Seconds(10);
+  MacVerifyCache cache(options);
+  cache.Insert("key1", "data", "mac");
+
+  now_ += absl::Seconds(9);
+  EXPECT_TRUE(cache.Contains("key1", "data", "mac"));
+
+  now_ += absl::Seconds(1);
+  EXPECT_FALSE(cache.Contains("key1", "data", "mac"));
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(MacVerifyCacheTest, ReinsertRefreshesExpiry) {
+  MacVerifyCache::Options options = NewOptions();
+  options.ttl = absl::Seconds(10);
+  MacVerifyCache cache(options);
+  cache.Insert("key1", "data", "mac");
+
+  now_ += absl::Seconds(5);
+  cache.Insert("key1", "data", "mac");
+  EXPECT_EQ(cache.size(), 1);
+
+  now_ += absl::Seconds(9);
+  EXPECT_TRUE(cache.Contains("key1", "data", "mac"));
+}
+
+TEST_F(MacVerifyCacheTest, OldestEntryIsEvictedAtCapacity) {
+  MacVerifyCache::Options options = NewOptions();
+  options.max_entries = 2;
+  MacVerifyCache cache(options);
+
+  cache.Insert("key1", "data1", "mac");
+  cache.Insert("key2", "data2", "mac");
+  // Re-inserting the first entry makes the second one the oldest.
+  cache.Insert("key1", "data1", "mac");
+  cache.Insert("key1", "data3", "mac");
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Contains("key1", "data1", "mac"));
+  EXPECT_FALSE(cache.Contains("key2", "data2", "mac"));
+  EXPECT_TRUE(cache.Contains("key1", "data3", "mac"));
+}
+
+TEST_F(MacVerifyCacheTest, ZeroCapacityRetainsNothing) {
+  MacVerifyCache::Options options = NewOptions();
+  options.max_entries = 0;
+  MacVerifyCache cache(options);
+
+  cache.Insert("key1", "data", "mac");
+  EXPECT_FALSE(cache.Contains("key1", "data", "mac"));
+}
+
+TEST_F(MacVerifyCacheTest, InvalidateRemovesOnlyNamedKey) {
+  MacVerifyCache cache(NewOptions());
+  cache.Insert("key1", "data1", "mac");
+  cache.Insert("key1", "data2", "mac");
+  cache.Insert("key2", "data1", "mac");
+
+  cache.Invalidate("key1");
+
+  EXPECT_FALSE(cache.Contains("key1", "data1", "mac"));
+  EXPECT_FALSE(cache.Contains("key1", "data2", "mac"));
+  EXPECT_TRUE(cache.Contains("key2", "data1", "mac"));
+  EXPECT_EQ(cache.size(), 1);
+}
+
+}  // namespace
+}  // namespace cloud_kms
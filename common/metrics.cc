@@ -0,0 +1,217 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/metrics.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#include "absl/numeric/bits.h"
+#include "absl/strings/str_format.h"
+
+namespace cloud_kms {
+namespace {
+
+// The number of sub-buckets per power of two, and its base-2 logarithm.
+constexpr int kSubBuckets = 4;
+constexpr int kSubBucketBits = 2;
+
+int ThreadShard(int shard_count) {
+  static std::atomic<int> next_shard{0};
+  thread_local int shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % shard_count;
+  return shard;
+}
+
+size_t HashSeries(const void* family, const void* name, int64_t code) {
+  uint64_t h = reinterpret_cast<uintptr_t>(family);
+  h = (h ^ reinterpret_cast<uintptr_t>(name)) * 0x9e3779b97f4a7c15;
+  h = (h ^ static_cast<uint64_t>(code)) * 0xbf58476d1ce4e5b9;
+  return h ^ (h >> 31);
+}
+
+}  // namespace
+
+int LatencyHistogram::BucketIndex(absl::Duration latency) {
+  int64_t nanos = absl::ToInt64Nanoseconds(latency);
+  if (nanos <= 0) {
+    return 0;
+  }
+  // Bucket by whole microseconds, rounding up so that upper bounds are
+  // inclusive.
+  uint64_t micros = (static_cast<uint64_t>(nanos) + 999) / 1000;
+  if (micros < kSubBuckets) {
+    return micros;
+  }
+  int exponent = absl::bit_width(micros) - 1;
+  int sub_bucket = (micros >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+  int index =
+      kSubBuckets + (exponent - kSubBucketBits) * kSubBuckets + sub_bucket;
+  return std::min(index, kBucketCount - 1);
+}
+
+absl::Duration LatencyHistogram::BucketUpperBound(int index) {
+  if (index >= kBucketCount - 1) {
+    return absl::InfiniteDuration();
+  }
+  if (index < kSubBuckets) {
+    return absl::Microseconds(index);
+  }
+  int exponent = (index - kSubBuckets) / kSubBuckets + kSubBucketBits;
+  int sub_bucket = (index - kSubBuckets) % kSubBuckets;
+  return absl::Microseconds(
+      ((int64_t{kSubBuckets + 1 + sub_bucket}) << (exponent - kSubBucketBits)) -
+      1);
+}
+
+void LatencyHistogram::Record(absl::Duration latency) {
+  Shard& shard = shards_[ThreadShard(kShardCount)];
+  shard.counts[BucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+  shard.sum_nanos.fetch_add(absl::ToInt64Nanoseconds(latency),
+                            std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Collect() const {
+  Snapshot snapshot{};
+  int64_t sum_nanos = 0;
+  for (const Shard& shard : shards_) {
+    for (int i = 0; i < kBucketCount; i++) {
+      uint64_t count = shard.counts[i].load(std::memory_order_relaxed);
+      snapshot.counts[i] += count;
+      snapshot.count += count;
+    }
+    sum_nanos += shard.sum_nanos.load(std::memory_order_relaxed);
+  }
+  snapshot.sum = absl::Nanoseconds(sum_nanos);
+  return snapshot;
+}
+
+MetricsRegistry::~MetricsRegistry() {
+  for (std::atomic<Series*>& slot : series_) {
+    delete slot.load(std::memory_order_acquire);
+  }
+}
+
+MetricsRegistry& MetricsRegistry::Global() {
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+void MetricsRegistry::RecordLatency(const Family& family, const char* name,
+                                    int64_t code, absl::Duration latency) {
+  Series* series = FindOrCreate(family, name, code);
+  if (!series) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  series->histogram.Record(latency);
+}
+
+MetricsRegistry::Series* MetricsRegistry::FindOrCreate(const Family& family,
+                                                       const char* name,
+                                                       int64_t code) {
+  size_t hash = HashSeries(&family, name, code);
+  Series* candidate = nullptr;
+  for (size_t i = 0; i < kCapacity; i++) {
+    std::atomic<Series*>& slot = series_[(hash + i) % kCapacity];
+    Series* series = slot.load(std::memory_order_acquire);
+    if (!series) {
+      if (!candidate) {
+        candidate = new Series{&family, name, code};
+      }
+      if (slot.compare_exchange_strong(series, candidate,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+        return candidate;
+      }
+      // Another thread filled the slot first; `series` now holds its value.
+    }
+    if (series->family == &family && series->name == name &&
+        series->code == code) {
+      delete candidate;
+      return series;
+    }
+  }
+  delete candidate;
+  return nullptr;
+}
+
+std::string MetricsRegistry::ToOpenMetrics() const {
+  // Series are merged by their rendered labels, since the same label values
+  // may be recorded through distinct (but equal) strings.
+  struct FamilySeries {
+    const Family* family;
+    std::map<std::tuple<std::string, std::string>, LatencyHistogram::Snapshot>
+        series;
+  };
+  std::map<std::string, FamilySeries> families;
+  for (const std::atomic<Series*>& slot : series_) {
+    const Series* series = slot.load(std::memory_order_acquire);
+    if (!series) {
+      continue;
+    }
+    FamilySeries& family = families[series->family->name];
+    family.family = series->family;
+    LatencyHistogram::Snapshot snapshot = series->histogram.Collect();
+    auto [it, inserted] = family.series.try_emplace(
+        {series->name, series->family->format_code(series->code)}, snapshot);
+    if (!inserted) {
+      for (int i = 0; i < LatencyHistogram::kBucketCount; i++) {
+        it->second.counts[i] += snapshot.counts[i];
+      }
+      it->second.count += snapshot.count;
+      it->second.sum += snapshot.sum;
+    }
+  }
+
+  std::string out;
+  for (const auto& [family_name, family] : families) {
+    absl::StrAppendFormat(&out, "# TYPE %s histogram\n", family_name);
+    absl::StrAppendFormat(&out, "# UNIT %s seconds\n", family_name);
+    absl::StrAppendFormat(&out, "# HELP %s %s\n", family_name,
+                          family.family->help);
+    for (const auto& [labels, snapshot] : family.series) {
+      std::string label_text =
+          absl::StrFormat("%s=\"%s\",%s=\"%s\"", family.family->name_label,
+                          std::get<0>(labels), family.family->code_label,
+                          std::get<1>(labels));
+      uint64_t cumulative = 0;
+      for (int i = 0; i < LatencyHistogram::kBucketCount - 1; i++) {
+        cumulative += snapshot.counts[i];
+        absl::StrAppendFormat(
+            &out, "%s_bucket{%s,le=\"%.6f\"} %d\n", family_name, label_text,
+            absl::ToDoubleSeconds(LatencyHistogram::BucketUpperBound(i)),
+            cumulative);
+      }
+      absl::StrAppendFormat(&out, "%s_bucket{%s,le=\"+Inf\"} %d\n",
+                            family_name, label_text, snapshot.count);
+      absl::StrAppendFormat(&out, "%s_count{%s} %d\n", family_name,
+                            label_text, snapshot.count);
+      absl::StrAppendFormat(&out, "%s_sum{%s} %.9f\n", family_name, label_text,
+                            absl::ToDoubleSeconds(snapshot.sum));
+    }
+  }
+  if (uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+      dropped > 0) {
+    absl::StrAppendFormat(&out,
+                          "# TYPE cloud_kms_metrics_dropped counter\n"
+                          "cloud_kms_metrics_dropped_total %d\n",
+                          dropped);
+  }
+  out.append("# EOF\n");
+  return out;
+}
+
+}  // namespace cloud_kms
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef COMMON_METRICS_H_
+#define COMMON_METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "absl/time/time.h"
+
+namespace cloud_kms {
+
+// LatencyHistogram counts durations in log-linear buckets: each power of two
+// (in microseconds) is split into four equal sub-buckets, so that a bucket's
+// bounds are within 25% of each other. Recording is lock-free, and writes are
+// spread across cache-line-aligned shards (selected per thread) so that
+// concurrent callers do not contend on the same counters.
+class LatencyHistogram {
+ public:
+  static constexpr int kBucketCount = 120;
+
+  struct Snapshot {
+    std::array<uint64_t, kBucketCount> counts;
+    uint64_t count;
+    absl::Duration sum;
+  };
+
+  void Record(absl::Duration latency);
+
+  // Returns the sum of all shards. Concurrent writes may or may not be
+  // reflected.
+  Snapshot Collect() const;
+
+  // Returns the inclusive upper bound of the bucket at `index`.
+  static absl::Duration BucketUpperBound(int index);
+
+  // Returns the bucket that holds `latency`.
+  static int BucketIndex(absl::Duration latency);
+
+ private:
+  static constexpr int kShardCount = 8;
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, kBucketCount> counts{};
+    std::atomic<int64_t> sum_nanos{0};
+  };
+
+  std::array<Shard, kShardCount> shards_;
+};
+
+// MetricsRegistry holds a latency histogram for each (family, name, code)
+// series that has been recorded, and renders them in the OpenMetrics text
+// format. Series are created on first use and are never removed; lookups and
+// recording do not take locks.
+class MetricsRegistry {
+ public:
+  // A metric family, such as the latency of Cryptoki functions. Each series
+  // in the family is identified by a name label (such as the function name)
+  // and a code label (such as its return value).
+  struct Family {
+    // The metric name, which must end with "_seconds".
+    const char* name;
+    const char* help;
+    const char* name_label;
+    const char* code_label;
+    // Renders a code as a label value.
+    std::string (*format_code)(int64_t code);
+  };
+
+  MetricsRegistry() = default;
+  ~MetricsRegistry();
+
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  // Returns the process-wide registry. It is never destroyed.
+  static MetricsRegistry& Global();
+
+  // Whether recording is enabled. The registry does not consult this itself;
+  // it lets instrumented code skip taking timestamps when nobody is
+  // collecting metrics.
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  void set_enabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Records `latency` in the identified series. `family` and `name` must
+  // outlive the registry; they are compared by address on the recording path.
+  void RecordLatency(const Family& family, const char* name, int64_t code,
+                     absl::Duration latency);
+
+  // Returns all series in the OpenMetrics text exposition format.
+  std::string ToOpenMetrics() const;
+
+ private:
+  struct Series {
+    const Family* family;
+    const char* name;
+    int64_t code;
+    LatencyHistogram histogram;
+  };
+
+  static constexpr size_t kCapacity = 1024;
+
+  Series* FindOrCreate(const Family& family, const char* name, int64_t code);
+
+  std::atomic<bool> enabled_{false};
+  // An open-addressed hash table of series. Slots are filled with
+  // compare-and-swap, and are never cleared.
+  std::array<std::atomic<Series*>, kCapacity> series_{};
+  // The number of recordings that were dropped because the table was full.
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace cloud_kms
+
+#endif  // COMMON_METRICS_H_
@@ -0,0 +1,165 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "common/metrics.h"
+
+#include <thread>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+
+namespace cloud_kms {
+namespace {
+
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+std::string FormatCode(int64_t code) { return absl::StrCat("E", code); }
+
+const MetricsRegistry::Family kTestFamily = {
+    "test_latency_seconds", "Latency of test operations.", "op", "code",
+    &FormatCode};
+
+TEST(LatencyHistogramTest, BucketsAreOrderedAndContiguous) {
+  for (int i = 1; i < LatencyHistogram::kBucketCount; i++) {
+    absl::Duration lower = LatencyHistogram::BucketUpperBound(i - 1);
+    absl::Duration upper = LatencyHistogram::BucketUpperBound(i);
+    ASSERT_LT(lower, upper) << "bucket " << i;
+    // The value just above the previous bucket's bound lands in this bucket.
+    EXPECT_EQ(LatencyHistogram::BucketIndex(lower + absl::Nanoseconds(1)), i);
+    if (upper != absl::InfiniteDuration()) {
+      EXPECT_EQ(LatencyHistogram::BucketIndex(upper), i);
+    }
+  }
+}
+
+TEST(LatencyHistogramTest, BucketResolutionIsWithinAQuarter) {
+  for (int i = 8; i < LatencyHistogram::kBucketCount - 1; i++) {
+    absl::Duration lower = LatencyHistogram::BucketUpperBound(i - 1);
+    absl::Duration upper = LatencyHistogram::BucketUpperBound(i);
+    EXPECT_LE(upper - lower, (lower + absl::Microseconds(1)) / 4)
+        << "bucket " << i;
+  }
+}
+
+TEST(LatencyHistogramTest, ExtremeValuesAreBucketed) {
+  EXPECT_EQ(LatencyHistogram::BucketIndex(absl::ZeroDuration()), 0);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(-absl::Seconds(1)), 0);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(absl::Hours(24 * 365)),
+            LatencyHistogram::kBucketCount - 1);
+}
+
+TEST(LatencyHistogramTest, CollectSumsAllThreads) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 16; t++) {
+    threads.emplace_back([&histogram] {
+      for (int i = 0; i < 1000; i++) {
+        histogram.Record(absl::Milliseconds(2));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  LatencyHistogram::Snapshot snapshot = histogram.Collect();
+  EXPECT_EQ(snapshot.count, 16000);
+  EXPECT_EQ(snapshot.sum, absl::Seconds(32));
+  EXPECT_EQ(
+      snapshot.counts[LatencyHistogram::BucketIndex(absl::Milliseconds(2))],
+      16000);
+}
+
+TEST(MetricsRegistryTest, RendersOpenMetrics) {
+  MetricsRegistry registry;
+  registry.RecordLatency(kTestFamily, "Sign", 0, absl::Microseconds(3));
+  registry.RecordLatency(kTestFamily, "Sign", 0, absl::Milliseconds(5));
+  registry.RecordLatency(kTestFamily, "Sign", 7, absl::Milliseconds(1));
+
+  std::string text = registry.ToOpenMetrics();
+  EXPECT_THAT(text, HasSubstr("# TYPE test_latency_seconds histogram\n"
+                              "# UNIT test_latency_seconds seconds\n"
+                              "# HELP test_latency_seconds Latency of test "
+                              "operations.\n"));
+  EXPECT_THAT(text, HasSubstr("test_latency_seconds_bucket{op=\"Sign\","
+                              "code=\"E0\",le=\"0.000003\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("test_latency_seconds_bucket{op=\"Sign\","
+                              "code=\"E0\",le=\"+Inf\"} 2\n"));
+  EXPECT_THAT(text, HasSubstr("test_latency_seconds_count{op=\"Sign\","
+                              "code=\"E0\"} 2\n"));
+  EXPECT_THAT(text, HasSubstr("test_latency_seconds_sum{op=\"Sign\","
+                              "code=\"E0\"} 0.005003000\n"));
+  EXPECT_THAT(text, HasSubstr("test_latency_seconds_count{op=\"Sign\","
+                              "code=\"E7\"} 1\n"));
+  EXPECT_THAT(text, Not(HasSubstr("cloud_kms_metrics_dropped")));
+  EXPECT_THAT(text, EndsWith("# EOF\n"));
+}
+
+TEST(MetricsRegistryTest, EqualNamesAreMerged) {
+  // Distinct arrays, so that the names have distinct addresses.
+  static const char kName1[] = "Sign";
+  static const char kName2[] = "Sign";
+
+  MetricsRegistry registry;
+  registry.RecordLatency(kTestFamily, kName1, 0, absl::Milliseconds(1));
+  registry.RecordLatency(kTestFamily, kName2, 0, absl::Milliseconds(1));
+
+  EXPECT_THAT(registry.ToOpenMetrics(),
+              HasSubstr("test_latency_seconds_count{op=\"Sign\","
+                        "code=\"E0\"} 2\n"));
+}
+
+TEST(MetricsRegistryTest, ConcurrentFirstUseCreatesOneSeries) {
+  MetricsRegistry registry;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&registry] {
+      for (int code = 0; code < 50; code++) {
+        registry.RecordLatency(kTestFamily, "Op", code, absl::Milliseconds(1));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::string text = registry.ToOpenMetrics();
+  for (int code = 0; code < 50; code++) {
+    EXPECT_THAT(text, HasSubstr(absl::StrCat(
+                          "test_latency_seconds_count{op=\"Op\",code=\"E",
+                          code, "\"} 8\n")));
+  }
+}
+
+TEST(MetricsRegistryTest, FullRegistryCountsDroppedRecordings) {
+  MetricsRegistry registry;
+  for (int code = 0; code < 1100; code++) {
+    registry.RecordLatency(kTestFamily, "Op", code, absl::Milliseconds(1));
+  }
+  EXPECT_THAT(registry.ToOpenMetrics(),
+              HasSubstr("cloud_kms_metrics_dropped_total 76\n"));
+}
+
+TEST(MetricsRegistryTest, EnabledIsOffByDefault) {
+  MetricsRegistry registry;
+  EXPECT_FALSE(registry.enabled());
+  registry.set_enabled(true);
+  EXPECT_TRUE(registry.enabled());
+}
+
+}  // namespace
+}  // namespace cloud_kms
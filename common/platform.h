@@ -18,9 +18,12 @@
 #define COMMON_PLATFORM_H_
 
 #include <cstdlib>
+#include <memory>
 #include <string>
+#include <string_view>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 
 namespace cloud_kms {
 
@@ -45,6 +48,24 @@ std::string GetHostPlatformInfo();
 // Writes the provided message to the system log. This is a no-op on Windows.
 void WriteToSystemLog(const char* message);
 
+// A read-only memory mapping of a file's contents.
+class MappedFile {
+ public:
+  static absl::StatusOr<std::unique_ptr<MappedFile>> Open(const char* filename);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  ~MappedFile();
+
+  std::string_view contents() const { return std::string_view(data_, size_); }
+
+ private:
+  MappedFile(const char* data, size_t size) : data_(data), size_(size) {}
+
+  const char* data_;
+  size_t size_;
+};
+
 }  // namespace cloud_kms
 
 #endif  // COMMON_PLATFORM_H_
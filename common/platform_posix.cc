@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/utsname.h>
@@ -23,6 +25,7 @@
 #include <gnu/libc-version.h>
 #endif
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/strings/str_format.h"
 #include "common/platform.h"
 #include "common/source_location.h"
@@ -83,4 +86,43 @@ void WriteToSystemLog(const char* message) {
   closelog();
 }
 
+absl::StatusOr<std::unique_ptr<MappedFile>> MappedFile::Open(
+    const char* filename) {
+  int fd = open(filename, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return absl::NotFoundError(
+        absl::StrFormat("at %s: unable to open file %s: error %d",
+                        SOURCE_LOCATION.ToString(), filename, errno));
+  }
+  absl::Cleanup c = [&] { close(fd); };
+
+  struct stat buf;
+  if (fstat(fd, &buf) != 0) {
+    return absl::InternalError(
+        absl::StrFormat("at %s: unable to stat file %s: error %d",
+                        SOURCE_LOCATION.ToString(), filename, errno));
+  }
+  size_t size = static_cast<size_t>(buf.st_size);
+  if (size == 0) {
+    // mmap does not permit zero-length mappings.
+    return std::unique_ptr<MappedFile>(new MappedFile(nullptr, 0));
+  }
+
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    return absl::InternalError(
+        absl::StrFormat("at %s: unable to map file %s: error %d",
+                        SOURCE_LOCATION.ToString(), filename, errno));
+  }
+  // using `new` to invoke a private constructor
+  return std::unique_ptr<MappedFile>(
+      new MappedFile(static_cast<const char*>(data), size));
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
 }  // namespace cloud_kms
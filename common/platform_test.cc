@@ -14,17 +14,47 @@
 
 #include "common/platform.h"
 
+#include <fstream>
+
+#include "absl/strings/str_cat.h"
+#include "common/test/matchers.h"
+#include "common/test/test_status_macros.h"
 #include "gmock/gmock.h"
 
 namespace cloud_kms {
 namespace {
 
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Not;
 
 TEST(PlatformTest, HostPlatformInfoIsKnown) {
   EXPECT_THAT(GetHostPlatformInfo(), Not(HasSubstr("unknown")));
 }
 
+TEST(PlatformTest, MappedFileHasFileContents) {
+  std::string filename = absl::StrCat(testing::TempDir(), "/mapped_file");
+  std::ofstream(filename) << "hello, world";
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<MappedFile> file,
+                       MappedFile::Open(filename.c_str()));
+  EXPECT_EQ(file->contents(), "hello, world");
+}
+
+TEST(PlatformTest, MappedFileEmptyFile) {
+  std::string filename = absl::StrCat(testing::TempDir(), "/empty_file");
+  std::ofstream(filename).flush();
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<MappedFile> file,
+                       MappedFile::Open(filename.c_str()));
+  EXPECT_THAT(file->contents(), IsEmpty());
+}
+
+TEST(PlatformTest, MappedFileMissingFile) {
+  std::string filename = absl::StrCat(testing::TempDir(), "/does_not_exist");
+  EXPECT_THAT(MappedFile::Open(filename.c_str()),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace cloud_kms
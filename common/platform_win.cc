@@ -157,4 +157,53 @@ void WriteToSystemLog(const char* message) {
   // https://learn.microsoft.com/en-us/windows/win32/eventlog/event-sources
 }
 
+absl::StatusOr<std::unique_ptr<MappedFile>> MappedFile::Open(
+    const char* filename) {
+  HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return absl::NotFoundError(
+        absl::StrFormat("at %s: unable to open file %s: error %d",
+                        SOURCE_LOCATION.ToString(), filename, GetLastError()));
+  }
+  absl::Cleanup close_file = [&] { CloseHandle(file); };
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    return absl::InternalError(
+        absl::StrFormat("at %s: unable to size file %s: error %d",
+                        SOURCE_LOCATION.ToString(), filename, GetLastError()));
+  }
+  if (size.QuadPart == 0) {
+    // CreateFileMapping does not permit zero-length mappings.
+    return std::unique_ptr<MappedFile>(new MappedFile(nullptr, 0));
+  }
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    return absl::InternalError(
+        absl::StrFormat("at %s: unable to map file %s: error %d",
+                        SOURCE_LOCATION.ToString(), filename, GetLastError()));
+  }
+  // The view holds its own reference to the mapping.
+  absl::Cleanup close_mapping = [&] { CloseHandle(mapping); };
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data) {
+    return absl::InternalError(
+        absl::StrFormat("at %s: unable to map view of file %s: error %d",
+                        SOURCE_LOCATION.ToString(), filename, GetLastError()));
+  }
+  // using `new` to invoke a private constructor
+  return std::unique_ptr<MappedFile>(new MappedFile(
+      static_cast<const char*>(data), static_cast<size_t>(size.QuadPart)));
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+}
+
 }  // namespace cloud_kms
@@ -43,19 +43,15 @@ func (f *fakeKMS) GetPublicKey(ctx context.Context, req *kmspb.GetPublicKeyReque
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.enabledKey(name)
 	if err != nil {
 		return nil, err
 	}
 
-	if ckv.pb.State != kmspb.CryptoKeyVersion_ENABLED {
-		return nil, errFailedPrecondition("key version %s is not enabled", name)
-	}
-
 	s, ok := ckv.keyMaterial.(crypto.Signer)
 	if !ok {
 		return nil, errFailedPrecondition("keys with algorithm %s do not contain a public key",
-			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 	}
 
 	derPub, err := x509.MarshalPKIXPublicKey(s.Public())
@@ -70,10 +66,10 @@ func (f *fakeKMS) GetPublicKey(ctx context.Context, req *kmspb.GetPublicKeyReque
 
 	return &kmspb.PublicKey{
 		Name:            req.Name,
-		Algorithm:       ckv.pb.Algorithm,
+		Algorithm:       ckv.algorithm,
 		Pem:             string(pemPub),
 		PemCrc32C:       crc32c(pemPub),
-		ProtectionLevel: ckv.pb.ProtectionLevel,
+		ProtectionLevel: ckv.protectionLevel,
 	}, nil
 }
 
@@ -88,19 +84,15 @@ func (f *fakeKMS) AsymmetricDecrypt(ctx context.Context, req *kmspb.AsymmetricDe
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.enabledKey(name)
 	if err != nil {
 		return nil, err
 	}
 
-	if ckv.pb.State != kmspb.CryptoKeyVersion_ENABLED {
-		return nil, errFailedPrecondition("key version %s is not enabled", name)
-	}
-
-	def, _ := algorithmDef(ckv.pb.Algorithm)
+	def, _ := algorithmDef(ckv.algorithm)
 	if def.Purpose != kmspb.CryptoKey_ASYMMETRIC_DECRYPT {
 		return nil, errFailedPrecondition("keys with algorithm %s may not be used for asymmetric decryption",
-			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 	}
 
 	if req.Ciphertext == nil {
@@ -125,7 +117,7 @@ func (f *fakeKMS) AsymmetricDecrypt(ctx context.Context, req *kmspb.AsymmetricDe
 		Plaintext:                pt,
 		PlaintextCrc32C:          crc32c(pt),
 		VerifiedCiphertextCrc32C: req.CiphertextCrc32C != nil,
-		ProtectionLevel:          ckv.pb.ProtectionLevel,
+		ProtectionLevel:          ckv.protectionLevel,
 	}, nil
 }
 
@@ -140,19 +132,15 @@ func (f *fakeKMS) AsymmetricSign(ctx context.Context, req *kmspb.AsymmetricSignR
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.enabledKey(name)
 	if err != nil {
 		return nil, err
 	}
 
-	if ckv.pb.State != kmspb.CryptoKeyVersion_ENABLED {
-		return nil, errFailedPrecondition("key version %s is not enabled", name)
-	}
-
-	def, _ := algorithmDef(ckv.pb.Algorithm)
+	def, _ := algorithmDef(ckv.algorithm)
 	if def.Purpose != kmspb.CryptoKey_ASYMMETRIC_SIGN {
 		return nil, errFailedPrecondition("keys with algorithm %s may not be used for signing",
-			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 	}
 
 	if req.DataCrc32C != nil && req.DigestCrc32C != nil {
@@ -219,6 +207,6 @@ func (f *fakeKMS) AsymmetricSign(ctx context.Context, req *kmspb.AsymmetricSignR
 		SignatureCrc32C:      crc32c(sig),
 		VerifiedDataCrc32C:   req.DataCrc32C != nil,
 		VerifiedDigestCrc32C: req.DigestCrc32C != nil,
-		ProtectionLevel:      ckv.pb.ProtectionLevel,
+		ProtectionLevel:      ckv.protectionLevel,
 	}, nil
 }
@@ -0,0 +1,139 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package contract
+
+import (
+	"context"
+	"sync"
+	"testing"
+
+	"google.golang.org/grpc/codes"
+	"google.golang.org/grpc/status"
+
+	"cloud.google.com/go/kms/apiv1/kmspb"
+	"google.golang.org/protobuf/types/known/fieldmaskpb"
+)
+
+func TestConcurrentMacSignWithStateChanges(t *testing.T) {
+	ctx := context.Background()
+	kr := client.CreateTestKR(ctx, t, &kmspb.CreateKeyRingRequest{Parent: location})
+	ck := client.CreateTestCK(ctx, t, &kmspb.CreateCryptoKeyRequest{
+		Parent: kr.Name,
+		CryptoKey: &kmspb.CryptoKey{
+			Purpose: kmspb.CryptoKey_MAC,
+			VersionTemplate: &kmspb.CryptoKeyVersionTemplate{
+				ProtectionLevel: kmspb.ProtectionLevel_HSM,
+				Algorithm:       kmspb.CryptoKeyVersion_HMAC_SHA256,
+			},
+		},
+		SkipInitialVersionCreation: true,
+	})
+	ckv := client.CreateTestCKVAndWait(ctx, t, &kmspb.CreateCryptoKeyVersionRequest{
+		Parent: ck.Name,
+	})
+
+	data := []byte("Here is some data to authenticate")
+	var wg sync.WaitGroup
+	for i := 0; i < 8; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for j := 0; j < 10; j++ {
+				_, err := client.MacSign(ctx, &kmspb.MacSignRequest{Name: ckv.Name, Data: data})
+				// The version is concurrently disabled and re-enabled.
+				if err != nil && status.Code(err) != codes.FailedPrecondition {
+					t.Errorf("MacSign: err=%v, want nil or code=%s", err, codes.FailedPrecondition)
+				}
+			}
+		}()
+	}
+
+	for _, state := range []kmspb.CryptoKeyVersion_CryptoKeyVersionState{
+		kmspb.CryptoKeyVersion_DISABLED, kmspb.CryptoKeyVersion_ENABLED,
+		kmspb.CryptoKeyVersion_DISABLED, kmspb.CryptoKeyVersion_ENABLED,
+	} {
+		ckv.State = state
+		got, err := client.UpdateCryptoKeyVersion(ctx, &kmspb.UpdateCryptoKeyVersionRequest{
+			CryptoKeyVersion: ckv,
+			UpdateMask:       &fieldmaskpb.FieldMask{Paths: []string{"state"}},
+		})
+		if err != nil {
+			t.Fatal(err)
+		}
+		if got.State != state {
+			t.Errorf("State=%s, want %s", got.State, state)
+		}
+	}
+	wg.Wait()
+
+	if _, err := client.MacSign(ctx, &kmspb.MacSignRequest{Name: ckv.Name, Data: data}); err != nil {
+		t.Errorf("MacSign after re-enabling: %v", err)
+	}
+}
+
+func TestConcurrentReadsWithStateChanges(t *testing.T) {
+	ctx := context.Background()
+	kr := client.CreateTestKR(ctx, t, &kmspb.CreateKeyRingRequest{Parent: location})
+	ck := client.CreateTestCK(ctx, t, &kmspb.CreateCryptoKeyRequest{
+		Parent: kr.Name,
+		CryptoKey: &kmspb.CryptoKey{
+			Purpose: kmspb.CryptoKey_ENCRYPT_DECRYPT,
+		},
+	})
+	primary := ck.Primary
+
+	// Responses are marshaled after the RPC returns, so a response that shares
+	// state with the server would be read here while it is being updated.
+	var wg sync.WaitGroup
+	for i := 0; i < 8; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for j := 0; j < 10; j++ {
+				got, err := client.GetCryptoKey(ctx, &kmspb.GetCryptoKeyRequest{Name: ck.Name})
+				if err != nil {
+					t.Errorf("GetCryptoKey: %v", err)
+					return
+				}
+				if s := got.Primary.State; s != kmspb.CryptoKeyVersion_ENABLED && s != kmspb.CryptoKeyVersion_DISABLED {
+					t.Errorf("Primary.State=%s, want %s or %s", s,
+						kmspb.CryptoKeyVersion_ENABLED, kmspb.CryptoKeyVersion_DISABLED)
+				}
+				if _, err := client.GetCryptoKeyVersion(ctx, &kmspb.GetCryptoKeyVersionRequest{Name: primary.Name}); err != nil {
+					t.Errorf("GetCryptoKeyVersion: %v", err)
+				}
+				iter := client.ListCryptoKeyVersions(ctx, &kmspb.ListCryptoKeyVersionsRequest{Parent: ck.Name})
+				if _, err := iter.Next(); err != nil {
+					t.Errorf("ListCryptoKeyVersions: %v", err)
+				}
+			}
+		}()
+	}
+
+	for _, state := range []kmspb.CryptoKeyVersion_CryptoKeyVersionState{
+		kmspb.CryptoKeyVersion_DISABLED, kmspb.CryptoKeyVersion_ENABLED,
+		kmspb.CryptoKeyVersion_DISABLED, kmspb.CryptoKeyVersion_ENABLED,
+	} {
+		primary.State = state
+		if _, err := client.UpdateCryptoKeyVersion(ctx, &kmspb.UpdateCryptoKeyVersionRequest{
+			CryptoKeyVersion: primary,
+			UpdateMask:       &fieldmaskpb.FieldMask{Paths: []string{"state"}},
+		}); err != nil {
+			t.Fatal(err)
+		}
+		client.CreateTestCKVAndWait(ctx, t, &kmspb.CreateCryptoKeyVersionRequest{Parent: ck.Name})
+	}
+	wg.Wait()
+}
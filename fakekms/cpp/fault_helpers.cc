@@ -21,6 +21,20 @@
 namespace fakekms {
 
 namespace {
+
+void SetDuration(absl::Duration d, google::protobuf::Duration* out) {
+  // Cribbed directly from util_time::EncodeGoogleApiProto
+  const int64_t s = absl::IDivDuration(d, absl::Seconds(1), &d);
+  const int64_t n = absl::IDivDuration(d, absl::Nanoseconds(1), &d);
+  out->set_seconds(s);
+  out->set_nanos(n);
+}
+
+void SetLognormal(absl::Duration median, double sigma, LognormalLatency* out) {
+  SetDuration(median, out->mutable_median());
+  out->set_sigma(sigma);
+}
+
 void AddResponseActionOrDie(const Server& server, std::string_view method_name,
                             ResponseAction response_action) {
   Fault fault;
@@ -37,16 +51,26 @@ void AddResponseActionOrDie(const Server& server, std::string_view method_name,
                      << "; message: " << result.error_message();
 }
 
+void AddShapingRuleOrDie(const Server& server, std::string_view method_name,
+                         ShapingRule rule) {
+  if (!method_name.empty()) {
+    rule.mutable_request_matcher()->set_method_name(std::string(method_name));
+  }
+
+  grpc::ClientContext ctx;
+  google::protobuf::Empty response;
+  grpc::Status result =
+      server.NewFaultClient()->AddShapingRule(&ctx, rule, &response);
+  CHECK(result.ok()) << "status code: " << result.error_code()
+                     << "; message: " << result.error_message();
+}
+
 }  // namespace
 
 void AddDelayOrDie(const Server& server, absl::Duration delay,
                    std::string_view method_name) {
   ResponseAction action;
-  // Cribbed directly from util_time::EncodeGoogleApiProto
-  const int64_t s = absl::IDivDuration(delay, absl::Seconds(1), &delay);
-  const int64_t n = absl::IDivDuration(delay, absl::Nanoseconds(1), &delay);
-  action.mutable_delay()->set_seconds(s);
-  action.mutable_delay()->set_nanos(n);
+  SetDuration(delay, action.mutable_delay());
   AddResponseActionOrDie(server, method_name, action);
 }
 
@@ -58,4 +82,65 @@ void AddErrorOrDie(const Server& server, absl::Status error,
   AddResponseActionOrDie(server, method_name, action);
 }
 
+LatencyProfile FixedLatencyProfile(absl::Duration latency) {
+  LatencyProfile profile;
+  SetDuration(latency, profile.mutable_fixed());
+  return profile;
+}
+
+LatencyProfile LognormalLatencyProfile(absl::Duration median, double sigma) {
+  LatencyProfile profile;
+  SetLognormal(median, sigma, profile.mutable_lognormal());
+  return profile;
+}
+
+LatencyProfile BimodalLatencyProfile(absl::Duration fast_median,
+                                     double fast_sigma,
+                                     absl::Duration slow_median,
+                                     double slow_sigma,
+                                     double slow_probability) {
+  LatencyProfile profile;
+  BimodalLatency* bimodal = profile.mutable_bimodal();
+  SetLognormal(fast_median, fast_sigma, bimodal->mutable_fast());
+  SetLognormal(slow_median, slow_sigma, bimodal->mutable_slow());
+  bimodal->set_slow_probability(slow_probability);
+  return profile;
+}
+
+LatencyProfile PercentileLatencyProfile(
+    const std::vector<std::pair<double, absl::Duration>>& points) {
+  LatencyProfile profile;
+  for (const auto& [percentile, latency] : points) {
+    PercentileLatency::Point* point =
+        profile.mutable_percentiles()->add_points();
+    point->set_percentile(percentile);
+    SetDuration(latency, point->mutable_latency());
+  }
+  return profile;
+}
+
+void AddLatencyProfileOrDie(const Server& server, const LatencyProfile& profile,
+                            std::string_view method_name) {
+  ShapingRule rule;
+  *rule.mutable_latency() = profile;
+  AddShapingRuleOrDie(server, method_name, rule);
+}
+
+void AddRateLimitOrDie(const Server& server, double queries_per_second,
+                       uint32_t burst, std::string_view method_name) {
+  ShapingRule rule;
+  rule.mutable_rate_limit()->set_queries_per_second(queries_per_second);
+  rule.mutable_rate_limit()->set_burst(burst);
+  AddShapingRuleOrDie(server, method_name, rule);
+}
+
+void ClearShapingRulesOrDie(const Server& server) {
+  grpc::ClientContext ctx;
+  google::protobuf::Empty request, response;
+  grpc::Status result =
+      server.NewFaultClient()->ClearShapingRules(&ctx, request, &response);
+  CHECK(result.ok()) << "status code: " << result.error_code()
+                     << "; message: " << result.error_message();
+}
+
 }  // namespace fakekms
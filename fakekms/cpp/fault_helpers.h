@@ -17,7 +17,10 @@
 #ifndef FAKEKMS_CPP_FAULT_HELPERS_H_
 #define FAKEKMS_CPP_FAULT_HELPERS_H_
 
+#include <cstdint>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/time/time.h"
@@ -32,6 +35,41 @@ void AddDelayOrDie(const Server& server, absl::Duration delay,
 void AddErrorOrDie(const Server& server, absl::Status error,
                    std::string_view method_name = "");
 
+// Returns a LatencyProfile in which every latency is `latency`.
+LatencyProfile FixedLatencyProfile(absl::Duration latency);
+
+// Returns a LatencyProfile with lognormally distributed latencies.
+LatencyProfile LognormalLatencyProfile(absl::Duration median, double sigma);
+
+// Returns a LatencyProfile that draws a latency from the lognormal
+// distribution given by `slow_median` and `slow_sigma` with probability
+// `slow_probability`, and from the one given by `fast_median` and `fast_sigma`
+// otherwise.
+LatencyProfile BimodalLatencyProfile(absl::Duration fast_median,
+                                     double fast_sigma,
+                                     absl::Duration slow_median,
+                                     double slow_sigma,
+                                     double slow_probability);
+
+// Returns a LatencyProfile given by (percentile, latency) points, in
+// increasing order of percentile.
+LatencyProfile PercentileLatencyProfile(
+    const std::vector<std::pair<double, absl::Duration>>& points);
+
+// Adds a shaping rule that delays every matching request by a latency drawn
+// from `profile`. The rule remains in effect until ClearShapingRulesOrDie.
+void AddLatencyProfileOrDie(const Server& server, const LatencyProfile& profile,
+                            std::string_view method_name = "");
+
+// Adds a shaping rule that fails matching requests with RESOURCE_EXHAUSTED
+// above `queries_per_second`. A `burst` of 0 selects the service's default.
+// The rule remains in effect until ClearShapingRulesOrDie.
+void AddRateLimitOrDie(const Server& server, double queries_per_second,
+                       uint32_t burst = 0, std::string_view method_name = "");
+
+// Removes all shaping rules.
+void ClearShapingRulesOrDie(const Server& server);
+
 }  // namespace fakekms
 
 #endif  // FAKEKMS_CPP_FAULT_HELPERS_H_
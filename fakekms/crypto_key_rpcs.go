@@ -61,6 +61,9 @@ func (f *fakeKMS) CreateCryptoKey(ctx context.Context, req *kmspb.CreateCryptoKe
 		return nil, err
 	}
 
+	f.mux.Lock()
+	defer f.mux.Unlock()
+
 	kr, ok := f.keyRings[krName]
 	if !ok {
 		return nil, errNotFound(krName)
@@ -86,14 +89,14 @@ func (f *fakeKMS) CreateCryptoKey(ctx context.Context, req *kmspb.CreateCryptoKe
 	}
 
 	if !req.SkipInitialVersionCreation {
-		ckv := f.createVersion(ck)
+		ckv, _ := f.createVersion(ck)
 		if purpose == kmspb.CryptoKey_ENCRYPT_DECRYPT {
-			pb.Primary = ckv
+			ck.primary = ckv
 		}
 	}
 
 	kr.keys[name] = ck
-	return pb, nil
+	return ck.proto(), nil
 }
 
 // GetCryptoKey fakes a Cloud KMS API function.
@@ -107,12 +110,15 @@ func (f *fakeKMS) GetCryptoKey(ctx context.Context, req *kmspb.GetCryptoKeyReque
 		return nil, err
 	}
 
+	f.mux.RLock()
+	defer f.mux.RUnlock()
+
 	ck, err := f.cryptoKey(name)
 	if err != nil {
 		return nil, err
 	}
 
-	return ck.pb, nil
+	return ck.proto(), nil
 }
 
 // ListCryptoKeys fakes a Cloud KMS API function.
@@ -126,6 +132,9 @@ func (f *fakeKMS) ListCryptoKeys(ctx context.Context, req *kmspb.ListCryptoKeysR
 		return nil, err
 	}
 
+	f.mux.RLock()
+	defer f.mux.RUnlock()
+
 	kr, ok := f.keyRings[parent]
 	if !ok {
 		return nil, errNotFound(parent)
@@ -133,7 +142,7 @@ func (f *fakeKMS) ListCryptoKeys(ctx context.Context, req *kmspb.ListCryptoKeysR
 
 	r := make([]*kmspb.CryptoKey, 0, len(kr.keys))
 	for _, ck := range kr.keys {
-		r = append(r, ck.pb)
+		r = append(r, ck.proto())
 	}
 
 	if len(r) > maxPageSize {
@@ -165,6 +174,9 @@ func (f *fakeKMS) UpdateCryptoKey(ctx context.Context, req *kmspb.UpdateCryptoKe
 		return nil, err
 	}
 
+	f.mux.Lock()
+	defer f.mux.Unlock()
+
 	ck, err := f.cryptoKey(name)
 	if err != nil {
 		return nil, err
@@ -182,5 +194,5 @@ func (f *fakeKMS) UpdateCryptoKey(ctx context.Context, req *kmspb.UpdateCryptoKe
 		}
 	}
 
-	return ck.pb, nil
+	return ck.proto(), nil
 }
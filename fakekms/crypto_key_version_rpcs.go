@@ -21,6 +21,7 @@ import (
 	"time"
 
 	"cloud.google.com/go/kms/apiv1/kmspb"
+	"google.golang.org/protobuf/proto"
 	"google.golang.org/protobuf/types/known/timestamppb"
 )
 
@@ -35,17 +36,22 @@ func (f *fakeKMS) CreateCryptoKeyVersion(ctx context.Context, req *kmspb.CreateC
 		return nil, err
 	}
 
+	f.mux.Lock()
+	defer f.mux.Unlock()
+
 	ck, err := f.cryptoKey(ckName)
 	if err != nil {
 		return nil, err
 	}
 
-	return f.createVersion(ck), nil
+	_, pb := f.createVersion(ck)
+	return pb, nil
 }
 
-// createVersion adds a new version to the provided cryptoKey and returns its proto.
-// Callers must already be holding f.mux (normally via the locking interceptor).
-func (f *fakeKMS) createVersion(ck *cryptoKey) *kmspb.CryptoKeyVersion {
+// createVersion adds a new version to the provided cryptoKey. It returns the
+// version and a copy of its initial state. Callers must already be holding
+// f.mux for writing.
+func (f *fakeKMS) createVersion(ck *cryptoKey) (*cryptoKeyVersion, *kmspb.CryptoKeyVersion) {
 	ckName, _ := parseCryptoKeyName(ck.pb.Name)
 	name := cryptoKeyVersionName{
 		cryptoKeyName:      ckName,
@@ -60,35 +66,31 @@ func (f *fakeKMS) createVersion(ck *cryptoKey) *kmspb.CryptoKeyVersion {
 	}
 
 	ckv := &cryptoKeyVersion{pb: pb}
+	ck.versions[name] = ckv
 	def, _ := algorithmDef(pb.Algorithm)
 
 	if def.Asymmetric() {
 		// async generation
 		pb.State = kmspb.CryptoKeyVersion_PENDING_GENERATION
+		initial := proto.Clone(pb).(*kmspb.CryptoKeyVersion)
 		go func() {
 			k := def.KeyFactory.Generate() // no need to wait on the lock for this
 
-			// Our lock interceptor ensures that f.mux is held whenever an RPC is in
-			// flight. This goroutine won't be able to acquire f.mux until after the
-			// CreateCryptoKeyVersion RPC completes. Since all RPCs acquire f.mux, we
-			// can further guarantee that no other RPCs are in flight when this
-			// routine proceeds.
-			f.mux.Lock()
-			defer f.mux.Unlock()
+			ckv.mux.Lock()
+			defer ckv.mux.Unlock()
 
 			ckv.keyMaterial = k
 			pb.State = kmspb.CryptoKeyVersion_ENABLED
 			pb.GenerateTime = timestamppb.Now()
 		}()
-	} else {
-		// sync generation
-		ckv.keyMaterial = def.KeyFactory.Generate()
-		pb.GenerateTime = pb.CreateTime
-		pb.State = kmspb.CryptoKeyVersion_ENABLED
+		return ckv, initial
 	}
 
-	ck.versions[name] = ckv
-	return pb
+	// sync generation
+	ckv.keyMaterial = def.KeyFactory.Generate()
+	pb.GenerateTime = pb.CreateTime
+	pb.State = kmspb.CryptoKeyVersion_ENABLED
+	return ckv, proto.Clone(pb).(*kmspb.CryptoKeyVersion)
 }
 
 // GetCryptoKeyVersion fakes a Cloud KMS API function.
@@ -102,12 +104,12 @@ func (f *fakeKMS) GetCryptoKeyVersion(ctx context.Context, req *kmspb.GetCryptoK
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.lookupCryptoKeyVersion(name)
 	if err != nil {
 		return nil, err
 	}
 
-	return ckv.pb, nil
+	return ckv.proto(), nil
 }
 
 // ListCryptoKeyVersions fakes a Cloud KMS API function.
@@ -121,6 +123,9 @@ func (f *fakeKMS) ListCryptoKeyVersions(ctx context.Context, req *kmspb.ListCryp
 		return nil, err
 	}
 
+	f.mux.RLock()
+	defer f.mux.RUnlock()
+
 	ck, err := f.cryptoKey(parent)
 	if err != nil {
 		return nil, err
@@ -128,7 +133,7 @@ func (f *fakeKMS) ListCryptoKeyVersions(ctx context.Context, req *kmspb.ListCryp
 
 	r := make([]*kmspb.CryptoKeyVersion, 0, len(ck.versions))
 	for _, ckv := range ck.versions {
-		r = append(r, ckv.pb)
+		r = append(r, ckv.proto())
 	}
 
 	if len(r) > maxPageSize {
@@ -160,11 +165,14 @@ func (f *fakeKMS) UpdateCryptoKeyVersion(ctx context.Context, req *kmspb.UpdateC
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.lookupCryptoKeyVersion(name)
 	if err != nil {
 		return nil, err
 	}
 
+	ckv.mux.Lock()
+	defer ckv.mux.Unlock()
+
 	for _, p := range req.UpdateMask.Paths {
 		switch p {
 		case "state":
@@ -180,7 +188,7 @@ func (f *fakeKMS) UpdateCryptoKeyVersion(ctx context.Context, req *kmspb.UpdateC
 		}
 	}
 
-	return ckv.pb, nil
+	return proto.Clone(ckv.pb).(*kmspb.CryptoKeyVersion), nil
 }
 
 // DestroyCryptoKeyVersion fakes a Cloud KMS API function.
@@ -194,11 +202,14 @@ func (f *fakeKMS) DestroyCryptoKeyVersion(ctx context.Context, req *kmspb.Destro
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.lookupCryptoKeyVersion(name)
 	if err != nil {
 		return nil, err
 	}
 
+	ckv.mux.Lock()
+	defer ckv.mux.Unlock()
+
 	switch ckv.pb.State {
 	case kmspb.CryptoKeyVersion_ENABLED, kmspb.CryptoKeyVersion_DISABLED:
 		break
@@ -211,5 +222,5 @@ func (f *fakeKMS) DestroyCryptoKeyVersion(ctx context.Context, req *kmspb.Destro
 
 	ckv.pb.DestroyTime = timestamppb.New(destroyTime)
 	ckv.pb.State = kmspb.CryptoKeyVersion_DESTROY_SCHEDULED
-	return ckv.pb, nil
+	return proto.Clone(ckv.pb).(*kmspb.CryptoKeyVersion), nil
 }
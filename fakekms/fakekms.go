@@ -23,6 +23,7 @@ import (
 
 	"cloud.google.com/kms/integrations/fakekms/fault"
 	"google.golang.org/grpc"
+	"google.golang.org/protobuf/proto"
 
 	"cloud.google.com/go/kms/apiv1/kmspb"
 	"cloud.google.com/kms/integrations/fakekms/fault/faultpb"
@@ -37,8 +38,11 @@ type fakeKMS struct {
 	kmspb.UnimplementedKeyManagementServiceServer
 	keyRings map[keyRingName]*keyRing
 
-	// Protects keyRings. For guarding object use within RPCs, the lock is held
-	// in the lock interceptor rather than directly in the RPC function.
+	// Protects the resource tree: keyRings, the keys and versions maps of its
+	// members, and the protos of key rings and crypto keys. Key version state
+	// is protected by a lock of its own, so that RPCs that use different key
+	// versions (or only read the same one) proceed concurrently. When both are
+	// held, mux is acquired first.
 	mux sync.RWMutex
 }
 
@@ -51,9 +55,20 @@ type keyRing struct {
 // cryptoKey models a CryptoKey in Cloud KMS.
 type cryptoKey struct {
 	pb       *kmspb.CryptoKey
+	primary  *cryptoKeyVersion // nil if the key has no primary version
 	versions map[cryptoKeyVersionName]*cryptoKeyVersion
 }
 
+// proto returns a copy of the key's current state, including the current
+// state of its primary version. Callers must hold f.mux.
+func (ck *cryptoKey) proto() *kmspb.CryptoKey {
+	pb := proto.Clone(ck.pb).(*kmspb.CryptoKey)
+	if ck.primary != nil {
+		pb.Primary = ck.primary.proto()
+	}
+	return pb
+}
+
 func (f *fakeKMS) cryptoKey(name cryptoKeyName) (*cryptoKey, error) {
 	kr, ok := f.keyRings[name.keyRingName]
 	if !ok {
@@ -68,10 +83,20 @@ func (f *fakeKMS) cryptoKey(name cryptoKeyName) (*cryptoKey, error) {
 
 // cryptoKeyVersion models a CryptoKeyVersion in Cloud KMS.
 type cryptoKeyVersion struct {
+	// Protects pb and keyMaterial.
+	mux         sync.RWMutex
 	pb          *kmspb.CryptoKeyVersion
 	keyMaterial interface{}
 }
 
+// proto returns a copy of the version's current state.
+func (ckv *cryptoKeyVersion) proto() *kmspb.CryptoKeyVersion {
+	ckv.mux.RLock()
+	defer ckv.mux.RUnlock()
+	return proto.Clone(ckv.pb).(*kmspb.CryptoKeyVersion)
+}
+
+// cryptoKeyVersion looks up a version. Callers must hold f.mux.
 func (f *fakeKMS) cryptoKeyVersion(name cryptoKeyVersionName) (*cryptoKeyVersion, error) {
 	kr, ok := f.keyRings[name.keyRingName]
 	if !ok {
@@ -88,6 +113,44 @@ func (f *fakeKMS) cryptoKeyVersion(name cryptoKeyVersionName) (*cryptoKeyVersion
 	return ckv, nil
 }
 
+// lookupCryptoKeyVersion looks up a version while holding f.mux for reading.
+// Versions are never removed, so the result remains valid after f.mux is
+// released.
+func (f *fakeKMS) lookupCryptoKeyVersion(name cryptoKeyVersionName) (*cryptoKeyVersion, error) {
+	f.mux.RLock()
+	defer f.mux.RUnlock()
+	return f.cryptoKeyVersion(name)
+}
+
+// usableKey is a snapshot of the parts of an enabled key version that are
+// needed to perform a cryptographic operation. Key material is immutable once
+// generated, so operations may use it without holding any lock.
+type usableKey struct {
+	algorithm       kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm
+	protectionLevel kmspb.ProtectionLevel
+	keyMaterial     interface{}
+}
+
+// enabledKey returns a snapshot of the named version, or FAILED_PRECONDITION
+// if the version is not enabled.
+func (f *fakeKMS) enabledKey(name cryptoKeyVersionName) (*usableKey, error) {
+	ckv, err := f.lookupCryptoKeyVersion(name)
+	if err != nil {
+		return nil, err
+	}
+
+	ckv.mux.RLock()
+	defer ckv.mux.RUnlock()
+	if ckv.pb.State != kmspb.CryptoKeyVersion_ENABLED {
+		return nil, errFailedPrecondition("key version %s is not enabled", name)
+	}
+	return &usableKey{
+		algorithm:       ckv.pb.Algorithm,
+		protectionLevel: ckv.pb.ProtectionLevel,
+		keyMaterial:     ckv.keyMaterial,
+	}, nil
+}
+
 // Server wraps a local gRPC server that serves KMS requests.
 type Server struct {
 	Addr       net.Addr
@@ -115,7 +178,7 @@ func NewServer() (*Server, error) {
 	fakeKMS := &fakeKMS{keyRings: make(map[keyRingName]*keyRing)}
 	faultServer := &fault.Server{}
 	s := grpc.NewServer(grpc.ChainUnaryInterceptor(
-		faultServer.NewInterceptor(), newLockInterceptor(&fakeKMS.mux)))
+		faultServer.NewInterceptor(), newServiceInterceptor()))
 	kmspb.RegisterKeyManagementServiceServer(s, fakeKMS)
 	faultpb.RegisterFaultServiceServer(s, faultServer)
 
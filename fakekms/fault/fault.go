@@ -16,11 +16,13 @@ package fault
 
 import (
 	"context"
+	"math/rand"
 	"strings"
 	"sync"
 	"time"
 
 	"google.golang.org/grpc"
+	"google.golang.org/grpc/codes"
 	"google.golang.org/grpc/status"
 
 	"cloud.google.com/kms/integrations/fakekms/fault/faultpb"
@@ -32,6 +34,8 @@ var _ faultpb.FaultServiceServer = (*Server)(nil)
 type Server struct {
 	lock   sync.Mutex
 	faults []*faultpb.Fault
+	rules  []*shapingRule
+	rand   *rand.Rand
 }
 
 func (s *Server) AddFault(ctx context.Context, fault *faultpb.Fault) (*emptypb.Empty, error) {
@@ -42,6 +46,52 @@ func (s *Server) AddFault(ctx context.Context, fault *faultpb.Fault) (*emptypb.E
 	return &emptypb.Empty{}, nil
 }
 
+func (s *Server) AddShapingRule(ctx context.Context, rule *faultpb.ShapingRule) (*emptypb.Empty, error) {
+	r, err := newShapingRule(rule, time.Now())
+	if err != nil {
+		return nil, status.Errorf(codes.InvalidArgument, "invalid shaping rule: %v", err)
+	}
+
+	s.lock.Lock()
+	defer s.lock.Unlock()
+
+	s.rules = append(s.rules, r)
+	return &emptypb.Empty{}, nil
+}
+
+func (s *Server) ClearShapingRules(ctx context.Context, _ *emptypb.Empty) (*emptypb.Empty, error) {
+	s.lock.Lock()
+	defer s.lock.Unlock()
+
+	s.rules = nil
+	return &emptypb.Empty{}, nil
+}
+
+// Applies the shaping rules that match the method. Returns the latency to add
+// to the request, or a RESOURCE_EXHAUSTED error if a rate limit is exceeded.
+func (s *Server) applyShapingRules(method string) (time.Duration, error) {
+	s.lock.Lock()
+	defer s.lock.Unlock()
+
+	now := time.Now()
+	for _, r := range s.rules {
+		if r.rateLimit != nil && r.matches(method) && !r.rateLimit.take(now) {
+			return 0, status.Errorf(codes.ResourceExhausted, "rate limit exceeded for method %s", method)
+		}
+	}
+
+	var latency time.Duration
+	for _, r := range s.rules {
+		if r.latency != nil && r.matches(method) {
+			if s.rand == nil {
+				s.rand = rand.New(rand.NewSource(now.UnixNano()))
+			}
+			latency += r.latency(s.rand)
+		}
+	}
+	return latency, nil
+}
+
 // Returns an appropriate ResponseAction for the method, or nil if
 // normal processing should be used.
 func (s *Server) findFaultResponse(method string) *faultpb.ResponseAction {
@@ -75,9 +125,16 @@ func (s *Server) NewInterceptor() grpc.UnaryServerInterceptor {
 
 		// FullMethod looks like "/foo.package.BarService/BazMethod"
 		method := strings.Split(info.FullMethod, "/")[2]
+		delay, err := s.applyShapingRules(method)
+		if err != nil {
+			return nil, err
+		}
 		action := s.findFaultResponse(method)
 		if action.GetDelay() != nil {
-			time.Sleep(action.Delay.AsDuration())
+			delay += action.Delay.AsDuration()
+		}
+		if delay > 0 {
+			time.Sleep(delay)
 		}
 		if action.GetError() != nil {
 			return nil, status.ErrorProto(action.Error)
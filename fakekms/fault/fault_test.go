@@ -29,6 +29,7 @@ import (
 	"cloud.google.com/kms/integrations/fakekms/fault/mathpb"
 	statuspb "google.golang.org/genproto/googleapis/rpc/status"
 	"google.golang.org/protobuf/types/known/durationpb"
+	"google.golang.org/protobuf/types/known/emptypb"
 )
 
 var _ mathpb.MathServiceServer = (*mathServer)(nil)
@@ -285,3 +286,95 @@ func TestDelay(t *testing.T) {
 		t.Errorf("duration=%v, want >= %v", duration, delay)
 	}
 }
+
+func TestShapingRuleDelaysEveryMatchingRequest(t *testing.T) {
+	ctx := context.Background()
+	conn, cancel, err := startTestServer(ctx)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer cancel()
+
+	delay := 200 * time.Millisecond
+	faultClient := faultpb.NewFaultServiceClient(conn)
+	_, err = faultClient.AddShapingRule(ctx, &faultpb.ShapingRule{
+		RequestMatcher: &faultpb.RequestMatcher{MethodName: "Multiply"},
+		Latency: &faultpb.LatencyProfile{
+			Distribution: &faultpb.LatencyProfile_Fixed{Fixed: durationpb.New(delay)},
+		},
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	mathClient := mathpb.NewMathServiceClient(conn)
+	for i := 0; i < 2; i++ {
+		begin := time.Now()
+		if _, err := mathClient.Multiply(ctx, &mathpb.MultiplyRequest{X: 2, Y: 3}); err != nil {
+			t.Fatal(err)
+		}
+		if duration := time.Now().Sub(begin); duration < delay {
+			t.Errorf("request %d: duration=%v, want >= %v", i, duration, delay)
+		}
+	}
+
+	begin := time.Now()
+	if _, err := mathClient.Add(ctx, &mathpb.AddRequest{}); err != nil {
+		t.Fatal(err)
+	}
+	if duration := time.Now().Sub(begin); duration >= delay {
+		t.Errorf("Add duration=%v, want < %v", duration, delay)
+	}
+}
+
+func TestShapingRuleRateLimitReturnsResourceExhausted(t *testing.T) {
+	ctx := context.Background()
+	conn, cancel, err := startTestServer(ctx)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer cancel()
+
+	faultClient := faultpb.NewFaultServiceClient(conn)
+	_, err = faultClient.AddShapingRule(ctx, &faultpb.ShapingRule{
+		RateLimit: &faultpb.RateLimit{QueriesPerSecond: 0.001, Burst: 2},
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	mathClient := mathpb.NewMathServiceClient(conn)
+	for i := 0; i < 2; i++ {
+		if _, err := mathClient.Add(ctx, &mathpb.AddRequest{}); err != nil {
+			t.Fatalf("request %d: %v", i, err)
+		}
+	}
+	_, err = mathClient.Add(ctx, &mathpb.AddRequest{})
+	if status.Code(err) != codes.ResourceExhausted {
+		t.Errorf("status.Code(err)=%v, want ResourceExhausted", status.Code(err))
+	}
+
+	if _, err := faultClient.ClearShapingRules(ctx, &emptypb.Empty{}); err != nil {
+		t.Fatal(err)
+	}
+	if _, err := mathClient.Add(ctx, &mathpb.AddRequest{}); err != nil {
+		t.Errorf("after ClearShapingRules: %v", err)
+	}
+}
+
+func TestAddShapingRuleRejectsInvalidRule(t *testing.T) {
+	ctx := context.Background()
+	conn, cancel, err := startTestServer(ctx)
+	if err != nil {
+		t.Fatal(err)
+	}
+	defer cancel()
+
+	faultClient := faultpb.NewFaultServiceClient(conn)
+	_, err = faultClient.AddShapingRule(ctx, &faultpb.ShapingRule{
+		RateLimit: &faultpb.RateLimit{QueriesPerSecond: -1},
+	})
+	if status.Code(err) != codes.InvalidArgument {
+		t.Errorf("status.Code(err)=%v, want InvalidArgument", status.Code(err))
+	}
+}
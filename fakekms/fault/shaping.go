@@ -0,0 +1,223 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package fault
+
+import (
+	"fmt"
+	"math"
+	"math/rand"
+	"time"
+
+	"google.golang.org/protobuf/types/known/durationpb"
+
+	"cloud.google.com/kms/integrations/fakekms/fault/faultpb"
+)
+
+// A latencySampler draws a latency from a distribution.
+type latencySampler func(r *rand.Rand) time.Duration
+
+// A tokenBucket admits requests at a sustained rate, with bursts of up to
+// burst requests.
+type tokenBucket struct {
+	rate   float64 // tokens per second
+	burst  float64
+	tokens float64
+	last   time.Time
+}
+
+func newTokenBucket(limit *faultpb.RateLimit, now time.Time) (*tokenBucket, error) {
+	qps := limit.GetQueriesPerSecond()
+	if !(qps > 0) || math.IsInf(qps, 0) {
+		return nil, fmt.Errorf("queries_per_second must be positive and finite, got %v", qps)
+	}
+	burst := float64(limit.GetBurst())
+	if burst == 0 {
+		burst = math.Max(1, qps)
+	}
+	return &tokenBucket{rate: qps, burst: burst, tokens: burst, last: now}, nil
+}
+
+// take reports whether a request arriving at now is admitted.
+func (b *tokenBucket) take(now time.Time) bool {
+	if elapsed := now.Sub(b.last); elapsed > 0 {
+		b.tokens = math.Min(b.burst, b.tokens+elapsed.Seconds()*b.rate)
+		b.last = now
+	}
+	if b.tokens < 1 {
+		return false
+	}
+	b.tokens--
+	return true
+}
+
+// A shapingRule is the parsed form of a faultpb.ShapingRule.
+type shapingRule struct {
+	methodName string
+	latency    latencySampler // nil if the rule adds no latency
+	rateLimit  *tokenBucket   // nil if the rule has no rate limit
+}
+
+func (r *shapingRule) matches(method string) bool {
+	return r.methodName == "" || r.methodName == method
+}
+
+func newShapingRule(rule *faultpb.ShapingRule, now time.Time) (*shapingRule, error) {
+	r := &shapingRule{methodName: rule.GetRequestMatcher().GetMethodName()}
+	if rule.GetLatency() != nil {
+		sampler, err := newLatencySampler(rule.GetLatency())
+		if err != nil {
+			return nil, fmt.Errorf("latency: %v", err)
+		}
+		r.latency = sampler
+	}
+	if rule.GetRateLimit() != nil {
+		bucket, err := newTokenBucket(rule.GetRateLimit(), now)
+		if err != nil {
+			return nil, fmt.Errorf("rate_limit: %v", err)
+		}
+		r.rateLimit = bucket
+	}
+	return r, nil
+}
+
+func toDuration(d *durationpb.Duration) (time.Duration, error) {
+	if err := d.CheckValid(); err != nil {
+		return 0, err
+	}
+	if d.AsDuration() < 0 {
+		return 0, fmt.Errorf("duration must not be negative, got %v", d.AsDuration())
+	}
+	return d.AsDuration(), nil
+}
+
+func newLatencySampler(profile *faultpb.LatencyProfile) (latencySampler, error) {
+	switch d := profile.GetDistribution().(type) {
+	case *faultpb.LatencyProfile_Fixed:
+		latency, err := toDuration(d.Fixed)
+		if err != nil {
+			return nil, fmt.Errorf("fixed: %v", err)
+		}
+		return func(*rand.Rand) time.Duration { return latency }, nil
+	case *faultpb.LatencyProfile_Lognormal:
+		sampler, err := newLognormalSampler(d.Lognormal)
+		if err != nil {
+			return nil, fmt.Errorf("lognormal: %v", err)
+		}
+		return sampler, nil
+	case *faultpb.LatencyProfile_Bimodal:
+		sampler, err := newBimodalSampler(d.Bimodal)
+		if err != nil {
+			return nil, fmt.Errorf("bimodal: %v", err)
+		}
+		return sampler, nil
+	case *faultpb.LatencyProfile_Percentiles:
+		sampler, err := newPercentileSampler(d.Percentiles)
+		if err != nil {
+			return nil, fmt.Errorf("percentiles: %v", err)
+		}
+		return sampler, nil
+	default:
+		return nil, fmt.Errorf("a distribution is required")
+	}
+}
+
+func newLognormalSampler(l *faultpb.LognormalLatency) (latencySampler, error) {
+	median, err := toDuration(l.GetMedian())
+	if err != nil {
+		return nil, fmt.Errorf("median: %v", err)
+	}
+	sigma := l.GetSigma()
+	if !(sigma >= 0) || math.IsInf(sigma, 0) {
+		return nil, fmt.Errorf("sigma must be non-negative and finite, got %v", sigma)
+	}
+	return func(r *rand.Rand) time.Duration {
+		return clampDuration(float64(median) * math.Exp(sigma*r.NormFloat64()))
+	}, nil
+}
+
+func newBimodalSampler(b *faultpb.BimodalLatency) (latencySampler, error) {
+	fast, err := newLognormalSampler(b.GetFast())
+	if err != nil {
+		return nil, fmt.Errorf("fast: %v", err)
+	}
+	slow, err := newLognormalSampler(b.GetSlow())
+	if err != nil {
+		return nil, fmt.Errorf("slow: %v", err)
+	}
+	p := b.GetSlowProbability()
+	if !(p >= 0 && p <= 1) {
+		return nil, fmt.Errorf("slow_probability must be between 0 and 1, got %v", p)
+	}
+	return func(r *rand.Rand) time.Duration {
+		if r.Float64() < p {
+			return slow(r)
+		}
+		return fast(r)
+	}, nil
+}
+
+type percentilePoint struct {
+	percentile float64
+	latency    time.Duration
+}
+
+func newPercentileSampler(p *faultpb.PercentileLatency) (latencySampler, error) {
+	if len(p.GetPoints()) == 0 {
+		return nil, fmt.Errorf("at least one point is required")
+	}
+	points := make([]percentilePoint, len(p.GetPoints()))
+	for i, pt := range p.GetPoints() {
+		pct := pt.GetPercentile()
+		if !(pct >= 0 && pct <= 100) {
+			return nil, fmt.Errorf("points[%d]: percentile must be between 0 and 100, got %v", i, pct)
+		}
+		if i > 0 && pct <= points[i-1].percentile {
+			return nil, fmt.Errorf("points[%d]: percentiles must be strictly increasing", i)
+		}
+		latency, err := toDuration(pt.GetLatency())
+		if err != nil {
+			return nil, fmt.Errorf("points[%d]: latency: %v", i, err)
+		}
+		points[i] = percentilePoint{pct, latency}
+	}
+	return func(r *rand.Rand) time.Duration {
+		return interpolatePercentile(points, r.Float64()*100)
+	}, nil
+}
+
+// interpolatePercentile returns the latency at percentile pct, interpolating
+// linearly between points and clamping outside of them.
+func interpolatePercentile(points []percentilePoint, pct float64) time.Duration {
+	if pct <= points[0].percentile {
+		return points[0].latency
+	}
+	for i := 1; i < len(points); i++ {
+		lo, hi := points[i-1], points[i]
+		if pct <= hi.percentile {
+			frac := (pct - lo.percentile) / (hi.percentile - lo.percentile)
+			return lo.latency + time.Duration(frac*float64(hi.latency-lo.latency))
+		}
+	}
+	return points[len(points)-1].latency
+}
+
+// clampDuration converts nanos to a time.Duration, saturating rather than
+// overflowing for very long tails.
+func clampDuration(nanos float64) time.Duration {
+	if nanos >= math.MaxInt64 {
+		return math.MaxInt64
+	}
+	return time.Duration(nanos)
+}
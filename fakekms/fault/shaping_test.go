@@ -0,0 +1,106 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+package fault
+
+import (
+	"math/rand"
+	"sort"
+	"testing"
+	"time"
+
+	"google.golang.org/protobuf/types/known/durationpb"
+
+	"cloud.google.com/kms/integrations/fakekms/fault/faultpb"
+)
+
+func TestInterpolatePercentile(t *testing.T) {
+	points := []percentilePoint{
+		{50, 10 * time.Millisecond},
+		{90, 50 * time.Millisecond},
+		{100, 250 * time.Millisecond},
+	}
+	for _, tc := range []struct {
+		pct  float64
+		want time.Duration
+	}{
+		{0, 10 * time.Millisecond},
+		{50, 10 * time.Millisecond},
+		{70, 30 * time.Millisecond},
+		{90, 50 * time.Millisecond},
+		{95, 150 * time.Millisecond},
+		{100, 250 * time.Millisecond},
+	} {
+		if got := interpolatePercentile(points, tc.pct); got != tc.want {
+			t.Errorf("interpolatePercentile(%v)=%v, want %v", tc.pct, got, tc.want)
+		}
+	}
+}
+
+func TestLognormalSamplerMedian(t *testing.T) {
+	sampler, err := newLatencySampler(&faultpb.LatencyProfile{
+		Distribution: &faultpb.LatencyProfile_Lognormal{
+			Lognormal: &faultpb.LognormalLatency{
+				Median: durationpb.New(20 * time.Millisecond),
+				Sigma:  0.5,
+			},
+		},
+	})
+	if err != nil {
+		t.Fatal(err)
+	}
+
+	r := rand.New(rand.NewSource(1))
+	samples := make([]time.Duration, 10001)
+	for i := range samples {
+		samples[i] = sampler(r)
+	}
+	sort.Slice(samples, func(i, j int) bool { return samples[i] < samples[j] })
+	if median := samples[len(samples)/2]; median < 19*time.Millisecond || median > 21*time.Millisecond {
+		t.Errorf("median=%v, want about 20ms", median)
+	}
+}
+
+func TestTokenBucketRefills(t *testing.T) {
+	start := time.Unix(0, 0)
+	b, err := newTokenBucket(&faultpb.RateLimit{QueriesPerSecond: 10, Burst: 1}, start)
+	if err != nil {
+		t.Fatal(err)
+	}
+	if !b.take(start) {
+		t.Errorf("take(start)=false, want true")
+	}
+	if b.take(start.Add(50 * time.Millisecond)) {
+		t.Errorf("take(start+50ms)=true, want false")
+	}
+	if !b.take(start.Add(100 * time.Millisecond)) {
+		t.Errorf("take(start+100ms)=false, want true")
+	}
+}
+
+func TestNewLatencySamplerRejectsUnorderedPercentiles(t *testing.T) {
+	_, err := newLatencySampler(&faultpb.LatencyProfile{
+		Distribution: &faultpb.LatencyProfile_Percentiles{
+			Percentiles: &faultpb.PercentileLatency{
+				Points: []*faultpb.PercentileLatency_Point{
+					{Percentile: 90, Latency: durationpb.New(time.Second)},
+					{Percentile: 50, Latency: durationpb.New(time.Millisecond)},
+				},
+			},
+		},
+	})
+	if err == nil {
+		t.Errorf("newLatencySampler with unordered percentiles succeeded, want error")
+	}
+}
@@ -17,13 +17,14 @@ package fakekms
 import (
 	"context"
 	"strings"
-	"sync"
 
 	"google.golang.org/grpc"
-	"google.golang.org/protobuf/proto"
 )
 
-func newLockInterceptor(mux *sync.RWMutex) grpc.UnaryServerInterceptor {
+// newServiceInterceptor rejects requests for services and methods that fakekms
+// does not support. Locking is done by the RPCs themselves, so that requests
+// for different key versions do not contend with one another.
+func newServiceInterceptor() grpc.UnaryServerInterceptor {
 	return func(ctx context.Context, req interface{}, info *grpc.UnaryServerInfo, handler grpc.UnaryHandler) (interface{}, error) {
 		methodParts := strings.Split(info.FullMethod, "/")
 		svc, method := methodParts[1], methodParts[2]
@@ -37,34 +38,15 @@ func newLockInterceptor(mux *sync.RWMutex) grpc.UnaryServerInterceptor {
 			return nil, errUnimplemented("unsupported service: %s", svc)
 		}
 
-		var locker sync.Locker
 		switch method {
-		case "AsymmetricDecrypt", "AsymmetricSign", "GenerateRandomBytes", "GetCryptoKey",
+		case "AsymmetricDecrypt", "AsymmetricSign", "CreateCryptoKey", "CreateCryptoKeyVersion",
+			"CreateKeyRing", "DestroyCryptoKeyVersion", "GenerateRandomBytes", "GetCryptoKey",
 			"GetCryptoKeyVersion", "GetKeyRing", "GetPublicKey", "ListCryptoKeys",
 			"ListCryptoKeyVersions", "ListKeyRings", "MacSign", "MacVerify", "RawDecrypt",
-			"RawEncrypt":
-			locker = mux.RLocker()
-		case "CreateCryptoKey", "CreateCryptoKeyVersion", "CreateKeyRing", "DestroyCryptoKeyVersion",
-			"UpdateCryptoKey", "UpdateCryptoKeyVersion":
-			locker = mux
+			"RawEncrypt", "UpdateCryptoKey", "UpdateCryptoKeyVersion":
+			return handler(ctx, req)
 		default:
 			return nil, errUnimplemented("unsupported method: %s", info.FullMethod)
 		}
-
-		locker.Lock()
-		defer locker.Unlock()
-
-		resp, err := handler(ctx, req)
-		if err != nil {
-			return nil, err
-		}
-
-		// The response message (or one of its nested messages) might be shared.
-		// Guarantee thread safety by cloning the response while we hold the lock.
-		respMsg, ok := resp.(proto.Message)
-		if !ok {
-			return nil, errInternal("resp.(type)=%T, want proto.Message", resp)
-		}
-		return proto.Clone(respMsg), nil
 	}
 }
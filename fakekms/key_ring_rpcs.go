@@ -19,6 +19,7 @@ import (
 	"sort"
 
 	"cloud.google.com/go/kms/apiv1/kmspb"
+	"google.golang.org/protobuf/proto"
 	"google.golang.org/protobuf/types/known/timestamppb"
 )
 
@@ -37,6 +38,10 @@ func (f *fakeKMS) CreateKeyRing(ctx context.Context, req *kmspb.CreateKeyRingReq
 	}
 
 	name := keyRingName{locationName: parent, KeyRingID: req.KeyRingId}
+
+	f.mux.Lock()
+	defer f.mux.Unlock()
+
 	if _, ok := f.keyRings[name]; ok {
 		return nil, errAlreadyExists(name)
 	}
@@ -49,7 +54,7 @@ func (f *fakeKMS) CreateKeyRing(ctx context.Context, req *kmspb.CreateKeyRingReq
 		pb:   pb,
 		keys: make(map[cryptoKeyName]*cryptoKey),
 	}
-	return pb, nil
+	return proto.Clone(pb).(*kmspb.KeyRing), nil
 }
 
 // GetKeyRing fakes a Cloud KMS API function.
@@ -63,11 +68,14 @@ func (f *fakeKMS) GetKeyRing(ctx context.Context, req *kmspb.GetKeyRingRequest)
 		return nil, err
 	}
 
+	f.mux.RLock()
+	defer f.mux.RUnlock()
+
 	kr, ok := f.keyRings[name]
 	if !ok {
 		return nil, errNotFound(name)
 	}
-	return kr.pb, nil
+	return proto.Clone(kr.pb).(*kmspb.KeyRing), nil
 }
 
 // ListKeyRings fakes a Cloud KMS API function.
@@ -81,10 +89,13 @@ func (f *fakeKMS) ListKeyRings(ctx context.Context, req *kmspb.ListKeyRingsReque
 		return nil, err
 	}
 
+	f.mux.RLock()
+	defer f.mux.RUnlock()
+
 	r := make([]*kmspb.KeyRing, 0, len(f.keyRings))
 	for name, kr := range f.keyRings {
 		if name.locationName == parent {
-			r = append(r, kr.pb)
+			r = append(r, proto.Clone(kr.pb).(*kmspb.KeyRing))
 		}
 	}
 
@@ -49,19 +49,15 @@ func (f *fakeKMS) RawEncrypt(ctx context.Context, req *kmspb.RawEncryptRequest)
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.enabledKey(name)
 	if err != nil {
 		return nil, err
 	}
 
-	if ckv.pb.State != kmspb.CryptoKeyVersion_ENABLED {
-		return nil, errFailedPrecondition("key version %s is not enabled", name)
-	}
-
-	def, _ := algorithmDef(ckv.pb.Algorithm)
+	def, _ := algorithmDef(ckv.algorithm)
 	if def.Purpose != kmspb.CryptoKey_RAW_ENCRYPT_DECRYPT {
 		return nil, errFailedPrecondition("keys with algorithm %s may not be used for raw encryption",
-			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 	}
 
 	if req.Plaintext == nil {
@@ -80,7 +76,7 @@ func (f *fakeKMS) RawEncrypt(ctx context.Context, req *kmspb.RawEncryptRequest)
 
 	var nonce []byte
 	// Validate request fields.
-	switch ckv.pb.Algorithm {
+	switch ckv.algorithm {
 	case kmspb.CryptoKeyVersion_AES_128_GCM, kmspb.CryptoKeyVersion_AES_256_GCM:
 		if req.InitializationVector != nil {
 			return nil, errInvalidArgument("cannot specify iv when using AES-GCM")
@@ -102,7 +98,7 @@ func (f *fakeKMS) RawEncrypt(ctx context.Context, req *kmspb.RawEncryptRequest)
 		kmspb.CryptoKeyVersion_AES_256_CBC:
 		if req.AdditionalAuthenticatedData != nil {
 			return nil, errInvalidArgument("cannot specify aad when using %s",
-				nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+				nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 		}
 		if req.InitializationVector != nil {
 			if len(req.InitializationVector) > maxIvSize {
@@ -132,7 +128,7 @@ func (f *fakeKMS) RawEncrypt(ctx context.Context, req *kmspb.RawEncryptRequest)
 
 	var ciphertext []byte
 	var tagLen int32
-	switch ckv.pb.Algorithm {
+	switch ckv.algorithm {
 	case kmspb.CryptoKeyVersion_AES_128_GCM, kmspb.CryptoKeyVersion_AES_256_GCM:
 		aesgcm, err := cipher.NewGCM(block)
 		if err != nil {
@@ -165,7 +161,7 @@ func (f *fakeKMS) RawEncrypt(ctx context.Context, req *kmspb.RawEncryptRequest)
 		VerifiedPlaintextCrc32C:    req.PlaintextCrc32C != nil,
 		VerifiedAdditionalAuthenticatedDataCrc32C: req.AdditionalAuthenticatedDataCrc32C != nil,
 		VerifiedInitializationVectorCrc32C:        req.InitializationVectorCrc32C != nil,
-		ProtectionLevel:                           ckv.pb.ProtectionLevel,
+		ProtectionLevel:                           ckv.protectionLevel,
 	}, nil
 }
 
@@ -180,19 +176,15 @@ func (f *fakeKMS) RawDecrypt(ctx context.Context, req *kmspb.RawDecryptRequest)
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.enabledKey(name)
 	if err != nil {
 		return nil, err
 	}
 
-	if ckv.pb.State != kmspb.CryptoKeyVersion_ENABLED {
-		return nil, errFailedPrecondition("key version %s is not enabled", name)
-	}
-
-	def, _ := algorithmDef(ckv.pb.Algorithm)
+	def, _ := algorithmDef(ckv.algorithm)
 	if def.Purpose != kmspb.CryptoKey_RAW_ENCRYPT_DECRYPT {
 		return nil, errFailedPrecondition("keys with algorithm %s may not be used for raw decryption",
-			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 	}
 
 	if req.Ciphertext == nil {
@@ -219,12 +211,12 @@ func (f *fakeKMS) RawDecrypt(ctx context.Context, req *kmspb.RawDecryptRequest)
 	}
 
 	if req.AdditionalAuthenticatedData != nil {
-		switch ckv.pb.Algorithm {
+		switch ckv.algorithm {
 		case kmspb.CryptoKeyVersion_AES_128_GCM, kmspb.CryptoKeyVersion_AES_256_GCM:
 			break
 		default:
 			return nil, errInvalidArgument("cannot specify aad when using %s",
-				nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+				nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 		}
 	}
 
@@ -245,7 +237,7 @@ func (f *fakeKMS) RawDecrypt(ctx context.Context, req *kmspb.RawDecryptRequest)
 	}
 
 	var plaintext []byte
-	switch ckv.pb.Algorithm {
+	switch ckv.algorithm {
 	case kmspb.CryptoKeyVersion_AES_128_GCM, kmspb.CryptoKeyVersion_AES_256_GCM:
 		if len(ciphertext) < defaultTagLength {
 			return nil, errInvalidArgument("len(ciphertext)=%d, want len(ciphertext) > %d", len(ciphertext), defaultTagLength)
@@ -276,7 +268,7 @@ func (f *fakeKMS) RawDecrypt(ctx context.Context, req *kmspb.RawDecryptRequest)
 		VerifiedCiphertextCrc32C: req.CiphertextCrc32C != nil,
 		VerifiedAdditionalAuthenticatedDataCrc32C: req.AdditionalAuthenticatedDataCrc32C != nil,
 		VerifiedInitializationVectorCrc32C:        req.InitializationVectorCrc32C != nil,
-		ProtectionLevel:                           ckv.pb.ProtectionLevel,
+		ProtectionLevel:                           ckv.protectionLevel,
 	}, nil
 }
 
@@ -291,19 +283,15 @@ func (f *fakeKMS) MacSign(ctx context.Context, req *kmspb.MacSignRequest) (*kmsp
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.enabledKey(name)
 	if err != nil {
 		return nil, err
 	}
 
-	if ckv.pb.State != kmspb.CryptoKeyVersion_ENABLED {
-		return nil, errFailedPrecondition("key version %s is not enabled", name)
-	}
-
-	def, _ := algorithmDef(ckv.pb.Algorithm)
+	def, _ := algorithmDef(ckv.algorithm)
 	if def.Purpose != kmspb.CryptoKey_MAC {
 		return nil, errFailedPrecondition("keys with algorithm %s may not be used for MAC signing",
-			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 	}
 
 	hash := def.Opts.(crypto.Hash)
@@ -340,7 +328,7 @@ func (f *fakeKMS) MacSign(ctx context.Context, req *kmspb.MacSignRequest) (*kmsp
 		Mac:                macTag,
 		MacCrc32C:          crc32c(macTag),
 		VerifiedDataCrc32C: req.DataCrc32C != nil,
-		ProtectionLevel:    ckv.pb.ProtectionLevel,
+		ProtectionLevel:    ckv.protectionLevel,
 	}, nil
 }
 
@@ -355,19 +343,15 @@ func (f *fakeKMS) MacVerify(ctx context.Context, req *kmspb.MacVerifyRequest) (*
 		return nil, err
 	}
 
-	ckv, err := f.cryptoKeyVersion(name)
+	ckv, err := f.enabledKey(name)
 	if err != nil {
 		return nil, err
 	}
 
-	if ckv.pb.State != kmspb.CryptoKeyVersion_ENABLED {
-		return nil, errFailedPrecondition("key version %s is not enabled", name)
-	}
-
-	def, _ := algorithmDef(ckv.pb.Algorithm)
+	def, _ := algorithmDef(ckv.algorithm)
 	if def.Purpose != kmspb.CryptoKey_MAC {
 		return nil, errFailedPrecondition("keys with algorithm %s may not be used for MAC verification",
-			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.pb.Algorithm)))
+			nameForValue(kmspb.CryptoKeyVersion_CryptoKeyVersionAlgorithm_name, int32(ckv.algorithm)))
 	}
 
 	if req.Data == nil {
@@ -418,6 +402,6 @@ func (f *fakeKMS) MacVerify(ctx context.Context, req *kmspb.MacVerifyRequest) (*
 		VerifiedSuccessIntegrity: hmac.Equal(req.Mac, macTag),
 		VerifiedDataCrc32C:       req.DataCrc32C != nil,
 		VerifiedMacCrc32C:        req.MacCrc32C != nil,
-		ProtectionLevel:          ckv.pb.ProtectionLevel,
+		ProtectionLevel:          ckv.protectionLevel,
 	}, nil
 }
@@ -252,7 +252,8 @@ static const auto* const kAlgorithmDetails = new absl::btree_set<
     {
         kms_v1::CryptoKeyVersion::AES_128_GCM,   // algorithm
         kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT,  // purpose
-        {CKM_CLOUDKMS_AES_GCM},                  // allowed_mechanisms
+        {CKM_CLOUDKMS_AES_GCM,
+         CKM_CLOUDKMS_AES_GCM_ENVELOPE},         // allowed_mechanisms
         CKK_AES,                                 // key_type
         128,                                     // key_bit_length
         CKM_AES_KEY_GEN,                         // key_gen_mechanism
@@ -261,7 +262,8 @@ static const auto* const kAlgorithmDetails = new absl::btree_set<
     {
         kms_v1::CryptoKeyVersion::AES_256_GCM,   // algorithm
         kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT,  // purpose
-        {CKM_CLOUDKMS_AES_GCM},                  // allowed_mechanisms
+        {CKM_CLOUDKMS_AES_GCM,
+         CKM_CLOUDKMS_AES_GCM_ENVELOPE},         // allowed_mechanisms
         CKK_AES,                                 // key_type
         256,                                     // key_bit_length
         CKM_AES_KEY_GEN,                         // key_gen_mechanism
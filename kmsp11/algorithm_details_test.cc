@@ -72,7 +72,8 @@ TEST(GetAlgorithmDetailsTest, AlgorithmAesGcm) {
 
   EXPECT_EQ(details.algorithm, kms_v1::CryptoKeyVersion::AES_256_GCM);
   EXPECT_EQ(details.purpose, kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT);
-  EXPECT_THAT(details.allowed_mechanisms, ElementsAre(CKM_CLOUDKMS_AES_GCM));
+  EXPECT_THAT(details.allowed_mechanisms,
+              ElementsAre(CKM_CLOUDKMS_AES_GCM, CKM_CLOUDKMS_AES_GCM_ENVELOPE));
   EXPECT_EQ(details.key_type, CKK_AES);
   EXPECT_EQ(details.key_bit_length, 256);
   EXPECT_EQ(details.key_gen_mechanism, CKM_AES_KEY_GEN);
@@ -115,6 +115,60 @@ extern "C" {
 //   field should not be freed between C_EncryptInit and C_Encrypt..
 #define CKM_CLOUDKMS_AES_GCM (CKM_GOOGLE_DEFINED | 0x01UL)
 
+// Envelope encryption using a Cloud KMS AES-GCM key:
+// - a random 256-bit data key is generated locally and wrapped once with the
+//   Cloud KMS key (using RawEncrypt)
+// - the data is encrypted locally in segments of 64 KiB, each sealed with
+//   AES-256-GCM, so there is no limit on the data length
+// - the mechanism parameter, which is optional, is the additional
+//   authenticated data (AAD) as a CK_BYTE array; it is bound to both the
+//   wrapped data key and every segment
+// The ciphertext is self-describing, and is laid out as:
+//   "KMSE" | version (1 byte, 0x01) | wrapped key length N (2 bytes,
+//   big-endian) | wrapped key (N bytes) | wrapping IV (12 bytes) |
+//   salt (16 bytes) | segment 0 | segment 1 | ... | last segment
+// Each segment is up to 64 KiB of encrypted data followed by its tag (16
+// bytes); every segment but the last holds exactly 64 KiB. Segments are
+// encrypted under HMAC-SHA256(data key, salt), with a nonce of 7 zero bytes |
+// segment index (4 bytes, big-endian) | 0x01 for the last segment and 0x00
+// otherwise. Each tag authenticates the header, the AAD, and its segment.
+// C_EncryptUpdate and C_DecryptUpdate return each segment once they are
+// given the data that follows it, and C_DecryptUpdate only returns plaintext
+// that has been authenticated. C_EncryptFinal and C_DecryptFinal return the
+// last segment.
+#define CKM_CLOUDKMS_AES_GCM_ENVELOPE (CKM_GOOGLE_DEFINED | 0x02UL)
+
+// Signs many inputs with one key in a single C_Sign call:
+// - the mechanism parameter is a CK_CLOUDKMS_BULK_SIGN_PARAMS, which names the
+//   mechanism that signs each item: CKM_ECDSA, CKM_RSA_PKCS, or
+//   CKM_RSA_PKCS_PSS (with its own parameter)
+// - the data provided to C_Sign is ulCount items of ulItemLen bytes each,
+//   laid out back to back; each item is the input that the inner mechanism
+//   expects (for example, a digest for CKM_ECDSA)
+// - the signature is ulCount signatures of the inner mechanism's signature
+//   length, laid out back to back in the same order as the items
+// - the CK_RV for each item is written to pResults, which must hold ulCount
+//   values. The signature of an item that fails is zeroed.
+// Items are signed concurrently. C_Sign returns CKR_OK if every item was
+// signed, and otherwise the CK_RV of the first item that failed.
+// NOTE: the memory pointed to by pResults should not be freed between
+// C_SignInit and C_Sign.
+#define CKM_CLOUDKMS_BULK_SIGN (CKM_GOOGLE_DEFINED | 0x03UL)
+
+// The parameter for CKM_CLOUDKMS_BULK_SIGN. Fields are declared with the C
+// types that underlie the PKCS #11 types, so that this header does not depend
+// on the PKCS #11 headers.
+typedef struct CK_CLOUDKMS_BULK_SIGN_PARAMS {
+  // The mechanism used to sign each item, as a CK_MECHANISM*.
+  const void* pMechanism;
+  // The length of each item, as a CK_ULONG.
+  unsigned long ulItemLen;
+  // The number of items, as a CK_ULONG.
+  unsigned long ulCount;
+  // An array of ulCount CK_RV values, which receives the result for each item.
+  unsigned long* pResults;
+} CK_CLOUDKMS_BULK_SIGN_PARAMS;
+
 #ifdef __cplusplus
 }
 #endif
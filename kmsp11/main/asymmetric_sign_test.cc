@@ -33,6 +33,7 @@ namespace {
 
 using ::testing::AllOf;
 using ::testing::AnyOf;
+using ::testing::Each;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::Ge;
@@ -113,6 +114,60 @@ TEST_P(AsymmetricSignTest, SignVerifySuccess) {
               StatusRvIs(CKR_OPERATION_NOT_INITIALIZED));
 }
 
+TEST_P(AsymmetricSignTest, BulkSignVerifySuccess) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
+                       fakekms::Server::New());
+  kms_v1::CryptoKeyVersion ckv;
+  ASSERT_OK_AND_ASSIGN(
+      std::string config_file,
+      InitializeBridgeForOneKmsKey(fake_server.get(),
+                                   kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+                                   GetParam().algorithm, &ckv));
+  absl::Cleanup config_close = [config_file] {
+    std::remove(config_file.c_str());
+    EXPECT_OK(Finalize(nullptr));
+  };
+
+  CK_SESSION_HANDLE session;
+  EXPECT_OK(OpenSession(0, CKF_SERIAL_SESSION, nullptr, nullptr, &session));
+
+  constexpr size_t kCount = 5;
+  std::vector<uint8_t> hashes(kCount * GetParam().digest_size);
+  RAND_bytes(hashes.data(), hashes.size());
+
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE private_key,
+                       GetPrivateKeyObjectHandle(session, ckv));
+
+  CK_MECHANISM inner{CKM_ECDSA, nullptr, 0};
+  std::vector<CK_RV> results(kCount, CKR_GENERAL_ERROR);
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{
+      &inner, static_cast<CK_ULONG>(GetParam().digest_size), kCount,
+      results.data()};
+  CK_MECHANISM mech{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+
+  EXPECT_OK(SignInit(session, &mech, private_key));
+
+  CK_ULONG signature_size;
+  EXPECT_OK(
+      Sign(session, hashes.data(), hashes.size(), nullptr, &signature_size));
+  EXPECT_EQ(signature_size, kCount * GetParam().signature_size);
+
+  std::vector<uint8_t> signatures(signature_size);
+  EXPECT_OK(Sign(session, hashes.data(), hashes.size(), signatures.data(),
+                 &signature_size));
+  EXPECT_THAT(results, Each(CKR_OK));
+
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE public_key,
+                       GetPublicKeyObjectHandle(session, ckv));
+  for (size_t i = 0; i < kCount; i++) {
+    EXPECT_OK(VerifyInit(session, &inner, public_key));
+    EXPECT_OK(Verify(session, &hashes[i * GetParam().digest_size],
+                     GetParam().digest_size,
+                     &signatures[i * GetParam().signature_size],
+                     GetParam().signature_size));
+  }
+}
+
 TEST_P(AsymmetricSignTest, SignVerifyMultiPartSuccess) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
                        fakekms::Server::New());
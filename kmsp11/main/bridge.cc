@@ -426,13 +426,15 @@ absl::Status FindObjectsFinal(CK_SESSION_HANDLE hSession) {
 // http://docs.oasis-open.org/pkcs11/pkcs11-base/v2.40/pkcs11-base-v2.40.html#_Toc235002361
 absl::Status DecryptInit(CK_SESSION_HANDLE hSession,
                          CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey) {
+  ASSIGN_OR_RETURN(Provider * provider, GetProvider());
   ASSIGN_OR_RETURN(std::shared_ptr<Session> session, GetSession(hSession));
   ASSIGN_OR_RETURN(std::shared_ptr<Object> key, session->token()->GetKey(hKey));
 
   if (!pMechanism) {
     return NullArgumentError("pMechanism", SOURCE_LOCATION);
   }
-  return session->DecryptInit(key, pMechanism);
+  return session->DecryptInit(
+      key, pMechanism, provider->library_config().streaming_multipart_aes());
 }
 
 // Complete a decrypt operation.
@@ -495,18 +497,46 @@ absl::Status DecryptUpdate(CK_SESSION_HANDLE hSession,
     return NullArgumentError("pulPartLen", SOURCE_LOCATION);
   }
 
-  absl::Status result = session->DecryptUpdate(
-      absl::MakeConstSpan(pEncryptedPart, ulEncryptedPartLen));
-
-  if (!result.ok()) {
+  absl::StatusOr<std::optional<size_t>> output_length =
+      session->DecryptUpdateOutputLength(ulEncryptedPartLen);
+  if (!output_length.ok()) {
     session->ReleaseOperation();
+    return output_length.status();
+  }
+
+  // Most mechanisms do not return partial decrypted plaintext, and for those
+  // the part is consumed regardless of the output buffer. Mechanisms that do
+  // stream plaintext follow the usual PKCS #11 length conventions: a null
+  // output buffer only queries the output length, and the part is not
+  // consumed, even when the part produces no output.
+  if (output_length->has_value()) {
+    size_t length = **output_length;
+    if (!pPart) {
+      *pulPartLen = length;
+      return absl::OkStatus();
+    }
+    if (*pulPartLen < length) {
+      absl::Status result = OutOfRangeError(
+          absl::StrFormat(
+              "plaintext of length %d cannot fit in buffer of length %d",
+              length, *pulPartLen),
+          SOURCE_LOCATION);
+      *pulPartLen = length;
+      return result;
+    }
   }
 
-  // The library does not return partial decrypted plaintext, so we set the
-  // partial output length to 0.
-  *pulPartLen = 0;
+  absl::StatusOr<absl::Span<const uint8_t>> plaintext = session->DecryptUpdate(
+      absl::MakeConstSpan(pEncryptedPart, ulEncryptedPartLen));
+  if (!plaintext.ok()) {
+    session->ReleaseOperation();
+    *pulPartLen = 0;
+    return plaintext.status();
+  }
 
-  return result;
+  std::copy(plaintext->begin(), plaintext->end(), pPart);
+  *pulPartLen = plaintext->size();
+  return absl::OkStatus();
 }
 
 // Complete a multi-part encrypt operation.
@@ -551,13 +581,15 @@ absl::Status DecryptFinal(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pLastPart,
 // http://docs.oasis-open.org/pkcs11/pkcs11-base/v2.40/pkcs11-base-v2.40.html#_Toc235002356
 absl::Status EncryptInit(CK_SESSION_HANDLE hSession,
                          CK_MECHANISM_PTR pMechanism, CK_OBJECT_HANDLE hKey) {
+  ASSIGN_OR_RETURN(Provider * provider, GetProvider());
   ASSIGN_OR_RETURN(std::shared_ptr<Session> session, GetSession(hSession));
   ASSIGN_OR_RETURN(std::shared_ptr<Object> key, session->token()->GetKey(hKey));
 
   if (!pMechanism) {
     return NullArgumentError("pMechanism", SOURCE_LOCATION);
   }
-  return session->EncryptInit(key, pMechanism);
+  return session->EncryptInit(
+      key, pMechanism, provider->library_config().streaming_multipart_aes());
 }
 
 // Complete an encrypt operation.
@@ -619,18 +651,46 @@ absl::Status EncryptUpdate(CK_SESSION_HANDLE hSession, CK_BYTE_PTR pPart,
     return NullArgumentError("pulEncryptedPartLen", SOURCE_LOCATION);
   }
 
-  absl::Status result =
-      session->EncryptUpdate(absl::MakeConstSpan(pPart, ulPartLen));
-
-  if (!result.ok()) {
+  absl::StatusOr<std::optional<size_t>> output_length =
+      session->EncryptUpdateOutputLength(ulPartLen);
+  if (!output_length.ok()) {
     session->ReleaseOperation();
+    return output_length.status();
+  }
+
+  // Most mechanisms do not return partial encrypted ciphertext, and for those
+  // the part is consumed regardless of the output buffer. Mechanisms that do
+  // stream ciphertext follow the usual PKCS #11 length conventions: a null
+  // output buffer only queries the output length, and the part is not
+  // consumed, even when the part produces no output.
+  if (output_length->has_value()) {
+    size_t length = **output_length;
+    if (!pEncryptedPart) {
+      *pulEncryptedPartLen = length;
+      return absl::OkStatus();
+    }
+    if (*pulEncryptedPartLen < length) {
+      absl::Status result = OutOfRangeError(
+          absl::StrFormat(
+              "ciphertext of length %d cannot fit in buffer of length %d",
+              length, *pulEncryptedPartLen),
+          SOURCE_LOCATION);
+      *pulEncryptedPartLen = length;
+      return result;
+    }
   }
 
-  // The library does not return partial encrypted ciphertext, so we set the
-  // partial output length to 0.
-  *pulEncryptedPartLen = 0;
+  absl::StatusOr<absl::Span<const uint8_t>> ciphertext =
+      session->EncryptUpdate(absl::MakeConstSpan(pPart, ulPartLen));
+  if (!ciphertext.ok()) {
+    session->ReleaseOperation();
+    *pulEncryptedPartLen = 0;
+    return ciphertext.status();
+  }
 
-  return result;
+  std::copy(ciphertext->begin(), ciphertext->end(), pEncryptedPart);
+  *pulEncryptedPartLen = ciphertext->size();
+  return absl::OkStatus();
 }
 
 // Complete a multi-part encrypt operation.
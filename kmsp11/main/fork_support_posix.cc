@@ -19,6 +19,7 @@
 #include "kmsp11/main/fork_support.h"
 #include "kmsp11/util/global_provider.h"
 #include "kmsp11/util/logging.h"
+#include "kmsp11/util/rcu.h"
 
 namespace cloud_kms::kmsp11 {
 
@@ -39,6 +40,7 @@ absl::Status RegisterForkHandlers() {
   // Now we can register our own fork handler.
   int result =
       pthread_atfork(/*prepare=*/nullptr, /*parent=*/nullptr, /*child=*/[] {
+        RcuResetAfterFork();
         ReleaseGlobalProvider().IgnoreError();
         ShutdownLogging();
       });
@@ -77,9 +77,14 @@ INSTANTIATE_TEST_SUITE_P(TestSymmetricEncryption, SymmetricGcmCryptTest,
 absl::StatusOr<std::string> InitializeAsymmetricCryptTest(
     fakekms::Server* fake_server,
     kms_v1::CryptoKeyVersion::CryptoKeyVersionAlgorithm algorithm,
-    kms_v1::CryptoKeyVersion* ckv, CK_SESSION_HANDLE* session) {
+    kms_v1::CryptoKeyVersion* ckv, CK_SESSION_HANDLE* session,
+    bool streaming_multipart_aes = false) {
   kms_v1::KeyRing kr;
   std::string config_file = CreateConfigFileWithOneKeyring(fake_server, &kr);
+  if (streaming_multipart_aes) {
+    std::ofstream(config_file, std::ios::app)
+        << "streaming_multipart_aes: true\n";
+  }
 
   auto init_args = InitArgs(config_file.c_str());
 
@@ -279,6 +284,68 @@ TEST_P(SymmetricCbcCryptTest, EncryptDecryptMultiPartSuccess) {
   EXPECT_EQ(recovered_plaintext_size, plaintext.size());
 }
 
+TEST_P(SymmetricCbcCryptTest, StreamingDecryptUpdateLengthQueryKeepsPart) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
+                       fakekms::Server::New());
+  kms_v1::CryptoKeyVersion ckv;
+  CK_SESSION_HANDLE session;
+  ASSERT_OK_AND_ASSIGN(std::string config_file,
+                       InitializeAsymmetricCryptTest(
+                           fake_server.get(), GetParam(), &ckv, &session,
+                           /*streaming_multipart_aes=*/true));
+  absl::Cleanup c = [config_file] {
+    std::remove(config_file.c_str());
+    EXPECT_OK(Finalize(nullptr));
+  };
+
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE secret_key,
+                       GetSecretKeyObjectHandle(session, ckv));
+
+  std::vector<uint8_t> iv(16);
+  RAND_bytes(iv.data(), iv.size());
+
+  CK_MECHANISM mech = {
+      CKM_AES_CBC_PAD,  // mechanism
+      iv.data(),        // pParameter
+      iv.size(),        // ulParameterLen
+  };
+
+  std::vector<uint8_t> plaintext(20);
+  RAND_bytes(plaintext.data(), plaintext.size());
+  std::vector<uint8_t> ciphertext =
+      EncryptPlaintext(session, mech, secret_key, plaintext, 32);
+
+  EXPECT_OK(DecryptInit(session, &mech, secret_key));
+  std::vector<uint8_t> recovered_plaintext(ciphertext.size());
+
+  // The first block may be the padding block, so it is held back and the
+  // length query reports no output. The query must not consume the block.
+  CK_ULONG part_size;
+  EXPECT_OK(DecryptUpdate(session, ciphertext.data(), 16, nullptr, &part_size));
+  EXPECT_EQ(part_size, 0);
+  part_size = recovered_plaintext.size();
+  EXPECT_OK(DecryptUpdate(session, ciphertext.data(), 16,
+                          recovered_plaintext.data(), &part_size));
+  EXPECT_EQ(part_size, 0);
+
+  EXPECT_OK(DecryptUpdate(session, ciphertext.data() + 16, 16, nullptr,
+                          &part_size));
+  EXPECT_EQ(part_size, 16);
+  EXPECT_OK(DecryptUpdate(session, ciphertext.data() + 16, 16,
+                          recovered_plaintext.data(), &part_size));
+  EXPECT_EQ(part_size, 16);
+
+  CK_ULONG final_size;
+  EXPECT_OK(DecryptFinal(session, nullptr, &final_size));
+  EXPECT_EQ(final_size, 4);
+  EXPECT_OK(
+      DecryptFinal(session, recovered_plaintext.data() + 16, &final_size));
+  EXPECT_EQ(final_size, 4);
+
+  recovered_plaintext.resize(16 + final_size);
+  EXPECT_EQ(recovered_plaintext, plaintext);
+}
+
 TEST_P(SymmetricCtrCryptTest, EncryptDecryptSuccess) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
                        fakekms::Server::New());
@@ -367,6 +434,124 @@ TEST_P(SymmetricCtrCryptTest, EncryptDecryptMultiPartSuccess) {
   EXPECT_EQ(recovered_plaintext_size, plaintext.size());
 }
 
+TEST_P(SymmetricCtrCryptTest, EncryptUpdateNullBufferConsumesPart) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
+                       fakekms::Server::New());
+  kms_v1::CryptoKeyVersion ckv;
+  CK_SESSION_HANDLE session;
+  ASSERT_OK_AND_ASSIGN(std::string config_file,
+                       InitializeAsymmetricCryptTest(
+                           fake_server.get(), GetParam(), &ckv, &session));
+  absl::Cleanup c = [config_file] {
+    std::remove(config_file.c_str());
+    EXPECT_OK(Finalize(nullptr));
+  };
+
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE secret_key,
+                       GetSecretKeyObjectHandle(session, ckv));
+
+  std::vector<uint8_t> iv(16);
+  RAND_bytes(iv.data(), iv.size());
+
+  CK_AES_CTR_PARAMS params;
+  params.ulCounterBits = 128;
+  memcpy(params.cb, iv.data(), sizeof(params.cb));
+
+  CK_MECHANISM mech = {
+      CKM_AES_CTR,     // mechanism
+      &params,         // pParameter
+      sizeof(params),  // ulParameterLen
+  };
+
+  std::vector<uint8_t> plaintext(40);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  // Without streaming, parts are buffered until EncryptFinal, and each part
+  // is consumed whether or not an output buffer is provided.
+  EXPECT_OK(EncryptInit(session, &mech, secret_key));
+  CK_ULONG part_size = 1;
+  EXPECT_OK(EncryptUpdate(session, plaintext.data(), 10, nullptr, &part_size));
+  EXPECT_EQ(part_size, 0);
+  EXPECT_OK(
+      EncryptUpdate(session, plaintext.data() + 10, 30, nullptr, &part_size));
+  EXPECT_EQ(part_size, 0);
+
+  std::vector<uint8_t> ciphertext(plaintext.size());
+  CK_ULONG ciphertext_size = ciphertext.size();
+  EXPECT_OK(EncryptFinal(session, ciphertext.data(), &ciphertext_size));
+  EXPECT_EQ(ciphertext_size, plaintext.size());
+
+  CK_ULONG recovered_plaintext_size = plaintext.size();
+  std::vector<uint8_t> recovered_plaintext = DecryptCiphertext(
+      session, mech, secret_key, ciphertext, &recovered_plaintext_size);
+  EXPECT_EQ(recovered_plaintext, plaintext);
+}
+
+TEST_P(SymmetricCtrCryptTest, StreamingEncryptUpdateLengthQueryKeepsPart) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
+                       fakekms::Server::New());
+  kms_v1::CryptoKeyVersion ckv;
+  CK_SESSION_HANDLE session;
+  ASSERT_OK_AND_ASSIGN(std::string config_file,
+                       InitializeAsymmetricCryptTest(
+                           fake_server.get(), GetParam(), &ckv, &session,
+                           /*streaming_multipart_aes=*/true));
+  absl::Cleanup c = [config_file] {
+    std::remove(config_file.c_str());
+    EXPECT_OK(Finalize(nullptr));
+  };
+
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE secret_key,
+                       GetSecretKeyObjectHandle(session, ckv));
+
+  std::vector<uint8_t> iv(16);
+  RAND_bytes(iv.data(), iv.size());
+
+  CK_AES_CTR_PARAMS params;
+  params.ulCounterBits = 128;
+  memcpy(params.cb, iv.data(), sizeof(params.cb));
+
+  CK_MECHANISM mech = {
+      CKM_AES_CTR,     // mechanism
+      &params,         // pParameter
+      sizeof(params),  // ulParameterLen
+  };
+
+  std::vector<uint8_t> plaintext(40);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  EXPECT_OK(EncryptInit(session, &mech, secret_key));
+  std::vector<uint8_t> ciphertext(plaintext.size());
+
+  // A part shorter than a block produces no output yet, so the length query
+  // reports 0. The query must not consume the part.
+  CK_ULONG part_size;
+  EXPECT_OK(EncryptUpdate(session, plaintext.data(), 10, nullptr, &part_size));
+  EXPECT_EQ(part_size, 0);
+  part_size = ciphertext.size();
+  EXPECT_OK(EncryptUpdate(session, plaintext.data(), 10, ciphertext.data(),
+                          &part_size));
+  EXPECT_EQ(part_size, 0);
+
+  EXPECT_OK(
+      EncryptUpdate(session, plaintext.data() + 10, 30, nullptr, &part_size));
+  EXPECT_EQ(part_size, 32);
+  EXPECT_OK(EncryptUpdate(session, plaintext.data() + 10, 30,
+                          ciphertext.data(), &part_size));
+  EXPECT_EQ(part_size, 32);
+
+  CK_ULONG final_size;
+  EXPECT_OK(EncryptFinal(session, nullptr, &final_size));
+  EXPECT_EQ(final_size, 8);
+  EXPECT_OK(EncryptFinal(session, ciphertext.data() + 32, &final_size));
+  EXPECT_EQ(final_size, 8);
+
+  CK_ULONG recovered_plaintext_size = plaintext.size();
+  std::vector<uint8_t> recovered_plaintext = DecryptCiphertext(
+      session, mech, secret_key, ciphertext, &recovered_plaintext_size);
+  EXPECT_EQ(recovered_plaintext, plaintext);
+}
+
 TEST_P(SymmetricGcmCryptTest, EncryptDecryptSuccess) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
                        fakekms::Server::New());
@@ -462,6 +647,96 @@ TEST_P(SymmetricGcmCryptTest, EncryptDecryptMultiPartSuccess) {
   EXPECT_EQ(recovered_plaintext_size, plaintext.size());
 }
 
+TEST_P(SymmetricGcmCryptTest, EnvelopeEncryptDecryptMultiPartSuccess) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
+                       fakekms::Server::New());
+  kms_v1::CryptoKeyVersion ckv;
+  CK_SESSION_HANDLE session;
+  ASSERT_OK_AND_ASSIGN(std::string config_file,
+                       InitializeAsymmetricCryptTest(
+                           fake_server.get(), GetParam(), &ckv, &session));
+  absl::Cleanup c = [config_file] {
+    std::remove(config_file.c_str());
+    EXPECT_OK(Finalize(nullptr));
+  };
+
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE secret_key,
+                       GetSecretKeyObjectHandle(session, ckv));
+
+  std::vector<uint8_t> aad = {0xDE, 0xAD, 0xBE, 0xEF};
+  CK_MECHANISM mech = {
+      CKM_CLOUDKMS_AES_GCM_ENVELOPE,               // mechanism
+      aad.data(),                                  // pParameter
+      static_cast<unsigned long int>(aad.size()),  // ulParameterLen
+  };
+
+  // Larger than the 64 KiB limit that applies to CKM_CLOUDKMS_AES_GCM.
+  std::vector<uint8_t> part1(100 * 1024);
+  std::vector<uint8_t> part2(100 * 1024);
+  RAND_bytes(part1.data(), part1.size());
+  RAND_bytes(part2.data(), part2.size());
+  std::vector<uint8_t> plaintext(part1);
+  plaintext.insert(plaintext.end(), part2.begin(), part2.end());
+
+  EXPECT_OK(EncryptInit(session, &mech, secret_key));
+  std::vector<uint8_t> ciphertext;
+  for (std::vector<uint8_t>* part : {&part1, &part2}) {
+    // Complete 64 KiB segments are returned as soon as they are known not to
+    // be the last segment.
+    CK_ULONG part_ciphertext_size;
+    EXPECT_OK(EncryptUpdate(session, part->data(), part->size(), nullptr,
+                            &part_ciphertext_size));
+
+    std::vector<uint8_t> part_ciphertext(part_ciphertext_size);
+    EXPECT_OK(EncryptUpdate(session, part->data(), part->size(),
+                            part_ciphertext.data(), &part_ciphertext_size));
+    EXPECT_EQ(part_ciphertext_size, part_ciphertext.size());
+    ciphertext.insert(ciphertext.end(), part_ciphertext.begin(),
+                      part_ciphertext.end());
+  }
+  CK_ULONG last_part_size;
+  EXPECT_OK(EncryptFinal(session, nullptr, &last_part_size));
+  std::vector<uint8_t> last_part(last_part_size);
+  EXPECT_OK(EncryptFinal(session, last_part.data(), &last_part_size));
+  EXPECT_EQ(last_part_size, last_part.size());
+  ciphertext.insert(ciphertext.end(), last_part.begin(), last_part.end());
+  // The header, and a 16-byte tag for each of the 4 segments.
+  EXPECT_EQ(ciphertext.size(), 83 + plaintext.size() + 4 * 16);
+
+  CK_ULONG recovered_plaintext_size = plaintext.size();
+  std::vector<uint8_t> recovered_plaintext = DecryptCiphertext(
+      session, mech, secret_key, ciphertext, &recovered_plaintext_size);
+  EXPECT_EQ(recovered_plaintext, plaintext);
+  EXPECT_EQ(recovered_plaintext_size, plaintext.size());
+
+  // Decrypted segments are returned as soon as they are authenticated.
+  EXPECT_OK(DecryptInit(session, &mech, secret_key));
+  recovered_plaintext.clear();
+  size_t half = ciphertext.size() / 2;
+  for (absl::Span<uint8_t> part :
+       {absl::MakeSpan(ciphertext).subspan(0, half),
+        absl::MakeSpan(ciphertext).subspan(half)}) {
+    CK_ULONG part_plaintext_size;
+    EXPECT_OK(DecryptUpdate(session, part.data(), part.size(), nullptr,
+                            &part_plaintext_size));
+    EXPECT_GT(part_plaintext_size, 0);
+
+    std::vector<uint8_t> part_plaintext(part_plaintext_size);
+    EXPECT_OK(DecryptUpdate(session, part.data(), part.size(),
+                            part_plaintext.data(), &part_plaintext_size));
+    EXPECT_EQ(part_plaintext_size, part_plaintext.size());
+    recovered_plaintext.insert(recovered_plaintext.end(),
+                               part_plaintext.begin(), part_plaintext.end());
+  }
+  EXPECT_OK(DecryptFinal(session, nullptr, &last_part_size));
+  last_part.resize(last_part_size);
+  EXPECT_OK(DecryptFinal(session, last_part.data(), &last_part_size));
+  EXPECT_EQ(last_part_size, last_part.size());
+  recovered_plaintext.insert(recovered_plaintext.end(), last_part.begin(),
+                             last_part.end());
+  EXPECT_EQ(recovered_plaintext, plaintext);
+}
+
 TEST_P(SymmetricGcmCryptTest, DecryptBufferTooSmall) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<fakekms::Server> fake_server,
                        fakekms::Server::New());
@@ -208,6 +208,14 @@ AllMechanisms() {
                   CKF_DECRYPT | CKF_ENCRYPT  // flags
               },
           },
+          {
+              CKM_CLOUDKMS_AES_GCM_ENVELOPE,
+              {
+                  16,                        // ulMinKeySize
+                  32,                        // ulMaxKeySize
+                  CKF_DECRYPT | CKF_ENCRYPT  // flags
+              },
+          },
           {
               CKM_AES_CTR,
               {
@@ -232,6 +240,16 @@ AllMechanisms() {
                   CKF_DECRYPT | CKF_ENCRYPT  // flags
               },
           },
+          // Key sizes span the inner mechanisms: CKM_ECDSA, CKM_RSA_PKCS and
+          // CKM_RSA_PKCS_PSS.
+          {
+              CKM_CLOUDKMS_BULK_SIGN,
+              {
+                  256,      // ulMinKeySize
+                  4096,     // ulMaxKeySize
+                  CKF_SIGN  // flags
+              },
+          },
       };
 
   return kMechanisms;
@@ -251,7 +269,8 @@ const absl::flat_hash_set<CK_MECHANISM_TYPE>& AllRawEncryptionMechanisms() {
   // These mechanisms are only supported if the
   // experimental_allow_raw_encryption_keys config flag is set.
   static const absl::flat_hash_set<CK_MECHANISM_TYPE> kRawEncryptionMechanisms =
-      {CKM_CLOUDKMS_AES_GCM, CKM_AES_CTR, CKM_AES_CBC, CKM_AES_CBC_PAD};
+      {CKM_CLOUDKMS_AES_GCM, CKM_CLOUDKMS_AES_GCM_ENVELOPE, CKM_AES_CTR,
+       CKM_AES_CBC, CKM_AES_CBC_PAD};
   return kRawEncryptionMechanisms;
 }
 
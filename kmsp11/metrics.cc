@@ -0,0 +1,190 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/metrics.h"
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "glog/logging.h"
+#include "kmsp11/util/crypto_utils.h"
+#include "kmsp11/util/errors.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+constexpr std::string_view kUnixSocketPrefix = "unix:";
+
+std::string FunctionRvLabel(int64_t rv) {
+  return absl::StrFormat("%#x", rv);
+}
+
+const MetricsRegistry::Family kFunctionLatency = {
+    "kmsp11_function_latency_seconds",
+    "Latency of Cryptoki function calls, by function and return value.",
+    "function", "rv", &FunctionRvLabel};
+
+absl::Status WriteMetricsFile(const std::string& path,
+                              std::string_view contents) {
+  // Write to a uniquely named temporary file and rename it into place, so that
+  // a scraper never observes a partially written file.
+  std::string temp_path =
+      absl::StrCat(path, ".", absl::BytesToHexString(RandBytes(8)), ".tmp");
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    out << contents;
+    out.close();
+    if (!out) {
+      std::error_code ignored;
+      std::filesystem::remove(temp_path, ignored);
+      return NewInternalError(
+          absl::StrCat("error writing metrics file ", temp_path),
+          SOURCE_LOCATION);
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    std::error_code ignored;
+    std::filesystem::remove(temp_path, ignored);
+    return NewInternalError(absl::StrCat("error moving metrics file into ",
+                                         path, ": ", ec.message()),
+                            SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status WriteMetricsSocket(const std::string& path,
+                                std::string_view contents) {
+#ifdef _WIN32
+  return NewError(absl::StatusCode::kUnimplemented,
+                  "metrics output to a Unix socket is not supported on Windows",
+                  CKR_GENERAL_ERROR, SOURCE_LOCATION);
+#else
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) {
+    return NewInvalidArgumentError(
+        absl::StrCat("metrics socket path is too long: ", path),
+        CKR_GENERAL_ERROR, SOURCE_LOCATION);
+  }
+  std::memcpy(addr.sun_path, path.data(), path.size());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return NewInternalError(
+        absl::StrCat("error creating metrics socket: ", std::strerror(errno)),
+        SOURCE_LOCATION);
+  }
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) !=
+      0) {
+    int error = errno;
+    close(fd);
+    return NewInternalError(absl::StrCat("error connecting to metrics socket ",
+                                         path, ": ", std::strerror(error)),
+                            SOURCE_LOCATION);
+  }
+
+#ifdef MSG_NOSIGNAL
+  constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+  constexpr int kSendFlags = 0;
+#endif
+  while (!contents.empty()) {
+    ssize_t sent = send(fd, contents.data(), contents.size(), kSendFlags);
+    if (sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int error = errno;
+      close(fd);
+      return NewInternalError(absl::StrCat("error writing to metrics socket ",
+                                           path, ": ", std::strerror(error)),
+                              SOURCE_LOCATION);
+    }
+    contents.remove_prefix(sent);
+  }
+  close(fd);
+  return absl::OkStatus();
+#endif
+}
+
+}  // namespace
+
+absl::Time FunctionStartTime() {
+  if (!MetricsRegistry::Global().enabled()) {
+    return absl::InfinitePast();
+  }
+  return absl::Now();
+}
+
+void RecordFunctionLatency(const char* function_name, CK_RV rv,
+                           absl::Time start) {
+  if (start == absl::InfinitePast()) {
+    return;
+  }
+  MetricsRegistry::Global().RecordLatency(kFunctionLatency, function_name, rv,
+                                          absl::Now() - start);
+}
+
+absl::Status WriteMetrics(const MetricsRegistry& registry,
+                          const std::string& output_path) {
+  std::string contents = registry.ToOpenMetrics();
+  if (absl::StartsWith(output_path, kUnixSocketPrefix)) {
+    return WriteMetricsSocket(output_path.substr(kUnixSocketPrefix.size()),
+                              contents);
+  }
+  return WriteMetricsFile(output_path, contents);
+}
+
+MetricsExporter::MetricsExporter(MetricsRegistry* registry,
+                                 std::string output_path,
+                                 absl::Duration interval)
+    : registry_(registry), output_path_(std::move(output_path)) {
+  registry_->set_enabled(true);
+  thread_ = std::thread([this, interval] {
+    auto write = [this] {
+      absl::Status result = WriteMetrics(*registry_, output_path_);
+      if (!result.ok()) {
+        LOG(WARNING) << "error writing metrics: " << result;
+      }
+    };
+    while (!shutdown_.WaitForNotificationWithTimeout(interval)) {
+      write();
+    }
+    write();
+  });
+}
+
+MetricsExporter::~MetricsExporter() {
+  registry_->set_enabled(false);
+  shutdown_.Notify();
+  thread_.join();
+}
+
+}  // namespace cloud_kms::kmsp11
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KMSP11_METRICS_H_
+#define KMSP11_METRICS_H_
+
+#include <string>
+#include <thread>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "common/metrics.h"
+#include "kmsp11/cryptoki.h"
+
+namespace cloud_kms::kmsp11 {
+
+// Returns the time at which a Cryptoki function was entered, or
+// absl::InfinitePast() if metrics are not enabled in the global registry.
+absl::Time FunctionStartTime();
+
+// Records the latency of a Cryptoki function that was entered at `start` and
+// returned `rv`. This is a no-op if `start` is absl::InfinitePast().
+void RecordFunctionLatency(const char* function_name, CK_RV rv,
+                           absl::Time start);
+
+// Writes `registry` in the OpenMetrics text format to `output_path`. A path of
+// the form "unix:<socket path>" sends the metrics to a Unix domain stream
+// socket; any other path names a file, which is replaced atomically.
+absl::Status WriteMetrics(const MetricsRegistry& registry,
+                          const std::string& output_path);
+
+// MetricsExporter enables recording in a registry, and writes its contents to
+// an output path at a fixed interval until it is destroyed. A final snapshot
+// is written on destruction.
+class MetricsExporter {
+ public:
+  MetricsExporter(MetricsRegistry* registry, std::string output_path,
+                  absl::Duration interval);
+  ~MetricsExporter();
+
+ private:
+  MetricsRegistry* registry_;
+  const std::string output_path_;
+  absl::Notification shutdown_;
+  std::thread thread_;
+};
+
+}  // namespace cloud_kms::kmsp11
+
+#endif  // KMSP11_METRICS_H_
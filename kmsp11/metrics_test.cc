@@ -0,0 +1,127 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/metrics.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "common/test/test_status_macros.h"
+#include "gmock/gmock.h"
+#include "kmsp11/test/matchers.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+
+std::string TempPath(std::string_view name) {
+  return (std::filesystem::path(testing::TempDir()) / name).string();
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+TEST(MetricsTest, FunctionLatencyIsNotRecordedWhenDisabled) {
+  MetricsRegistry::Global().set_enabled(false);
+  EXPECT_EQ(FunctionStartTime(), absl::InfinitePast());
+}
+
+TEST(MetricsTest, WriteMetricsReplacesFile) {
+  std::string path = TempPath("metrics_replace.txt");
+  std::ofstream(path) << "stale contents";
+
+  MetricsRegistry registry;
+  EXPECT_OK(WriteMetrics(registry, path));
+  EXPECT_EQ(ReadFile(path), "# EOF\n");
+}
+
+TEST(MetricsTest, WriteMetricsFailsForMissingDirectory) {
+  MetricsRegistry registry;
+  EXPECT_THAT(WriteMetrics(registry, TempPath("missing/metrics.txt")),
+              StatusRvIs(CKR_GENERAL_ERROR));
+}
+
+TEST(MetricsTest, ExporterRecordsFunctionLatency) {
+  std::string path = TempPath("metrics_exporter.txt");
+  {
+    MetricsExporter exporter(&MetricsRegistry::Global(), path, absl::Hours(1));
+    absl::Time start = FunctionStartTime();
+    ASSERT_NE(start, absl::InfinitePast());
+    RecordFunctionLatency("C_Sign", CKR_KEY_HANDLE_INVALID, start);
+  }
+
+  // The final snapshot is written when the exporter is destroyed.
+  std::string contents = ReadFile(path);
+  EXPECT_THAT(contents,
+              HasSubstr("kmsp11_function_latency_seconds_count{"
+                        "function=\"C_Sign\",rv=\"0x60\"} 1\n"));
+  EXPECT_THAT(contents, EndsWith("# EOF\n"));
+  EXPECT_FALSE(MetricsRegistry::Global().enabled());
+}
+
+#ifndef _WIN32
+TEST(MetricsTest, WriteMetricsSendsToUnixSocket) {
+  std::string socket_path = TempPath("metrics.sock");
+  std::filesystem::remove(socket_path);
+
+  int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(listener, 0);
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  ASSERT_LT(socket_path.size(), sizeof(addr.sun_path));
+  socket_path.copy(addr.sun_path, socket_path.size());
+  ASSERT_EQ(
+      bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)),
+      0);
+  ASSERT_EQ(listen(listener, 1), 0);
+
+  MetricsRegistry registry;
+  EXPECT_OK(WriteMetrics(registry, "unix:" + socket_path));
+
+  int conn = accept(listener, nullptr, nullptr);
+  ASSERT_GE(conn, 0);
+  std::string received;
+  char buf[256];
+  ssize_t n;
+  while ((n = read(conn, buf, sizeof(buf))) > 0) {
+    received.append(buf, n);
+  }
+  close(conn);
+  close(listener);
+
+  EXPECT_EQ(received, "# EOF\n");
+}
+
+TEST(MetricsTest, WriteMetricsFailsWithoutSocketListener) {
+  MetricsRegistry registry;
+  EXPECT_THAT(WriteMetrics(registry, "unix:" + TempPath("no_listener.sock")),
+              StatusRvIs(CKR_GENERAL_ERROR));
+}
+#endif
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
@@ -254,7 +254,7 @@ absl::Status AddX509CertificateAttributes(AttributeMap* attrs,
 }  // namespace
 
 absl::StatusOr<KeyPair> Object::NewKeyPair(const kms_v1::CryptoKeyVersion& ckv,
-                                           BSSL_CONST EVP_PKEY* public_key) {
+                                           EVP_PKEY* public_key) {
   ASSIGN_OR_RETURN(std::string pub_der, MarshalX509PublicKeyDer(public_key));
 
   AttributeMap pub_attrs;
@@ -290,8 +290,11 @@ absl::StatusOr<KeyPair> Object::NewKeyPair(const kms_v1::CryptoKeyVersion& ckv,
   }
 
   ASSIGN_OR_RETURN(AlgorithmDetails algorithm, GetDetails(ckv.algorithm()));
-  return KeyPair{Object(ckv.name(), CKO_PUBLIC_KEY, algorithm, pub_attrs),
-                 Object(ckv.name(), CKO_PRIVATE_KEY, algorithm, prv_attrs)};
+  EVP_PKEY_up_ref(public_key);
+  std::shared_ptr<EVP_PKEY> shared_key(public_key, &EVP_PKEY_free);
+  return KeyPair{
+      Object(ckv.name(), CKO_PUBLIC_KEY, algorithm, pub_attrs, shared_key),
+      Object(ckv.name(), CKO_PRIVATE_KEY, algorithm, prv_attrs, shared_key)};
 }
 
 absl::StatusOr<Object> Object::NewSecretKey(
@@ -318,4 +321,14 @@ absl::StatusOr<Object> Object::NewCertificate(
   return Object(ckv.name(), CKO_CERTIFICATE, algorithm, cert_attrs);
 }
 
+absl::StatusOr<bssl::UniquePtr<EVP_PKEY>> Object::GetPublicKey() const {
+  if (!public_key_) {
+    return NewInternalError(
+        absl::StrFormat("object for %s has no public key", kms_key_name_),
+        SOURCE_LOCATION);
+  }
+  EVP_PKEY_up_ref(public_key_.get());
+  return bssl::UniquePtr<EVP_PKEY>(public_key_.get());
+}
+
 }  // namespace cloud_kms::kmsp11
@@ -17,10 +17,12 @@
 #ifndef KMSP11_OBJECT_H_
 #define KMSP11_OBJECT_H_
 
+#include <memory>
 #include <string_view>
 
 #include "absl/status/statusor.h"
 #include "common/kms_v1.h"
+#include "common/openssl.h"
 #include "google/cloud/kms/v1/resources.pb.h"
 #include "kmsp11/algorithm_details.h"
 #include "kmsp11/attribute_map.h"
@@ -36,8 +38,11 @@ struct KeyPair;
 // See go/kms-pkcs11-model
 class Object {
  public:
+  // Creates the public and private key objects for an asymmetric key. Both
+  // objects retain a reference to `public_key`, which must not be modified
+  // afterwards.
   static absl::StatusOr<KeyPair> NewKeyPair(const kms_v1::CryptoKeyVersion& ckv,
-                                            BSSL_CONST EVP_PKEY* public_key);
+                                            EVP_PKEY* public_key);
   static absl::StatusOr<Object> NewSecretKey(
       const kms_v1::CryptoKeyVersion& ckv);
 
@@ -49,18 +54,26 @@ class Object {
   const AlgorithmDetails& algorithm() const { return algorithm_; }
   const AttributeMap& attributes() const { return attributes_; }
 
+  // Returns a new reference to the public key of a key pair object. The key is
+  // parsed once when the object is created, and shared by all operations that
+  // use it.
+  absl::StatusOr<bssl::UniquePtr<EVP_PKEY>> GetPublicKey() const;
+
  private:
   Object(std::string kms_key_name, CK_OBJECT_CLASS object_class,
-         AlgorithmDetails algorithm, AttributeMap attributes)
+         AlgorithmDetails algorithm, AttributeMap attributes,
+         std::shared_ptr<EVP_PKEY> public_key = nullptr)
       : kms_key_name_(kms_key_name),
         object_class_(object_class),
         algorithm_(algorithm),
-        attributes_(attributes) {}
+        attributes_(attributes),
+        public_key_(std::move(public_key)) {}
 
   const std::string kms_key_name_;
   const CK_OBJECT_CLASS object_class_;
   const AlgorithmDetails algorithm_;
   const AttributeMap attributes_;
+  const std::shared_ptr<EVP_PKEY> public_key_;
 };
 
 struct KeyPair {
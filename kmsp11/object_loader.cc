@@ -14,6 +14,11 @@
 
 #include "kmsp11/object_loader.h"
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <thread>
+
 #include "common/status_macros.h"
 #include "glog/logging.h"
 #include "kmsp11/algorithm_details.h"
@@ -27,9 +32,82 @@ std::string EnumNameOrValue(std::string name, int value) {
   return name.empty() ? std::to_string(value) : name;
 }
 
+// LoadExecutor runs loading tasks on a bounded number of worker threads. Tasks
+// are started in the order in which they are submitted. Once a task reports
+// failure, tasks that have not yet started are skipped. The destructor waits
+// for all started tasks to complete.
+//
+// With a concurrency of 1 or less, tasks are run inline in Submit.
+class LoadExecutor {
+ public:
+  explicit LoadExecutor(int max_concurrency) {
+    for (int i = 0; max_concurrency > 1 && i < max_concurrency; i++) {
+      workers_.emplace_back(&LoadExecutor::Work, this);
+    }
+  }
+
+  ~LoadExecutor() {
+    {
+      absl::MutexLock lock(&mutex_);
+      closed_ = true;
+    }
+    for (std::thread& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  // Submits a task, which returns false on failure.
+  void Submit(std::function<bool()> task) {
+    if (workers_.empty()) {
+      if (!failed() && !task()) {
+        failed_ = true;
+      }
+      return;
+    }
+    absl::MutexLock lock(&mutex_);
+    tasks_.push_back(std::move(task));
+  }
+
+  bool failed() const { return failed_; }
+
+ private:
+  void Work() {
+    while (true) {
+      std::function<bool()> task;
+      {
+        absl::MutexLock lock(&mutex_);
+        mutex_.Await(absl::Condition(this, &LoadExecutor::HasWorkOrClosed));
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+        // Checked while holding the mutex, so that a task is never skipped due
+        // to the failure of a task that was submitted after it.
+        if (failed_) {
+          continue;
+        }
+      }
+      if (!task()) {
+        failed_ = true;
+      }
+    }
+  }
+
+  bool HasWorkOrClosed() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return closed_ || !tasks_.empty();
+  }
+
+  std::atomic<bool> failed_ = false;
+  absl::Mutex mutex_;
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+  std::deque<std::function<bool()>> tasks_ ABSL_GUARDED_BY(mutex_);
+  std::vector<std::thread> workers_;
+};
+
 }  // namespace
 
-bool ObjectLoader::IsLoadable(const kms_v1::CryptoKey& key) {
+bool ObjectLoader::IsLoadable(const kms_v1::CryptoKey& key) const {
   switch (key.purpose()) {
     case kms_v1::CryptoKey::ASYMMETRIC_DECRYPT:
     case kms_v1::CryptoKey::ASYMMETRIC_SIGN:
@@ -70,7 +148,7 @@ bool ObjectLoader::IsLoadable(const kms_v1::CryptoKey& key) {
   return true;
 }
 
-bool ObjectLoader::IsLoadable(const kms_v1::CryptoKeyVersion& ckv) {
+bool ObjectLoader::IsLoadable(const kms_v1::CryptoKeyVersion& ckv) const {
   if (ckv.state() != kms_v1::CryptoKeyVersion::ENABLED) {
     LOG(INFO) << "INFO: version " << ckv.name()
               << " is not loadable due to unsupported state "
@@ -103,6 +181,15 @@ Key* ObjectLoader::Cache::Get(std::string_view ckv_name) {
   return it->second.get();
 }
 
+absl::flat_hash_set<std::string> ObjectLoader::Cache::VersionNames() const {
+  absl::flat_hash_set<std::string> names;
+  names.reserve(keys_.size());
+  for (const auto& [name, key] : keys_) {
+    names.insert(name);
+  }
+  return names;
+}
+
 Key* ObjectLoader::Cache::Store(const kms_v1::CryptoKeyVersion& ckv,
                                 std::string_view public_key_der,
                                 std::string_view certificate_der) {
@@ -132,6 +219,18 @@ Key* ObjectLoader::Cache::StoreSecretKey(const kms_v1::CryptoKeyVersion& ckv) {
   return key;
 }
 
+void ObjectLoader::Cache::Restore(const Key& key) {
+  keys_[key.crypto_key_version().name()] = std::make_unique<Key>(key);
+
+  for (CK_OBJECT_HANDLE handle :
+       {key.public_key_handle(), key.private_key_handle(),
+        key.certificate().handle(), key.secret_key_handle()}) {
+    if (handle != CK_INVALID_HANDLE) {
+      allocated_handles_.insert(handle);
+    }
+  }
+}
+
 void ObjectLoader::Cache::EvictUnused(const ObjectStoreState& state) {
   absl::flat_hash_set<std::string> items_to_retain;
   for (const Key& key : state.keys()) {
@@ -173,7 +272,7 @@ CK_OBJECT_HANDLE ObjectLoader::Cache::NewHandle() {
 absl::StatusOr<std::unique_ptr<ObjectLoader>> ObjectLoader::New(
     std::string_view key_ring_name,
     absl::Span<const std::string* const> pem_user_certs, bool generate_certs,
-    bool allow_software_keys) {
+    bool allow_software_keys, int max_concurrent_loads) {
   absl::flat_hash_map<std::string, std::string> user_certs;
   for (const std::string* const pem_cert : pem_user_certs) {
     ASSIGN_OR_RETURN(bssl::UniquePtr<X509> parsed_cert,
@@ -198,7 +297,62 @@ absl::StatusOr<std::unique_ptr<ObjectLoader>> ObjectLoader::New(
 
   return absl::WrapUnique(new ObjectLoader(key_ring_name, user_certs,
                                            std::move(cert_authority),
-                                           allow_software_keys));
+                                           allow_software_keys,
+                                           max_concurrent_loads));
+}
+
+void ObjectLoader::Prime(const ObjectStoreState& state) {
+  absl::MutexLock lock(&cache_mutex_);
+  for (const Key& key : state.keys()) {
+    cache_.Restore(key);
+  }
+}
+
+absl::StatusOr<std::vector<ObjectLoader::LoadedVersion>>
+ObjectLoader::LoadVersions(
+    const KmsClient& client, const kms_v1::CryptoKey& key,
+    const absl::flat_hash_set<std::string>& cached_versions) const {
+  std::vector<LoadedVersion> result;
+
+  kms_v1::ListCryptoKeyVersionsRequest req;
+  req.set_parent(key.name());
+  CryptoKeyVersionsRange v = client.ListCryptoKeyVersions(req);
+
+  for (CryptoKeyVersionsRange::iterator it = v.begin(); it != v.end(); it++) {
+    ASSIGN_OR_RETURN(kms_v1::CryptoKeyVersion ckv, *it);
+    if (!IsLoadable(ckv)) {
+      continue;
+    }
+
+    LoadedVersion& loaded = result.emplace_back();
+    loaded.cached = cached_versions.contains(ckv.name());
+    if (loaded.cached || key.purpose() == kms_v1::CryptoKey::MAC ||
+        key.purpose() == kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT) {
+      loaded.ckv = std::move(ckv);
+      continue;
+    }
+
+    kms_v1::GetPublicKeyRequest pub_req;
+    pub_req.set_name(ckv.name());
+
+    ASSIGN_OR_RETURN(kms_v1::PublicKey pub_resp, client.GetPublicKey(pub_req));
+    ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> pub,
+                     ParseX509PublicKeyPem(pub_resp.pem()));
+    ASSIGN_OR_RETURN(loaded.public_key_der, MarshalX509PublicKeyDer(pub.get()));
+
+    if (auto it = user_certs_.find(loaded.public_key_der);
+        it != user_certs_.end()) {
+      loaded.certificate_der = it->second;
+    } else if (cert_authority_) {
+      ASSIGN_OR_RETURN(bssl::UniquePtr<X509> cert,
+                       cert_authority_->GenerateCert(ckv, pub.get()));
+      ASSIGN_OR_RETURN(loaded.certificate_der,
+                       MarshalX509CertificateDer(cert.get()));
+    }
+    loaded.ckv = std::move(ckv);
+  }
+
+  return result;
 }
 
 absl::StatusOr<ObjectStoreState> ObjectLoader::BuildState(
@@ -208,59 +362,69 @@ absl::StatusOr<ObjectStoreState> ObjectLoader::BuildState(
   // duration of BuildState seems like a pretty cheap way to guard against an
   // unintentional change that causes BuildState calls to overlap.
   absl::MutexLock lock(&cache_mutex_);
-  ObjectStoreState result;
-
-  kms_v1::ListCryptoKeysRequest req;
-  req.set_parent(key_ring_name_);
-  CryptoKeysRange keys = client.ListCryptoKeys(req);
 
-  for (CryptoKeysRange::iterator it = keys.begin(); it != keys.end(); it++) {
-    ASSIGN_OR_RETURN(kms_v1::CryptoKey key, *it);
-    if (!IsLoadable(key)) {
-      continue;
-    }
-
-    kms_v1::ListCryptoKeyVersionsRequest req;
-    req.set_parent(key.name());
-    CryptoKeyVersionsRange v = client.ListCryptoKeyVersions(req);
+  // Versions are loaded on worker threads while the key listing is paged
+  // through, so the workers get a read-only view of the cache. The cache itself
+  // is only updated below, in key listing order, so that the result does not
+  // depend on the order in which loads complete.
+  const absl::flat_hash_set<std::string> cached_versions =
+      cache_.VersionNames();
+
+  struct KeyLoad {
+    kms_v1::CryptoKey key;
+    absl::StatusOr<std::vector<LoadedVersion>> versions =
+        absl::CancelledError("versions were not loaded");
+  };
+  // A deque, so that pointers to elements remain valid as it grows.
+  std::deque<KeyLoad> loads;
+
+  {
+    LoadExecutor executor(max_concurrent_loads_);
+
+    kms_v1::ListCryptoKeysRequest req;
+    req.set_parent(key_ring_name_);
+    CryptoKeysRange keys = client.ListCryptoKeys(req);
+
+    for (CryptoKeysRange::iterator it = keys.begin(); it != keys.end(); it++) {
+      if (executor.failed()) {
+        break;
+      }
 
-    for (CryptoKeyVersionsRange::iterator it = v.begin(); it != v.end(); it++) {
-      ASSIGN_OR_RETURN(kms_v1::CryptoKeyVersion ckv, *it);
-      if (!IsLoadable(ckv)) {
+      absl::StatusOr<kms_v1::CryptoKey> key = *it;
+      if (!key.ok()) {
+        loads.emplace_back().versions = key.status();
+        break;
+      }
+      if (!IsLoadable(*key)) {
         continue;
       }
 
-      Key* cached_key = cache_.Get(ckv.name());
-      if (cached_key) {
-        *result.add_keys() = *cached_key;
+      KeyLoad* load = &loads.emplace_back();
+      load->key = *std::move(key);
+      executor.Submit([this, &client, &cached_versions, load] {
+        load->versions = LoadVersions(client, load->key, cached_versions);
+        return load->versions.ok();
+      });
+    }
+  }  // Waits for all submitted loads to complete.
+
+  ObjectStoreState result;
+  for (KeyLoad& load : loads) {
+    ASSIGN_OR_RETURN(std::vector<LoadedVersion> versions,
+                     std::move(load.versions));
+
+    for (const LoadedVersion& loaded : versions) {
+      if (loaded.cached) {
+        *result.add_keys() = *cache_.Get(loaded.ckv.name());
         continue;
       }
 
-      if (key.purpose() == kms_v1::CryptoKey::MAC ||
-          key.purpose() == kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT) {
-        *result.add_keys() = *cache_.StoreSecretKey(ckv);
+      if (load.key.purpose() == kms_v1::CryptoKey::MAC ||
+          load.key.purpose() == kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT) {
+        *result.add_keys() = *cache_.StoreSecretKey(loaded.ckv);
       } else {
-        kms_v1::GetPublicKeyRequest pub_req;
-        pub_req.set_name(ckv.name());
-
-        ASSIGN_OR_RETURN(kms_v1::PublicKey pub_resp,
-                         client.GetPublicKey(pub_req));
-        ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> pub,
-                         ParseX509PublicKeyPem(pub_resp.pem()));
-        ASSIGN_OR_RETURN(std::string public_key_der,
-                         MarshalX509PublicKeyDer(pub.get()));
-
-        std::string cert_der;
-        if (auto it = user_certs_.find(public_key_der);
-            it != user_certs_.end()) {
-          cert_der = it->second;
-        } else if (cert_authority_) {
-          ASSIGN_OR_RETURN(bssl::UniquePtr<X509> cert,
-                           cert_authority_->GenerateCert(ckv, pub.get()));
-          ASSIGN_OR_RETURN(cert_der, MarshalX509CertificateDer(cert.get()));
-        }
-
-        *result.add_keys() = *cache_.Store(ckv, public_key_der, cert_der);
+        *result.add_keys() = *cache_.Store(loaded.ckv, loaded.public_key_der,
+                                           loaded.certificate_der);
       }
     }
   }
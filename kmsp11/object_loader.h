@@ -33,38 +33,69 @@ class ObjectLoader {
   static absl::StatusOr<std::unique_ptr<ObjectLoader>> New(
       std::string_view key_ring_name,
       absl::Span<const std::string* const> pem_user_certs, bool generate_certs,
-      bool allow_software_keys = false);
+      bool allow_software_keys = false,
+      int max_concurrent_loads = kDefaultMaxConcurrentLoads);
+
+  // The default number of keys whose versions and public keys are loaded
+  // concurrently by BuildState.
+  static constexpr int kDefaultMaxConcurrentLoads = 8;
 
   inline std::string_view key_ring_name() const { return key_ring_name_; }
 
   absl::StatusOr<ObjectStoreState> BuildState(const KmsClient& client);
 
+  // Populates the cache with the keys in `state`, which was produced by an
+  // earlier BuildState call (possibly in another process), so that subsequent
+  // calls to BuildState retain their handles and key material.
+  void Prime(const ObjectStoreState& state);
+
  private:
   ObjectLoader(std::string_view key_ring_name,
                absl::flat_hash_map<std::string, std::string> user_certs,
                std::unique_ptr<CertAuthority> cert_authority,
-               bool allow_software_keys)
+               bool allow_software_keys, int max_concurrent_loads)
       : key_ring_name_(key_ring_name),
         user_certs_(user_certs),
         cert_authority_(std::move(cert_authority)),
-        allow_software_keys_(allow_software_keys) {}
+        allow_software_keys_(allow_software_keys),
+        max_concurrent_loads_(max_concurrent_loads) {}
+
+  bool IsLoadable(const kms_v1::CryptoKey& key) const;
+  bool IsLoadable(const kms_v1::CryptoKeyVersion& ckv) const;
+
+  // A loadable version of a key, along with any key material that was
+  // retrieved for it. Key material is only retrieved for versions that are
+  // not already cached.
+  struct LoadedVersion {
+    kms_v1::CryptoKeyVersion ckv;
+    bool cached;
+    std::string public_key_der;
+    std::string certificate_der;
+  };
 
-  bool IsLoadable(const kms_v1::CryptoKey& key);
-  bool IsLoadable(const kms_v1::CryptoKeyVersion& ckv);
+  // Lists the versions of `key` and retrieves public keys and certificates for
+  // the versions that aren't in `cached_versions`. This does not touch the
+  // cache, and may be called concurrently for different keys.
+  absl::StatusOr<std::vector<LoadedVersion>> LoadVersions(
+      const KmsClient& client, const kms_v1::CryptoKey& key,
+      const absl::flat_hash_set<std::string>& cached_versions) const;
 
   std::string key_ring_name_;
   // map from SPKI DER to user-provided certificate DER
   absl::flat_hash_map<std::string, std::string> user_certs_;
   std::unique_ptr<CertAuthority> cert_authority_;
   bool allow_software_keys_;
+  int max_concurrent_loads_;
 
   class Cache {
    public:
     Key* Get(std::string_view ckv_name);
+    absl::flat_hash_set<std::string> VersionNames() const;
     Key* Store(const kms_v1::CryptoKeyVersion& ckv,
                std::string_view public_key_der,
                std::string_view certificate_der);
     Key* StoreSecretKey(const kms_v1::CryptoKeyVersion& ckv);
+    void Restore(const Key& key);
     void EvictUnused(const ObjectStoreState& state);
 
    private:
@@ -346,5 +346,56 @@ TEST_F(BuildStateTest, VersionWithAlgorithmP224IsOmitted) {
               IsOkAndHolds(EqualsProto(ObjectStoreState())));
 }
 
+TEST_F(BuildStateTest, ConcurrentLoadOutputMatchesSerialLoadOutput) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectLoader> serial_loader,
+                       ObjectLoader::New(key_ring_.name(), {}, false,
+                                         /*allow_software_keys=*/false,
+                                         /*max_concurrent_loads=*/1));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectLoader> concurrent_loader,
+                       ObjectLoader::New(key_ring_.name(), {}, false,
+                                         /*allow_software_keys=*/false,
+                                         /*max_concurrent_loads=*/4));
+  for (int i = 0; i < 12; i++) {
+    if (i % 3 == 0) {
+      AddKeyAndInitialVersion(absl::StrCat("ck", i), kms_v1::CryptoKey::MAC,
+                              kms_v1::CryptoKeyVersion::HMAC_SHA256);
+    } else {
+      AddKeyAndInitialVersion(absl::StrCat("ck", i),
+                              kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+                              kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+    }
+  }
+
+  ASSERT_OK_AND_ASSIGN(ObjectStoreState serial_state,
+                       serial_loader->BuildState(*client_));
+  ASSERT_OK_AND_ASSIGN(ObjectStoreState concurrent_state,
+                       concurrent_loader->BuildState(*client_));
+
+  ASSERT_EQ(concurrent_state.keys_size(), serial_state.keys_size());
+  for (int i = 0; i < serial_state.keys_size(); i++) {
+    // Handles are randomly assigned, so compare everything else.
+    EXPECT_THAT(concurrent_state.keys(i).crypto_key_version(),
+                EqualsProto(serial_state.keys(i).crypto_key_version()));
+    EXPECT_EQ(concurrent_state.keys(i).public_key_der(),
+              serial_state.keys(i).public_key_der());
+  }
+}
+
+TEST_F(BuildStateTest, ConcurrentLoadStateIsUnchangedAfterRefresh) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectLoader> loader_,
+                       ObjectLoader::New(key_ring_.name(), {}, true,
+                                         /*allow_software_keys=*/false,
+                                         /*max_concurrent_loads=*/4));
+  for (int i = 0; i < 6; i++) {
+    AddKeyAndInitialVersion(absl::StrCat("ck", i),
+                            kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+                            kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+  }
+
+  ASSERT_OK_AND_ASSIGN(ObjectStoreState state, loader_->BuildState(*client_));
+  EXPECT_EQ(state.keys_size(), 6);
+  EXPECT_THAT(loader_->BuildState(*client_), IsOkAndHolds(EqualsProto(state)));
+}
+
 }  // namespace
 }  // namespace cloud_kms::kmsp11
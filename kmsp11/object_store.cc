@@ -14,7 +14,11 @@
 
 #include "kmsp11/object_store.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "common/status_macros.h"
+#include "google/protobuf/util/message_differencer.h"
 #include "kmsp11/util/crypto_utils.h"
 #include "kmsp11/util/errors.h"
 
@@ -30,56 +34,57 @@ static_assert(
 
 using ObjectStoreEntry = ObjectStoreMap::value_type;
 
-absl::StatusOr<std::vector<ObjectStoreEntry>> ParseStoreEntries(
-    const ObjectStoreState& state) {
+// Attributes that applications commonly search on, and which ObjectStore
+// indexes at construction time.
+constexpr CK_ATTRIBUTE_TYPE kIndexedAttributes[] = {CKA_CLASS, CKA_LABEL,
+                                                     CKA_ID, CKA_KEY_TYPE};
+
+absl::StatusOr<std::vector<ObjectStoreEntry>> ParseKeyEntries(
+    const Key& item) {
   std::vector<ObjectStoreEntry> entries;
-  for (const Key& item : state.keys()) {
-    if (item.secret_key_handle() == 0 && item.private_key_handle() == 0) {
-      return absl::InvalidArgumentError(
-          "both secret_key_handle and private_key_handle are unset, cannot "
-          "determine if key is symmetric or asymmetric");
-    }
-    if (item.secret_key_handle() != 0) {
-      ASSIGN_OR_RETURN(Object key,
-                       Object::NewSecretKey(item.crypto_key_version()));
+  if (item.secret_key_handle() == 0 && item.private_key_handle() == 0) {
+    return absl::InvalidArgumentError(
+        "both secret_key_handle and private_key_handle are unset, cannot "
+        "determine if key is symmetric or asymmetric");
+  }
+  if (item.secret_key_handle() != 0) {
+    ASSIGN_OR_RETURN(Object key,
+                     Object::NewSecretKey(item.crypto_key_version()));
 
-      entries.emplace_back(item.secret_key_handle(),
-                           std::make_shared<Object>(std::move(key)));
-      continue;
-    }
-    ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key,
-                     ParseX509PublicKeyDer(item.public_key_der()));
-    ASSIGN_OR_RETURN(
-        KeyPair keypair,
-        Object::NewKeyPair(item.crypto_key_version(), public_key.get()));
+    entries.emplace_back(item.secret_key_handle(),
+                         std::make_shared<Object>(std::move(key)));
+    return entries;
+  }
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key,
+                   ParseX509PublicKeyDer(item.public_key_der()));
+  ASSIGN_OR_RETURN(
+      KeyPair keypair,
+      Object::NewKeyPair(item.crypto_key_version(), public_key.get()));
 
-    if (item.public_key_handle() == 0) {
-      return absl::InvalidArgumentError("public_key_handle is unset");
-    }
-    entries.emplace_back(
-        item.public_key_handle(),
-        std::make_shared<Object>(std::move(keypair.public_key)));
+  if (item.public_key_handle() == 0) {
+    return absl::InvalidArgumentError("public_key_handle is unset");
+  }
+  entries.emplace_back(item.public_key_handle(),
+                       std::make_shared<Object>(std::move(keypair.public_key)));
 
-    if (item.private_key_handle() == 0) {
-      return absl::InvalidArgumentError("private_key_handle is unset");
-    }
-    entries.emplace_back(
-        item.private_key_handle(),
-        std::make_shared<Object>(std::move(keypair.private_key)));
+  if (item.private_key_handle() == 0) {
+    return absl::InvalidArgumentError("private_key_handle is unset");
+  }
+  entries.emplace_back(
+      item.private_key_handle(),
+      std::make_shared<Object>(std::move(keypair.private_key)));
 
-    if (item.has_certificate()) {
-      if (item.certificate().handle() == 0) {
-        return absl::InvalidArgumentError("certificate_handle is unset");
-      }
-      ASSIGN_OR_RETURN(
-          bssl::UniquePtr<X509> x509,
-          ParseX509CertificateDer(item.certificate().x509_der()));
-      ASSIGN_OR_RETURN(
-          Object cert,
-          Object::NewCertificate(item.crypto_key_version(), x509.get()));
-      entries.emplace_back(item.certificate().handle(),
-                           std::make_shared<Object>(std::move(cert)));
+  if (item.has_certificate()) {
+    if (item.certificate().handle() == 0) {
+      return absl::InvalidArgumentError("certificate_handle is unset");
     }
+    ASSIGN_OR_RETURN(bssl::UniquePtr<X509> x509,
+                     ParseX509CertificateDer(item.certificate().x509_der()));
+    ASSIGN_OR_RETURN(
+        Object cert,
+        Object::NewCertificate(item.crypto_key_version(), x509.get()));
+    entries.emplace_back(item.certificate().handle(),
+                         std::make_shared<Object>(std::move(cert)));
   }
   return entries;
 }
@@ -94,30 +99,116 @@ bool EntryCompare(const ObjectStoreEntry& e1, const ObjectStoreEntry& e2) {
   return name_cmp < 0;
 }
 
+std::string_view AttributeValue(const CK_ATTRIBUTE& attr) {
+  return std::string_view(static_cast<const char*>(attr.pValue),
+                          attr.ulValueLen);
+}
+
+bool MatchesTemplate(const Object& object,
+                     absl::Span<const CK_ATTRIBUTE> attr_template) {
+  for (const CK_ATTRIBUTE& attr : attr_template) {
+    if (!object.attributes().Contains(attr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
+ObjectStore::ObjectStore(ObjectStoreMap entries, KeyObjectsMap keys)
+    : entries_(std::move(entries)), keys_(std::move(keys)) {
+  sorted_entries_.reserve(entries_.size());
+  for (const ObjectStoreEntry& entry : entries_) {
+    sorted_entries_.push_back(&entry);
+  }
+  std::sort(sorted_entries_.begin(), sorted_entries_.end(),
+            [](const ObjectStoreEntry* e1, const ObjectStoreEntry* e2) {
+              return EntryCompare(*e1, *e2);
+            });
+
+  for (CK_ATTRIBUTE_TYPE type : kIndexedAttributes) {
+    AttributeIndex& index = indexes_[type];
+    for (size_t i = 0; i < sorted_entries_.size(); i++) {
+      absl::StatusOr<std::string_view> value =
+          sorted_entries_[i]->second->attributes().Value(type);
+      // Absent and sensitive attributes never match a template, so they are
+      // left out of the index.
+      if (value.ok()) {
+        index[*value].push_back(i);
+      }
+    }
+  }
+}
+
 absl::StatusOr<std::unique_ptr<ObjectStore>> ObjectStore::New(
     const ObjectStoreState& state) {
-  absl::StatusOr<std::vector<ObjectStoreEntry>> entries =
-      ParseStoreEntries(state);
-  if (!entries.ok()) {
-    return NewInvalidArgumentError(
-        absl::StrCat("failure building ObjectStore: ",
-                     entries.status().message()),
-        CKR_DEVICE_ERROR, SOURCE_LOCATION);
+  return ObjectStore(ObjectStoreMap(), KeyObjectsMap()).Update(state);
+}
+
+absl::StatusOr<std::unique_ptr<ObjectStore>> ObjectStore::Update(
+    const ObjectStoreState& state,
+    std::vector<std::string>* changed_keys) const {
+  KeyObjectsMap keys;
+  keys.reserve(state.keys_size());
+  size_t entry_count = 0;
+
+  for (const Key& item : state.keys()) {
+    const std::string& name = item.crypto_key_version().name();
+    if (keys.contains(name)) {
+      return NewInvalidArgumentError(
+          absl::StrCat("duplicate key detected: ", name), CKR_DEVICE_ERROR,
+          SOURCE_LOCATION);
+    }
+
+    // Reuse the objects for this key if it is unchanged.
+    if (auto it = keys_.find(name); it != keys_.end()) {
+      if (google::protobuf::util::MessageDifferencer::Equals(it->second.key,
+                                                             item)) {
+        entry_count += it->second.entries.size();
+        keys.emplace(name, it->second);
+        continue;
+      }
+      if (changed_keys) {
+        changed_keys->push_back(name);
+      }
+    }
+
+    absl::StatusOr<std::vector<ObjectStoreEntry>> entries =
+        ParseKeyEntries(item);
+    if (!entries.ok()) {
+      return NewInvalidArgumentError(
+          absl::StrCat("failure building ObjectStore: ",
+                       entries.status().message()),
+          CKR_DEVICE_ERROR, SOURCE_LOCATION);
+    }
+    entry_count += entries->size();
+    keys.emplace(name, KeyObjects{item, *std::move(entries)});
   }
 
-  std::unique_ptr<ObjectStore> store = absl::WrapUnique(
-      new ObjectStore(ObjectStoreMap(entries->begin(), entries->end())));
-  if (store->entries_.size() != entries->size()) {
+  ObjectStoreMap entries;
+  entries.reserve(entry_count);
+  for (const auto& [name, key_objects] : keys) {
+    entries.insert(key_objects.entries.begin(), key_objects.entries.end());
+  }
+  if (entries.size() != entry_count) {
     return NewInvalidArgumentError(
         absl::StrFormat("duplicate handle detected: "
                         "store.entries_.size()=%d; entries.size()=%d",
-                        store->entries_.size(), entries->size()),
+                        entries.size(), entry_count),
         CKR_DEVICE_ERROR, SOURCE_LOCATION);
   }
 
-  return std::move(store);
+  if (changed_keys) {
+    for (const auto& [name, key_objects] : keys_) {
+      if (!keys.contains(name)) {
+        changed_keys->push_back(name);
+      }
+    }
+  }
+
+  return absl::WrapUnique(
+      new ObjectStore(std::move(entries), std::move(keys)));
 }
 
 absl::StatusOr<std::shared_ptr<Object>> ObjectStore::GetObject(
@@ -151,18 +242,62 @@ absl::StatusOr<std::shared_ptr<Object>> ObjectStore::GetKey(
 
 std::vector<CK_OBJECT_HANDLE> ObjectStore::Find(
     std::function<bool(const Object&)> predicate) const {
-  std::vector<std::reference_wrapper<const ObjectStoreEntry>> matches;
-  for (const ObjectStoreEntry& entry : entries_) {
-    if (predicate(*entry.second)) {
-      matches.push_back(entry);
+  std::vector<CK_OBJECT_HANDLE> handles;
+  for (const ObjectStoreEntry* entry : sorted_entries_) {
+    if (predicate(*entry->second)) {
+      handles.push_back(entry->first);
     }
   }
+  return handles;
+}
 
-  std::sort(matches.begin(), matches.end(), &EntryCompare);
+std::vector<CK_OBJECT_HANDLE> ObjectStore::Find(
+    absl::Span<const CK_ATTRIBUTE> attr_template) const {
+  std::vector<const std::vector<size_t>*> postings;
+  std::vector<CK_ATTRIBUTE> unindexed;
+  for (const CK_ATTRIBUTE& attr : attr_template) {
+    auto index = indexes_.find(attr.type);
+    if (index == indexes_.end()) {
+      unindexed.push_back(attr);
+      continue;
+    }
+    auto it = index->second.find(AttributeValue(attr));
+    if (it == index->second.end()) {
+      return {};
+    }
+    postings.push_back(&it->second);
+  }
 
-  std::vector<CK_OBJECT_HANDLE> handles(matches.size());
-  for (size_t i = 0; i < matches.size(); i++) {
-    handles[i] = matches[i].get().first;
+  std::vector<CK_OBJECT_HANDLE> handles;
+  if (postings.empty()) {
+    for (const ObjectStoreEntry* entry : sorted_entries_) {
+      if (MatchesTemplate(*entry->second, unindexed)) {
+        handles.push_back(entry->first);
+      }
+    }
+    return handles;
+  }
+
+  // Intersect the smallest posting lists first to keep the candidate set
+  // small. All posting lists are in ascending order, so the result is too.
+  std::sort(postings.begin(), postings.end(),
+            [](const std::vector<size_t>* a, const std::vector<size_t>* b) {
+              return a->size() < b->size();
+            });
+  std::vector<size_t> candidates = *postings[0];
+  for (size_t i = 1; i < postings.size() && !candidates.empty(); i++) {
+    std::vector<size_t> intersection;
+    std::set_intersection(candidates.begin(), candidates.end(),
+                          postings[i]->begin(), postings[i]->end(),
+                          std::back_inserter(intersection));
+    candidates = std::move(intersection);
+  }
+
+  for (size_t i : candidates) {
+    const ObjectStoreEntry* entry = sorted_entries_[i];
+    if (MatchesTemplate(*entry->second, unindexed)) {
+      handles.push_back(entry->first);
+    }
   }
   return handles;
 }
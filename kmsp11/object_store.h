@@ -17,8 +17,12 @@
 #ifndef KMSP11_OBJECT_STORE_H_
 #define KMSP11_OBJECT_STORE_H_
 
+#include <string>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "kmsp11/cryptoki.h"
 #include "kmsp11/object.h"
 #include "kmsp11/object_store_state.pb.h"
@@ -34,6 +38,14 @@ class ObjectStore {
   static absl::StatusOr<std::unique_ptr<ObjectStore>> New(
       const ObjectStoreState& state);
 
+  // Create a new ObjectStore with the provided state. Objects for keys that are
+  // unchanged from this store's state are shared with this store rather than
+  // being parsed again. If `changed_keys` is provided, the names of keys in
+  // this store that are changed or absent in `state` are appended to it.
+  absl::StatusOr<std::unique_ptr<ObjectStore>> Update(
+      const ObjectStoreState& state,
+      std::vector<std::string>* changed_keys = nullptr) const;
+
   // GetObject retrieves the object with the provided handle, or returns
   // CKR_OBJECT_HANDLE_INVALID if the handle is not valid.
   absl::StatusOr<std::shared_ptr<Object>> GetObject(
@@ -49,6 +61,14 @@ class ObjectStore {
   std::vector<CK_OBJECT_HANDLE> Find(
       std::function<bool(const Object&)> predicate) const;
 
+  // Find retrieves a list of handles whose objects contain every attribute in
+  // the provided template, using the same ordering as the predicate overload.
+  // Attributes that are indexed (see kIndexedAttributes in object_store.cc) are
+  // resolved with index lookups; the remaining attributes are checked only
+  // against the objects that satisfy the indexed ones.
+  std::vector<CK_OBJECT_HANDLE> Find(
+      absl::Span<const CK_ATTRIBUTE> attr_template) const;
+
   // FindSingle retrieves the object that matches the provided predicate, or
   // NotFound if no such object exists, or PreconditionFailed if multiple
   // matching objects exist.
@@ -56,9 +76,31 @@ class ObjectStore {
       std::function<bool(const Object&)> predicate) const;
 
  private:
-  ObjectStore(ObjectStoreMap entries) : entries_(entries) {}
+  // The objects derived from a single Key in an ObjectStoreState.
+  struct KeyObjects {
+    Key key;
+    std::vector<ObjectStoreMap::value_type> entries;
+  };
+  // Map from CryptoKeyVersion name to objects.
+  using KeyObjectsMap = absl::flat_hash_map<std::string, KeyObjects>;
+
+  // Map from attribute value to positions in sorted_entries_, in ascending
+  // order.
+  using AttributeIndex =
+      absl::flat_hash_map<std::string, std::vector<size_t>>;
+
+  ObjectStore(ObjectStoreMap entries, KeyObjectsMap keys);
+  // sorted_entries_ points into entries_, so copies are not permitted.
+  ObjectStore(const ObjectStore&) = delete;
+  ObjectStore& operator=(const ObjectStore&) = delete;
 
   const ObjectStoreMap entries_;
+  const KeyObjectsMap keys_;
+  // Pointers to the entries in entries_, sorted by KMS key name and then
+  // object class.
+  std::vector<const ObjectStoreMap::value_type*> sorted_entries_;
+  // Secondary indexes over sorted_entries_, keyed by attribute type.
+  absl::flat_hash_map<CK_ATTRIBUTE_TYPE, AttributeIndex> indexes_;
 };
 
 }  // namespace cloud_kms::kmsp11
@@ -27,6 +27,7 @@ using ::testing::AllOf;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
+using ::testing::Not;
 using ::testing::Property;
 using ::testing::UnorderedElementsAre;
 
@@ -532,6 +533,72 @@ TEST(ObjectStoreTest, FindSortsByNameThenClass) {
                           ));
 }
 
+TEST(ObjectStoreTest, FindTemplateMatchesIndexedAttributes) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricEcKeyAndCert());
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> store, ObjectStore::New(s));
+
+  CK_OBJECT_CLASS object_class = CKO_PRIVATE_KEY;
+  std::string label = "luz";
+  std::vector<CK_ATTRIBUTE> attr_template = {
+      {CKA_CLASS, &object_class, sizeof(object_class)},
+      {CKA_LABEL, label.data(), label.size()},
+  };
+
+  EXPECT_THAT(store->Find(attr_template),
+              ElementsAre(s.keys(0).private_key_handle()));
+}
+
+TEST(ObjectStoreTest, FindTemplateChecksUnindexedAttributes) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricEcKeyAndCert());
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> store, ObjectStore::New(s));
+
+  CK_BBOOL yes = CK_TRUE;
+  CK_KEY_TYPE key_type = CKK_RSA;
+  std::vector<CK_ATTRIBUTE> attr_template = {
+      {CKA_KEY_TYPE, &key_type, sizeof(key_type)},
+      {CKA_DECRYPT, &yes, sizeof(yes)},
+  };
+
+  EXPECT_THAT(store->Find(attr_template),
+              ElementsAre(s.keys(1).private_key_handle()));
+}
+
+TEST(ObjectStoreTest, FindTemplateWithUnknownValueReturnsEmptyVector) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricEcKeyAndCert());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> store, ObjectStore::New(s));
+
+  std::string id = "no-such-id";
+  std::vector<CK_ATTRIBUTE> attr_template = {
+      {CKA_ID, id.data(), id.size()},
+  };
+
+  EXPECT_THAT(store->Find(attr_template), IsEmpty());
+}
+
+TEST(ObjectStoreTest, FindTemplateMatchesPredicateOrdering) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricEcKeyAndCert());
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> store, ObjectStore::New(s));
+
+  EXPECT_EQ(store->Find(absl::Span<const CK_ATTRIBUTE>()),
+            store->Find([](const kmsp11::Object& o) -> bool { return true; }));
+
+  CK_OBJECT_CLASS object_class = CKO_PUBLIC_KEY;
+  std::vector<CK_ATTRIBUTE> attr_template = {
+      {CKA_CLASS, &object_class, sizeof(object_class)},
+  };
+  EXPECT_EQ(store->Find(attr_template),
+            store->Find([](const kmsp11::Object& o) -> bool {
+              return o.object_class() == CKO_PUBLIC_KEY;
+            }));
+}
+
 TEST(ObjectStoreTest, FindSingleReturnsSingleMatch) {
   ObjectStoreState s;
 
@@ -585,5 +652,101 @@ TEST(ObjectStoreTest, FindSingleWithMultipleMatchesReturnsFailedPrecondition) {
               StatusIs(absl::StatusCode::kFailedPrecondition));
 }
 
+TEST(ObjectStoreTest, UpdateReusesObjectsForUnchangedKeys) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricEcKeyAndCert());
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> store, ObjectStore::New(s));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> updated, store->Update(s));
+
+  for (const Key& key : s.keys()) {
+    ASSERT_OK_AND_ASSIGN(std::shared_ptr<Object> original,
+                         store->GetObject(key.public_key_handle()));
+    EXPECT_THAT(updated->GetObject(key.public_key_handle()),
+                IsOkAndHolds(original));
+  }
+}
+
+TEST(ObjectStoreTest, UpdateParsesChangedKeys) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricEcKeyAndCert());
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> store, ObjectStore::New(s));
+
+  ObjectStoreState changed = s;
+  changed.mutable_keys(1)->set_public_key_handle(2001);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> updated,
+                       store->Update(changed));
+
+  // The unchanged key is shared.
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Object> ec_public,
+                       store->GetObject(s.keys(0).public_key_handle()));
+  EXPECT_THAT(updated->GetObject(s.keys(0).public_key_handle()),
+              IsOkAndHolds(ec_public));
+
+  // The changed key is reparsed with its new handle.
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Object> rsa_private,
+                       store->GetObject(s.keys(1).private_key_handle()));
+  EXPECT_THAT(updated->GetObject(s.keys(1).private_key_handle()),
+              IsOkAndHolds(Not(rsa_private)));
+  EXPECT_THAT(updated->GetObject(s.keys(1).public_key_handle()),
+              StatusRvIs(CKR_OBJECT_HANDLE_INVALID));
+  EXPECT_OK(updated->GetObject(2001));
+}
+
+TEST(ObjectStoreTest, UpdateRemovesAbsentKeys) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricEcKeyAndCert());
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> store, ObjectStore::New(s));
+
+  ObjectStoreState removed;
+  *removed.add_keys() = s.keys(0);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> updated,
+                       store->Update(removed));
+
+  EXPECT_OK(updated->GetObject(s.keys(0).public_key_handle()));
+  EXPECT_THAT(updated->GetObject(s.keys(1).public_key_handle()),
+              StatusRvIs(CKR_OBJECT_HANDLE_INVALID));
+  EXPECT_OK(store->GetObject(s.keys(1).public_key_handle()));
+}
+
+TEST(ObjectStoreTest, UpdateReportsChangedAndRemovedKeys) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricEcKeyAndCert());
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ObjectStore> store, ObjectStore::New(s));
+
+  std::vector<std::string> changed_keys;
+  ASSERT_OK(store->Update(s, &changed_keys));
+  EXPECT_THAT(changed_keys, IsEmpty());
+
+  ObjectStoreState changed = s;
+  changed.mutable_keys(0)->set_public_key_handle(2001);
+  ASSERT_OK(store->Update(changed, &changed_keys));
+  EXPECT_THAT(changed_keys,
+              ElementsAre(s.keys(0).crypto_key_version().name()));
+
+  changed_keys.clear();
+  ObjectStoreState removed;
+  *removed.add_keys() = s.keys(0);
+  ASSERT_OK(store->Update(removed, &changed_keys));
+  EXPECT_THAT(changed_keys,
+              ElementsAre(s.keys(1).crypto_key_version().name()));
+}
+
+TEST(ObjectStoreTest, NewStoreFailsDuplicateKey) {
+  ObjectStoreState s;
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  ASSERT_OK_AND_ASSIGN(*s.add_keys(), NewAsymmetricRsaKey());
+  s.mutable_keys(1)->set_public_key_handle(2001);
+  s.mutable_keys(1)->set_private_key_handle(2002);
+
+  EXPECT_THAT(ObjectStore::New(s),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("duplicate key detected")));
+}
+
 }  // namespace
 }  // namespace cloud_kms::kmsp11
@@ -224,6 +224,34 @@ TEST(NewKeyPairTest, RsaKeyAttributes) {
               StatusRvIs(CKR_ATTRIBUTE_SENSITIVE));
 }
 
+TEST(NewKeyPairTest, KeyPairSharesPublicKey) {
+  kms_v1::CryptoKeyVersion ckv = NewTestCkv();
+  ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> pub, GetTestP256Key());
+  ASSERT_OK_AND_ASSIGN(KeyPair key_pair, Object::NewKeyPair(ckv, pub.get()));
+
+  ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> from_public,
+                       key_pair.public_key.GetPublicKey());
+  ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> from_private,
+                       key_pair.private_key.GetPublicKey());
+
+  // The objects hold references to the original key rather than copies.
+  EXPECT_EQ(from_public.get(), pub.get());
+  EXPECT_EQ(from_private.get(), pub.get());
+}
+
+TEST(NewKeyPairTest, PublicKeyOutlivesCaller) {
+  kms_v1::CryptoKeyVersion ckv = NewTestCkv();
+  ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> pub, GetTestP256Key());
+  ASSERT_OK_AND_ASSIGN(std::string want_der,
+                       MarshalX509PublicKeyDer(pub.get()));
+  ASSERT_OK_AND_ASSIGN(KeyPair key_pair, Object::NewKeyPair(ckv, pub.get()));
+  pub.reset();
+
+  ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> got,
+                       key_pair.private_key.GetPublicKey());
+  EXPECT_THAT(MarshalX509PublicKeyDer(got.get()), IsOkAndHolds(want_der));
+}
+
 TEST(NewCertificateTest, CertificateAttributes) {
   kms_v1::CryptoKeyVersion ckv = NewTestCkv();
   ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> pub, GetTestP256Key());
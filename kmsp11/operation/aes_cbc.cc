@@ -15,6 +15,7 @@
 #include "kmsp11/operation/aes_cbc.h"
 
 #include "absl/cleanup/cleanup.h"
+#include "common/crc32c.h"
 #include "common/status_macros.h"
 #include "kmsp11/kmsp11.h"
 #include "kmsp11/object.h"
@@ -45,8 +46,8 @@ class AesCbcEncrypter : public EncrypterInterface {
 
   absl::StatusOr<absl::Span<const uint8_t>> Encrypt(
       KmsClient* client, absl::Span<const uint8_t> ciphertext) override;
-  absl::Status EncryptUpdate(KmsClient* client,
-                             absl::Span<const uint8_t> plaintext_part) override;
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> plaintext_part) override;
   absl::StatusOr<absl::Span<const uint8_t>> EncryptFinal(
       KmsClient* client) override;
 
@@ -61,7 +62,7 @@ class AesCbcEncrypter : public EncrypterInterface {
   PaddingMode padding_mode_;
   std::optional<std::vector<uint8_t, ZeroDeallocator<uint8_t>>>
       plaintext_;  // for multi-part
-  std::vector<uint8_t> ciphertext_;
+  std::unique_ptr<std::string> ciphertext_;
 };
 
 absl::StatusOr<absl::Span<const uint8_t>> AesCbcEncrypter::Encrypt(
@@ -83,7 +84,7 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCbcEncrypter::Encrypt(
   return EncryptInternal(client, plaintext);
 }
 
-absl::Status AesCbcEncrypter::EncryptUpdate(
+absl::StatusOr<absl::Span<const uint8_t>> AesCbcEncrypter::EncryptUpdate(
     KmsClient* client, absl::Span<const uint8_t> plaintext_part) {
   if (!plaintext_) {
     plaintext_.emplace();
@@ -102,7 +103,7 @@ absl::Status AesCbcEncrypter::EncryptUpdate(
   plaintext_->insert(plaintext_->end(), plaintext_part.begin(),
                      plaintext_part.end());
 
-  return absl::OkStatus();
+  return absl::Span<const uint8_t>();
 }
 
 absl::StatusOr<absl::Span<const uint8_t>> AesCbcEncrypter::EncryptFinal(
@@ -130,17 +131,13 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCbcEncrypter::EncryptInternal(
 
   kms_v1::RawEncryptRequest req;
   req.set_name(std::string(object_->kms_key_name()));
-  std::vector<uint8_t> padded_plaintext;
   switch (padding_mode_) {
     case PaddingMode::kPkcs7:
-      padded_plaintext = Pad(plaintext);
-      req.set_plaintext(
-          std::string(reinterpret_cast<const char*>(padded_plaintext.data()),
-                      padded_plaintext.size()));
+      Pad(plaintext, req.mutable_plaintext());
       break;
     case PaddingMode::kNone:
-      req.set_plaintext(std::string(
-          reinterpret_cast<const char*>(plaintext.data()), plaintext.size()));
+      req.mutable_plaintext_crc32c()->set_value(
+          AssignWithCRC32C(plaintext, req.mutable_plaintext()));
       break;
     default:
       return NewInternalError("unsupported padding mode", SOURCE_LOCATION);
@@ -157,11 +154,8 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCbcEncrypter::EncryptInternal(
         SOURCE_LOCATION);
   }
 
-  ciphertext_.resize(resp.ciphertext().size());
-  std::copy_n(resp.ciphertext().begin(), resp.ciphertext().size(),
-              ciphertext_.begin());
-
-  return ciphertext_;
+  ciphertext_.reset(resp.release_ciphertext());
+  return SpanFromStr(*ciphertext_);
 }
 
 // An implementation of DecrypterInterface that decrypts AES-CBC ciphertexts
@@ -174,7 +168,7 @@ class AesCbcDecrypter : public DecrypterInterface {
 
   absl::StatusOr<absl::Span<const uint8_t>> Decrypt(
       KmsClient* client, absl::Span<const uint8_t> ciphertext) override;
-  absl::Status DecryptUpdate(
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptUpdate(
       KmsClient* client, absl::Span<const uint8_t> ciphertext_part) override;
   absl::StatusOr<absl::Span<const uint8_t>> DecryptFinal(
       KmsClient* client) override;
@@ -205,7 +199,7 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCbcDecrypter::Decrypt(
   return DecryptInternal(client, ciphertext);
 }
 
-absl::Status AesCbcDecrypter::DecryptUpdate(
+absl::StatusOr<absl::Span<const uint8_t>> AesCbcDecrypter::DecryptUpdate(
     KmsClient* client, absl::Span<const uint8_t> ciphertext_part) {
   if (!ciphertext_) {
     ciphertext_.emplace();
@@ -224,7 +218,7 @@ absl::Status AesCbcDecrypter::DecryptUpdate(
   ciphertext_->insert(ciphertext_->end(), ciphertext_part.begin(),
                       ciphertext_part.end());
 
-  return absl::OkStatus();
+  return absl::Span<const uint8_t>();
 }
 
 absl::StatusOr<absl::Span<const uint8_t>> AesCbcDecrypter::DecryptFinal(
@@ -243,16 +237,15 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCbcDecrypter::DecryptInternal(
     KmsClient* client, absl::Span<const uint8_t> ciphertext) {
   kms_v1::RawDecryptRequest req;
   req.set_name(std::string(object_->kms_key_name()));
-  req.set_ciphertext(std::string(
-      reinterpret_cast<const char*>(ciphertext.data()), ciphertext.size()));
+  req.mutable_ciphertext_crc32c()->set_value(
+      AssignWithCRC32C(ciphertext, req.mutable_ciphertext()));
   req.set_initialization_vector(
       std::string(reinterpret_cast<const char*>(iv_.data()), iv_.size()));
 
   ASSIGN_OR_RETURN(kms_v1::RawDecryptResponse resp, client->RawDecrypt(req));
 
   plaintext_.reset(resp.release_plaintext());
-  absl::Span<const uint8_t> full_plaintext(
-      reinterpret_cast<const uint8_t*>(plaintext_->data()), plaintext_->size());
+  absl::Span<const uint8_t> full_plaintext = SpanFromStr(*plaintext_);
 
   switch (padding_mode_) {
     case PaddingMode::kNone:
@@ -262,10 +255,302 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCbcDecrypter::DecryptInternal(
   }
 }
 
+// An implementation of EncrypterInterface that streams multi-part AES-CBC
+// encryption through Cloud KMS. Full blocks are encrypted as soon as they are
+// available, in RPCs of at most kMaxPlaintextBytes, with the last ciphertext
+// block of each RPC used as the IV for the next one. Only a partial block is
+// buffered between calls, and padding (if any) is applied in EncryptFinal.
+class AesCbcStreamingEncrypter : public EncrypterInterface {
+ public:
+  AesCbcStreamingEncrypter(std::shared_ptr<Object> object,
+                           absl::Span<uint8_t> iv, PaddingMode padding)
+      : single_part_(object, iv, padding),
+        object_(object),
+        iv_(iv.begin(), iv.end()),
+        padding_mode_(padding) {}
+
+  absl::StatusOr<absl::Span<const uint8_t>> Encrypt(
+      KmsClient* client, absl::Span<const uint8_t> plaintext) override;
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> plaintext_part) override;
+  size_t EncryptUpdateOutputLength(size_t plaintext_part_length) override;
+  bool StreamsUpdateOutput() const override { return true; }
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptFinal(
+      KmsClient* client) override;
+
+  virtual ~AesCbcStreamingEncrypter() {}
+
+ private:
+  absl::Status EncryptBlocks(KmsClient* client,
+                             absl::Span<const uint8_t> plaintext);
+
+  AesCbcEncrypter single_part_;
+  std::shared_ptr<Object> object_;
+  std::vector<uint8_t> iv_;
+  PaddingMode padding_mode_;
+  bool started_ = false;
+  bool finished_ = false;
+  std::vector<uint8_t, ZeroDeallocator<uint8_t>> pending_;
+  std::vector<uint8_t> ciphertext_;
+};
+
+absl::StatusOr<absl::Span<const uint8_t>> AesCbcStreamingEncrypter::Encrypt(
+    KmsClient* client, absl::Span<const uint8_t> plaintext) {
+  if (started_) {
+    return FailedPreconditionError(
+        "Encrypt cannot be used to terminate a multi-part encryption operation",
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+  return single_part_.Encrypt(client, plaintext);
+}
+
+absl::StatusOr<absl::Span<const uint8_t>>
+AesCbcStreamingEncrypter::EncryptUpdate(
+    KmsClient* client, absl::Span<const uint8_t> plaintext_part) {
+  started_ = true;
+  pending_.insert(pending_.end(), plaintext_part.begin(),
+                  plaintext_part.end());
+
+  size_t aligned = pending_.size() / kBlockSize * kBlockSize;
+  ciphertext_.clear();
+  for (size_t offset = 0; offset < aligned; offset += kMaxPlaintextBytes) {
+    RETURN_IF_ERROR(EncryptBlocks(
+        client, absl::MakeConstSpan(pending_).subspan(
+                    offset, std::min(kMaxPlaintextBytes, aligned - offset))));
+  }
+  pending_.erase(pending_.begin(), pending_.begin() + aligned);
+  return ciphertext_;
+}
+
+size_t AesCbcStreamingEncrypter::EncryptUpdateOutputLength(
+    size_t plaintext_part_length) {
+  return (pending_.size() + plaintext_part_length) / kBlockSize * kBlockSize;
+}
+
+absl::StatusOr<absl::Span<const uint8_t>>
+AesCbcStreamingEncrypter::EncryptFinal(KmsClient* client) {
+  if (!started_) {
+    return FailedPreconditionError(
+        "EncryptUpdate needs to be called prior to terminating a multi-part "
+        "encryption operation",
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+  // A repeated call, which follows a query for the output length, returns the
+  // same final blocks.
+  if (finished_) {
+    return ciphertext_;
+  }
+
+  ciphertext_.clear();
+  switch (padding_mode_) {
+    case PaddingMode::kNone:
+      if (!pending_.empty()) {
+        return NewInvalidArgumentError(
+            absl::StrFormat("plaintext length should be a multiple of the "
+                            "block size (%u bytes)",
+                            kBlockSize),
+            CKR_DATA_LEN_RANGE, SOURCE_LOCATION);
+      }
+      break;
+    case PaddingMode::kPkcs7: {
+      std::vector<uint8_t> padded = Pad(pending_);
+      RETURN_IF_ERROR(EncryptBlocks(client, padded));
+      break;
+    }
+  }
+  pending_.clear();
+  finished_ = true;
+  return ciphertext_;
+}
+
+absl::Status AesCbcStreamingEncrypter::EncryptBlocks(
+    KmsClient* client, absl::Span<const uint8_t> plaintext) {
+  kms_v1::RawEncryptRequest req;
+  req.set_name(std::string(object_->kms_key_name()));
+  req.mutable_plaintext_crc32c()->set_value(
+      AssignWithCRC32C(plaintext, req.mutable_plaintext()));
+  req.set_initialization_vector(
+      std::string(reinterpret_cast<const char*>(iv_.data()), iv_.size()));
+
+  ASSIGN_OR_RETURN(kms_v1::RawEncryptResponse resp, client->RawEncrypt(req));
+
+  if (req.initialization_vector() != resp.initialization_vector()) {
+    return NewInternalError(
+        "the IV returned by the server does not match user-supplied IV",
+        SOURCE_LOCATION);
+  }
+  if (resp.ciphertext().size() != plaintext.size()) {
+    return NewInternalError(
+        absl::StrFormat("unexpected AES-CBC ciphertext length: got %d, want %d",
+                        resp.ciphertext().size(), plaintext.size()),
+        SOURCE_LOCATION);
+  }
+
+  ciphertext_.insert(ciphertext_.end(), resp.ciphertext().begin(),
+                     resp.ciphertext().end());
+  std::copy(ciphertext_.end() - kBlockSize, ciphertext_.end(), iv_.begin());
+  return absl::OkStatus();
+}
+
+// An implementation of DecrypterInterface that streams multi-part AES-CBC
+// decryption through Cloud KMS. Full blocks are decrypted as soon as they are
+// available, with the last ciphertext block of each RPC used as the IV for the
+// next one. In padded mode the final block is held back until DecryptFinal so
+// that the padding can be removed.
+class AesCbcStreamingDecrypter : public DecrypterInterface {
+ public:
+  AesCbcStreamingDecrypter(std::shared_ptr<Object> object,
+                           absl::Span<uint8_t> iv, PaddingMode padding)
+      : single_part_(object, iv, padding),
+        object_(object),
+        iv_(iv.begin(), iv.end()),
+        padding_mode_(padding) {}
+
+  absl::StatusOr<absl::Span<const uint8_t>> Decrypt(
+      KmsClient* client, absl::Span<const uint8_t> ciphertext) override;
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> ciphertext_part) override;
+  size_t DecryptUpdateOutputLength(size_t ciphertext_part_length) override;
+  bool StreamsUpdateOutput() const override { return true; }
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptFinal(
+      KmsClient* client) override;
+
+  virtual ~AesCbcStreamingDecrypter() {}
+
+ private:
+  // Returns the number of buffered bytes that can be decrypted right away.
+  size_t ReadyLength(size_t buffered_length) const;
+  absl::Status DecryptBlocks(KmsClient* client,
+                             absl::Span<const uint8_t> ciphertext);
+
+  AesCbcDecrypter single_part_;
+  std::shared_ptr<Object> object_;
+  std::vector<uint8_t> iv_;
+  PaddingMode padding_mode_;
+  bool started_ = false;
+  bool finished_ = false;
+  std::vector<uint8_t> pending_;
+  std::vector<uint8_t, ZeroDeallocator<uint8_t>> plaintext_;
+  // The output of DecryptFinal, which is a prefix of plaintext_.
+  absl::Span<const uint8_t> last_part_;
+};
+
+absl::StatusOr<absl::Span<const uint8_t>> AesCbcStreamingDecrypter::Decrypt(
+    KmsClient* client, absl::Span<const uint8_t> ciphertext) {
+  if (started_) {
+    return FailedPreconditionError(
+        "Decrypt cannot be used to terminate a multi-part decryption operation",
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+  return single_part_.Decrypt(client, ciphertext);
+}
+
+absl::StatusOr<absl::Span<const uint8_t>>
+AesCbcStreamingDecrypter::DecryptUpdate(
+    KmsClient* client, absl::Span<const uint8_t> ciphertext_part) {
+  started_ = true;
+  pending_.insert(pending_.end(), ciphertext_part.begin(),
+                  ciphertext_part.end());
+
+  size_t ready = ReadyLength(pending_.size());
+  plaintext_.clear();
+  for (size_t offset = 0; offset < ready; offset += kMaxPlaintextBytes) {
+    RETURN_IF_ERROR(DecryptBlocks(
+        client, absl::MakeConstSpan(pending_).subspan(
+                    offset, std::min(kMaxPlaintextBytes, ready - offset))));
+  }
+  pending_.erase(pending_.begin(), pending_.begin() + ready);
+  return plaintext_;
+}
+
+size_t AesCbcStreamingDecrypter::DecryptUpdateOutputLength(
+    size_t ciphertext_part_length) {
+  return ReadyLength(pending_.size() + ciphertext_part_length);
+}
+
+absl::StatusOr<absl::Span<const uint8_t>>
+AesCbcStreamingDecrypter::DecryptFinal(KmsClient* client) {
+  if (!started_) {
+    return FailedPreconditionError(
+        "DecryptUpdate needs to be called prior to terminating a multi-part "
+        "decryption operation",
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+  // A repeated call, which follows a query for the output length, returns the
+  // same final block.
+  if (finished_) {
+    return last_part_;
+  }
+
+  plaintext_.clear();
+  switch (padding_mode_) {
+    case PaddingMode::kNone:
+      if (!pending_.empty()) {
+        return NewInvalidArgumentError(
+            absl::StrFormat("ciphertext length should be a multiple of the "
+                            "block size (%u bytes)",
+                            kBlockSize),
+            CKR_ENCRYPTED_DATA_LEN_RANGE, SOURCE_LOCATION);
+      }
+      last_part_ = plaintext_;
+      break;
+    case PaddingMode::kPkcs7:
+      if (pending_.size() != kBlockSize) {
+        return NewInvalidArgumentError(
+            absl::StrFormat("ciphertext length should be a non-zero multiple "
+                            "of the block size (%u bytes)",
+                            kBlockSize),
+            CKR_ENCRYPTED_DATA_LEN_RANGE, SOURCE_LOCATION);
+      }
+      RETURN_IF_ERROR(DecryptBlocks(client, pending_));
+      pending_.clear();
+      ASSIGN_OR_RETURN(last_part_, Unpad(plaintext_));
+      break;
+  }
+  finished_ = true;
+  return last_part_;
+}
+
+size_t AesCbcStreamingDecrypter::ReadyLength(size_t buffered_length) const {
+  size_t aligned = buffered_length / kBlockSize * kBlockSize;
+  if (padding_mode_ == PaddingMode::kPkcs7 && aligned == buffered_length &&
+      aligned > 0) {
+    // The last block might be the final one, which carries the padding.
+    aligned -= kBlockSize;
+  }
+  return aligned;
+}
+
+absl::Status AesCbcStreamingDecrypter::DecryptBlocks(
+    KmsClient* client, absl::Span<const uint8_t> ciphertext) {
+  kms_v1::RawDecryptRequest req;
+  req.set_name(std::string(object_->kms_key_name()));
+  req.mutable_ciphertext_crc32c()->set_value(
+      AssignWithCRC32C(ciphertext, req.mutable_ciphertext()));
+  req.set_initialization_vector(
+      std::string(reinterpret_cast<const char*>(iv_.data()), iv_.size()));
+
+  ASSIGN_OR_RETURN(kms_v1::RawDecryptResponse resp, client->RawDecrypt(req));
+
+  std::unique_ptr<std::string, ZeroDelete<std::string>> plaintext(
+      resp.release_plaintext());
+  if (plaintext->size() != ciphertext.size()) {
+    return NewInternalError(
+        absl::StrFormat("unexpected AES-CBC plaintext length: got %d, want %d",
+                        plaintext->size(), ciphertext.size()),
+        SOURCE_LOCATION);
+  }
+
+  plaintext_.insert(plaintext_.end(), plaintext->begin(), plaintext->end());
+  std::copy(ciphertext.end() - kBlockSize, ciphertext.end(), iv_.begin());
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesCbcEncrypter(
-    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism) {
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism,
+    bool streaming) {
   RETURN_IF_ERROR(CheckKeyPreconditions(CKK_AES, CKO_SECRET_KEY,
                                         mechanism->mechanism, key.get()));
   if (!mechanism->pParameter || mechanism->ulParameterLen != kIvBytes) {
@@ -275,28 +560,33 @@ absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesCbcEncrypter(
         SOURCE_LOCATION);
   }
 
-  CK_BYTE* iv;
+  PaddingMode padding;
   switch (mechanism->mechanism) {
     case CKM_AES_CBC:
-      iv = reinterpret_cast<CK_BYTE*>(mechanism->pParameter);
-      return std::make_unique<AesCbcEncrypter>(
-          key, absl::MakeSpan(iv, mechanism->ulParameterLen),
-          PaddingMode::kNone);
+      padding = PaddingMode::kNone;
+      break;
     case CKM_AES_CBC_PAD:
-      iv = reinterpret_cast<CK_BYTE*>(mechanism->pParameter);
-      return std::make_unique<AesCbcEncrypter>(
-          key, absl::MakeSpan(iv, mechanism->ulParameterLen),
-          PaddingMode::kPkcs7);
+      padding = PaddingMode::kPkcs7;
+      break;
     default:
       return NewInternalError(
           absl::StrFormat("Mechanism %#x not supported for AES-CBC encryption",
                           mechanism->mechanism),
           SOURCE_LOCATION);
   }
+
+  absl::Span<uint8_t> iv = absl::MakeSpan(
+      reinterpret_cast<CK_BYTE*>(mechanism->pParameter),
+      mechanism->ulParameterLen);
+  if (streaming) {
+    return std::make_unique<AesCbcStreamingEncrypter>(key, iv, padding);
+  }
+  return std::make_unique<AesCbcEncrypter>(key, iv, padding);
 }
 
 absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewAesCbcDecrypter(
-    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism) {
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism,
+    bool streaming) {
   RETURN_IF_ERROR(CheckKeyPreconditions(CKK_AES, CKO_SECRET_KEY,
                                         mechanism->mechanism, key.get()));
   if (!mechanism->pParameter || mechanism->ulParameterLen != kIvBytes) {
@@ -306,22 +596,28 @@ absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewAesCbcDecrypter(
         SOURCE_LOCATION);
   }
 
-  CK_BYTE* iv = reinterpret_cast<CK_BYTE*>(mechanism->pParameter);
+  PaddingMode padding;
   switch (mechanism->mechanism) {
     case CKM_AES_CBC:
-      return std::make_unique<AesCbcDecrypter>(
-          key, absl::MakeSpan(iv, mechanism->ulParameterLen),
-          PaddingMode::kNone);
+      padding = PaddingMode::kNone;
+      break;
     case CKM_AES_CBC_PAD:
-      return std::make_unique<AesCbcDecrypter>(
-          key, absl::MakeSpan(iv, mechanism->ulParameterLen),
-          PaddingMode::kPkcs7);
+      padding = PaddingMode::kPkcs7;
+      break;
     default:
       return NewInternalError(
           absl::StrFormat("Mechanism %#x not supported for AES-CBC decryption",
                           mechanism->mechanism),
           SOURCE_LOCATION);
   }
+
+  absl::Span<uint8_t> iv = absl::MakeSpan(
+      reinterpret_cast<CK_BYTE*>(mechanism->pParameter),
+      mechanism->ulParameterLen);
+  if (streaming) {
+    return std::make_unique<AesCbcStreamingDecrypter>(key, iv, padding);
+  }
+  return std::make_unique<AesCbcDecrypter>(key, iv, padding);
 }
 
 }  // namespace cloud_kms::kmsp11
@@ -26,13 +26,18 @@
 
 namespace cloud_kms::kmsp11 {
 
-// Returns an AesCbcEncrypter.
+// Returns an AesCbcEncrypter. If `streaming` is true, multi-part encryption
+// returns ciphertext from each EncryptUpdate call instead of buffering the
+// whole message until EncryptFinal.
 absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesCbcEncrypter(
-    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism);
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism,
+    bool streaming = false);
 
-// Returns an AesCbcDecrypter.
+// Returns an AesCbcDecrypter. If `streaming` is true, multi-part decryption
+// returns plaintext from each DecryptUpdate call.
 absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewAesCbcDecrypter(
-    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism);
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism,
+    bool streaming = false);
 
 }  // namespace cloud_kms::kmsp11
 
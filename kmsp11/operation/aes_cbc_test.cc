@@ -362,5 +362,137 @@ TEST_F(AesCbcTest, DecryptFailureKeyDisabled) {
               StatusRvIs(CKR_DEVICE_ERROR));
 }
 
+TEST_F(AesCbcTest, StreamingEncryptMatchesSinglePart) {
+  std::vector<uint8_t> plaintext(1000);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  CK_MECHANISM mechanism = NewAesCbcPaddingMechanism(iv_.data());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> single_part,
+                       NewAesCbcEncrypter(prv_, &mechanism));
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> single_part_ciphertext,
+                       single_part->Encrypt(client_.get(), plaintext));
+  std::vector<uint8_t> expected(single_part_ciphertext.begin(),
+                                single_part_ciphertext.end());
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCbcEncrypter(prv_, &mechanism, true));
+  std::vector<uint8_t> ciphertext;
+  absl::Span<const uint8_t> remaining(plaintext);
+  for (size_t part_size : {7, 100, 400, 493}) {
+    absl::Span<const uint8_t> part = remaining.subspan(0, part_size);
+    remaining.remove_prefix(part_size);
+
+    size_t expected_length = encrypter->EncryptUpdateOutputLength(part.size());
+    ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> output,
+                         encrypter->EncryptUpdate(client_.get(), part));
+    EXPECT_EQ(output.size(), expected_length);
+    ciphertext.insert(ciphertext.end(), output.begin(), output.end());
+  }
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> last,
+                       encrypter->EncryptFinal(client_.get()));
+  ciphertext.insert(ciphertext.end(), last.begin(), last.end());
+
+  EXPECT_EQ(ciphertext, expected);
+}
+
+TEST_F(AesCbcTest, StreamingPaddedDecryptHoldsBackLastBlock) {
+  std::vector<uint8_t> plaintext(48);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  CK_MECHANISM mechanism = NewAesCbcPaddingMechanism(iv_.data());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCbcEncrypter(prv_, &mechanism));
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                       encrypter->Encrypt(client_.get(), plaintext));
+  ASSERT_EQ(ciphertext.size(), 64);
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<DecrypterInterface> decrypter,
+                       NewAesCbcDecrypter(prv_, &mechanism, true));
+  EXPECT_EQ(decrypter->DecryptUpdateOutputLength(ciphertext.size()), 48);
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> output,
+                       decrypter->DecryptUpdate(client_.get(), ciphertext));
+  EXPECT_EQ(output, absl::MakeConstSpan(plaintext));
+
+  // The final block consists entirely of padding.
+  EXPECT_THAT(decrypter->DecryptFinal(client_.get()),
+              IsOkAndHolds(testing::IsEmpty()));
+}
+
+TEST_F(AesCbcTest, StreamingEncryptDecryptLargeMessageSuccess) {
+  // Larger than the 64 KiB limit that applies to non-streaming operations.
+  std::vector<uint8_t> plaintext(200 * 1024);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  CK_MECHANISM mechanism = NewAesCbcMechanism(iv_.data());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCbcEncrypter(prv_, &mechanism, true));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<DecrypterInterface> decrypter,
+                       NewAesCbcDecrypter(prv_, &mechanism, true));
+
+  std::vector<uint8_t> ciphertext;
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> output,
+                       encrypter->EncryptUpdate(client_.get(), plaintext));
+  ciphertext.insert(ciphertext.end(), output.begin(), output.end());
+  EXPECT_THAT(encrypter->EncryptFinal(client_.get()),
+              IsOkAndHolds(testing::IsEmpty()));
+  ASSERT_EQ(ciphertext.size(), plaintext.size());
+
+  std::vector<uint8_t> recovered;
+  absl::Span<const uint8_t> remaining(ciphertext);
+  while (!remaining.empty()) {
+    absl::Span<const uint8_t> part = remaining.subspan(0, 70001);
+    remaining.remove_prefix(part.size());
+    ASSERT_OK_AND_ASSIGN(output, decrypter->DecryptUpdate(client_.get(), part));
+    recovered.insert(recovered.end(), output.begin(), output.end());
+  }
+  EXPECT_THAT(decrypter->DecryptFinal(client_.get()),
+              IsOkAndHolds(testing::IsEmpty()));
+
+  EXPECT_EQ(recovered, plaintext);
+}
+
+TEST_F(AesCbcTest, StreamingFinalIsRepeatable) {
+  std::vector<uint8_t> plaintext(20);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  CK_MECHANISM mechanism = NewAesCbcPaddingMechanism(iv_.data());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCbcEncrypter(prv_, &mechanism, true));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<DecrypterInterface> decrypter,
+                       NewAesCbcDecrypter(prv_, &mechanism, true));
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> output,
+                       encrypter->EncryptUpdate(client_.get(), plaintext));
+  std::vector<uint8_t> ciphertext(output.begin(), output.end());
+  ASSERT_OK_AND_ASSIGN(output, encrypter->EncryptFinal(client_.get()));
+  std::vector<uint8_t> last(output.begin(), output.end());
+  EXPECT_EQ(last.size(), 16);
+  // A repeated call, as made after a query for the output length, returns the
+  // same output.
+  EXPECT_THAT(encrypter->EncryptFinal(client_.get()),
+              IsOkAndHolds(testing::ElementsAreArray(last)));
+  ciphertext.insert(ciphertext.end(), last.begin(), last.end());
+
+  ASSERT_OK_AND_ASSIGN(output,
+                       decrypter->DecryptUpdate(client_.get(), ciphertext));
+  EXPECT_EQ(output.size(), 16);
+  ASSERT_OK_AND_ASSIGN(output, decrypter->DecryptFinal(client_.get()));
+  last.assign(output.begin(), output.end());
+  EXPECT_EQ(absl::MakeConstSpan(last),
+            absl::MakeConstSpan(plaintext).subspan(16));
+  EXPECT_THAT(decrypter->DecryptFinal(client_.get()),
+              IsOkAndHolds(testing::ElementsAreArray(last)));
+}
+
+TEST_F(AesCbcTest, StreamingEncryptFinalFailurePartialBlock) {
+  CK_MECHANISM mechanism = NewAesCbcMechanism(iv_.data());
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCbcEncrypter(prv_, &mechanism, true));
+
+  EXPECT_OK(encrypter->EncryptUpdate(client_.get(), std::vector<uint8_t>(20)));
+  EXPECT_THAT(encrypter->EncryptFinal(client_.get()),
+              StatusRvIs(CKR_DATA_LEN_RANGE));
+}
+
 }  // namespace
 }  // namespace cloud_kms::kmsp11
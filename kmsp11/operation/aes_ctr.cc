@@ -14,7 +14,10 @@
 
 #include "kmsp11/operation/aes_ctr.h"
 
+#include <functional>
+
 #include "absl/cleanup/cleanup.h"
+#include "common/crc32c.h"
 #include "common/status_macros.h"
 #include "kmsp11/kmsp11.h"
 #include "kmsp11/object.h"
@@ -40,8 +43,8 @@ class AesCtrEncrypter : public EncrypterInterface {
 
   absl::StatusOr<absl::Span<const uint8_t>> Encrypt(
       KmsClient* client, absl::Span<const uint8_t> ciphertext) override;
-  absl::Status EncryptUpdate(KmsClient* client,
-                             absl::Span<const uint8_t> plaintext_part) override;
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> plaintext_part) override;
   absl::StatusOr<absl::Span<const uint8_t>> EncryptFinal(
       KmsClient* client) override;
 
@@ -55,7 +58,7 @@ class AesCtrEncrypter : public EncrypterInterface {
   const std::vector<uint8_t> iv_;
   std::optional<std::vector<uint8_t, ZeroDeallocator<uint8_t>>>
       plaintext_;  // for multi-part only
-  std::vector<uint8_t> ciphertext_;
+  std::unique_ptr<std::string> ciphertext_;
 };
 
 absl::StatusOr<absl::Span<const uint8_t>> AesCtrEncrypter::Encrypt(
@@ -68,7 +71,7 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCtrEncrypter::Encrypt(
   return EncryptInternal(client, plaintext);
 }
 
-absl::Status AesCtrEncrypter::EncryptUpdate(
+absl::StatusOr<absl::Span<const uint8_t>> AesCtrEncrypter::EncryptUpdate(
     KmsClient* client, absl::Span<const uint8_t> plaintext_part) {
   if (!plaintext_) {
     plaintext_.emplace();
@@ -87,7 +90,7 @@ absl::Status AesCtrEncrypter::EncryptUpdate(
   plaintext_->insert(plaintext_->end(), plaintext_part.begin(),
                      plaintext_part.end());
 
-  return absl::OkStatus();
+  return absl::Span<const uint8_t>();
 }
 
 absl::StatusOr<absl::Span<const uint8_t>> AesCtrEncrypter::EncryptFinal(
@@ -113,8 +116,8 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCtrEncrypter::EncryptInternal(
 
   kms_v1::RawEncryptRequest req;
   req.set_name(std::string(object_->kms_key_name()));
-  req.set_plaintext(std::string(reinterpret_cast<const char*>(plaintext.data()),
-                                plaintext.size()));
+  req.mutable_plaintext_crc32c()->set_value(
+      AssignWithCRC32C(plaintext, req.mutable_plaintext()));
   req.set_initialization_vector(
       std::string(reinterpret_cast<const char*>(iv_.data()), iv_.size()));
 
@@ -126,11 +129,8 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCtrEncrypter::EncryptInternal(
         SOURCE_LOCATION);
   }
 
-  ciphertext_.resize(resp.ciphertext().size());
-  std::copy_n(resp.ciphertext().begin(), resp.ciphertext().size(),
-              ciphertext_.begin());
-
-  return ciphertext_;
+  ciphertext_.reset(resp.release_ciphertext());
+  return SpanFromStr(*ciphertext_);
 }
 
 // An implementation of DecrypterInterface that decrypts AES-CTR ciphertexts
@@ -142,7 +142,7 @@ class AesCtrDecrypter : public DecrypterInterface {
 
   absl::StatusOr<absl::Span<const uint8_t>> Decrypt(
       KmsClient* client, absl::Span<const uint8_t> ciphertext) override;
-  absl::Status DecryptUpdate(
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptUpdate(
       KmsClient* client, absl::Span<const uint8_t> ciphertext_part) override;
   absl::StatusOr<absl::Span<const uint8_t>> DecryptFinal(
       KmsClient* client) override;
@@ -171,7 +171,7 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCtrDecrypter::Decrypt(
   return DecryptInternal(client, ciphertext);
 }
 
-absl::Status AesCtrDecrypter::DecryptUpdate(
+absl::StatusOr<absl::Span<const uint8_t>> AesCtrDecrypter::DecryptUpdate(
     KmsClient* client, absl::Span<const uint8_t> ciphertext_part) {
   if (!ciphertext_) {
     ciphertext_.emplace();
@@ -190,7 +190,7 @@ absl::Status AesCtrDecrypter::DecryptUpdate(
   ciphertext_->insert(ciphertext_->end(), ciphertext_part.begin(),
                       ciphertext_part.end());
 
-  return absl::OkStatus();
+  return absl::Span<const uint8_t>();
 }
 
 absl::StatusOr<absl::Span<const uint8_t>> AesCtrDecrypter::DecryptFinal(
@@ -208,17 +208,245 @@ absl::StatusOr<absl::Span<const uint8_t>> AesCtrDecrypter::DecryptInternal(
     KmsClient* client, absl::Span<const uint8_t> ciphertext) {
   kms_v1::RawDecryptRequest req;
   req.set_name(std::string(object_->kms_key_name()));
-  req.set_ciphertext(std::string(
-      reinterpret_cast<const char*>(ciphertext.data()), ciphertext.size()));
+  req.mutable_ciphertext_crc32c()->set_value(
+      AssignWithCRC32C(ciphertext, req.mutable_ciphertext()));
   req.set_initialization_vector(
       std::string(reinterpret_cast<const char*>(iv_.data()), iv_.size()));
   ASSIGN_OR_RETURN(kms_v1::RawDecryptResponse resp, client->RawDecrypt(req));
 
   plaintext_.reset(resp.release_plaintext());
-  return absl::MakeConstSpan(
-      reinterpret_cast<const uint8_t*>(plaintext_->data()), plaintext_->size());
+  return SpanFromStr(*plaintext_);
+}
+
+// Adds `blocks` to the 128-bit big-endian counter block `counter`.
+void AdvanceCounter(std::vector<uint8_t>& counter, uint64_t blocks) {
+  for (size_t i = counter.size(); i > 0 && blocks > 0; --i) {
+    uint64_t sum = counter[i - 1] + (blocks & 0xff);
+    counter[i - 1] = static_cast<uint8_t>(sum);
+    blocks = (blocks >> 8) + (sum >> 8);
+  }
 }
 
+// A streaming AES-CTR transform for multi-part operations. Input is processed
+// as soon as a full block is available, in RPCs of at most
+// kMaxPlaintextBytes, and the counter block is advanced across RPCs, so a
+// multi-part operation is not limited in size and only a partial block is
+// buffered between calls.
+class AesCtrStream {
+ public:
+  using Output = std::unique_ptr<std::string, ZeroDelete<std::string>>;
+  using Transform = std::function<absl::StatusOr<Output>(
+      KmsClient* client, absl::Span<const uint8_t> in,
+      absl::Span<const uint8_t> counter)>;
+
+  AesCtrStream(absl::Span<const uint8_t> iv, Transform transform)
+      : counter_(iv.begin(), iv.end()), transform_(std::move(transform)) {}
+
+  bool started() const { return started_; }
+
+  size_t UpdateOutputLength(size_t part_length) const {
+    return (pending_.size() + part_length) / kBlockBytes * kBlockBytes;
+  }
+
+  absl::StatusOr<absl::Span<const uint8_t>> Update(
+      KmsClient* client, absl::Span<const uint8_t> part) {
+    started_ = true;
+    pending_.insert(pending_.end(), part.begin(), part.end());
+
+    size_t aligned = pending_.size() / kBlockBytes * kBlockBytes;
+    outputs_.clear();
+    for (size_t offset = 0; offset < aligned; offset += kMaxPlaintextBytes) {
+      RETURN_IF_ERROR(Process(client, absl::MakeConstSpan(pending_).subspan(
+          offset, std::min(kMaxPlaintextBytes, aligned - offset))));
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + aligned);
+    return JoinOutputs();
+  }
+
+  // Processes the remaining partial block. A repeated call, which follows a
+  // query for the output length, returns the same output.
+  absl::StatusOr<absl::Span<const uint8_t>> Final(KmsClient* client) {
+    if (!finished_) {
+      outputs_.clear();
+      if (!pending_.empty()) {
+        RETURN_IF_ERROR(Process(client, pending_));
+        pending_.clear();
+      }
+      finished_ = true;
+    }
+    return JoinOutputs();
+  }
+
+ private:
+  static constexpr size_t kBlockBytes = 16;
+
+  // Returns the output of the RPCs made by the current call. The output of a
+  // single RPC, which is the common case, is returned in place.
+  absl::Span<const uint8_t> JoinOutputs() {
+    if (outputs_.size() == 1) {
+      return SpanFromStr(*outputs_.front());
+    }
+    joined_.clear();
+    for (const Output& out : outputs_) {
+      joined_.insert(joined_.end(), out->begin(), out->end());
+    }
+    return joined_;
+  }
+
+  absl::Status Process(KmsClient* client, absl::Span<const uint8_t> in) {
+    ASSIGN_OR_RETURN(Output out, transform_(client, in, counter_));
+    if (out->size() != in.size()) {
+      return NewInternalError(
+          absl::StrFormat("unexpected AES-CTR output length: got %d, want %d",
+                          out->size(), in.size()),
+          SOURCE_LOCATION);
+    }
+    outputs_.push_back(std::move(out));
+    AdvanceCounter(counter_, in.size() / kBlockBytes);
+    return absl::OkStatus();
+  }
+
+  std::vector<uint8_t> counter_;
+  Transform transform_;
+  bool started_ = false;
+  bool finished_ = false;
+  std::vector<uint8_t, ZeroDeallocator<uint8_t>> pending_;
+  std::vector<Output> outputs_;
+  std::vector<uint8_t, ZeroDeallocator<uint8_t>> joined_;
+};
+
+// An implementation of EncrypterInterface that streams multi-part AES-CTR
+// encryption through Cloud KMS.
+class AesCtrStreamingEncrypter : public EncrypterInterface {
+ public:
+  AesCtrStreamingEncrypter(std::shared_ptr<Object> object,
+                           absl::Span<const uint8_t> iv)
+      : single_part_(object, iv),
+        stream_(iv, [object](KmsClient* client,
+                             absl::Span<const uint8_t> plaintext,
+                             absl::Span<const uint8_t> counter)
+                        -> absl::StatusOr<AesCtrStream::Output> {
+          kms_v1::RawEncryptRequest req;
+          req.set_name(std::string(object->kms_key_name()));
+          req.mutable_plaintext_crc32c()->set_value(
+              AssignWithCRC32C(plaintext, req.mutable_plaintext()));
+          req.set_initialization_vector(std::string(
+              reinterpret_cast<const char*>(counter.data()), counter.size()));
+
+          ASSIGN_OR_RETURN(kms_v1::RawEncryptResponse resp,
+                           client->RawEncrypt(req));
+          if (req.initialization_vector() != resp.initialization_vector()) {
+            return NewInternalError(
+                "the IV returned by the server does not match user-supplied "
+                "IV",
+                SOURCE_LOCATION);
+          }
+          return AesCtrStream::Output(resp.release_ciphertext());
+        }) {}
+
+  absl::StatusOr<absl::Span<const uint8_t>> Encrypt(
+      KmsClient* client, absl::Span<const uint8_t> plaintext) override {
+    if (stream_.started()) {
+      return FailedPreconditionError(
+          "Encrypt cannot be used to terminate a multi-part encryption "
+          "operation",
+          CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+    }
+    return single_part_.Encrypt(client, plaintext);
+  }
+
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> plaintext_part) override {
+    return stream_.Update(client, plaintext_part);
+  }
+
+  size_t EncryptUpdateOutputLength(size_t plaintext_part_length) override {
+    return stream_.UpdateOutputLength(plaintext_part_length);
+  }
+
+  bool StreamsUpdateOutput() const override { return true; }
+
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptFinal(
+      KmsClient* client) override {
+    if (!stream_.started()) {
+      return FailedPreconditionError(
+          "EncryptUpdate needs to be called prior to terminating a multi-part "
+          "encryption operation",
+          CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+    }
+    return stream_.Final(client);
+  }
+
+  virtual ~AesCtrStreamingEncrypter() {}
+
+ private:
+  AesCtrEncrypter single_part_;
+  AesCtrStream stream_;
+};
+
+// An implementation of DecrypterInterface that streams multi-part AES-CTR
+// decryption through Cloud KMS.
+class AesCtrStreamingDecrypter : public DecrypterInterface {
+ public:
+  AesCtrStreamingDecrypter(std::shared_ptr<Object> object,
+                           absl::Span<const uint8_t> iv)
+      : single_part_(object, iv),
+        stream_(iv, [object](KmsClient* client,
+                             absl::Span<const uint8_t> ciphertext,
+                             absl::Span<const uint8_t> counter)
+                        -> absl::StatusOr<AesCtrStream::Output> {
+          kms_v1::RawDecryptRequest req;
+          req.set_name(std::string(object->kms_key_name()));
+          req.mutable_ciphertext_crc32c()->set_value(
+              AssignWithCRC32C(ciphertext, req.mutable_ciphertext()));
+          req.set_initialization_vector(std::string(
+              reinterpret_cast<const char*>(counter.data()), counter.size()));
+
+          ASSIGN_OR_RETURN(kms_v1::RawDecryptResponse resp,
+                           client->RawDecrypt(req));
+          return AesCtrStream::Output(resp.release_plaintext());
+        }) {}
+
+  absl::StatusOr<absl::Span<const uint8_t>> Decrypt(
+      KmsClient* client, absl::Span<const uint8_t> ciphertext) override {
+    if (stream_.started()) {
+      return FailedPreconditionError(
+          "Decrypt cannot be used to terminate a multi-part decryption "
+          "operation",
+          CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+    }
+    return single_part_.Decrypt(client, ciphertext);
+  }
+
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> ciphertext_part) override {
+    return stream_.Update(client, ciphertext_part);
+  }
+
+  size_t DecryptUpdateOutputLength(size_t ciphertext_part_length) override {
+    return stream_.UpdateOutputLength(ciphertext_part_length);
+  }
+
+  bool StreamsUpdateOutput() const override { return true; }
+
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptFinal(
+      KmsClient* client) override {
+    if (!stream_.started()) {
+      return FailedPreconditionError(
+          "DecryptUpdate needs to be called prior to terminating a multi-part "
+          "decryption operation",
+          CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+    }
+    return stream_.Final(client);
+  }
+
+  virtual ~AesCtrStreamingDecrypter() {}
+
+ private:
+  AesCtrDecrypter single_part_;
+  AesCtrStream stream_;
+};
+
 absl::StatusOr<absl::Span<const uint8_t>> ExtractIv(void* parameters,
                                                     CK_ULONG parameters_size) {
   if (parameters_size != sizeof(CK_AES_CTR_PARAMS)) {
@@ -242,7 +470,8 @@ absl::StatusOr<absl::Span<const uint8_t>> ExtractIv(void* parameters,
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesCtrEncrypter(
-    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism) {
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism,
+    bool streaming) {
   RETURN_IF_ERROR(CheckKeyPreconditions(CKK_AES, CKO_SECRET_KEY,
                                         mechanism->mechanism, key.get()));
 
@@ -251,6 +480,9 @@ absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesCtrEncrypter(
       ASSIGN_OR_RETURN(
           absl::Span<const uint8_t> iv,
           ExtractIv(mechanism->pParameter, mechanism->ulParameterLen));
+      if (streaming) {
+        return std::make_unique<AesCtrStreamingEncrypter>(key, iv);
+      }
       return std::make_unique<AesCtrEncrypter>(key, iv);
     }
     default:
@@ -262,7 +494,8 @@ absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesCtrEncrypter(
 }
 
 absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewAesCtrDecrypter(
-    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism) {
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism,
+    bool streaming) {
   RETURN_IF_ERROR(CheckKeyPreconditions(CKK_AES, CKO_SECRET_KEY,
                                         mechanism->mechanism, key.get()));
 
@@ -271,6 +504,9 @@ absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewAesCtrDecrypter(
       ASSIGN_OR_RETURN(
           absl::Span<const uint8_t> iv,
           ExtractIv(mechanism->pParameter, mechanism->ulParameterLen));
+      if (streaming) {
+        return std::make_unique<AesCtrStreamingDecrypter>(key, iv);
+      }
       return std::make_unique<AesCtrDecrypter>(key, iv);
     }
     default:
@@ -26,13 +26,18 @@
 
 namespace cloud_kms::kmsp11 {
 
-// Returns an AesCtrEncrypter.
+// Returns an AesCtrEncrypter. If `streaming` is true, multi-part encryption
+// returns ciphertext from each EncryptUpdate call instead of buffering the
+// whole message until EncryptFinal.
 absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesCtrEncrypter(
-    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism);
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism,
+    bool streaming = false);
 
-// Returns an AesCtrDecrypter.
+// Returns an AesCtrDecrypter. If `streaming` is true, multi-part decryption
+// returns plaintext from each DecryptUpdate call.
 absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewAesCtrDecrypter(
-    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism);
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism,
+    bool streaming = false);
 
 }  // namespace cloud_kms::kmsp11
 
@@ -307,5 +307,148 @@ TEST_F(AesCtrTest, DecryptFailureKeyDisabled) {
               StatusRvIs(CKR_DEVICE_ERROR));
 }
 
+TEST_F(AesCtrTest, StreamingEncryptMatchesSinglePart) {
+  std::vector<uint8_t> plaintext(1000);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> single_part,
+                       encrypter_->Encrypt(client_.get(), plaintext));
+  std::vector<uint8_t> expected(single_part.begin(), single_part.end());
+
+  CK_AES_CTR_PARAMS params = NewCtrParams(iv_.data());
+  CK_MECHANISM mechanism = NewAesCtrMechanism(&params);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCtrEncrypter(prv_, &mechanism, true));
+
+  std::vector<uint8_t> ciphertext;
+  absl::Span<const uint8_t> remaining(plaintext);
+  for (size_t part_size : {7, 100, 400, 493}) {
+    absl::Span<const uint8_t> part = remaining.subspan(0, part_size);
+    remaining.remove_prefix(part_size);
+
+    size_t expected_length = encrypter->EncryptUpdateOutputLength(part.size());
+    ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> output,
+                         encrypter->EncryptUpdate(client_.get(), part));
+    EXPECT_EQ(output.size(), expected_length);
+    EXPECT_EQ(output.size() % 16, 0);
+    ciphertext.insert(ciphertext.end(), output.begin(), output.end());
+  }
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> last,
+                       encrypter->EncryptFinal(client_.get()));
+  ciphertext.insert(ciphertext.end(), last.begin(), last.end());
+
+  EXPECT_EQ(ciphertext, expected);
+}
+
+TEST_F(AesCtrTest, StreamingCounterCarriesAcrossBytes) {
+  std::vector<uint8_t> iv(16, 0xff);
+  iv[0] = 0x00;
+  iv[14] = 0xfe;
+  CK_AES_CTR_PARAMS params = NewCtrParams(iv.data());
+  CK_MECHANISM mechanism = NewAesCtrMechanism(&params);
+
+  std::vector<uint8_t> plaintext(128);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> single_part,
+                       NewAesCtrEncrypter(prv_, &mechanism));
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> expected,
+                       single_part->Encrypt(client_.get(), plaintext));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCtrEncrypter(prv_, &mechanism, true));
+  std::vector<uint8_t> ciphertext;
+  for (size_t offset = 0; offset < plaintext.size(); offset += 16) {
+    ASSERT_OK_AND_ASSIGN(
+        absl::Span<const uint8_t> output,
+        encrypter->EncryptUpdate(
+            client_.get(), absl::MakeConstSpan(plaintext).subspan(offset, 16)));
+    ciphertext.insert(ciphertext.end(), output.begin(), output.end());
+  }
+  EXPECT_THAT(encrypter->EncryptFinal(client_.get()),
+              IsOkAndHolds(testing::IsEmpty()));
+
+  EXPECT_EQ(absl::MakeConstSpan(ciphertext), expected);
+}
+
+TEST_F(AesCtrTest, StreamingEncryptDecryptLargeMessageSuccess) {
+  // Larger than the 64 KiB limit that applies to non-streaming operations.
+  std::vector<uint8_t> plaintext(200 * 1024 + 5);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  CK_AES_CTR_PARAMS params = NewCtrParams(iv_.data());
+  CK_MECHANISM mechanism = NewAesCtrMechanism(&params);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCtrEncrypter(prv_, &mechanism, true));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<DecrypterInterface> decrypter,
+                       NewAesCtrDecrypter(prv_, &mechanism, true));
+
+  std::vector<uint8_t> ciphertext;
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> output,
+                       encrypter->EncryptUpdate(client_.get(), plaintext));
+  ciphertext.insert(ciphertext.end(), output.begin(), output.end());
+  ASSERT_OK_AND_ASSIGN(output, encrypter->EncryptFinal(client_.get()));
+  ciphertext.insert(ciphertext.end(), output.begin(), output.end());
+  ASSERT_EQ(ciphertext.size(), plaintext.size());
+
+  std::vector<uint8_t> recovered;
+  absl::Span<const uint8_t> remaining(ciphertext);
+  while (!remaining.empty()) {
+    absl::Span<const uint8_t> part = remaining.subspan(0, 70000);
+    remaining.remove_prefix(part.size());
+    ASSERT_OK_AND_ASSIGN(output, decrypter->DecryptUpdate(client_.get(), part));
+    recovered.insert(recovered.end(), output.begin(), output.end());
+  }
+  ASSERT_OK_AND_ASSIGN(output, decrypter->DecryptFinal(client_.get()));
+  recovered.insert(recovered.end(), output.begin(), output.end());
+
+  EXPECT_EQ(recovered, plaintext);
+}
+
+TEST_F(AesCtrTest, StreamingFinalIsRepeatable) {
+  std::vector<uint8_t> plaintext(20);
+  RAND_bytes(plaintext.data(), plaintext.size());
+
+  CK_AES_CTR_PARAMS params = NewCtrParams(iv_.data());
+  CK_MECHANISM mechanism = NewAesCtrMechanism(&params);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCtrEncrypter(prv_, &mechanism, true));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<DecrypterInterface> decrypter,
+                       NewAesCtrDecrypter(prv_, &mechanism, true));
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> output,
+                       encrypter->EncryptUpdate(client_.get(), plaintext));
+  std::vector<uint8_t> ciphertext(output.begin(), output.end());
+  ASSERT_OK_AND_ASSIGN(output, encrypter->EncryptFinal(client_.get()));
+  std::vector<uint8_t> last(output.begin(), output.end());
+  EXPECT_EQ(last.size(), 4);
+  // A repeated call, as made after a query for the output length, returns the
+  // same output.
+  EXPECT_THAT(encrypter->EncryptFinal(client_.get()),
+              IsOkAndHolds(testing::ElementsAreArray(last)));
+  ciphertext.insert(ciphertext.end(), last.begin(), last.end());
+
+  ASSERT_OK_AND_ASSIGN(output,
+                       decrypter->DecryptUpdate(client_.get(), ciphertext));
+  EXPECT_EQ(output.size(), 16);
+  ASSERT_OK_AND_ASSIGN(output, decrypter->DecryptFinal(client_.get()));
+  last.assign(output.begin(), output.end());
+  EXPECT_EQ(absl::MakeConstSpan(last),
+            absl::MakeConstSpan(plaintext).subspan(16));
+  EXPECT_THAT(decrypter->DecryptFinal(client_.get()),
+              IsOkAndHolds(testing::ElementsAreArray(last)));
+}
+
+TEST_F(AesCtrTest, StreamingEncryptFailsAfterUpdate) {
+  CK_AES_CTR_PARAMS params = NewCtrParams(iv_.data());
+  CK_MECHANISM mechanism = NewAesCtrMechanism(&params);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EncrypterInterface> encrypter,
+                       NewAesCtrEncrypter(prv_, &mechanism, true));
+
+  EXPECT_OK(encrypter->EncryptUpdate(client_.get(), std::vector<uint8_t>(8)));
+  EXPECT_THAT(encrypter->Encrypt(client_.get(), std::vector<uint8_t>(8)),
+              StatusRvIs(CKR_FUNCTION_FAILED));
+}
+
 }  // namespace
 }  // namespace cloud_kms::kmsp11
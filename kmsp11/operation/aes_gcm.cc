@@ -15,6 +15,7 @@
 #include "kmsp11/operation/aes_gcm.h"
 
 #include "absl/cleanup/cleanup.h"
+#include "common/crc32c.h"
 #include "common/status_macros.h"
 #include "kmsp11/kmsp11.h"
 #include "kmsp11/object.h"
@@ -44,8 +45,8 @@ class AesGcmEncrypter : public EncrypterInterface {
 
   absl::StatusOr<absl::Span<const uint8_t>> Encrypt(
       KmsClient* client, absl::Span<const uint8_t> ciphertext) override;
-  absl::Status EncryptUpdate(KmsClient* client,
-                             absl::Span<const uint8_t> plaintext_part) override;
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> plaintext_part) override;
   absl::StatusOr<absl::Span<const uint8_t>> EncryptFinal(
       KmsClient* client) override;
 
@@ -60,7 +61,7 @@ class AesGcmEncrypter : public EncrypterInterface {
   std::string aad_;
   std::optional<std::vector<uint8_t, ZeroDeallocator<uint8_t>>>
       plaintext_;  // for multi-part only
-  std::vector<uint8_t> ciphertext_;
+  std::unique_ptr<std::string> ciphertext_;
 };
 
 absl::StatusOr<absl::Span<const uint8_t>> AesGcmEncrypter::Encrypt(
@@ -82,7 +83,7 @@ absl::StatusOr<absl::Span<const uint8_t>> AesGcmEncrypter::Encrypt(
   return EncryptInternal(client, plaintext);
 }
 
-absl::Status AesGcmEncrypter::EncryptUpdate(
+absl::StatusOr<absl::Span<const uint8_t>> AesGcmEncrypter::EncryptUpdate(
     KmsClient* client, absl::Span<const uint8_t> plaintext_part) {
   if (!plaintext_) {
     plaintext_.emplace();
@@ -101,7 +102,7 @@ absl::Status AesGcmEncrypter::EncryptUpdate(
   plaintext_->insert(plaintext_->end(), plaintext_part.begin(),
                      plaintext_part.end());
 
-  return absl::OkStatus();
+  return absl::Span<const uint8_t>();
 }
 
 absl::StatusOr<absl::Span<const uint8_t>> AesGcmEncrypter::EncryptFinal(
@@ -120,8 +121,8 @@ absl::StatusOr<absl::Span<const uint8_t>> AesGcmEncrypter::EncryptInternal(
     KmsClient* client, absl::Span<const uint8_t> plaintext) {
   kms_v1::RawEncryptRequest req;
   req.set_name(std::string(object_->kms_key_name()));
-  req.set_plaintext(std::string(reinterpret_cast<const char*>(plaintext.data()),
-                                plaintext.size()));
+  req.mutable_plaintext_crc32c()->set_value(
+      AssignWithCRC32C(plaintext, req.mutable_plaintext()));
   req.set_additional_authenticated_data(aad_);
 
   ASSIGN_OR_RETURN(kms_v1::RawEncryptResponse resp, client->RawEncrypt(req));
@@ -129,11 +130,8 @@ absl::StatusOr<absl::Span<const uint8_t>> AesGcmEncrypter::EncryptInternal(
   std::copy_n(resp.initialization_vector().begin(),
               resp.initialization_vector().size(), iv_.begin());
 
-  ciphertext_.resize(resp.ciphertext().size());
-  std::copy_n(resp.ciphertext().begin(), resp.ciphertext().size(),
-              ciphertext_.begin());
-
-  return ciphertext_;
+  ciphertext_.reset(resp.release_ciphertext());
+  return SpanFromStr(*ciphertext_);
 }
 
 // An implementation of DecrypterInterface that decrypts AES-GCM ciphertexts
@@ -148,7 +146,7 @@ class AesGcmDecrypter : public DecrypterInterface {
 
   absl::StatusOr<absl::Span<const uint8_t>> Decrypt(
       KmsClient* client, absl::Span<const uint8_t> ciphertext) override;
-  absl::Status DecryptUpdate(
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptUpdate(
       KmsClient* client, absl::Span<const uint8_t> ciphertext_part) override;
   absl::StatusOr<absl::Span<const uint8_t>> DecryptFinal(
       KmsClient* client) override;
@@ -179,7 +177,7 @@ absl::StatusOr<absl::Span<const uint8_t>> AesGcmDecrypter::Decrypt(
   return DecryptInternal(client, ciphertext);
 }
 
-absl::Status AesGcmDecrypter::DecryptUpdate(
+absl::StatusOr<absl::Span<const uint8_t>> AesGcmDecrypter::DecryptUpdate(
     KmsClient* client, absl::Span<const uint8_t> ciphertext_part) {
   if (!ciphertext_) {
     ciphertext_.emplace();
@@ -198,7 +196,7 @@ absl::Status AesGcmDecrypter::DecryptUpdate(
   ciphertext_->insert(ciphertext_->end(), ciphertext_part.begin(),
                       ciphertext_part.end());
 
-  return absl::OkStatus();
+  return absl::Span<const uint8_t>();
 }
 
 absl::StatusOr<absl::Span<const uint8_t>> AesGcmDecrypter::DecryptFinal(
@@ -217,8 +215,8 @@ absl::StatusOr<absl::Span<const uint8_t>> AesGcmDecrypter::DecryptInternal(
     KmsClient* client, absl::Span<const uint8_t> ciphertext) {
   kms_v1::RawDecryptRequest req;
   req.set_name(std::string(object_->kms_key_name()));
-  req.set_ciphertext(std::string(
-      reinterpret_cast<const char*>(ciphertext.data()), ciphertext.size()));
+  req.mutable_ciphertext_crc32c()->set_value(
+      AssignWithCRC32C(ciphertext, req.mutable_ciphertext()));
   req.set_initialization_vector(reinterpret_cast<const char*>(iv_.data()),
                                 iv_.size());
   req.set_additional_authenticated_data(aad_);
@@ -226,8 +224,7 @@ absl::StatusOr<absl::Span<const uint8_t>> AesGcmDecrypter::DecryptInternal(
   ASSIGN_OR_RETURN(kms_v1::RawDecryptResponse resp, client->RawDecrypt(req));
 
   plaintext_.reset(resp.release_plaintext());
-  return absl::MakeConstSpan(
-      reinterpret_cast<const uint8_t*>(plaintext_->data()), plaintext_->size());
+  return SpanFromStr(*plaintext_);
 }
 
 absl::StatusOr<CK_GCM_PARAMS> ExtractGcmParameters(void* parameters,
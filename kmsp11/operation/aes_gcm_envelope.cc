@@ -0,0 +1,629 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/operation/aes_gcm_envelope.h"
+
+#include <algorithm>
+#include <string_view>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "common/kms_client.h"
+#include "common/openssl.h"
+#include "common/status_macros.h"
+#include "kmsp11/kmsp11.h"
+#include "kmsp11/object.h"
+#include "kmsp11/operation/preconditions.h"
+#include "kmsp11/util/crypto_utils.h"
+#include "kmsp11/util/errors.h"
+#include "openssl/hmac.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+// The ciphertext layout is documented alongside the mechanism definition in
+// kmsp11.h.
+constexpr std::string_view kMagic = "KMSE";
+constexpr uint8_t kVersion = 1;
+constexpr size_t kDataKeyBytes = 32;
+constexpr size_t kIvBytes = 12;
+constexpr size_t kSaltBytes = 16;
+constexpr size_t kTagBytes = 16;
+// Cloud KMS appends a 16-byte tag to raw AES-GCM ciphertexts.
+constexpr size_t kWrappedKeyBytes = kDataKeyBytes + 16;
+// magic | version | wrapped key length
+constexpr size_t kFixedHeaderBytes = kMagic.size() + 1 + 2;
+constexpr size_t kHeaderBytes =
+    kFixedHeaderBytes + kWrappedKeyBytes + kIvBytes + kSaltBytes;
+// The plaintext length of every segment but the last.
+constexpr size_t kSegmentBytes = 64 * 1024;
+constexpr size_t kSegmentCiphertextBytes = kSegmentBytes + kTagBytes;
+// Segment indexes are encoded in 4 bytes of the nonce.
+constexpr uint64_t kMaxSegments = uint64_t{1} << 32;
+// EVP_CipherUpdate takes an int length, so larger inputs are split.
+constexpr size_t kMaxCipherUpdateBytes = 1 << 30;
+
+using SecretBytes = std::vector<uint8_t, ZeroDeallocator<uint8_t>>;
+
+// Returns the number of complete segments of `segment_length` bytes in
+// `length` bytes of input that are known not to be the last segment, because
+// more input follows them. The last segment may be a complete one.
+size_t LeadingSegments(size_t length, size_t segment_length) {
+  return length == 0 ? 0 : (length - 1) / segment_length;
+}
+
+// Runs the provided input through ctx, appending the output to `output`.
+template <typename Allocator>
+absl::Status CipherUpdate(EVP_CIPHER_CTX* ctx, absl::Span<const uint8_t> input,
+                          std::vector<uint8_t, Allocator>* output) {
+  size_t offset = output->size();
+  output->resize(offset + input.size());
+  while (!input.empty()) {
+    size_t chunk = std::min(input.size(), kMaxCipherUpdateBytes);
+    int out_len;
+    if (!EVP_CipherUpdate(ctx, output->data() + offset, &out_len, input.data(),
+                          chunk)) {
+      return NewInternalError(
+          absl::StrCat("error processing data: ", SslErrorToString()),
+          SOURCE_LOCATION);
+    }
+    offset += out_len;
+    input.remove_prefix(chunk);
+  }
+  output->resize(offset);
+  return absl::OkStatus();
+}
+
+// Encrypts or decrypts the segments of one envelope ciphertext, in order. Each
+// segment is sealed with AES-256-GCM under a key derived from the data key and
+// the ciphertext's salt. The nonce encodes the segment index and whether the
+// segment is the last one, so segments can't be reordered, dropped, or
+// truncated without failing authentication.
+class SegmentCipher {
+ public:
+  static absl::StatusOr<std::unique_ptr<SegmentCipher>> New(
+      bool encrypt, absl::Span<const uint8_t> data_key, std::string_view salt,
+      std::string associated_data);
+
+  // Encrypts `plaintext` as the next segment, and appends the encrypted
+  // segment and its tag to `output`.
+  absl::Status Seal(absl::Span<const uint8_t> plaintext, bool last,
+                    std::vector<uint8_t>* output);
+
+  // Authenticates and decrypts `segment`, which ends with its tag, as the next
+  // segment, and appends the plaintext to `output`. Nothing is appended if the
+  // segment can't be authenticated.
+  absl::Status Open(absl::Span<const uint8_t> segment, bool last,
+                    SecretBytes* output);
+
+ private:
+  SegmentCipher(bssl::UniquePtr<EVP_CIPHER_CTX> ctx,
+                std::string associated_data)
+      : ctx_(std::move(ctx)), associated_data_(std::move(associated_data)) {}
+
+  // Sets the nonce for the next segment, and processes the associated data.
+  absl::Status StartSegment(bool last);
+
+  bssl::UniquePtr<EVP_CIPHER_CTX> ctx_;
+  // The header and the AAD, which are authenticated with every segment.
+  std::string associated_data_;
+  uint64_t next_index_ = 0;
+};
+
+absl::StatusOr<std::unique_ptr<SegmentCipher>> SegmentCipher::New(
+    bool encrypt, absl::Span<const uint8_t> data_key, std::string_view salt,
+    std::string associated_data) {
+  uint8_t segment_key[kDataKeyBytes];
+  unsigned int segment_key_length;
+  if (!HMAC(EVP_sha256(), data_key.data(), data_key.size(),
+            reinterpret_cast<const uint8_t*>(salt.data()), salt.size(),
+            segment_key, &segment_key_length)) {
+    return NewInternalError(
+        absl::StrCat("error deriving segment key: ", SslErrorToString()),
+        SOURCE_LOCATION);
+  }
+
+  bssl::UniquePtr<EVP_CIPHER_CTX> ctx(EVP_CIPHER_CTX_new());
+  bool initialized =
+      ctx && EVP_CipherInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr,
+                               segment_key, nullptr, encrypt ? 1 : 0);
+  OPENSSL_cleanse(segment_key, sizeof(segment_key));
+  if (!initialized) {
+    return NewInternalError(
+        absl::StrCat("error initializing AES-GCM: ", SslErrorToString()),
+        SOURCE_LOCATION);
+  }
+  return absl::WrapUnique(
+      new SegmentCipher(std::move(ctx), std::move(associated_data)));
+}
+
+absl::Status SegmentCipher::StartSegment(bool last) {
+  if (next_index_ >= kMaxSegments) {
+    return NewInvalidArgumentError(
+        "data is too long for an envelope ciphertext",
+        EVP_CIPHER_CTX_encrypting(ctx_.get()) ? CKR_DATA_LEN_RANGE
+                                              : CKR_ENCRYPTED_DATA_LEN_RANGE,
+        SOURCE_LOCATION);
+  }
+
+  // 7 zero bytes | segment index (4 bytes, big-endian) | last segment flag
+  uint8_t nonce[kIvBytes] = {};
+  for (int i = 0; i < 4; i++) {
+    nonce[7 + i] = static_cast<uint8_t>(next_index_ >> (8 * (3 - i)));
+  }
+  nonce[11] = last ? 1 : 0;
+  next_index_++;
+
+  int out_len;
+  if (!EVP_CipherInit_ex(ctx_.get(), nullptr, nullptr, nullptr, nonce, -1) ||
+      !EVP_CipherUpdate(
+          ctx_.get(), nullptr, &out_len,
+          reinterpret_cast<const uint8_t*>(associated_data_.data()),
+          associated_data_.size())) {
+    return NewInternalError(
+        absl::StrCat("error starting segment: ", SslErrorToString()),
+        SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SegmentCipher::Seal(absl::Span<const uint8_t> plaintext,
+                                 bool last, std::vector<uint8_t>* output) {
+  RETURN_IF_ERROR(StartSegment(last));
+  RETURN_IF_ERROR(CipherUpdate(ctx_.get(), plaintext, output));
+
+  int out_len;
+  uint8_t tag[kTagBytes];
+  if (!EVP_EncryptFinal_ex(ctx_.get(), nullptr, &out_len) ||
+      !EVP_CIPHER_CTX_ctrl(ctx_.get(), EVP_CTRL_GCM_GET_TAG, kTagBytes, tag)) {
+    return NewInternalError(
+        absl::StrCat("error finalizing AES-GCM: ", SslErrorToString()),
+        SOURCE_LOCATION);
+  }
+  output->insert(output->end(), std::begin(tag), std::end(tag));
+  return absl::OkStatus();
+}
+
+absl::Status SegmentCipher::Open(absl::Span<const uint8_t> segment, bool last,
+                                 SecretBytes* output) {
+  if (segment.size() < kTagBytes) {
+    return NewInvalidArgumentError("ciphertext is too short",
+                                   CKR_ENCRYPTED_DATA_LEN_RANGE,
+                                   SOURCE_LOCATION);
+  }
+  RETURN_IF_ERROR(StartSegment(last));
+
+  size_t offset = output->size();
+  absl::Span<const uint8_t> encrypted =
+      segment.subspan(0, segment.size() - kTagBytes);
+  absl::Span<const uint8_t> tag = segment.subspan(encrypted.size());
+  RETURN_IF_ERROR(CipherUpdate(ctx_.get(), encrypted, output));
+
+  int out_len;
+  if (!EVP_CIPHER_CTX_ctrl(ctx_.get(), EVP_CTRL_GCM_SET_TAG, kTagBytes,
+                           const_cast<uint8_t*>(tag.data())) ||
+      !EVP_DecryptFinal_ex(ctx_.get(), nullptr, &out_len)) {
+    OPENSSL_cleanse(output->data() + offset, output->size() - offset);
+    output->resize(offset);
+    return NewInvalidArgumentError("ciphertext could not be authenticated",
+                                   CKR_ENCRYPTED_DATA_INVALID, SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+// The parsed header of an envelope ciphertext.
+struct EnvelopeHeader {
+  std::string_view wrapped_key;
+  std::string_view wrapping_iv;
+  std::string_view salt;
+};
+
+// Parses the header at the start of an envelope ciphertext.
+absl::StatusOr<EnvelopeHeader> ParseHeader(std::string_view header) {
+  if (header.size() != kHeaderBytes || !absl::StartsWith(header, kMagic) ||
+      header[kMagic.size()] != kVersion ||
+      header[kMagic.size() + 1] != (kWrappedKeyBytes >> 8) ||
+      header[kMagic.size() + 2] != (kWrappedKeyBytes & 0xff)) {
+    return NewInvalidArgumentError(
+        "ciphertext is not a supported envelope ciphertext",
+        CKR_ENCRYPTED_DATA_INVALID, SOURCE_LOCATION);
+  }
+  header.remove_prefix(kFixedHeaderBytes);
+  return EnvelopeHeader{
+      header.substr(0, kWrappedKeyBytes),
+      header.substr(kWrappedKeyBytes, kIvBytes),
+      header.substr(kWrappedKeyBytes + kIvBytes, kSaltBytes),
+  };
+}
+
+// An implementation of EncrypterInterface that encrypts data locally under a
+// data key wrapped by Cloud KMS.
+class AesGcmEnvelopeEncrypter : public EncrypterInterface {
+ public:
+  AesGcmEnvelopeEncrypter(std::shared_ptr<Object> object,
+                          absl::Span<const uint8_t> aad)
+      : object_(object),
+        aad_(reinterpret_cast<const char*>(aad.data()), aad.size()) {}
+
+  absl::StatusOr<absl::Span<const uint8_t>> Encrypt(
+      KmsClient* client, absl::Span<const uint8_t> plaintext) override;
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> plaintext_part) override;
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptFinal(
+      KmsClient* client) override;
+  size_t EncryptUpdateOutputLength(size_t plaintext_part_length) override;
+  bool StreamsUpdateOutput() const override { return true; }
+
+  virtual ~AesGcmEnvelopeEncrypter() {}
+
+ private:
+  // Starts a new ciphertext with a fresh salt, and writes its header to
+  // ciphertext_. The data key is generated and wrapped on first use, and is
+  // reused for the lifetime of this operation.
+  absl::Status Begin(KmsClient* client);
+
+  std::shared_ptr<Object> object_;
+  std::string aad_;
+  SecretBytes data_key_;
+  std::string wrapped_key_;
+  std::string wrapping_iv_;
+  std::unique_ptr<SegmentCipher> cipher_;
+  bool multi_part_ = false;
+  bool finished_ = false;
+  // Plaintext that has not yet been encrypted, which is less than a segment,
+  // or a complete segment that may turn out to be the last one.
+  SecretBytes pending_;
+  std::vector<uint8_t> ciphertext_;
+};
+
+absl::StatusOr<absl::Span<const uint8_t>> AesGcmEnvelopeEncrypter::Encrypt(
+    KmsClient* client, absl::Span<const uint8_t> plaintext) {
+  if (multi_part_) {
+    return FailedPreconditionError(
+        "Encrypt cannot be used to terminate a multi-part encryption operation",
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+
+  size_t segments = LeadingSegments(plaintext.size(), kSegmentBytes) + 1;
+  ciphertext_.clear();
+  ciphertext_.reserve(kHeaderBytes + plaintext.size() + segments * kTagBytes);
+  RETURN_IF_ERROR(Begin(client));
+  for (size_t i = 1; i < segments; i++) {
+    RETURN_IF_ERROR(cipher_->Seal(plaintext.subspan(0, kSegmentBytes),
+                                  /*last=*/false, &ciphertext_));
+    plaintext.remove_prefix(kSegmentBytes);
+  }
+  RETURN_IF_ERROR(cipher_->Seal(plaintext, /*last=*/true, &ciphertext_));
+  return ciphertext_;
+}
+
+absl::StatusOr<absl::Span<const uint8_t>>
+AesGcmEnvelopeEncrypter::EncryptUpdate(
+    KmsClient* client, absl::Span<const uint8_t> plaintext_part) {
+  ciphertext_.clear();
+  if (!multi_part_) {
+    RETURN_IF_ERROR(Begin(client));
+    multi_part_ = true;
+  }
+
+  // A complete segment is only encrypted once more plaintext follows it, since
+  // the last segment is sealed differently.
+  while (pending_.size() + plaintext_part.size() > kSegmentBytes) {
+    if (pending_.empty()) {
+      RETURN_IF_ERROR(cipher_->Seal(plaintext_part.subspan(0, kSegmentBytes),
+                                    /*last=*/false, &ciphertext_));
+      plaintext_part.remove_prefix(kSegmentBytes);
+      continue;
+    }
+    size_t fill = kSegmentBytes - pending_.size();
+    pending_.insert(pending_.end(), plaintext_part.begin(),
+                    plaintext_part.begin() + fill);
+    plaintext_part.remove_prefix(fill);
+    RETURN_IF_ERROR(cipher_->Seal(pending_, /*last=*/false, &ciphertext_));
+    pending_.clear();
+  }
+  pending_.insert(pending_.end(), plaintext_part.begin(), plaintext_part.end());
+  return ciphertext_;
+}
+
+absl::StatusOr<absl::Span<const uint8_t>> AesGcmEnvelopeEncrypter::EncryptFinal(
+    KmsClient* client) {
+  if (!multi_part_) {
+    return FailedPreconditionError(
+        "EncryptUpdate needs to be called prior to terminating a multi-part "
+        "encryption operation",
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+
+  // A repeated call, which follows a query for the output length, returns the
+  // same final segment.
+  if (!finished_) {
+    ciphertext_.clear();
+    RETURN_IF_ERROR(cipher_->Seal(pending_, /*last=*/true, &ciphertext_));
+    pending_.clear();
+    finished_ = true;
+  }
+  return ciphertext_;
+}
+
+size_t AesGcmEnvelopeEncrypter::EncryptUpdateOutputLength(
+    size_t plaintext_part_length) {
+  return (multi_part_ ? 0 : kHeaderBytes) +
+         LeadingSegments(pending_.size() + plaintext_part_length,
+                         kSegmentBytes) *
+             kSegmentCiphertextBytes;
+}
+
+absl::Status AesGcmEnvelopeEncrypter::Begin(KmsClient* client) {
+  if (data_key_.empty()) {
+    std::string data_key = RandBytes(kDataKeyBytes);
+    data_key_.assign(data_key.begin(), data_key.end());
+    OPENSSL_cleanse(data_key.data(), data_key.size());
+
+    kms_v1::RawEncryptRequest req;
+    req.set_name(std::string(object_->kms_key_name()));
+    req.set_plaintext(reinterpret_cast<const char*>(data_key_.data()),
+                      data_key_.size());
+    req.set_additional_authenticated_data(aad_);
+
+    absl::StatusOr<kms_v1::RawEncryptResponse> resp = client->RawEncrypt(req);
+    OPENSSL_cleanse(req.mutable_plaintext()->data(), req.plaintext().size());
+    if (!resp.ok()) {
+      data_key_.clear();
+      return resp.status();
+    }
+    if (resp->ciphertext().size() != kWrappedKeyBytes ||
+        resp->initialization_vector().size() != kIvBytes) {
+      data_key_.clear();
+      return NewInternalError(
+          absl::StrFormat("unexpected wrapped data key length %d",
+                          resp->ciphertext().size()),
+          SOURCE_LOCATION);
+    }
+    wrapped_key_ = resp->ciphertext();
+    wrapping_iv_ = resp->initialization_vector();
+  }
+
+  std::string salt = RandBytes(kSaltBytes);
+  std::string header;
+  header.reserve(kHeaderBytes);
+  header.append(kMagic);
+  header.push_back(static_cast<char>(kVersion));
+  header.push_back(static_cast<char>((wrapped_key_.size() >> 8) & 0xff));
+  header.push_back(static_cast<char>(wrapped_key_.size() & 0xff));
+  header.append(wrapped_key_);
+  header.append(wrapping_iv_);
+  header.append(salt);
+
+  ciphertext_.insert(ciphertext_.end(), header.begin(), header.end());
+  ASSIGN_OR_RETURN(cipher_,
+                   SegmentCipher::New(/*encrypt=*/true, data_key_, salt,
+                                      absl::StrCat(header, aad_)));
+  return absl::OkStatus();
+}
+
+// An implementation of DecrypterInterface that decrypts ciphertexts produced
+// by AesGcmEnvelopeEncrypter. Plaintext is released one segment at a time, once
+// the segment has been authenticated.
+class AesGcmEnvelopeDecrypter : public DecrypterInterface {
+ public:
+  AesGcmEnvelopeDecrypter(std::shared_ptr<Object> object,
+                          absl::Span<const uint8_t> aad)
+      : object_(object),
+        aad_(reinterpret_cast<const char*>(aad.data()), aad.size()) {}
+
+  absl::StatusOr<absl::Span<const uint8_t>> Decrypt(
+      KmsClient* client, absl::Span<const uint8_t> ciphertext) override;
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> ciphertext_part) override;
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptFinal(
+      KmsClient* client) override;
+  size_t DecryptUpdateOutputLength(size_t ciphertext_part_length) override;
+  bool StreamsUpdateOutput() const override { return true; }
+
+  virtual ~AesGcmEnvelopeDecrypter() {}
+
+ private:
+  // Decrypts the segments of `data` that are known not to be the last one,
+  // appending their plaintext to plaintext_.
+  absl::Status Update(KmsClient* client, absl::Span<const uint8_t> data);
+  absl::Status Begin(KmsClient* client, std::string_view header);
+  // Decrypts the last segment, appending its plaintext to plaintext_.
+  absl::Status Finish();
+
+  std::shared_ptr<Object> object_;
+  std::string aad_;
+  // The most recently unwrapped data key, and the wrapped key it came from.
+  std::string wrapped_key_;
+  SecretBytes data_key_;
+  std::unique_ptr<SegmentCipher> cipher_;
+  bool multi_part_ = false;
+  bool finished_ = false;
+  // Before the header is parsed, the header bytes received so far. After the
+  // header is parsed, ciphertext that has not yet been decrypted, which is
+  // less than a segment, or a complete segment that may be the last one.
+  std::vector<uint8_t> pending_;
+  SecretBytes plaintext_;
+};
+
+absl::StatusOr<absl::Span<const uint8_t>> AesGcmEnvelopeDecrypter::Decrypt(
+    KmsClient* client, absl::Span<const uint8_t> ciphertext) {
+  if (multi_part_) {
+    return FailedPreconditionError(
+        "Decrypt cannot be used to terminate a multi-part decryption operation",
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+
+  cipher_.reset();
+  pending_.clear();
+  plaintext_.clear();
+  plaintext_.reserve(ciphertext.size());
+  absl::Status result = Update(client, ciphertext);
+  if (result.ok()) {
+    result = Finish();
+  }
+  if (!result.ok()) {
+    plaintext_.clear();
+    return result;
+  }
+  return absl::MakeConstSpan(plaintext_.data(), plaintext_.size());
+}
+
+absl::StatusOr<absl::Span<const uint8_t>>
+AesGcmEnvelopeDecrypter::DecryptUpdate(
+    KmsClient* client, absl::Span<const uint8_t> ciphertext_part) {
+  multi_part_ = true;
+  plaintext_.clear();
+  RETURN_IF_ERROR(Update(client, ciphertext_part));
+  return absl::MakeConstSpan(plaintext_.data(), plaintext_.size());
+}
+
+absl::StatusOr<absl::Span<const uint8_t>> AesGcmEnvelopeDecrypter::DecryptFinal(
+    KmsClient* client) {
+  if (!multi_part_) {
+    return FailedPreconditionError(
+        "DecryptUpdate needs to be called prior to terminating a multi-part "
+        "decryption operation",
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+
+  // A repeated call, which follows a query for the output length, returns the
+  // same final segment.
+  if (!finished_) {
+    plaintext_.clear();
+    RETURN_IF_ERROR(Finish());
+    finished_ = true;
+  }
+  return absl::MakeConstSpan(plaintext_.data(), plaintext_.size());
+}
+
+size_t AesGcmEnvelopeDecrypter::DecryptUpdateOutputLength(
+    size_t ciphertext_part_length) {
+  size_t available = pending_.size() + ciphertext_part_length;
+  if (!cipher_) {
+    if (available < kHeaderBytes) {
+      return 0;
+    }
+    available -= kHeaderBytes;
+  }
+  return LeadingSegments(available, kSegmentCiphertextBytes) * kSegmentBytes;
+}
+
+absl::Status AesGcmEnvelopeDecrypter::Update(KmsClient* client,
+                                             absl::Span<const uint8_t> data) {
+  if (!cipher_) {
+    size_t fill = std::min(kHeaderBytes - pending_.size(), data.size());
+    pending_.insert(pending_.end(), data.begin(), data.begin() + fill);
+    data.remove_prefix(fill);
+    if (pending_.size() < kHeaderBytes) {
+      return absl::OkStatus();
+    }
+    RETURN_IF_ERROR(Begin(
+        client, std::string_view(reinterpret_cast<const char*>(pending_.data()),
+                                 pending_.size())));
+    pending_.clear();
+  }
+
+  // A complete segment is only decrypted once more ciphertext follows it,
+  // since the last segment is opened differently.
+  while (pending_.size() + data.size() > kSegmentCiphertextBytes) {
+    if (pending_.empty()) {
+      RETURN_IF_ERROR(cipher_->Open(data.subspan(0, kSegmentCiphertextBytes),
+                                    /*last=*/false, &plaintext_));
+      data.remove_prefix(kSegmentCiphertextBytes);
+      continue;
+    }
+    size_t fill = kSegmentCiphertextBytes - pending_.size();
+    pending_.insert(pending_.end(), data.begin(), data.begin() + fill);
+    data.remove_prefix(fill);
+    RETURN_IF_ERROR(cipher_->Open(pending_, /*last=*/false, &plaintext_));
+    pending_.clear();
+  }
+  pending_.insert(pending_.end(), data.begin(), data.end());
+  return absl::OkStatus();
+}
+
+absl::Status AesGcmEnvelopeDecrypter::Begin(KmsClient* client,
+                                            std::string_view header) {
+  ASSIGN_OR_RETURN(EnvelopeHeader parsed, ParseHeader(header));
+
+  if (data_key_.empty() || parsed.wrapped_key != wrapped_key_) {
+    kms_v1::RawDecryptRequest req;
+    req.set_name(std::string(object_->kms_key_name()));
+    req.set_ciphertext(std::string(parsed.wrapped_key));
+    req.set_initialization_vector(std::string(parsed.wrapping_iv));
+    req.set_additional_authenticated_data(aad_);
+
+    ASSIGN_OR_RETURN(kms_v1::RawDecryptResponse resp, client->RawDecrypt(req));
+    std::unique_ptr<std::string, ZeroDelete<std::string>> data_key(
+        resp.release_plaintext());
+    if (data_key->size() != kDataKeyBytes) {
+      return NewInvalidArgumentError(
+          absl::StrFormat("unexpected data key length %d", data_key->size()),
+          CKR_ENCRYPTED_DATA_INVALID, SOURCE_LOCATION);
+    }
+    data_key_.assign(data_key->begin(), data_key->end());
+    wrapped_key_ = std::string(parsed.wrapped_key);
+  }
+
+  ASSIGN_OR_RETURN(cipher_,
+                   SegmentCipher::New(/*encrypt=*/false, data_key_,
+                                      parsed.salt, absl::StrCat(header, aad_)));
+  return absl::OkStatus();
+}
+
+absl::Status AesGcmEnvelopeDecrypter::Finish() {
+  if (!cipher_) {
+    return NewInvalidArgumentError("ciphertext is too short",
+                                   CKR_ENCRYPTED_DATA_LEN_RANGE,
+                                   SOURCE_LOCATION);
+  }
+  RETURN_IF_ERROR(cipher_->Open(pending_, /*last=*/true, &plaintext_));
+  pending_.clear();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<absl::Span<const uint8_t>> ExtractAad(
+    const CK_MECHANISM* mechanism) {
+  if (mechanism->ulParameterLen == 0) {
+    return absl::Span<const uint8_t>();
+  }
+  if (!mechanism->pParameter) {
+    return InvalidMechanismParamError(
+        "AAD length specified but the AAD pointer is invalid", SOURCE_LOCATION);
+  }
+  return absl::MakeConstSpan(
+      static_cast<const uint8_t*>(mechanism->pParameter),
+      mechanism->ulParameterLen);
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesGcmEnvelopeEncrypter(
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism) {
+  RETURN_IF_ERROR(CheckKeyPreconditions(CKK_AES, CKO_SECRET_KEY,
+                                        mechanism->mechanism, key.get()));
+  ASSIGN_OR_RETURN(absl::Span<const uint8_t> aad, ExtractAad(mechanism));
+  return std::make_unique<AesGcmEnvelopeEncrypter>(key, aad);
+}
+
+absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewAesGcmEnvelopeDecrypter(
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism) {
+  RETURN_IF_ERROR(CheckKeyPreconditions(CKK_AES, CKO_SECRET_KEY,
+                                        mechanism->mechanism, key.get()));
+  ASSIGN_OR_RETURN(absl::Span<const uint8_t> aad, ExtractAad(mechanism));
+  return std::make_unique<AesGcmEnvelopeDecrypter>(key, aad);
+}
+
+}  // namespace cloud_kms::kmsp11
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KMSP11_OPERATION_AES_GCM_ENVELOPE_H_
+#define KMSP11_OPERATION_AES_GCM_ENVELOPE_H_
+
+#include "kmsp11/operation/crypter_interfaces.h"
+
+namespace cloud_kms::kmsp11 {
+
+// Returns an encrypter for CKM_CLOUDKMS_AES_GCM_ENVELOPE, which encrypts data
+// locally under a data key that is wrapped by the provided Cloud KMS key.
+absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewAesGcmEnvelopeEncrypter(
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism);
+
+// Returns a decrypter for CKM_CLOUDKMS_AES_GCM_ENVELOPE.
+absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewAesGcmEnvelopeDecrypter(
+    std::shared_ptr<Object> key, const CK_MECHANISM* mechanism);
+
+}  // namespace cloud_kms::kmsp11
+
+#endif  // KMSP11_OPERATION_AES_GCM_ENVELOPE_H_
@@ -0,0 +1,429 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/operation/aes_gcm_envelope.h"
+
+#include <algorithm>
+
+#include "common/kms_client.h"
+#include "common/test/test_status_macros.h"
+#include "fakekms/cpp/fakekms.h"
+#include "gmock/gmock.h"
+#include "kmsp11/kmsp11.h"
+#include "kmsp11/object.h"
+#include "kmsp11/test/matchers.h"
+#include "kmsp11/test/resource_helpers.h"
+#include "kmsp11/util/crypto_utils.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::SizeIs;
+
+constexpr size_t kHeaderBytes = 83;
+constexpr size_t kTagBytes = 16;
+constexpr size_t kSegmentBytes = 64 * 1024;
+constexpr size_t kSegmentCiphertextBytes = kSegmentBytes + kTagBytes;
+
+CK_MECHANISM NewEnvelopeMechanism(std::vector<uint8_t>* aad) {
+  return CK_MECHANISM{
+      CKM_CLOUDKMS_AES_GCM_ENVELOPE,                // mechanism
+      aad->data(),                                  // pParameter
+      static_cast<unsigned long int>(aad->size()),  // ulParameterLen
+  };
+}
+
+std::vector<uint8_t> ToVector(absl::Span<const uint8_t> span) {
+  return std::vector<uint8_t>(span.begin(), span.end());
+}
+
+absl::Span<const uint8_t> ToSpan(const std::string& data) {
+  return absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(data.data()),
+                             data.size());
+}
+
+TEST(NewAesGcmEnvelopeEncrypterTest, SuccessWithoutAad) {
+  ASSERT_OK_AND_ASSIGN(Object prv,
+                       NewMockSecretKey(kms_v1::CryptoKeyVersion::AES_256_GCM));
+  std::shared_ptr<Object> key = std::make_shared<Object>(prv);
+
+  CK_MECHANISM mechanism = {CKM_CLOUDKMS_AES_GCM_ENVELOPE, nullptr, 0};
+
+  EXPECT_OK(NewAesGcmEnvelopeEncrypter(key, &mechanism));
+}
+
+TEST(NewAesGcmEnvelopeEncrypterTest, FailureWrongKeyType) {
+  ASSERT_OK_AND_ASSIGN(Object prv,
+                       NewMockSecretKey(kms_v1::CryptoKeyVersion::HMAC_SHA1));
+  std::shared_ptr<Object> key = std::make_shared<Object>(prv);
+
+  std::vector<uint8_t> aad = {0xDE, 0xAD, 0xBE, 0xEF};
+  CK_MECHANISM mechanism = NewEnvelopeMechanism(&aad);
+
+  EXPECT_THAT(NewAesGcmEnvelopeEncrypter(key, &mechanism),
+              StatusRvIs(CKR_KEY_TYPE_INCONSISTENT));
+}
+
+TEST(NewAesGcmEnvelopeEncrypterTest, FailureWrongKeyAlgorithm) {
+  ASSERT_OK_AND_ASSIGN(Object prv,
+                       NewMockSecretKey(kms_v1::CryptoKeyVersion::AES_256_CTR));
+  std::shared_ptr<Object> key = std::make_shared<Object>(prv);
+
+  std::vector<uint8_t> aad = {0xDE, 0xAD, 0xBE, 0xEF};
+  CK_MECHANISM mechanism = NewEnvelopeMechanism(&aad);
+
+  EXPECT_THAT(NewAesGcmEnvelopeEncrypter(key, &mechanism),
+              StatusRvIs(CKR_KEY_FUNCTION_NOT_PERMITTED));
+}
+
+TEST(NewAesGcmEnvelopeEncrypterTest, FailureAadLengthWithoutPointer) {
+  ASSERT_OK_AND_ASSIGN(Object prv,
+                       NewMockSecretKey(kms_v1::CryptoKeyVersion::AES_256_GCM));
+  std::shared_ptr<Object> key = std::make_shared<Object>(prv);
+
+  CK_MECHANISM mechanism = {CKM_CLOUDKMS_AES_GCM_ENVELOPE, nullptr, 4};
+
+  EXPECT_THAT(NewAesGcmEnvelopeEncrypter(key, &mechanism),
+              StatusRvIs(CKR_MECHANISM_PARAM_INVALID));
+}
+
+class AesGcmEnvelopeTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_OK_AND_ASSIGN(fake_server_, fakekms::Server::New());
+    client_ = std::make_unique<KmsClient>(KmsClient::Options{
+        .endpoint_address = fake_server_->listen_addr(),
+        .rpc_timeout = absl::Seconds(1),
+        .error_decorator =
+            [](absl::Status& status) { SetErrorRv(status, CKR_DEVICE_ERROR); },
+    });
+
+    auto fake_client = fake_server_->NewClient();
+
+    kms_v1::KeyRing kr;
+    kr = CreateKeyRingOrDie(fake_client.get(), kTestLocation, RandomId(), kr);
+
+    kms_v1::CryptoKey ck;
+    ck.set_purpose(kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT);
+    ck.mutable_version_template()->set_algorithm(
+        kms_v1::CryptoKeyVersion::AES_256_GCM);
+    ck = CreateCryptoKeyOrDie(fake_client.get(), kr.name(), "ck", ck, true);
+
+    kms_v1::CryptoKeyVersion ckv;
+    ckv = CreateCryptoKeyVersionOrDie(fake_client.get(), ck.name(), ckv);
+    ckv = WaitForEnablement(fake_client.get(), ckv);
+
+    ASSERT_OK_AND_ASSIGN(Object key, Object::NewSecretKey(ckv));
+    key_ = std::make_shared<Object>(key);
+
+    aad_ = {'s', 'o', 'm', 'e', ' ', 'a', 'a', 'd'};
+    CK_MECHANISM mechanism = NewEnvelopeMechanism(&aad_);
+    ASSERT_OK_AND_ASSIGN(encrypter_,
+                         NewAesGcmEnvelopeEncrypter(key_, &mechanism));
+    ASSERT_OK_AND_ASSIGN(decrypter_,
+                         NewAesGcmEnvelopeDecrypter(key_, &mechanism));
+  }
+
+  std::unique_ptr<fakekms::Server> fake_server_;
+  std::unique_ptr<KmsClient> client_;
+  std::shared_ptr<Object> key_;
+  std::vector<uint8_t> aad_;
+  std::unique_ptr<EncrypterInterface> encrypter_;
+  std::unique_ptr<DecrypterInterface> decrypter_;
+};
+
+TEST_F(AesGcmEnvelopeTest, EncryptDecryptSuccess) {
+  std::vector<uint8_t> plaintext = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05};
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                       encrypter_->Encrypt(client_.get(), plaintext));
+  EXPECT_THAT(ciphertext, SizeIs(kHeaderBytes + plaintext.size() + kTagBytes));
+
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              IsOkAndHolds(ElementsAreArray(plaintext)));
+}
+
+TEST_F(AesGcmEnvelopeTest, EncryptDecryptLargePlaintextSuccess) {
+  // Larger than the 64 KiB limit that applies to CKM_CLOUDKMS_AES_GCM.
+  std::string plaintext = RandBytes(1024 * 1024);
+  absl::Span<const uint8_t> plaintext_bytes = ToSpan(plaintext);
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                       encrypter_->Encrypt(client_.get(), plaintext_bytes));
+  size_t segments = plaintext.size() / kSegmentBytes;
+  EXPECT_THAT(ciphertext,
+              SizeIs(kHeaderBytes + plaintext.size() + segments * kTagBytes));
+
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              IsOkAndHolds(ElementsAreArray(plaintext_bytes)));
+}
+
+TEST_F(AesGcmEnvelopeTest, EncryptDecryptSegmentBoundarySuccess) {
+  for (size_t size : {kSegmentBytes - 1, kSegmentBytes, kSegmentBytes + 1}) {
+    SCOPED_TRACE(size);
+    std::string plaintext = RandBytes(size);
+
+    ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                         encrypter_->Encrypt(client_.get(), ToSpan(plaintext)));
+    size_t segments = (size - 1) / kSegmentBytes + 1;
+    EXPECT_THAT(ciphertext,
+                SizeIs(kHeaderBytes + plaintext.size() + segments * kTagBytes));
+
+    EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+                IsOkAndHolds(ElementsAreArray(ToSpan(plaintext))));
+  }
+}
+
+TEST_F(AesGcmEnvelopeTest, RepeatedEncryptUsesFreshSalt) {
+  std::vector<uint8_t> plaintext = {0x00, 0x01, 0x02, 0x03};
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext1,
+                       encrypter_->Encrypt(client_.get(), plaintext));
+  std::vector<uint8_t> first = ToVector(ciphertext1);
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext2,
+                       encrypter_->Encrypt(client_.get(), plaintext));
+
+  EXPECT_NE(first, ToVector(ciphertext2));
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), first),
+              IsOkAndHolds(ElementsAreArray(plaintext)));
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext2),
+              IsOkAndHolds(ElementsAreArray(plaintext)));
+}
+
+TEST_F(AesGcmEnvelopeTest, EncryptUpdateBuffersPartialSegment) {
+  std::vector<uint8_t> part1 = {0x00, 0x01, 0x02};
+  std::vector<uint8_t> part2 = {0x03, 0x04, 0x05, 0x06};
+
+  EXPECT_EQ(encrypter_->EncryptUpdateOutputLength(part1.size()), kHeaderBytes);
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> out1,
+                       encrypter_->EncryptUpdate(client_.get(), part1));
+  EXPECT_THAT(out1, SizeIs(kHeaderBytes));
+  std::vector<uint8_t> ciphertext = ToVector(out1);
+
+  EXPECT_EQ(encrypter_->EncryptUpdateOutputLength(part2.size()), 0);
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> out2,
+                       encrypter_->EncryptUpdate(client_.get(), part2));
+  EXPECT_THAT(out2, SizeIs(0));
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> last,
+                       encrypter_->EncryptFinal(client_.get()));
+  EXPECT_THAT(last, SizeIs(part1.size() + part2.size() + kTagBytes));
+  ciphertext.insert(ciphertext.end(), last.begin(), last.end());
+
+  std::vector<uint8_t> plaintext = part1;
+  plaintext.insert(plaintext.end(), part2.begin(), part2.end());
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              IsOkAndHolds(ElementsAreArray(plaintext)));
+}
+
+TEST_F(AesGcmEnvelopeTest, EncryptUpdateStreamsCompleteSegments) {
+  std::string plaintext = RandBytes(3 * kSegmentBytes);
+  absl::Span<const uint8_t> plaintext_bytes = ToSpan(plaintext);
+
+  // A complete segment is held back until more plaintext follows it.
+  EXPECT_EQ(encrypter_->EncryptUpdateOutputLength(kSegmentBytes),
+            kHeaderBytes);
+  ASSERT_OK_AND_ASSIGN(
+      absl::Span<const uint8_t> out1,
+      encrypter_->EncryptUpdate(client_.get(),
+                                plaintext_bytes.subspan(0, kSegmentBytes)));
+  EXPECT_THAT(out1, SizeIs(kHeaderBytes));
+  std::vector<uint8_t> ciphertext = ToVector(out1);
+
+  EXPECT_EQ(encrypter_->EncryptUpdateOutputLength(kSegmentBytes + 1),
+            2 * kSegmentCiphertextBytes);
+  ASSERT_OK_AND_ASSIGN(
+      absl::Span<const uint8_t> out2,
+      encrypter_->EncryptUpdate(
+          client_.get(), plaintext_bytes.subspan(kSegmentBytes,
+                                                 kSegmentBytes + 1)));
+  EXPECT_THAT(out2, SizeIs(2 * kSegmentCiphertextBytes));
+  ciphertext.insert(ciphertext.end(), out2.begin(), out2.end());
+
+  EXPECT_EQ(encrypter_->EncryptUpdateOutputLength(kSegmentBytes - 1), 0);
+  ASSERT_OK_AND_ASSIGN(
+      absl::Span<const uint8_t> out3,
+      encrypter_->EncryptUpdate(client_.get(), plaintext_bytes.subspan(
+                                                   2 * kSegmentBytes + 1)));
+  EXPECT_THAT(out3, SizeIs(0));
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> last,
+                       encrypter_->EncryptFinal(client_.get()));
+  EXPECT_THAT(last, SizeIs(kSegmentCiphertextBytes));
+  ciphertext.insert(ciphertext.end(), last.begin(), last.end());
+
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              IsOkAndHolds(ElementsAreArray(plaintext_bytes)));
+}
+
+TEST_F(AesGcmEnvelopeTest, EncryptFinalIsRepeatable) {
+  std::vector<uint8_t> plaintext = {0x00, 0x01, 0x02, 0x03};
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> header,
+                       encrypter_->EncryptUpdate(client_.get(), plaintext));
+  std::vector<uint8_t> ciphertext = ToVector(header);
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> last1,
+                       encrypter_->EncryptFinal(client_.get()));
+  std::vector<uint8_t> first = ToVector(last1);
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> last2,
+                       encrypter_->EncryptFinal(client_.get()));
+  EXPECT_EQ(ToVector(last2), first);
+  ciphertext.insert(ciphertext.end(), first.begin(), first.end());
+
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              IsOkAndHolds(ElementsAreArray(plaintext)));
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptUpdateAcceptsArbitraryPartBoundaries) {
+  std::string plaintext = RandBytes(2 * kSegmentBytes + 1000);
+  absl::Span<const uint8_t> plaintext_bytes = ToSpan(plaintext);
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                       encrypter_->Encrypt(client_.get(), plaintext_bytes));
+
+  // Split the ciphertext into parts of varying size, including parts that
+  // split the header, the segments, and their tags.
+  std::vector<uint8_t> decrypted;
+  size_t offset = 0;
+  for (size_t part_length = 1; offset < ciphertext.size(); part_length += 997) {
+    size_t length = std::min(part_length, ciphertext.size() - offset);
+    size_t expected_length = decrypter_->DecryptUpdateOutputLength(length);
+    ASSERT_OK_AND_ASSIGN(
+        absl::Span<const uint8_t> part,
+        decrypter_->DecryptUpdate(client_.get(),
+                                  ciphertext.subspan(offset, length)));
+    EXPECT_THAT(part, SizeIs(expected_length));
+    decrypted.insert(decrypted.end(), part.begin(), part.end());
+    offset += length;
+  }
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> last,
+                       decrypter_->DecryptFinal(client_.get()));
+  decrypted.insert(decrypted.end(), last.begin(), last.end());
+  EXPECT_THAT(decrypted, ElementsAreArray(plaintext_bytes));
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptUpdateStreamsAuthenticatedSegments) {
+  std::string plaintext = RandBytes(2 * kSegmentBytes + 10);
+  absl::Span<const uint8_t> plaintext_bytes = ToSpan(plaintext);
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                       encrypter_->Encrypt(client_.get(), plaintext_bytes));
+
+  size_t length = kHeaderBytes + 2 * kSegmentCiphertextBytes + 1;
+  EXPECT_EQ(decrypter_->DecryptUpdateOutputLength(length), 2 * kSegmentBytes);
+  EXPECT_THAT(
+      decrypter_->DecryptUpdate(client_.get(), ciphertext.subspan(0, length)),
+      IsOkAndHolds(
+          ElementsAreArray(plaintext_bytes.subspan(0, 2 * kSegmentBytes))));
+
+  EXPECT_EQ(decrypter_->DecryptUpdateOutputLength(ciphertext.size() - length),
+            0);
+  EXPECT_THAT(decrypter_->DecryptUpdate(client_.get(),
+                                        ciphertext.subspan(length)),
+              IsOkAndHolds(SizeIs(0)));
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> last1,
+                       decrypter_->DecryptFinal(client_.get()));
+  std::vector<uint8_t> first = ToVector(last1);
+  EXPECT_THAT(first,
+              ElementsAreArray(plaintext_bytes.subspan(2 * kSegmentBytes)));
+  EXPECT_THAT(decrypter_->DecryptFinal(client_.get()),
+              IsOkAndHolds(ElementsAreArray(first)));
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptFailureModifiedCiphertext) {
+  std::vector<uint8_t> plaintext = {0x00, 0x01, 0x02, 0x03};
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> out,
+                       encrypter_->Encrypt(client_.get(), plaintext));
+  std::vector<uint8_t> ciphertext = ToVector(out);
+  ciphertext[kHeaderBytes] ^= 0x01;
+
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              StatusRvIs(CKR_ENCRYPTED_DATA_INVALID));
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptFailureModifiedSalt) {
+  std::vector<uint8_t> plaintext = {0x00, 0x01, 0x02, 0x03};
+
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> out,
+                       encrypter_->Encrypt(client_.get(), plaintext));
+  std::vector<uint8_t> ciphertext = ToVector(out);
+  ciphertext[kHeaderBytes - 1] ^= 0x01;
+
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              StatusRvIs(CKR_ENCRYPTED_DATA_INVALID));
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptFailureWrongAad) {
+  std::vector<uint8_t> plaintext = {0x00, 0x01, 0x02, 0x03};
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                       encrypter_->Encrypt(client_.get(), plaintext));
+
+  std::vector<uint8_t> other_aad = {'o', 't', 'h', 'e', 'r'};
+  CK_MECHANISM mechanism = NewEnvelopeMechanism(&other_aad);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<DecrypterInterface> decrypter,
+                       NewAesGcmEnvelopeDecrypter(key_, &mechanism));
+
+  EXPECT_FALSE(decrypter->Decrypt(client_.get(), ciphertext).ok());
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptFailureTruncatedCiphertext) {
+  std::vector<uint8_t> plaintext = {0x00, 0x01, 0x02, 0x03};
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                       encrypter_->Encrypt(client_.get(), plaintext));
+
+  EXPECT_THAT(
+      decrypter_->Decrypt(client_.get(), ciphertext.subspan(0, kHeaderBytes)),
+      StatusRvIs(CKR_ENCRYPTED_DATA_LEN_RANGE));
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptFailureTruncatedAtSegmentBoundary) {
+  std::string plaintext = RandBytes(2 * kSegmentBytes);
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> ciphertext,
+                       encrypter_->Encrypt(client_.get(), ToSpan(plaintext)));
+
+  size_t length = kHeaderBytes + kSegmentCiphertextBytes;
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext.subspan(0, length)),
+              StatusRvIs(CKR_ENCRYPTED_DATA_INVALID));
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptFailureReorderedSegments) {
+  std::string plaintext = RandBytes(3 * kSegmentBytes);
+  ASSERT_OK_AND_ASSIGN(absl::Span<const uint8_t> out,
+                       encrypter_->Encrypt(client_.get(), ToSpan(plaintext)));
+  std::vector<uint8_t> ciphertext = ToVector(out);
+  auto first_segment = ciphertext.begin() + kHeaderBytes;
+  std::swap_ranges(first_segment, first_segment + kSegmentCiphertextBytes,
+                   first_segment + kSegmentCiphertextBytes);
+
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              StatusRvIs(CKR_ENCRYPTED_DATA_INVALID));
+}
+
+TEST_F(AesGcmEnvelopeTest, DecryptFailureNotEnvelopeCiphertext) {
+  std::vector<uint8_t> ciphertext(128, 0xAB);
+
+  EXPECT_THAT(decrypter_->Decrypt(client_.get(), ciphertext),
+              StatusRvIs(CKR_ENCRYPTED_DATA_INVALID));
+}
+
+TEST_F(AesGcmEnvelopeTest, EncryptFinalWithoutUpdateFails) {
+  EXPECT_THAT(encrypter_->EncryptFinal(client_.get()),
+              StatusRvIs(CKR_FUNCTION_FAILED));
+}
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
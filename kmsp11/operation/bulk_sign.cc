@@ -0,0 +1,213 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/operation/bulk_sign.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "kmsp11/util/errors.h"
+#include "kmsp11/util/status_utils.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+// The state shared between a bulk signing operation and its RPCs.
+struct BulkSignState {
+  absl::Mutex mutex;
+  size_t in_flight ABSL_GUARDED_BY(mutex) = 0;
+  std::vector<absl::Status> statuses ABSL_GUARDED_BY(mutex);
+
+  bool CanStart() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return in_flight < kMaxBulkSignConcurrency;
+  }
+  bool Done() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    return in_flight == 0;
+  }
+};
+
+// An implementation of SignerInterface that signs a sequence of fixed-length
+// items with another signer, and reports the result of each item separately.
+class BulkSigner : public SignerInterface {
+ public:
+  BulkSigner(std::unique_ptr<SignerInterface> inner,
+             const CK_CLOUDKMS_BULK_SIGN_PARAMS& params)
+      : inner_(std::move(inner)),
+        item_length_(params.ulItemLen),
+        count_(params.ulCount),
+        results_(params.pResults) {}
+
+  size_t signature_length() override {
+    return count_ * inner_->signature_length();
+  }
+  Object* object() override { return inner_->object(); }
+
+  absl::Status Sign(KmsClient* client, absl::Span<const uint8_t> data,
+                    absl::Span<uint8_t> signature) override;
+
+  virtual ~BulkSigner() {}
+
+ private:
+  std::unique_ptr<SignerInterface> inner_;
+  size_t item_length_;
+  size_t count_;
+  CK_RV* results_;
+};
+
+absl::Status BulkSigner::Sign(KmsClient* client,
+                              absl::Span<const uint8_t> data,
+                              absl::Span<uint8_t> signature) {
+  if (data.size() != count_ * item_length_) {
+    return NewInvalidArgumentError(
+        absl::StrFormat("provided data has incorrect size (got %d, want %d "
+                        "items of %d bytes)",
+                        data.size(), count_, item_length_),
+        CKR_DATA_LEN_RANGE, SOURCE_LOCATION);
+  }
+  if (signature.size() != signature_length()) {
+    return NewInternalError(
+        absl::StrFormat(
+            "provided signature buffer has incorrect size (got %d, want %d)",
+            signature.size(), signature_length()),
+        SOURCE_LOCATION);
+  }
+
+  // Each item is an AsymmetricSign call to Cloud KMS, so the calls are made
+  // asynchronously, with at most kMaxBulkSignConcurrency of them in flight.
+  size_t item_signature_length = inner_->signature_length();
+  auto state = std::make_shared<BulkSignState>();
+  state->statuses.resize(count_);
+
+  for (size_t i = 0; i < count_; i++) {
+    absl::Span<uint8_t> item_signature =
+        signature.subspan(i * item_signature_length, item_signature_length);
+    kms_v1::AsymmetricSignRequest req;
+    absl::Status prepared = inner_->PrepareSign(
+        data.subspan(i * item_length_, item_length_), item_signature, &req);
+
+    if (!prepared.ok()) {
+      absl::MutexLock lock(&state->mutex);
+      state->statuses[i] = std::move(prepared);
+      continue;
+    }
+
+    {
+      absl::MutexLock lock(&state->mutex);
+      state->mutex.Await(
+          absl::Condition(state.get(), &BulkSignState::CanStart));
+      state->in_flight++;
+    }
+    client->AsymmetricSignAsync(
+        std::move(req),
+        [this, state, i, item_signature](
+            absl::StatusOr<kms_v1::AsymmetricSignResponse> resp) {
+          absl::Status status = resp.status();
+          if (status.ok()) {
+            status = inner_->FinishSign(*resp, item_signature);
+          }
+          absl::MutexLock lock(&state->mutex);
+          state->statuses[i] = std::move(status);
+          state->in_flight--;
+        });
+  }
+
+  absl::MutexLock lock(&state->mutex);
+  state->mutex.Await(absl::Condition(state.get(), &BulkSignState::Done));
+  const std::vector<absl::Status>& statuses = state->statuses;
+  absl::Status result = absl::OkStatus();
+  for (size_t i = 0; i < count_; i++) {
+    results_[i] = GetCkRv(statuses[i]);
+    if (statuses[i].ok()) {
+      continue;
+    }
+    absl::Span<uint8_t> item_signature =
+        signature.subspan(i * item_signature_length, item_signature_length);
+    std::fill(item_signature.begin(), item_signature.end(), 0);
+    if (result.ok()) {
+      result = NewError(statuses[i].code(),
+                        absl::StrFormat("error signing item %d: %s", i,
+                                        statuses[i].message()),
+                        results_[i], SOURCE_LOCATION);
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+absl::StatusOr<CK_CLOUDKMS_BULK_SIGN_PARAMS> ExtractBulkSignParams(
+    const CK_MECHANISM* mechanism) {
+  if (mechanism->ulParameterLen != sizeof(CK_CLOUDKMS_BULK_SIGN_PARAMS) ||
+      !mechanism->pParameter) {
+    return InvalidMechanismParamError(
+        "mechanism parameters must be of type CK_CLOUDKMS_BULK_SIGN_PARAMS",
+        SOURCE_LOCATION);
+  }
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params =
+      *static_cast<CK_CLOUDKMS_BULK_SIGN_PARAMS*>(mechanism->pParameter);
+
+  const CK_MECHANISM* inner = BulkSignInnerMechanism(params);
+  if (!inner) {
+    return InvalidMechanismParamError("pMechanism is null", SOURCE_LOCATION);
+  }
+  switch (inner->mechanism) {
+    case CKM_ECDSA:
+    case CKM_RSA_PKCS:
+    case CKM_RSA_PKCS_PSS:
+      break;
+    default:
+      return InvalidMechanismParamError(
+          absl::StrFormat("mechanism %#x is not supported for bulk signing",
+                          inner->mechanism),
+          SOURCE_LOCATION);
+  }
+
+  if (params.ulItemLen == 0 || params.ulCount == 0) {
+    return InvalidMechanismParamError(
+        "ulItemLen and ulCount must be greater than zero", SOURCE_LOCATION);
+  }
+  if (params.ulCount > std::numeric_limits<size_t>::max() / params.ulItemLen) {
+    return InvalidMechanismParamError(
+        absl::StrFormat("%d items of %d bytes is too large", params.ulCount,
+                        params.ulItemLen),
+        SOURCE_LOCATION);
+  }
+  if (!params.pResults) {
+    return InvalidMechanismParamError("pResults is null", SOURCE_LOCATION);
+  }
+  return params;
+}
+
+const CK_MECHANISM* BulkSignInnerMechanism(
+    const CK_CLOUDKMS_BULK_SIGN_PARAMS& params) {
+  return static_cast<const CK_MECHANISM*>(params.pMechanism);
+}
+
+absl::StatusOr<std::unique_ptr<SignerInterface>> NewBulkSigner(
+    std::unique_ptr<SignerInterface> inner,
+    const CK_CLOUDKMS_BULK_SIGN_PARAMS& params) {
+  if (params.ulCount >
+      std::numeric_limits<size_t>::max() / inner->signature_length()) {
+    return InvalidMechanismParamError(
+        absl::StrFormat("%d signatures of %d bytes is too large",
+                        params.ulCount, inner->signature_length()),
+        SOURCE_LOCATION);
+  }
+  return std::make_unique<BulkSigner>(std::move(inner), params);
+}
+
+}  // namespace cloud_kms::kmsp11
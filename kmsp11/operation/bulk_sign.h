@@ -0,0 +1,49 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KMSP11_OPERATION_BULK_SIGN_H_
+#define KMSP11_OPERATION_BULK_SIGN_H_
+
+#include "kmsp11/cryptoki.h"
+#include "kmsp11/kmsp11.h"
+#include "kmsp11/operation/crypter_interfaces.h"
+
+namespace cloud_kms::kmsp11 {
+
+// The maximum number of items in a CKM_CLOUDKMS_BULK_SIGN operation that are
+// signed at the same time.
+inline constexpr size_t kMaxBulkSignConcurrency = 32;
+
+// Returns the CK_CLOUDKMS_BULK_SIGN_PARAMS in `mechanism`, after checking that
+// they are well-formed and name a supported inner mechanism.
+absl::StatusOr<CK_CLOUDKMS_BULK_SIGN_PARAMS> ExtractBulkSignParams(
+    const CK_MECHANISM* mechanism);
+
+// Returns the mechanism used to sign each item in a CKM_CLOUDKMS_BULK_SIGN
+// operation.
+const CK_MECHANISM* BulkSignInnerMechanism(
+    const CK_CLOUDKMS_BULK_SIGN_PARAMS& params);
+
+// Returns a signer that signs each of the `params.ulCount` items in its input
+// with `inner`, concurrently. `inner` must be safe to use for concurrent calls
+// to Sign.
+absl::StatusOr<std::unique_ptr<SignerInterface>> NewBulkSigner(
+    std::unique_ptr<SignerInterface> inner,
+    const CK_CLOUDKMS_BULK_SIGN_PARAMS& params);
+
+}  // namespace cloud_kms::kmsp11
+
+#endif  // KMSP11_OPERATION_BULK_SIGN_H_
@@ -0,0 +1,189 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/operation/bulk_sign.h"
+
+#include "common/test/test_status_macros.h"
+#include "fakekms/cpp/fakekms.h"
+#include "kmsp11/object.h"
+#include "kmsp11/operation/crypter_ops.h"
+#include "kmsp11/test/matchers.h"
+#include "kmsp11/test/resource_helpers.h"
+#include "kmsp11/util/crypto_utils.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+using ::testing::AllOf;
+using ::testing::Each;
+
+TEST(ExtractBulkSignParamsTest, ParamSizeInvalid) {
+  char buf[1];
+  CK_MECHANISM mechanism{CKM_CLOUDKMS_BULK_SIGN, buf, sizeof(buf)};
+  EXPECT_THAT(ExtractBulkSignParams(&mechanism),
+              StatusRvIs(CKR_MECHANISM_PARAM_INVALID));
+}
+
+TEST(ExtractBulkSignParamsTest, InnerMechanismMissing) {
+  CK_RV results[1];
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{nullptr, 48, 1, results};
+  CK_MECHANISM mechanism{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  EXPECT_THAT(ExtractBulkSignParams(&mechanism),
+              StatusRvIs(CKR_MECHANISM_PARAM_INVALID));
+}
+
+TEST(ExtractBulkSignParamsTest, InnerMechanismUnsupported) {
+  CK_RV results[1];
+  CK_MECHANISM inner{CKM_ECDSA_SHA384, nullptr, 0};
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 48, 1, results};
+  CK_MECHANISM mechanism{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  EXPECT_THAT(ExtractBulkSignParams(&mechanism),
+              StatusRvIs(CKR_MECHANISM_PARAM_INVALID));
+}
+
+TEST(ExtractBulkSignParamsTest, NestedBulkSignUnsupported) {
+  CK_RV results[1];
+  CK_MECHANISM inner{CKM_CLOUDKMS_BULK_SIGN, nullptr, 0};
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 48, 1, results};
+  CK_MECHANISM mechanism{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  EXPECT_THAT(ExtractBulkSignParams(&mechanism),
+              StatusRvIs(CKR_MECHANISM_PARAM_INVALID));
+}
+
+TEST(ExtractBulkSignParamsTest, CountZero) {
+  CK_RV results[1];
+  CK_MECHANISM inner{CKM_ECDSA, nullptr, 0};
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 48, 0, results};
+  CK_MECHANISM mechanism{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  EXPECT_THAT(ExtractBulkSignParams(&mechanism),
+              StatusRvIs(CKR_MECHANISM_PARAM_INVALID));
+}
+
+TEST(ExtractBulkSignParamsTest, ResultsMissing) {
+  CK_MECHANISM inner{CKM_ECDSA, nullptr, 0};
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 48, 1, nullptr};
+  CK_MECHANISM mechanism{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  EXPECT_THAT(ExtractBulkSignParams(&mechanism),
+              StatusRvIs(CKR_MECHANISM_PARAM_INVALID));
+}
+
+class BulkSignTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_OK_AND_ASSIGN(fake_server_, fakekms::Server::New());
+    client_ = std::make_unique<KmsClient>(KmsClient::Options{
+        .endpoint_address = fake_server_->listen_addr(),
+        .rpc_timeout = absl::Seconds(1),
+    });
+
+    auto fake_client = fake_server_->NewClient();
+
+    kms_v1::KeyRing kr;
+    kr = CreateKeyRingOrDie(fake_client.get(), kTestLocation, RandomId(), kr);
+
+    kms_v1::CryptoKey ck;
+    ck.set_purpose(kms_v1::CryptoKey::ASYMMETRIC_SIGN);
+    ck.mutable_version_template()->set_algorithm(
+        kms_v1::CryptoKeyVersion::EC_SIGN_P384_SHA384);
+    ck = CreateCryptoKeyOrDie(fake_client.get(), kr.name(), "ck", ck, true);
+
+    kms_v1::CryptoKeyVersion ckv;
+    ckv = CreateCryptoKeyVersionOrDie(fake_client.get(), ck.name(), ckv);
+    ckv = WaitForEnablement(fake_client.get(), ckv);
+
+    kms_v1::PublicKey pub_proto = GetPublicKeyOrDie(fake_client.get(), ckv);
+    ASSERT_OK_AND_ASSIGN(public_key_, ParseX509PublicKeyPem(pub_proto.pem()));
+
+    ASSERT_OK_AND_ASSIGN(KeyPair kp,
+                         Object::NewKeyPair(ckv, public_key_.get()));
+    prv_ = std::make_shared<Object>(kp.private_key);
+  }
+
+  std::unique_ptr<fakekms::Server> fake_server_;
+  std::unique_ptr<KmsClient> client_;
+  bssl::UniquePtr<EVP_PKEY> public_key_;
+  std::shared_ptr<Object> prv_;
+};
+
+TEST_F(BulkSignTest, SignSuccess) {
+  constexpr size_t kCount = 40;
+  std::vector<uint8_t> digests(kCount * 48);
+  for (size_t i = 0; i < kCount; i++) {
+    uint8_t data = static_cast<uint8_t>(i);
+    SHA384(&data, 1, &digests[i * 48]);
+  }
+
+  std::vector<CK_RV> results(kCount, CKR_GENERAL_ERROR);
+  CK_MECHANISM inner{CKM_ECDSA, nullptr, 0};
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 48, kCount, results.data()};
+  CK_MECHANISM mech{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  ASSERT_OK_AND_ASSIGN(SignOp signer, NewSignOp(prv_, &mech));
+  EXPECT_EQ(signer->signature_length(), kCount * 96);
+
+  std::vector<uint8_t> sigs(signer->signature_length());
+  EXPECT_OK(signer->Sign(client_.get(), digests, absl::MakeSpan(sigs)));
+
+  EXPECT_THAT(results, Each(CKR_OK));
+  for (size_t i = 0; i < kCount; i++) {
+    EXPECT_OK(EcdsaVerifyP1363(
+        EVP_PKEY_get0_EC_KEY(public_key_.get()), EVP_sha384(),
+        absl::MakeConstSpan(digests).subspan(i * 48, 48),
+        absl::MakeConstSpan(sigs).subspan(i * 96, 96)));
+  }
+}
+
+TEST_F(BulkSignTest, DataLengthInvalid) {
+  std::vector<uint8_t> digests(2 * 48 + 1);
+
+  CK_RV results[2];
+  CK_MECHANISM inner{CKM_ECDSA, nullptr, 0};
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 48, 2, results};
+  CK_MECHANISM mech{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  ASSERT_OK_AND_ASSIGN(SignOp signer, NewSignOp(prv_, &mech));
+
+  std::vector<uint8_t> sigs(signer->signature_length());
+  EXPECT_THAT(signer->Sign(client_.get(), digests, absl::MakeSpan(sigs)),
+              AllOf(StatusIs(absl::StatusCode::kInvalidArgument),
+                    StatusRvIs(CKR_DATA_LEN_RANGE)));
+}
+
+TEST_F(BulkSignTest, ItemFailuresReported) {
+  // Each 47-byte item is rejected by the ECDSA signer.
+  constexpr size_t kCount = 3;
+  std::vector<uint8_t> digests(kCount * 47);
+
+  std::vector<CK_RV> results(kCount, CKR_OK);
+  CK_MECHANISM inner{CKM_ECDSA, nullptr, 0};
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 47, kCount, results.data()};
+  CK_MECHANISM mech{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  ASSERT_OK_AND_ASSIGN(SignOp signer, NewSignOp(prv_, &mech));
+
+  std::vector<uint8_t> sigs(signer->signature_length(), 0xFF);
+  EXPECT_THAT(signer->Sign(client_.get(), digests, absl::MakeSpan(sigs)),
+              AllOf(StatusIs(absl::StatusCode::kInvalidArgument),
+                    StatusRvIs(CKR_DATA_LEN_RANGE)));
+  EXPECT_THAT(results, Each(CKR_DATA_LEN_RANGE));
+  EXPECT_THAT(sigs, Each(0));
+}
+
+TEST_F(BulkSignTest, InnerMechanismKeyMismatch) {
+  CK_RV results[1];
+  CK_MECHANISM inner{CKM_RSA_PKCS, nullptr, 0};
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 48, 1, results};
+  CK_MECHANISM mech{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  EXPECT_THAT(NewSignOp(prv_, &mech), StatusRvIs(CKR_KEY_TYPE_INCONSISTENT));
+}
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
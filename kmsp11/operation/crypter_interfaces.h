@@ -29,13 +29,25 @@ class EncrypterInterface {
   virtual absl::StatusOr<absl::Span<const uint8_t>> Encrypt(
       KmsClient* client, absl::Span<const uint8_t> plaintext) = 0;
 
-  virtual absl::Status EncryptUpdate(KmsClient* client,
-                                     absl::Span<const uint8_t> plaintext_part) {
+  // Returns the ciphertext produced for this part, which is empty for
+  // mechanisms that buffer their input until EncryptFinal.
+  virtual absl::StatusOr<absl::Span<const uint8_t>> EncryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> plaintext_part) {
     return FailedPreconditionError(
         "provided mechanism does not support multi-part encryption",
         CKR_FUNCTION_FAILED, SOURCE_LOCATION);
   }
 
+  // Returns true if EncryptUpdate returns ciphertext as parts are received,
+  // rather than buffering them until EncryptFinal.
+  virtual bool StreamsUpdateOutput() const { return false; }
+
+  // Returns the length of the ciphertext that EncryptUpdate will return for a
+  // part of the provided length.
+  virtual size_t EncryptUpdateOutputLength(size_t plaintext_part_length) {
+    return 0;
+  }
+
   virtual absl::StatusOr<absl::Span<const uint8_t>> EncryptFinal(
       KmsClient* client) {
     return FailedPreconditionError(
@@ -51,13 +63,25 @@ class DecrypterInterface {
   virtual absl::StatusOr<absl::Span<const uint8_t>> Decrypt(
       KmsClient* client, absl::Span<const uint8_t> ciphertext) = 0;
 
-  virtual absl::Status DecryptUpdate(KmsClient* client,
-                                     absl::Span<const uint8_t> ciphertext) {
+  // Returns the plaintext produced for this part, which is empty for
+  // mechanisms that buffer their input until DecryptFinal.
+  virtual absl::StatusOr<absl::Span<const uint8_t>> DecryptUpdate(
+      KmsClient* client, absl::Span<const uint8_t> ciphertext) {
     return FailedPreconditionError(
         "provided mechanism does not support multi-part decryption",
         CKR_FUNCTION_FAILED, SOURCE_LOCATION);
   }
 
+  // Returns true if DecryptUpdate returns plaintext as parts are received,
+  // rather than buffering them until DecryptFinal.
+  virtual bool StreamsUpdateOutput() const { return false; }
+
+  // Returns the length of the plaintext that DecryptUpdate will return for a
+  // part of the provided length.
+  virtual size_t DecryptUpdateOutputLength(size_t ciphertext_part_length) {
+    return 0;
+  }
+
   virtual absl::StatusOr<absl::Span<const uint8_t>> DecryptFinal(
       KmsClient* client) {
     return FailedPreconditionError(
@@ -92,6 +116,33 @@ class SignerInterface {
         CKR_FUNCTION_FAILED, SOURCE_LOCATION);
   };
 
+  // Splits a single-part Sign into the AsymmetricSign request that it sends,
+  // and the copying of the signature in the response to `signature`, so that
+  // the RPC can be made asynchronously. Only signers that make exactly one
+  // AsymmetricSign call per Sign support this.
+  virtual absl::Status PrepareSign(absl::Span<const uint8_t> data,
+                                   absl::Span<uint8_t> signature,
+                                   kms_v1::AsymmetricSignRequest* request) {
+    return FailedPreconditionError(
+        absl::StrFormat(
+            "provided mechanism %#x does not support asynchronous signing",
+            object()->algorithm().algorithm),
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+  virtual absl::Status FinishSign(
+      const kms_v1::AsymmetricSignResponse& response,
+      absl::Span<uint8_t> signature) {
+    return FailedPreconditionError(
+        absl::StrFormat(
+            "provided mechanism %#x does not support asynchronous signing",
+            object()->algorithm().algorithm),
+        CKR_FUNCTION_FAILED, SOURCE_LOCATION);
+  }
+
+  // Discards any multi-part signing state, so that the signer can be reused for
+  // another operation with the same key and mechanism.
+  virtual void Reset() {}
+
   virtual ~SignerInterface() {}
 };
 
@@ -118,6 +169,10 @@ class VerifierInterface {
         CKR_FUNCTION_FAILED, SOURCE_LOCATION);
   };
 
+  // Discards any multi-part verification state, so that the verifier can be
+  // reused for another operation with the same key and mechanism.
+  virtual void Reset() {}
+
   virtual ~VerifierInterface() {}
 };
 
@@ -14,10 +14,13 @@
 
 #include "kmsp11/operation/crypter_ops.h"
 
+#include "common/status_macros.h"
 #include "kmsp11/kmsp11.h"
 #include "kmsp11/operation/aes_cbc.h"
 #include "kmsp11/operation/aes_ctr.h"
 #include "kmsp11/operation/aes_gcm.h"
+#include "kmsp11/operation/aes_gcm_envelope.h"
+#include "kmsp11/operation/bulk_sign.h"
 #include "kmsp11/operation/ecdsa.h"
 #include "kmsp11/operation/hmac.h"
 #include "kmsp11/operation/rsaes_oaep.h"
@@ -29,7 +32,8 @@
 namespace cloud_kms::kmsp11 {
 
 absl::StatusOr<DecryptOp> NewDecryptOp(std::shared_ptr<Object> key,
-                                       const CK_MECHANISM* mechanism) {
+                                       const CK_MECHANISM* mechanism,
+                                       bool streaming_multipart_aes) {
   switch (mechanism->mechanism) {
     case CKM_RSA_PKCS_OAEP:
       return NewRsaOaepDecrypter(key, mechanism);
@@ -43,11 +47,13 @@ absl::StatusOr<DecryptOp> NewDecryptOp(std::shared_ptr<Object> key,
           CKR_MECHANISM_INVALID, SOURCE_LOCATION);
     case CKM_CLOUDKMS_AES_GCM:
       return NewAesGcmDecrypter(key, mechanism);
+    case CKM_CLOUDKMS_AES_GCM_ENVELOPE:
+      return NewAesGcmEnvelopeDecrypter(key, mechanism);
     case CKM_AES_CTR:
-      return NewAesCtrDecrypter(key, mechanism);
+      return NewAesCtrDecrypter(key, mechanism, streaming_multipart_aes);
     case CKM_AES_CBC:
     case CKM_AES_CBC_PAD:
-      return NewAesCbcDecrypter(key, mechanism);
+      return NewAesCbcDecrypter(key, mechanism, streaming_multipart_aes);
     default:
       return InvalidMechanismError(mechanism->mechanism, "decrypt",
                                    SOURCE_LOCATION);
@@ -55,7 +61,8 @@ absl::StatusOr<DecryptOp> NewDecryptOp(std::shared_ptr<Object> key,
 }
 
 absl::StatusOr<EncryptOp> NewEncryptOp(std::shared_ptr<Object> key,
-                                       const CK_MECHANISM* mechanism) {
+                                       const CK_MECHANISM* mechanism,
+                                       bool streaming_multipart_aes) {
   switch (mechanism->mechanism) {
     case CKM_RSA_PKCS_OAEP:
       return NewRsaOaepEncrypter(key, mechanism);
@@ -69,11 +76,13 @@ absl::StatusOr<EncryptOp> NewEncryptOp(std::shared_ptr<Object> key,
           CKR_MECHANISM_INVALID, SOURCE_LOCATION);
     case CKM_CLOUDKMS_AES_GCM:
       return NewAesGcmEncrypter(key, mechanism);
+    case CKM_CLOUDKMS_AES_GCM_ENVELOPE:
+      return NewAesGcmEnvelopeEncrypter(key, mechanism);
     case CKM_AES_CTR:
-      return NewAesCtrEncrypter(key, mechanism);
+      return NewAesCtrEncrypter(key, mechanism, streaming_multipart_aes);
     case CKM_AES_CBC:
     case CKM_AES_CBC_PAD:
-      return NewAesCbcEncrypter(key, mechanism);
+      return NewAesCbcEncrypter(key, mechanism, streaming_multipart_aes);
     default:
       return InvalidMechanismError(mechanism->mechanism, "encrypt",
                                    SOURCE_LOCATION);
@@ -104,6 +113,13 @@ absl::StatusOr<SignOp> NewSignOp(std::shared_ptr<Object> key,
     case CKM_SHA384_HMAC:
     case CKM_SHA512_HMAC:
       return NewHmacSigner(key, mechanism);
+    case CKM_CLOUDKMS_BULK_SIGN: {
+      ASSIGN_OR_RETURN(CK_CLOUDKMS_BULK_SIGN_PARAMS params,
+                       ExtractBulkSignParams(mechanism));
+      ASSIGN_OR_RETURN(SignOp inner,
+                       NewSignOp(key, BulkSignInnerMechanism(params)));
+      return NewBulkSigner(std::move(inner), params);
+    }
     default:
       return InvalidMechanismError(mechanism->mechanism, "sign",
                                    SOURCE_LOCATION);
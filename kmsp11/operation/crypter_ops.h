@@ -23,13 +23,19 @@ namespace cloud_kms::kmsp11 {
 
 using DecryptOp = std::unique_ptr<DecrypterInterface>;
 
+// If `streaming_multipart_aes` is true, multi-part AES-CTR and AES-CBC
+// operations return output from each update call rather than buffering the
+// entire message.
 absl::StatusOr<DecryptOp> NewDecryptOp(std::shared_ptr<Object> key,
-                                       const CK_MECHANISM* mechanism);
+                                       const CK_MECHANISM* mechanism,
+                                       bool streaming_multipart_aes = false);
 
 using EncryptOp = std::unique_ptr<EncrypterInterface>;
 
+// See NewDecryptOp for the meaning of `streaming_multipart_aes`.
 absl::StatusOr<EncryptOp> NewEncryptOp(std::shared_ptr<Object> key,
-                                       const CK_MECHANISM* mechanism);
+                                       const CK_MECHANISM* mechanism,
+                                       bool streaming_multipart_aes = false);
 
 using SignOp = std::unique_ptr<SignerInterface>;
 
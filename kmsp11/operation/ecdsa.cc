@@ -25,6 +25,7 @@
 #include "kmsp11/operation/kms_prehashed_signer.h"
 #include "kmsp11/operation/preconditions.h"
 #include "kmsp11/util/crypto_utils.h"
+#include "kmsp11/util/ec_verify_tables.h"
 #include "kmsp11/util/errors.h"
 
 namespace cloud_kms::kmsp11 {
@@ -75,13 +76,10 @@ absl::StatusOr<std::unique_ptr<SignerInterface>> EcdsaSigner::New(
                                         mechanism->mechanism, key.get()));
   RETURN_IF_ERROR(EnsureNoParameters(mechanism));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
   return std::unique_ptr<SignerInterface>(new EcdsaSigner(
-      key, bssl::UniquePtr<EC_KEY>(EVP_PKEY_get1_EC_KEY(parsed_key.get()))));
+      key, bssl::UniquePtr<EC_KEY>(EVP_PKEY_get1_EC_KEY(public_key.get()))));
 }
 
 size_t EcdsaSigner::signature_length() {
@@ -115,11 +113,16 @@ class EcdsaVerifier : public VerifierInterface {
   virtual ~EcdsaVerifier() {}
 
  private:
-  EcdsaVerifier(std::shared_ptr<Object> object, bssl::UniquePtr<EC_KEY> key)
-      : object_(object), key_(std::move(key)) {}
+  EcdsaVerifier(std::shared_ptr<Object> object, bssl::UniquePtr<EC_KEY> key,
+                std::shared_ptr<EcVerifyTables::Key> table_key)
+      : object_(object),
+        key_(std::move(key)),
+        table_key_(std::move(table_key)) {}
 
   std::shared_ptr<Object> object_;
   bssl::UniquePtr<EC_KEY> key_;
+  // Registered once, so that verification doesn't look up the public key.
+  std::shared_ptr<EcVerifyTables::Key> table_key_;
 };
 
 absl::StatusOr<std::unique_ptr<VerifierInterface>> NewEcdsaVerifier(
@@ -147,13 +150,14 @@ absl::StatusOr<std::unique_ptr<VerifierInterface>> EcdsaVerifier::New(
       CheckKeyPreconditions(CKK_EC, CKO_PUBLIC_KEY, CKM_ECDSA, key.get()));
   RETURN_IF_ERROR(EnsureNoParameters(mechanism));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
-  return std::unique_ptr<VerifierInterface>(new EcdsaVerifier(
-      key, bssl::UniquePtr<EC_KEY>(EVP_PKEY_get1_EC_KEY(parsed_key.get()))));
+  bssl::UniquePtr<EC_KEY> ec_key(EVP_PKEY_get1_EC_KEY(public_key.get()));
+  ASSIGN_OR_RETURN(std::shared_ptr<EcVerifyTables::Key> table_key,
+                   EcVerifyTables::Global().Register(ec_key.get()));
+
+  return std::unique_ptr<VerifierInterface>(
+      new EcdsaVerifier(key, std::move(ec_key), std::move(table_key)));
 }
 
 absl::Status EcdsaVerifier::Verify(KmsClient* client,
@@ -161,7 +165,8 @@ absl::Status EcdsaVerifier::Verify(KmsClient* client,
                                    absl::Span<const uint8_t> signature) {
   ASSIGN_OR_RETURN(const EVP_MD* md,
                    DigestForMechanism(*object_->algorithm().digest_mechanism));
-  return EcdsaVerifyP1363(key_.get(), md, digest, signature);
+  return EcVerifyTables::Global().Verify(table_key_.get(), key_.get(), md,
+                                         digest, signature);
 }
 
 }  // namespace cloud_kms::kmsp11
@@ -44,6 +44,8 @@ class HmacSigner : public SignerInterface {
   absl::Status SignFinal(KmsClient* client,
                          absl::Span<uint8_t> signature) override;
 
+  void Reset() override { buffer_.reset(); }
+
   virtual ~HmacSigner() {}
 
  private:
@@ -124,13 +126,14 @@ absl::Status HmacSigner::SignFinal(KmsClient* client,
 absl::Status HmacSigner::SignInternal(KmsClient* client,
                                       absl::Span<const uint8_t> data,
                                       absl::Span<uint8_t> signature) {
-  kms_v1::MacSignRequest req;
-  req.set_name(std::string(object_->kms_key_name()));
-  req.set_data(
-      std::string(reinterpret_cast<const char*>(data.data()), data.size()));
-
-  ASSIGN_OR_RETURN(kms_v1::MacSignResponse resp, client->MacSign(req));
-  std::copy(resp.mac().begin(), resp.mac().end(), signature.begin());
+  CallArena arena;
+  kms_v1::MacSignRequest* req = arena.Create<kms_v1::MacSignRequest>();
+  req->set_name(std::string(object_->kms_key_name()));
+  req->set_data(data.data(), data.size());
+
+  ASSIGN_OR_RETURN(kms_v1::MacSignResponse * resp,
+                   client->MacSign(*req, arena.get()));
+  std::copy(resp->mac().begin(), resp->mac().end(), signature.begin());
   return absl::OkStatus();
 }
 
@@ -151,6 +154,8 @@ class HmacVerifier : public VerifierInterface {
   absl::Status VerifyFinal(KmsClient* client,
                            absl::Span<const uint8_t> signature) override;
 
+  void Reset() override { buffer_.reset(); }
+
   virtual ~HmacVerifier() {}
 
  private:
@@ -34,17 +34,16 @@ absl::StatusOr<std::unique_ptr<SignerInterface>> KmsDigestingSigner::New(
 absl::Status KmsDigestingSigner::Sign(KmsClient* client,
                                       absl::Span<const uint8_t> data,
                                       absl::Span<uint8_t> signature) {
-  if (md_ctx_) {
+  if (multi_part_) {
     return FailedPreconditionError(
         "Sign cannot be used to terminate a multi-part signing operation",
         CKR_FUNCTION_FAILED, SOURCE_LOCATION);
   }
 
   const size_t md_size = EVP_MD_size(md_);
-  std::vector<uint8_t> evp_digest(md_size);
+  uint8_t evp_digest[EVP_MAX_MD_SIZE];
   unsigned int digest_len;
-  bssl::UniquePtr<EVP_MD_CTX> ctx(EVP_MD_CTX_new());
-  if (EVP_Digest(data.data(), data.size(), evp_digest.data(), &digest_len, md_,
+  if (EVP_Digest(data.data(), data.size(), evp_digest, &digest_len, md_,
                  nullptr) != 1) {
     return NewInternalError(
         absl::StrFormat(
@@ -61,26 +60,31 @@ absl::Status KmsDigestingSigner::Sign(KmsClient* client,
         SOURCE_LOCATION);
   }
 
+  absl::Span<const uint8_t> digest =
+      absl::MakeConstSpan(evp_digest, digest_len);
   if (IsRawRsaAlgorithm(object()->algorithm().algorithm)) {
     ASSIGN_OR_RETURN(std::vector<uint8_t> digest_info,
-                     BuildRsaDigestInfo(EVP_MD_type(md_), evp_digest));
+                     BuildRsaDigestInfo(EVP_MD_type(md_), digest));
     return inner_signer_->Sign(client, digest_info, signature);
   }
 
-  return inner_signer_->Sign(client, evp_digest, signature);
+  return inner_signer_->Sign(client, digest, signature);
 }
 
 absl::Status KmsDigestingSigner::SignUpdate(KmsClient* client,
                                             absl::Span<const uint8_t> data) {
-  if (!md_ctx_) {
-    md_ctx_ = bssl::UniquePtr<EVP_MD_CTX>(EVP_MD_CTX_new());
-    if (EVP_DigestInit(md_ctx_.get(), md_) != 1) {
+  if (!multi_part_) {
+    if (!md_ctx_) {
+      md_ctx_ = bssl::UniquePtr<EVP_MD_CTX>(EVP_MD_CTX_new());
+    }
+    if (EVP_DigestInit_ex(md_ctx_.get(), md_, nullptr) != 1) {
       return NewInternalError(
           absl::StrFormat(
               "failed while initializing EVP digest with digest size %d: %s",
               EVP_MD_size(md_), SslErrorToString()),
           SOURCE_LOCATION);
     }
+    multi_part_ = true;
   }
 
   if (EVP_DigestUpdate(md_ctx_.get(), data.data(), data.size()) != 1) {
@@ -95,16 +99,16 @@ absl::Status KmsDigestingSigner::SignUpdate(KmsClient* client,
 
 absl::Status KmsDigestingSigner::SignFinal(KmsClient* client,
                                            absl::Span<uint8_t> signature) {
-  if (!md_ctx_) {
+  if (!multi_part_) {
     return FailedPreconditionError(
         "SignUpdate needs to be called prior to terminating a multi-part "
         "signing operation",
         CKR_FUNCTION_FAILED, SOURCE_LOCATION);
   }
 
-  std::vector<uint8_t> evp_digest(EVP_MD_size(md_));
+  uint8_t evp_digest[EVP_MAX_MD_SIZE];
   unsigned int digest_len;
-  if (EVP_DigestFinal(md_ctx_.get(), evp_digest.data(), &digest_len) != 1) {
+  if (EVP_DigestFinal(md_ctx_.get(), evp_digest, &digest_len) != 1) {
     return NewInternalError(absl::StrCat("failed while finalizing EVP digest: ",
                                          SslErrorToString()),
                             SOURCE_LOCATION);
@@ -118,13 +122,15 @@ absl::Status KmsDigestingSigner::SignFinal(KmsClient* client,
         SOURCE_LOCATION);
   }
 
+  absl::Span<const uint8_t> digest =
+      absl::MakeConstSpan(evp_digest, digest_len);
   if (IsRawRsaAlgorithm(object()->algorithm().algorithm)) {
     ASSIGN_OR_RETURN(std::vector<uint8_t> digest_info,
-                     BuildRsaDigestInfo(EVP_MD_type(md_), evp_digest));
+                     BuildRsaDigestInfo(EVP_MD_type(md_), digest));
     return inner_signer_->Sign(client, digest_info, signature);
   }
 
-  return inner_signer_->Sign(client, evp_digest, signature);
+  return inner_signer_->Sign(client, digest, signature);
 }
 
 size_t KmsDigestingSigner::signature_length() {
@@ -48,6 +48,8 @@ class KmsDigestingSigner : public SignerInterface {
   size_t signature_length() override;
   Object* object() override { return inner_signer_->object(); };
 
+  void Reset() override { multi_part_ = false; }
+
   virtual ~KmsDigestingSigner() {}
 
  protected:
@@ -56,7 +58,10 @@ class KmsDigestingSigner : public SignerInterface {
 
  private:
   std::unique_ptr<SignerInterface> inner_signer_;
+  // Allocated by the first multi-part operation, and reinitialized by each
+  // one after that.
   bssl::UniquePtr<EVP_MD_CTX> md_ctx_;
+  bool multi_part_ = false;
   const EVP_MD* md_;
 };
 
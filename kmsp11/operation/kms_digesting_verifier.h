@@ -45,6 +45,8 @@ class KmsDigestingVerifier : public VerifierInterface {
   absl::Status VerifyFinal(KmsClient* client,
                            absl::Span<const uint8_t> signature) override;
 
+  void Reset() override { multi_part_ = false; }
+
   virtual ~KmsDigestingVerifier() {}
 
  protected:
@@ -54,7 +56,10 @@ class KmsDigestingVerifier : public VerifierInterface {
 
  private:
   std::unique_ptr<VerifierInterface> inner_verifier_;
+  // Allocated by the first multi-part operation, and reinitialized by each
+  // one after that.
   bssl::UniquePtr<EVP_MD_CTX> md_ctx_;
+  bool multi_part_ = false;
   const EVP_MD* md_;
 };
 
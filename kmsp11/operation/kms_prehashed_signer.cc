@@ -24,6 +24,19 @@ namespace cloud_kms::kmsp11 {
 absl::Status KmsPrehashedSigner::Sign(KmsClient* client,
                                       absl::Span<const uint8_t> digest,
                                       absl::Span<uint8_t> signature) {
+  CallArena arena;
+  kms_v1::AsymmetricSignRequest* req =
+      arena.Create<kms_v1::AsymmetricSignRequest>();
+  RETURN_IF_ERROR(PrepareSign(digest, signature, req));
+
+  ASSIGN_OR_RETURN(kms_v1::AsymmetricSignResponse * resp,
+                   client->AsymmetricSign(*req, arena.get()));
+  return FinishSign(*resp, signature);
+}
+
+absl::Status KmsPrehashedSigner::PrepareSign(
+    absl::Span<const uint8_t> digest, absl::Span<uint8_t> signature,
+    kms_v1::AsymmetricSignRequest* req) {
   ASSIGN_OR_RETURN(const EVP_MD* md,
                    DigestForMechanism(*object_->algorithm().digest_mechanism));
 
@@ -42,19 +55,18 @@ absl::Status KmsPrehashedSigner::Sign(KmsClient* client,
         SOURCE_LOCATION);
   }
 
-  kms_v1::AsymmetricSignRequest req;
-  req.set_name(std::string(object_->kms_key_name()));
+  req->set_name(std::string(object_->kms_key_name()));
 
   int digest_nid = EVP_MD_type(md);
   switch (digest_nid) {
     case NID_sha256:
-      req.mutable_digest()->set_sha256(digest.data(), digest.size());
+      req->mutable_digest()->set_sha256(digest.data(), digest.size());
       break;
     case NID_sha384:
-      req.mutable_digest()->set_sha384(digest.data(), digest.size());
+      req->mutable_digest()->set_sha384(digest.data(), digest.size());
       break;
     case NID_sha512:
-      req.mutable_digest()->set_sha512(digest.data(), digest.size());
+      req->mutable_digest()->set_sha512(digest.data(), digest.size());
       break;
     default:
       return NewInternalError(
@@ -62,12 +74,15 @@ absl::Status KmsPrehashedSigner::Sign(KmsClient* client,
           SOURCE_LOCATION);
   }
 
-  ASSIGN_OR_RETURN(kms_v1::AsymmetricSignResponse resp,
-                   client->AsymmetricSign(req));
-  RETURN_IF_ERROR(CopySignature(resp.signature(), signature));
   return absl::OkStatus();
 }
 
+absl::Status KmsPrehashedSigner::FinishSign(
+    const kms_v1::AsymmetricSignResponse& response,
+    absl::Span<uint8_t> signature) {
+  return CopySignature(response.signature(), signature);
+}
+
 absl::Status KmsPrehashedSigner::CopySignature(std::string_view src,
                                             absl::Span<uint8_t> dest) {
   if (src.size() != signature_length()) {
@@ -32,6 +32,12 @@ class KmsPrehashedSigner : public SignerInterface {
   virtual absl::Status Sign(KmsClient* client, absl::Span<const uint8_t> digest,
                             absl::Span<uint8_t> signature) override;
 
+  absl::Status PrepareSign(absl::Span<const uint8_t> digest,
+                           absl::Span<uint8_t> signature,
+                           kms_v1::AsymmetricSignRequest* request) override;
+  absl::Status FinishSign(const kms_v1::AsymmetricSignResponse& response,
+                          absl::Span<uint8_t> signature) override;
+
   virtual ~KmsPrehashedSigner() {}
 
  protected:
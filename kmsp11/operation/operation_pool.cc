@@ -0,0 +1,50 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/operation/operation_pool.h"
+
+#include <algorithm>
+
+#include "kmsp11/kmsp11.h"
+
+namespace cloud_kms::kmsp11 {
+
+std::optional<PooledMechanism> PooledMechanism::Copy(
+    const CK_MECHANISM& mechanism) {
+  if (mechanism.mechanism == CKM_CLOUDKMS_BULK_SIGN ||
+      mechanism.ulParameterLen > kMaxParameterSize ||
+      (mechanism.ulParameterLen > 0 && !mechanism.pParameter)) {
+    return std::nullopt;
+  }
+  const uint8_t* parameter = static_cast<const uint8_t*>(mechanism.pParameter);
+  return PooledMechanism(
+      mechanism.mechanism,
+      absl::InlinedVector<uint8_t, kMaxParameterSize>(
+          parameter, parameter + mechanism.ulParameterLen));
+}
+
+bool PooledMechanism::Matches(const CK_MECHANISM& mechanism) const {
+  if (mechanism.mechanism != type_ ||
+      mechanism.ulParameterLen != parameter_.size()) {
+    return false;
+  }
+  if (parameter_.empty()) {
+    return true;
+  }
+  return mechanism.pParameter &&
+         std::equal(parameter_.begin(), parameter_.end(),
+                    static_cast<const uint8_t*>(mechanism.pParameter));
+}
+
+}  // namespace cloud_kms::kmsp11
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KMSP11_OPERATION_OPERATION_POOL_H_
+#define KMSP11_OPERATION_OPERATION_POOL_H_
+
+#include <optional>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "kmsp11/cryptoki.h"
+#include "kmsp11/object.h"
+
+namespace cloud_kms::kmsp11 {
+
+// A copy of the mechanism that an operation was initialized with, which
+// identifies the operations that may be reused for another initialization.
+class PooledMechanism {
+ public:
+  // Returns a copy of `mechanism`, or nullopt if operations initialized with
+  // `mechanism` must not be reused. That is the case for mechanisms whose
+  // parameters point to other memory, which may change between operations,
+  // and for parameters too large to copy without allocating.
+  static std::optional<PooledMechanism> Copy(const CK_MECHANISM& mechanism);
+
+  bool Matches(const CK_MECHANISM& mechanism) const;
+
+ private:
+  static constexpr size_t kMaxParameterSize = 32;
+
+  PooledMechanism(CK_MECHANISM_TYPE type,
+                  absl::InlinedVector<uint8_t, kMaxParameterSize> parameter)
+      : type_(type), parameter_(std::move(parameter)) {}
+
+  CK_MECHANISM_TYPE type_;
+  absl::InlinedVector<uint8_t, kMaxParameterSize> parameter_;
+};
+
+// OperationPool holds sign or verify operations that have completed, so that
+// an operation can be reused rather than reconstructed when it is initialized
+// again with the same key and mechanism. The most recently released operations
+// are kept, up to a fixed capacity.
+//
+// `Op` is a std::unique_ptr to a SignerInterface or VerifierInterface.
+// OperationPool is not thread-safe.
+template <typename Op>
+class OperationPool {
+ public:
+  static constexpr size_t kCapacity = 4;
+
+  OperationPool() { entries_.reserve(kCapacity); }
+
+  // Removes and returns an operation on `key` that was initialized with
+  // `mechanism`, after resetting it, or nullptr if there is none.
+  Op Acquire(const Object* key, const CK_MECHANISM& mechanism) {
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->op->object() == key && it->mechanism.Matches(mechanism)) {
+        Op op = std::move(it->op);
+        entries_.erase(it);
+        op->Reset();
+        return op;
+      }
+    }
+    return nullptr;
+  }
+
+  // Adds `op`, which was initialized with `mechanism`, to the pool. If the
+  // pool is full, the least recently released operation is destroyed.
+  void Release(PooledMechanism mechanism, Op op) {
+    if (entries_.size() == kCapacity) {
+      entries_.pop_back();
+    }
+    entries_.insert(entries_.begin(),
+                    Entry{std::move(mechanism), std::move(op)});
+  }
+
+  // Destroys all pooled operations.
+  void Clear() { entries_.clear(); }
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    PooledMechanism mechanism;
+    Op op;
+  };
+
+  // Ordered from most to least recently released.
+  std::vector<Entry> entries_;
+};
+
+}  // namespace cloud_kms::kmsp11
+
+#endif  // KMSP11_OPERATION_OPERATION_POOL_H_
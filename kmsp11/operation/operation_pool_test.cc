@@ -0,0 +1,165 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/operation/operation_pool.h"
+
+#include "common/test/test_status_macros.h"
+#include "kmsp11/kmsp11.h"
+#include "kmsp11/object.h"
+#include "kmsp11/operation/crypter_ops.h"
+#include "kmsp11/test/matchers.h"
+#include "kmsp11/test/resource_helpers.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+using ::testing::IsNull;
+
+TEST(PooledMechanismTest, MatchesSameTypeAndParameter) {
+  CK_RSA_PKCS_PSS_PARAMS params{CKM_SHA256, CKG_MGF1_SHA256, 32};
+  CK_MECHANISM mechanism{CKM_RSA_PKCS_PSS, &params, sizeof(params)};
+  std::optional<PooledMechanism> pooled = PooledMechanism::Copy(mechanism);
+  ASSERT_TRUE(pooled.has_value());
+
+  CK_RSA_PKCS_PSS_PARAMS same_params = params;
+  CK_MECHANISM same{CKM_RSA_PKCS_PSS, &same_params, sizeof(same_params)};
+  EXPECT_TRUE(pooled->Matches(same));
+}
+
+TEST(PooledMechanismTest, DoesNotMatchDifferentParameter) {
+  CK_RSA_PKCS_PSS_PARAMS params{CKM_SHA256, CKG_MGF1_SHA256, 32};
+  CK_MECHANISM mechanism{CKM_RSA_PKCS_PSS, &params, sizeof(params)};
+  std::optional<PooledMechanism> pooled = PooledMechanism::Copy(mechanism);
+  ASSERT_TRUE(pooled.has_value());
+
+  params.sLen = 20;
+  EXPECT_FALSE(pooled->Matches(mechanism));
+}
+
+TEST(PooledMechanismTest, DoesNotMatchDifferentType) {
+  CK_MECHANISM mechanism{CKM_ECDSA, nullptr, 0};
+  std::optional<PooledMechanism> pooled = PooledMechanism::Copy(mechanism);
+  ASSERT_TRUE(pooled.has_value());
+
+  CK_MECHANISM other{CKM_ECDSA_SHA256, nullptr, 0};
+  EXPECT_FALSE(pooled->Matches(other));
+}
+
+TEST(PooledMechanismTest, BulkSignIsNotCopied) {
+  CK_MECHANISM inner{CKM_ECDSA, nullptr, 0};
+  CK_RV results[1];
+  CK_CLOUDKMS_BULK_SIGN_PARAMS params{&inner, 32, 1, results};
+  CK_MECHANISM mechanism{CKM_CLOUDKMS_BULK_SIGN, &params, sizeof(params)};
+  EXPECT_FALSE(PooledMechanism::Copy(mechanism).has_value());
+}
+
+class OperationPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_OK_AND_ASSIGN(
+        KeyPair kp,
+        NewMockKeyPair(kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256,
+                       "ec_p256_public.pem"));
+    key_ = std::make_shared<Object>(kp.private_key);
+  }
+
+  // Creates a sign operation on `key` for `mechanism`, and releases it to
+  // `pool`. The operation is recorded in released_.
+  void ReleaseNewOp(OperationPool<SignOp>& pool, std::shared_ptr<Object> key,
+                    CK_MECHANISM mechanism) {
+    ASSERT_OK_AND_ASSIGN(SignOp op, NewSignOp(key, &mechanism));
+    released_.push_back(op.get());
+    pool.Release(*PooledMechanism::Copy(mechanism), std::move(op));
+  }
+
+  std::shared_ptr<Object> key_;
+  std::vector<SignerInterface*> released_;
+};
+
+TEST_F(OperationPoolTest, AcquireFromEmptyPool) {
+  OperationPool<SignOp> pool;
+  EXPECT_THAT(pool.Acquire(key_.get(), {CKM_ECDSA, nullptr, 0}), IsNull());
+}
+
+TEST_F(OperationPoolTest, ReleasedOperationIsReused) {
+  OperationPool<SignOp> pool;
+  ReleaseNewOp(pool, key_, {CKM_ECDSA, nullptr, 0});
+
+  SignOp op = pool.Acquire(key_.get(), {CKM_ECDSA, nullptr, 0});
+  EXPECT_EQ(op.get(), released_[0]);
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST_F(OperationPoolTest, DifferentMechanismIsNotReused) {
+  OperationPool<SignOp> pool;
+  ReleaseNewOp(pool, key_, {CKM_ECDSA, nullptr, 0});
+
+  EXPECT_THAT(pool.Acquire(key_.get(), {CKM_ECDSA_SHA256, nullptr, 0}),
+              IsNull());
+  EXPECT_EQ(pool.size(), 1);
+}
+
+TEST_F(OperationPoolTest, DifferentKeyIsNotReused) {
+  OperationPool<SignOp> pool;
+  ReleaseNewOp(pool, key_, {CKM_ECDSA, nullptr, 0});
+
+  Object other_key = *key_;
+  EXPECT_THAT(pool.Acquire(&other_key, {CKM_ECDSA, nullptr, 0}), IsNull());
+}
+
+TEST_F(OperationPoolTest, LeastRecentlyReleasedIsEvicted) {
+  OperationPool<SignOp> pool;
+  std::vector<std::shared_ptr<Object>> keys;
+  for (size_t i = 0; i <= OperationPool<SignOp>::kCapacity; i++) {
+    keys.push_back(std::make_shared<Object>(*key_));
+    ReleaseNewOp(pool, keys.back(), {CKM_ECDSA, nullptr, 0});
+  }
+  EXPECT_EQ(pool.size(), OperationPool<SignOp>::kCapacity);
+
+  EXPECT_THAT(pool.Acquire(keys.front().get(), {CKM_ECDSA, nullptr, 0}),
+              IsNull());
+  EXPECT_EQ(pool.Acquire(keys.back().get(), {CKM_ECDSA, nullptr, 0}).get(),
+            released_.back());
+}
+
+TEST_F(OperationPoolTest, ClearDestroysOperations) {
+  OperationPool<SignOp> pool;
+  ReleaseNewOp(pool, key_, {CKM_ECDSA, nullptr, 0});
+  std::weak_ptr<Object> key = key_;
+  key_.reset();
+
+  EXPECT_FALSE(key.expired());
+  pool.Clear();
+  EXPECT_EQ(pool.size(), 0);
+  EXPECT_TRUE(key.expired());
+}
+
+TEST_F(OperationPoolTest, AcquireResetsOperation) {
+  OperationPool<SignOp> pool;
+  CK_MECHANISM mechanism{CKM_ECDSA_SHA256, nullptr, 0};
+  ASSERT_OK_AND_ASSIGN(SignOp op, NewSignOp(key_, &mechanism));
+
+  uint8_t data[] = {0xDE, 0xAD, 0xBE, 0xEF};
+  EXPECT_OK(op->SignUpdate(nullptr, data));
+  pool.Release(*PooledMechanism::Copy(mechanism), std::move(op));
+
+  op = pool.Acquire(key_.get(), mechanism);
+  ASSERT_NE(op, nullptr);
+  uint8_t signature[64];
+  EXPECT_THAT(op->SignFinal(nullptr, absl::MakeSpan(signature)),
+              StatusRvIs(CKR_FUNCTION_FAILED));
+}
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
@@ -152,12 +152,9 @@ absl::StatusOr<std::unique_ptr<EncrypterInterface>> NewRsaOaepEncrypter(
   RETURN_IF_ERROR(ValidateRsaOaepParameters(key.get(), mechanism->pParameter,
                                             mechanism->ulParameterLen));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
-  return std::make_unique<RsaOaepEncrypter>(key, std::move(parsed_key));
+  return std::make_unique<RsaOaepEncrypter>(key, std::move(public_key));
 }
 
 absl::StatusOr<std::unique_ptr<DecrypterInterface>> NewRsaOaepDecrypter(
@@ -72,8 +72,9 @@ class RsaPkcs1Signer : public KmsPrehashedSigner {
 
   size_t signature_length() override;
 
-  absl::Status Sign(KmsClient* client, absl::Span<const uint8_t> data,
-                    absl::Span<uint8_t> signature) override;
+  absl::Status PrepareSign(absl::Span<const uint8_t> data,
+                           absl::Span<uint8_t> signature,
+                           kms_v1::AsymmetricSignRequest* request) override;
 
   virtual ~RsaPkcs1Signer() {}
 
@@ -117,30 +118,27 @@ absl::StatusOr<std::unique_ptr<SignerInterface>> RsaPkcs1Signer::New(
       CheckKeyPreconditions(CKK_RSA, CKO_PRIVATE_KEY, CKM_RSA_PKCS, key.get()));
   RETURN_IF_ERROR(EnsureNoParameters(mechanism));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
   return std::unique_ptr<SignerInterface>(new RsaPkcs1Signer(
-      key, bssl::UniquePtr<RSA>(EVP_PKEY_get1_RSA(parsed_key.get())),
+      key, bssl::UniquePtr<RSA>(EVP_PKEY_get1_RSA(public_key.get())),
       input_type));
 }
 
 size_t RsaPkcs1Signer::signature_length() { return RSA_size(key_.get()); }
 
-absl::Status RsaPkcs1Signer::Sign(KmsClient* client,
-                                  absl::Span<const uint8_t> data,
-                                  absl::Span<uint8_t> signature) {
+absl::Status RsaPkcs1Signer::PrepareSign(
+    absl::Span<const uint8_t> data, absl::Span<uint8_t> signature,
+    kms_v1::AsymmetricSignRequest* request) {
   if (input_type_ == ExpectedInput::kDigest) {
-    return KmsPrehashedSigner::Sign(client, data, signature);
+    return KmsPrehashedSigner::PrepareSign(data, signature, request);
   }
 
   ASSIGN_OR_RETURN(const EVP_MD* md,
                    DigestForMechanism(*object()->algorithm().digest_mechanism));
   ASSIGN_OR_RETURN(std::vector<uint8_t> digest,
                    ExtractDigest(data, EVP_MD_type(md)));
-  return KmsPrehashedSigner::Sign(client, digest, signature);
+  return KmsPrehashedSigner::PrepareSign(digest, signature, request);
 }
 
 class RsaPkcs1Verifier : public VerifierInterface {
@@ -196,13 +194,10 @@ absl::StatusOr<std::unique_ptr<VerifierInterface>> RsaPkcs1Verifier::New(
       CheckKeyPreconditions(CKK_RSA, CKO_PUBLIC_KEY, CKM_RSA_PKCS, key.get()));
   RETURN_IF_ERROR(EnsureNoParameters(mechanism));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
   return std::unique_ptr<VerifierInterface>(new RsaPkcs1Verifier(
-      key, bssl::UniquePtr<RSA>(EVP_PKEY_get1_RSA(parsed_key.get())),
+      key, bssl::UniquePtr<RSA>(EVP_PKEY_get1_RSA(public_key.get())),
       input_type));
 }
 
@@ -102,13 +102,10 @@ absl::StatusOr<std::unique_ptr<SignerInterface>> RsaPssSigner::New(
   RETURN_IF_ERROR(ValidatePssParameters(key.get(), mechanism->pParameter,
                                         mechanism->ulParameterLen));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
   return std::unique_ptr<SignerInterface>(
-      new RsaPssSigner(key, std::move(parsed_key)));
+      new RsaPssSigner(key, std::move(public_key)));
 }
 
 size_t RsaPssSigner::signature_length() {
@@ -162,13 +159,10 @@ absl::StatusOr<std::unique_ptr<VerifierInterface>> RsaPssVerifier::New(
   RETURN_IF_ERROR(ValidatePssParameters(key.get(), mechanism->pParameter,
                                         mechanism->ulParameterLen));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
   return std::unique_ptr<VerifierInterface>(
-      new RsaPssVerifier(key, std::move(parsed_key)));
+      new RsaPssVerifier(key, std::move(public_key)));
 }
 
 absl::Status RsaPssVerifier::Verify(KmsClient* client,
@@ -40,6 +40,11 @@ class RsaRawPkcs1Signer : public SignerInterface {
 
   absl::Status Sign(KmsClient* client, absl::Span<const uint8_t> data,
                     absl::Span<uint8_t> signature) override;
+  absl::Status PrepareSign(absl::Span<const uint8_t> data,
+                           absl::Span<uint8_t> signature,
+                           kms_v1::AsymmetricSignRequest* request) override;
+  absl::Status FinishSign(const kms_v1::AsymmetricSignResponse& response,
+                          absl::Span<uint8_t> signature) override;
 
   virtual ~RsaRawPkcs1Signer() {}
 
@@ -78,13 +83,10 @@ absl::StatusOr<std::unique_ptr<SignerInterface>> RsaRawPkcs1Signer::New(
       CheckKeyPreconditions(CKK_RSA, CKO_PRIVATE_KEY, CKM_RSA_PKCS, key.get()));
   RETURN_IF_ERROR(EnsureNoParameters(mechanism));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
   return std::unique_ptr<SignerInterface>(new RsaRawPkcs1Signer(
-      key, bssl::UniquePtr<RSA>(EVP_PKEY_get1_RSA(parsed_key.get()))));
+      key, bssl::UniquePtr<RSA>(EVP_PKEY_get1_RSA(public_key.get()))));
 }
 
 size_t RsaRawPkcs1Signer::signature_length() { return RSA_size(key_.get()); }
@@ -92,6 +94,19 @@ size_t RsaRawPkcs1Signer::signature_length() { return RSA_size(key_.get()); }
 absl::Status RsaRawPkcs1Signer::Sign(KmsClient* client,
                                      absl::Span<const uint8_t> data,
                                      absl::Span<uint8_t> signature) {
+  CallArena arena;
+  kms_v1::AsymmetricSignRequest* req =
+      arena.Create<kms_v1::AsymmetricSignRequest>();
+  RETURN_IF_ERROR(PrepareSign(data, signature, req));
+
+  ASSIGN_OR_RETURN(kms_v1::AsymmetricSignResponse * resp,
+                   client->AsymmetricSign(*req, arena.get()));
+  return FinishSign(*resp, signature);
+}
+
+absl::Status RsaRawPkcs1Signer::PrepareSign(
+    absl::Span<const uint8_t> data, absl::Span<uint8_t> signature,
+    kms_v1::AsymmetricSignRequest* req) {
   size_t key_byte_length = RSA_size(key_.get());
   constexpr size_t kRsaPkcs1OverheadBytes = 11;
   // I don't know how we'd end up with a <11-byte key, but for completeness, and
@@ -116,14 +131,15 @@ absl::Status RsaRawPkcs1Signer::Sign(KmsClient* client,
         SOURCE_LOCATION);
   }
 
-  kms_v1::AsymmetricSignRequest req;
-  req.set_name(std::string(object_->kms_key_name()));
-  req.set_data(
-      std::string(reinterpret_cast<const char*>(data.data()), data.size()));
+  req->set_name(std::string(object_->kms_key_name()));
+  req->set_data(data.data(), data.size());
+  return absl::OkStatus();
+}
 
-  ASSIGN_OR_RETURN(kms_v1::AsymmetricSignResponse resp,
-                   client->AsymmetricSign(req));
-  std::copy(resp.signature().begin(), resp.signature().end(),
+absl::Status RsaRawPkcs1Signer::FinishSign(
+    const kms_v1::AsymmetricSignResponse& response,
+    absl::Span<uint8_t> signature) {
+  std::copy(response.signature().begin(), response.signature().end(),
             signature.begin());
   return absl::OkStatus();
 }
@@ -176,13 +192,10 @@ absl::StatusOr<std::unique_ptr<VerifierInterface>> RsaRawPkcs1Verifier::New(
       CheckKeyPreconditions(CKK_RSA, CKO_PUBLIC_KEY, CKM_RSA_PKCS, key.get()));
   RETURN_IF_ERROR(EnsureNoParameters(mechanism));
 
-  ASSIGN_OR_RETURN(std::string_view key_der,
-                   key->attributes().Value(CKA_PUBLIC_KEY_INFO));
-  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> parsed_key,
-                   ParseX509PublicKeyDer(key_der));
+  ASSIGN_OR_RETURN(bssl::UniquePtr<EVP_PKEY> public_key, key->GetPublicKey());
 
   return std::unique_ptr<VerifierInterface>(new RsaRawPkcs1Verifier(
-      key, bssl::UniquePtr<RSA>(EVP_PKEY_get1_RSA(parsed_key.get()))));
+      key, bssl::UniquePtr<RSA>(EVP_PKEY_get1_RSA(public_key.get()))));
 }
 
 absl::Status RsaRawPkcs1Verifier::Verify(KmsClient* client,
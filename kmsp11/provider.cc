@@ -14,11 +14,15 @@
 
 #include "kmsp11/provider.h"
 
+#include <algorithm>
+
 #include "common/kms_client.h"
 #include "common/status_macros.h"
 #include "glog/logging.h"
 #include "kmsp11/cert_authority.h"
 #include "kmsp11/mechanism.h"
+#include "kmsp11/metrics.h"
+#include "kmsp11/util/ec_verify_tables.h"
 #include "kmsp11/util/string_utils.h"
 #include "kmsp11/version.h"
 
@@ -27,6 +31,7 @@ namespace {
 
 static const char* kDefaultKmsEndpoint = "cloudkms.googleapis.com:443";
 constexpr absl::Duration kDefaultRpcTimeout = absl::Seconds(30);
+constexpr absl::Duration kDefaultMetricsInterval = absl::Seconds(60);
 
 absl::StatusOr<CK_INFO> NewCkInfo() {
   CK_INFO info = {
@@ -42,6 +47,46 @@ absl::StatusOr<CK_INFO> NewCkInfo() {
   return info;
 }
 
+AdmissionController::Options NewAdmissionControllerOptions(
+    const AdmissionControlConfig& config) {
+  AdmissionController::Options options;
+  options.requests_per_second = config.requests_per_second();
+  if (config.burst() > 0) {
+    options.burst = config.burst();
+  }
+  if (config.initial_concurrency() > 0) {
+    options.initial_limit = config.initial_concurrency();
+  }
+  if (config.max_concurrency() > 0) {
+    options.max_limit = config.max_concurrency();
+  }
+  options.latency_threshold =
+      absl::Milliseconds(config.latency_threshold_millis());
+  if (config.max_queue_depth() > 0) {
+    options.max_queue_depth = config.max_queue_depth();
+  }
+  if (config.max_queue_wait_millis() > 0) {
+    options.max_queue_wait = absl::Milliseconds(config.max_queue_wait_millis());
+  }
+  return options;
+}
+
+EcVerifyTables::Options NewEcVerifyTablesOptions(const LibraryConfig& config) {
+  EcVerifyTables::Options options;
+  if (!config.has_ec_verify_tables()) {
+    options.max_memory_bytes = 0;
+    return options;
+  }
+  if (config.ec_verify_tables().max_memory_mib() > 0) {
+    options.max_memory_bytes =
+        size_t{config.ec_verify_tables().max_memory_mib()} << 20;
+  }
+  if (config.ec_verify_tables().min_uses() > 0) {
+    options.min_uses = config.ec_verify_tables().min_uses();
+  }
+  return options;
+}
+
 absl::StatusOr<std::unique_ptr<KmsClient>> NewKmsClient(
     const LibraryConfig& config) {
   KmsClient::Options options;
@@ -74,6 +119,48 @@ absl::StatusOr<std::unique_ptr<KmsClient>> NewKmsClient(
   };
   options.rpc_feature_flags = config.experimental_rpc_feature_flags();
   options.user_project_override = config.user_project_override();
+  if (config.channel_pool_size() > 0) {
+    options.channel_pool_size = config.channel_pool_size();
+  }
+  if (config.has_mac_verify_cache()) {
+    MacVerifyCache::Options cache;
+    if (config.mac_verify_cache().max_entries() > 0) {
+      cache.max_entries = config.mac_verify_cache().max_entries();
+    }
+    if (config.mac_verify_cache().ttl_secs() > 0) {
+      cache.ttl = absl::Seconds(config.mac_verify_cache().ttl_secs());
+    }
+    options.mac_verify_cache = cache;
+  }
+  if (config.has_hedging()) {
+    HedgePolicy::Options hedging;
+    if (config.hedging().delay_percentile() > 0) {
+      hedging.delay_percentile =
+          std::min(config.hedging().delay_percentile(), 100u) / 100.0;
+    }
+    if (config.hedging().initial_delay_millis() > 0) {
+      hedging.initial_delay =
+          absl::Milliseconds(config.hedging().initial_delay_millis());
+    }
+    if (config.hedging().max_hedge_percent() > 0) {
+      hedging.max_hedge_fraction =
+          std::min(config.hedging().max_hedge_percent(), 100u) / 100.0;
+    }
+    options.hedging = hedging;
+  }
+  if (!config.metrics().output_path().empty()) {
+    options.metrics = &MetricsRegistry::Global();
+  }
+  if (config.has_admission_control()) {
+    options.admission_control =
+        NewAdmissionControllerOptions(config.admission_control());
+  }
+  for (const TokenConfig& token_config : config.tokens()) {
+    if (token_config.has_admission_control()) {
+      options.key_ring_admission_control[token_config.key_ring()] =
+          NewAdmissionControllerOptions(token_config.admission_control());
+    }
+  }
 
   return std::make_unique<KmsClient>(options);
 }
@@ -83,20 +170,30 @@ absl::StatusOr<std::unique_ptr<KmsClient>> NewKmsClient(
 absl::StatusOr<std::unique_ptr<Provider>> Provider::New(LibraryConfig config) {
   ASSIGN_OR_RETURN(CK_INFO info, NewCkInfo());
   ASSIGN_OR_RETURN(std::unique_ptr<KmsClient> client, NewKmsClient(config));
+  EcVerifyTables::Global().Configure(NewEcVerifyTablesOptions(config));
 
   std::vector<std::unique_ptr<Token>> tokens;
   tokens.reserve(config.tokens_size());
   for (const TokenConfig& tokenConfig : config.tokens()) {
     ASSIGN_OR_RETURN(std::unique_ptr<Token> token,
                      Token::New(tokens.size(), tokenConfig, client.get(),
-                                config.generate_certs(), config.allow_software_keys()));
+                                config.generate_certs(),
+                                config.allow_software_keys(),
+                                config.state_cache_directory()));
     tokens.emplace_back(std::move(token));
   }
 
+  // Tokens that were loaded from a snapshot are revalidated in the background
+  // right away.
+  bool revalidate = std::any_of(tokens.begin(), tokens.end(),
+                                [](const std::unique_ptr<Token>& t) {
+                                  return t->loaded_from_snapshot();
+                                });
+
   // using `new` to invoke a private constructor
   return std::unique_ptr<Provider>(
       new Provider(config, info, std::move(tokens), std::move(client),
-                   absl::Seconds(config.refresh_interval_secs())));
+                   absl::Seconds(config.refresh_interval_secs()), revalidate));
 }
 
 absl::StatusOr<Token*> Provider::TokenAt(CK_SLOT_ID slot_id) {
@@ -130,11 +227,12 @@ absl::Status Provider::CloseAllSessions(CK_SLOT_ID slot_id) {
   return absl::OkStatus();
 }
 
-Provider::Refresher::Refresher(Provider* provider, absl::Duration interval)
+Provider::Refresher::Refresher(Provider* provider, absl::Duration interval,
+                               bool refresh_immediately)
     : thread_(
           [](Provider* provider, const absl::Duration interval,
-             const absl::Notification* shutdown) {
-            while (!shutdown->WaitForNotificationWithTimeout(interval)) {
+             bool refresh_immediately, const absl::Notification* shutdown) {
+            auto refresh_all = [provider] {
               for (const std::unique_ptr<Token>& token : provider->tokens_) {
                 absl::Status refresh_result =
                     token->RefreshState(*provider->kms_client_);
@@ -144,15 +242,32 @@ Provider::Refresher::Refresher(Provider* provider, absl::Duration interval)
                       << token->key_ring_name() << ": " << refresh_result;
                 }
               }
+            };
+            if (refresh_immediately) {
+              refresh_all();
+            }
+            while (!shutdown->WaitForNotificationWithTimeout(interval)) {
+              refresh_all();
             }
           },
-          provider, interval, &shutdown_) {}
+          provider, interval, refresh_immediately, &shutdown_) {}
 
 Provider::Refresher::~Refresher() {
   shutdown_.Notify();
   thread_.join();
 }
 
+void Provider::StartMetricsExporter() {
+  const MetricsConfig& config = library_config_.metrics();
+  if (config.output_path().empty()) {
+    return;
+  }
+  metrics_exporter_ = std::make_unique<MetricsExporter>(
+      &MetricsRegistry::Global(), config.output_path(),
+      config.interval_secs() == 0 ? kDefaultMetricsInterval
+                                  : absl::Seconds(config.interval_secs()));
+}
+
 absl::Span<const CK_MECHANISM_TYPE> Provider::Mechanisms() {
   return mechanism_types_;
 }
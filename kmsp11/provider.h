@@ -24,6 +24,7 @@
 #include "kmsp11/config/config.pb.h"
 #include "kmsp11/cryptoki.h"
 #include "kmsp11/mechanism.h"
+#include "kmsp11/metrics.h"
 #include "kmsp11/session.h"
 #include "kmsp11/token.h"
 #include "kmsp11/util/errors.h"
@@ -61,7 +62,10 @@ class Provider {
  private:
   class Refresher {
    public:
-    Refresher(Provider* provider, absl::Duration interval);
+    // If `refresh_immediately` is true, a refresh is started right away rather
+    // than after the first interval elapses.
+    Refresher(Provider* provider, absl::Duration interval,
+              bool refresh_immediately);
     virtual ~Refresher();
 
    private:
@@ -69,17 +73,23 @@ class Provider {
     std::thread thread_;
   };
 
+  // Starts writing metrics, if metrics output is configured.
+  void StartMetricsExporter();
+
   Provider(LibraryConfig library_config, CK_INFO info,
            std::vector<std::unique_ptr<Token>>&& tokens,
            std::unique_ptr<KmsClient> kms_client,
-           absl::Duration refresh_interval)
+           absl::Duration refresh_interval, bool refresh_immediately)
       : library_config_(library_config),
         info_(info),
         tokens_(std::move(tokens)),
         sessions_(CKR_SESSION_HANDLE_INVALID),
         kms_client_(std::move(kms_client)) {
+    StartMetricsExporter();
     if (refresh_interval > absl::ZeroDuration()) {
-      refresher_.emplace(this, refresh_interval);
+      refresher_.emplace(this, refresh_interval, refresh_immediately);
+    } else if (refresh_immediately) {
+      refresher_.emplace(this, absl::InfiniteDuration(), refresh_immediately);
     }
     auto all_mechanisms = AllMechanisms();
     auto all_mac_mechanisms = AllMacMechanisms();
@@ -98,6 +108,7 @@ class Provider {
   HandleMap<Session> sessions_;
   std::unique_ptr<KmsClient> kms_client_;
   std::optional<Refresher> refresher_;
+  std::unique_ptr<MetricsExporter> metrics_exporter_;
   std::vector<CK_MECHANISM_TYPE> mechanism_types_;
 };
 
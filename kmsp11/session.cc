@@ -278,7 +278,28 @@ CK_SESSION_INFO Session::info() const {
 
 void Session::ReleaseOperation() {
   absl::MutexLock l(&op_mutex_);
+  // An operation that outlived a token refresh may hold an Object that is no
+  // longer current, so it isn't pooled.
+  if (op_.has_value() && op_mechanism_.has_value() && PoolsAreCurrent()) {
+    if (SignOp* op = std::get_if<SignOp>(&*op_)) {
+      sign_pool_.Release(*std::move(op_mechanism_), std::move(*op));
+    } else if (VerifyOp* op = std::get_if<VerifyOp>(&*op_)) {
+      verify_pool_.Release(*std::move(op_mechanism_), std::move(*op));
+    }
+  }
   op_ = std::nullopt;
+  op_mechanism_ = std::nullopt;
+}
+
+bool Session::PoolsAreCurrent() {
+  uint64_t generation = token_->store_generation();
+  if (generation == pool_generation_) {
+    return true;
+  }
+  sign_pool_.Clear();
+  verify_pool_.Clear();
+  pool_generation_ = generation;
+  return false;
 }
 
 absl::Status Session::FindObjectsInit(
@@ -289,17 +310,7 @@ absl::Status Session::FindObjectsInit(
     return OperationActiveError(SOURCE_LOCATION);
   }
 
-  std::vector<CK_OBJECT_HANDLE> results =
-      token_->FindObjects([&attributes](const Object& o) -> bool {
-        for (const CK_ATTRIBUTE& attr : attributes) {
-          if (!o.attributes().Contains(attr)) {
-            return false;
-          }
-        }
-        return true;
-      });
-
-  op_ = FindOp(results);
+  op_ = FindOp(token_->FindObjects(attributes));
   return absl::OkStatus();
 }
 
@@ -327,14 +338,16 @@ absl::Status Session::FindObjectsFinal() {
 }
 
 absl::Status Session::DecryptInit(std::shared_ptr<Object> key,
-                                  CK_MECHANISM* mechanism) {
+                                  CK_MECHANISM* mechanism,
+                                  bool streaming_multipart_aes) {
   absl::MutexLock l(&op_mutex_);
 
   if (op_.has_value()) {
     return OperationActiveError(SOURCE_LOCATION);
   }
 
-  ASSIGN_OR_RETURN(op_, NewDecryptOp(key, mechanism));
+  ASSIGN_OR_RETURN(op_,
+                   NewDecryptOp(key, mechanism, streaming_multipart_aes));
   return absl::OkStatus();
 }
 
@@ -349,7 +362,8 @@ absl::StatusOr<absl::Span<const uint8_t>> Session::Decrypt(
   return std::get<DecryptOp>(*op_)->Decrypt(kms_client_, ciphertext);
 }
 
-absl::Status Session::DecryptUpdate(absl::Span<const uint8_t> ciphertext) {
+absl::StatusOr<absl::Span<const uint8_t>> Session::DecryptUpdate(
+    absl::Span<const uint8_t> ciphertext) {
   absl::MutexLock l(&op_mutex_);
 
   if (!op_.has_value() || !std::holds_alternative<DecryptOp>(*op_)) {
@@ -369,15 +383,32 @@ absl::StatusOr<absl::Span<const uint8_t>> Session::DecryptFinal() {
   return std::get<DecryptOp>(*op_)->DecryptFinal(kms_client_);
 }
 
+absl::StatusOr<std::optional<size_t>> Session::DecryptUpdateOutputLength(
+    size_t ciphertext_length) {
+  absl::MutexLock l(&op_mutex_);
+
+  if (!op_.has_value() || !std::holds_alternative<DecryptOp>(*op_)) {
+    return OperationNotInitializedError("decrypt", SOURCE_LOCATION);
+  }
+
+  DecryptOp& op = std::get<DecryptOp>(*op_);
+  if (!op->StreamsUpdateOutput()) {
+    return std::nullopt;
+  }
+  return op->DecryptUpdateOutputLength(ciphertext_length);
+}
+
 absl::Status Session::EncryptInit(std::shared_ptr<Object> key,
-                                  CK_MECHANISM* mechanism) {
+                                  CK_MECHANISM* mechanism,
+                                  bool streaming_multipart_aes) {
   absl::MutexLock l(&op_mutex_);
 
   if (op_.has_value()) {
     return OperationActiveError(SOURCE_LOCATION);
   }
 
-  ASSIGN_OR_RETURN(op_, NewEncryptOp(key, mechanism));
+  ASSIGN_OR_RETURN(op_,
+                   NewEncryptOp(key, mechanism, streaming_multipart_aes));
   return absl::OkStatus();
 }
 
@@ -392,7 +423,8 @@ absl::StatusOr<absl::Span<const uint8_t>> Session::Encrypt(
   return std::get<EncryptOp>(*op_)->Encrypt(kms_client_, plaintext);
 }
 
-absl::Status Session::EncryptUpdate(absl::Span<const uint8_t> plaintext) {
+absl::StatusOr<absl::Span<const uint8_t>> Session::EncryptUpdate(
+    absl::Span<const uint8_t> plaintext) {
   absl::MutexLock l(&op_mutex_);
 
   if (!op_.has_value() || !std::holds_alternative<EncryptOp>(*op_)) {
@@ -401,6 +433,7 @@ absl::Status Session::EncryptUpdate(absl::Span<const uint8_t> plaintext) {
 
   return std::get<EncryptOp>(*op_)->EncryptUpdate(kms_client_, plaintext);
 }
+
 absl::StatusOr<absl::Span<const uint8_t>> Session::EncryptFinal() {
   absl::MutexLock l(&op_mutex_);
 
@@ -411,6 +444,21 @@ absl::StatusOr<absl::Span<const uint8_t>> Session::EncryptFinal() {
   return std::get<EncryptOp>(*op_)->EncryptFinal(kms_client_);
 }
 
+absl::StatusOr<std::optional<size_t>> Session::EncryptUpdateOutputLength(
+    size_t plaintext_length) {
+  absl::MutexLock l(&op_mutex_);
+
+  if (!op_.has_value() || !std::holds_alternative<EncryptOp>(*op_)) {
+    return OperationNotInitializedError("encrypt", SOURCE_LOCATION);
+  }
+
+  EncryptOp& op = std::get<EncryptOp>(*op_);
+  if (!op->StreamsUpdateOutput()) {
+    return std::nullopt;
+  }
+  return op->EncryptUpdateOutputLength(plaintext_length);
+}
+
 absl::Status Session::SignInit(std::shared_ptr<Object> key,
                                CK_MECHANISM* mechanism) {
   absl::MutexLock l(&op_mutex_);
@@ -419,7 +467,13 @@ absl::Status Session::SignInit(std::shared_ptr<Object> key,
     return OperationActiveError(SOURCE_LOCATION);
   }
 
-  ASSIGN_OR_RETURN(op_, NewSignOp(key, mechanism));
+  PoolsAreCurrent();
+  if (SignOp op = sign_pool_.Acquire(key.get(), *mechanism)) {
+    op_ = std::move(op);
+  } else {
+    ASSIGN_OR_RETURN(op_, NewSignOp(key, mechanism));
+  }
+  op_mechanism_ = PooledMechanism::Copy(*mechanism);
   return absl::OkStatus();
 }
 
@@ -472,7 +526,13 @@ absl::Status Session::VerifyInit(std::shared_ptr<Object> key,
     return OperationActiveError(SOURCE_LOCATION);
   }
 
-  ASSIGN_OR_RETURN(op_, NewVerifyOp(key, mechanism));
+  PoolsAreCurrent();
+  if (VerifyOp op = verify_pool_.Acquire(key.get(), *mechanism)) {
+    op_ = std::move(op);
+  } else {
+    ASSIGN_OR_RETURN(op_, NewVerifyOp(key, mechanism));
+  }
+  op_mechanism_ = PooledMechanism::Copy(*mechanism);
   return absl::OkStatus();
 }
 
@@ -17,7 +17,10 @@
 #ifndef KMSP11_SESSION_H_
 #define KMSP11_SESSION_H_
 
+#include <optional>
+
 #include "kmsp11/operation/operation.h"
+#include "kmsp11/operation/operation_pool.h"
 #include "kmsp11/token.h"
 
 namespace cloud_kms::kmsp11 {
@@ -35,7 +38,10 @@ struct AsymmetricHandleSet {
 class Session {
  public:
   Session(Token* token, SessionType session_type, KmsClient* kms_client)
-      : token_(token), session_type_(session_type), kms_client_(kms_client) {}
+      : token_(token),
+        session_type_(session_type),
+        kms_client_(kms_client),
+        pool_generation_(token->store_generation()) {}
 
   Token* token() const { return token_; }
   CK_SESSION_INFO info() const;
@@ -48,18 +54,32 @@ class Session {
   absl::Status FindObjectsFinal();
 
   absl::Status DecryptInit(std::shared_ptr<Object> key,
-                           CK_MECHANISM* mechanism);
+                           CK_MECHANISM* mechanism,
+                           bool streaming_multipart_aes = false);
   absl::StatusOr<absl::Span<const uint8_t>> Decrypt(
       absl::Span<const uint8_t> ciphertext);
-  absl::Status DecryptUpdate(absl::Span<const uint8_t> ciphertext);
+  absl::StatusOr<absl::Span<const uint8_t>> DecryptUpdate(
+      absl::Span<const uint8_t> ciphertext);
   absl::StatusOr<absl::Span<const uint8_t>> DecryptFinal();
+  // Returns the length of the output that DecryptUpdate will return for a part
+  // of the provided length, or nullopt if the operation does not return output
+  // until DecryptFinal.
+  absl::StatusOr<std::optional<size_t>> DecryptUpdateOutputLength(
+      size_t ciphertext_length);
 
   absl::Status EncryptInit(std::shared_ptr<Object> key,
-                           CK_MECHANISM* mechanism);
+                           CK_MECHANISM* mechanism,
+                           bool streaming_multipart_aes = false);
   absl::StatusOr<absl::Span<const uint8_t>> Encrypt(
       absl::Span<const uint8_t> plaintext);
-  absl::Status EncryptUpdate(absl::Span<const uint8_t> plaintext);
+  absl::StatusOr<absl::Span<const uint8_t>> EncryptUpdate(
+      absl::Span<const uint8_t> plaintext);
   absl::StatusOr<absl::Span<const uint8_t>> EncryptFinal();
+  // Returns the length of the output that EncryptUpdate will return for a part
+  // of the provided length, or nullopt if the operation does not return output
+  // until EncryptFinal.
+  absl::StatusOr<std::optional<size_t>> EncryptUpdateOutputLength(
+      size_t plaintext_length);
 
   absl::Status SignInit(std::shared_ptr<Object> key, CK_MECHANISM* mechanism);
   absl::Status Sign(absl::Span<const uint8_t> digest,
@@ -92,12 +112,29 @@ class Session {
   absl::Status GenerateRandom(absl::Span<uint8_t> buffer);
 
  private:
+  // Empties the operation pools if the token's objects have been refreshed
+  // since they were filled, and returns false if it did so.
+  bool PoolsAreCurrent() ABSL_EXCLUSIVE_LOCKS_REQUIRED(op_mutex_);
+
   Token* token_;
   const SessionType session_type_;
   KmsClient* kms_client_;
 
   absl::Mutex op_mutex_;
   std::optional<Operation> op_ ABSL_GUARDED_BY(op_mutex_);
+
+  // The mechanism that op_ was initialized with, if op_ is a sign or verify
+  // operation that may be returned to a pool when it is released.
+  std::optional<PooledMechanism> op_mechanism_ ABSL_GUARDED_BY(op_mutex_);
+  // Completed sign and verify operations, which are reused by SignInit and
+  // VerifyInit for the same key and mechanism so that applications that
+  // initialize an operation for every signature don't rebuild it each time.
+  OperationPool<SignOp> sign_pool_ ABSL_GUARDED_BY(op_mutex_);
+  OperationPool<VerifyOp> verify_pool_ ABSL_GUARDED_BY(op_mutex_);
+  // The token store generation that pooled operations belong to. Pooled
+  // operations hold their key Object, so they are dropped once the token
+  // replaces its objects rather than keeping the old ones alive.
+  uint64_t pool_generation_ ABSL_GUARDED_BY(op_mutex_);
 };
 
 }  // namespace cloud_kms::kmsp11
@@ -638,6 +638,117 @@ TEST_F(SessionTest, Sign) {
                              digest, signature));
 }
 
+TEST_F(SessionTest, SignAfterReusedMultiPartSign) {
+  auto kms_client = fake_server_->NewClient();
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::ASYMMETRIC_SIGN);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+  ck.mutable_version_template()->set_protection_level(
+      kms_v1::ProtectionLevel::HSM);
+  ck = CreateCryptoKeyOrDie(kms_client.get(), key_ring_.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(kms_client.get(), ck.name(), ckv);
+  ckv = WaitForEnablement(kms_client.get(), ckv);
+
+  kms_v1::PublicKey pub_proto = GetPublicKeyOrDie(kms_client.get(), ckv);
+  ASSERT_OK_AND_ASSIGN(bssl::UniquePtr<EVP_PKEY> pub,
+                       ParseX509PublicKeyPem(pub_proto.pem()));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Token> token,
+                       Token::New(0, config_, client_.get()));
+  Session s(token.get(), SessionType::kReadOnly, client_.get());
+
+  std::vector<CK_OBJECT_HANDLE> handles =
+      s.token()->FindObjects([&](const Object& o) -> bool {
+        return o.kms_key_name() == ckv.name() &&
+               o.object_class() == CKO_PRIVATE_KEY;
+      });
+  EXPECT_EQ(handles.size(), 1);
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Object> object,
+                       s.token()->GetObject(handles[0]));
+
+  CK_MECHANISM mech{CKM_ECDSA_SHA256, nullptr, 0};
+  uint8_t data[] = {0xDE, 0xAD, 0xBE, 0xEF}, signature[64];
+
+  EXPECT_OK(s.SignInit(object, &mech));
+  EXPECT_OK(s.SignUpdate(data));
+  EXPECT_OK(s.SignFinal(absl::MakeSpan(signature)));
+  s.ReleaseOperation();
+
+  // The released operation is reused, and must not carry over the state of
+  // the multi-part operation.
+  EXPECT_OK(s.SignInit(object, &mech));
+  EXPECT_OK(s.Sign(data, absl::MakeSpan(signature)));
+  s.ReleaseOperation();
+
+  uint8_t digest[32];
+  SHA256(data, sizeof(data), digest);
+  EXPECT_OK(EcdsaVerifyP1363(EVP_PKEY_get0_EC_KEY(pub.get()), EVP_sha256(),
+                             digest, signature));
+}
+
+TEST_F(SessionTest, PooledOperationsDroppedAfterRefresh) {
+  auto kms_client = fake_server_->NewClient();
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::ASYMMETRIC_SIGN);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+  ck.mutable_version_template()->set_protection_level(
+      kms_v1::ProtectionLevel::HSM);
+  ck = CreateCryptoKeyOrDie(kms_client.get(), key_ring_.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv1;
+  ckv1 = CreateCryptoKeyVersionOrDie(kms_client.get(), ck.name(), ckv1);
+  ckv1 = WaitForEnablement(kms_client.get(), ckv1);
+
+  kms_v1::CryptoKeyVersion ckv2;
+  ckv2 = CreateCryptoKeyVersionOrDie(kms_client.get(), ck.name(), ckv2);
+  ckv2 = WaitForEnablement(kms_client.get(), ckv2);
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Token> token,
+                       Token::New(0, config_, client_.get()));
+  Session s(token.get(), SessionType::kReadOnly, client_.get());
+
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE handle1,
+                       token->FindSingleObject([&](const Object& o) -> bool {
+                         return o.kms_key_name() == ckv1.name() &&
+                                o.object_class() == CKO_PRIVATE_KEY;
+                       }));
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Object> object1,
+                       token->GetObject(handle1));
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE handle2,
+                       token->FindSingleObject([&](const Object& o) -> bool {
+                         return o.kms_key_name() == ckv2.name() &&
+                                o.object_class() == CKO_PRIVATE_KEY;
+                       }));
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Object> object2,
+                       token->GetObject(handle2));
+
+  CK_MECHANISM mech{CKM_ECDSA, nullptr, 0};
+  uint8_t digest[32], signature[64];
+  EXPECT_OK(s.SignInit(object1, &mech));
+  EXPECT_OK(s.Sign(digest, absl::MakeSpan(signature)));
+  s.ReleaseOperation();
+
+  std::weak_ptr<Object> pooled_key = object1;
+  object1.reset();
+
+  // Once ckv1 is disabled, only the pooled operation refers to its Object.
+  ckv1.set_state(kms_v1::CryptoKeyVersion::DISABLED);
+  google::protobuf::FieldMask update_mask;
+  update_mask.add_paths("state");
+  ckv1 = UpdateCryptoKeyVersionOrDie(kms_client.get(), ckv1, update_mask);
+  ASSERT_OK(token->RefreshState(*client_));
+  EXPECT_FALSE(pooled_key.expired());
+
+  EXPECT_OK(s.SignInit(object2, &mech));
+  EXPECT_TRUE(pooled_key.expired());
+}
+
 TEST_F(SessionTest, SignInitAlreadyActive) {
   auto kms_client = fake_server_->NewClient();
 
@@ -0,0 +1,176 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/state_snapshot.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "common/openssl.h"
+#include "common/platform.h"
+#include "common/status_macros.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "kmsp11/util/crypto_utils.h"
+#include "kmsp11/util/errors.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+// The snapshot file format is a fixed-size header followed by a serialized
+// StateSnapshot proto (the payload). All integers are little-endian.
+//
+//   offset  size  field
+//   0       8     magic ("KMSP11SS")
+//   8       4     format version
+//   12      4     reserved (zero)
+//   16      8     payload length
+//   24      32    SHA-256 digest of the payload
+//   56            payload
+constexpr std::string_view kMagic = "KMSP11SS";
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kHeaderSize = 56;
+
+void AppendLittleEndian(uint64_t value, size_t size, std::string* dest) {
+  for (size_t i = 0; i < size; i++) {
+    dest->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+uint64_t ReadLittleEndian(std::string_view src, size_t offset, size_t size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; i++) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(src[offset + i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+std::string Sha256(std::string_view data) {
+  std::string digest(SHA256_DIGEST_LENGTH, '\0');
+  SHA256(reinterpret_cast<const uint8_t*>(data.data()), data.size(),
+         reinterpret_cast<uint8_t*>(digest.data()));
+  return digest;
+}
+
+absl::Status SnapshotError(std::string_view path, std::string_view reason,
+                           const SourceLocation& source_location) {
+  return NewError(absl::StatusCode::kFailedPrecondition,
+                  absl::StrCat("snapshot ", path, " is unusable: ", reason),
+                  CKR_GENERAL_ERROR, source_location);
+}
+
+}  // namespace
+
+std::string StateSnapshotPath(std::string_view directory,
+                              std::string_view key_ring_name) {
+  // Key ring names contain path separators, so use a digest of the name.
+  return absl::StrCat(directory, "/",
+                      absl::BytesToHexString(Sha256(key_ring_name)),
+                      ".snapshot");
+}
+
+std::string StateConfigDigest(const TokenConfig& token_config,
+                              bool generate_certs, bool allow_software_keys) {
+  std::string config;
+  google::protobuf::io::StringOutputStream stream(&config);
+  {
+    google::protobuf::io::CodedOutputStream coded(&stream);
+    coded.SetSerializationDeterministic(true);
+    token_config.SerializeToCodedStream(&coded);
+  }
+  return Sha256(absl::StrCat(config, generate_certs ? "1" : "0",
+                             allow_software_keys ? "1" : "0"));
+}
+
+absl::StatusOr<StateSnapshot> ReadStateSnapshot(const std::string& path) {
+  ASSIGN_OR_RETURN(std::unique_ptr<MappedFile> file,
+                   MappedFile::Open(path.c_str()));
+  RETURN_IF_ERROR(EnsureWriteProtected(path.c_str()));
+
+  std::string_view contents = file->contents();
+  if (contents.size() < kHeaderSize ||
+      contents.substr(0, kMagic.size()) != kMagic) {
+    return SnapshotError(path, "missing header", SOURCE_LOCATION);
+  }
+  uint32_t version = ReadLittleEndian(contents, 8, 4);
+  if (version != kFormatVersion) {
+    return SnapshotError(
+        path, absl::StrCat("unsupported format version ", version),
+        SOURCE_LOCATION);
+  }
+  uint64_t payload_length = ReadLittleEndian(contents, 16, 8);
+  std::string_view payload = contents.substr(kHeaderSize);
+  if (payload.size() != payload_length) {
+    return SnapshotError(path, "unexpected length", SOURCE_LOCATION);
+  }
+  if (Sha256(payload) != contents.substr(24, SHA256_DIGEST_LENGTH)) {
+    return SnapshotError(path, "digest mismatch", SOURCE_LOCATION);
+  }
+
+  StateSnapshot snapshot;
+  if (!snapshot.ParseFromArray(payload.data(), payload.size())) {
+    return SnapshotError(path, "payload could not be parsed", SOURCE_LOCATION);
+  }
+  return snapshot;
+}
+
+absl::Status WriteStateSnapshot(const std::string& path,
+                                const StateSnapshot& snapshot) {
+  std::string payload = snapshot.SerializeAsString();
+
+  std::string header(kMagic);
+  AppendLittleEndian(kFormatVersion, 4, &header);
+  AppendLittleEndian(0, 4, &header);
+  AppendLittleEndian(payload.size(), 8, &header);
+  header.append(Sha256(payload));
+
+  // Write to a uniquely named temporary file and rename it into place, so that
+  // concurrent readers and writers never observe a partially written file.
+  std::string temp_path =
+      absl::StrCat(path, ".", absl::BytesToHexString(RandBytes(8)), ".tmp");
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    out << header << payload;
+    out.close();
+    if (!out) {
+      std::error_code ignored;
+      std::filesystem::remove(temp_path, ignored);
+      return NewInternalError(
+          absl::StrCat("error writing snapshot file ", temp_path),
+          SOURCE_LOCATION);
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::permissions(temp_path,
+                               std::filesystem::perms::owner_read |
+                                   std::filesystem::perms::owner_write,
+                               ec);
+  if (!ec) {
+    std::filesystem::rename(temp_path, path, ec);
+  }
+  if (ec) {
+    std::error_code ignored;
+    std::filesystem::remove(temp_path, ignored);
+    return NewInternalError(absl::StrCat("error moving snapshot file into ",
+                                         path, ": ", ec.message()),
+                            SOURCE_LOCATION);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace cloud_kms::kmsp11
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KMSP11_STATE_SNAPSHOT_H_
+#define KMSP11_STATE_SNAPSHOT_H_
+
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "kmsp11/config/config.pb.h"
+#include "kmsp11/object_store_state.pb.h"
+
+namespace cloud_kms::kmsp11 {
+
+// Returns the path of the snapshot file for `key_ring_name` in `directory`.
+std::string StateSnapshotPath(std::string_view directory,
+                              std::string_view key_ring_name);
+
+// Returns a digest of the configuration options that affect the contents of a
+// token's ObjectStoreState.
+std::string StateConfigDigest(const TokenConfig& token_config,
+                              bool generate_certs, bool allow_software_keys);
+
+// Reads a snapshot that was written by WriteStateSnapshot. An error is
+// returned if the file is missing, has excessive write permissions, was
+// written in a different format version, or fails its integrity check.
+absl::StatusOr<StateSnapshot> ReadStateSnapshot(const std::string& path);
+
+// Writes `snapshot` to `path`, replacing any existing file atomically.
+absl::Status WriteStateSnapshot(const std::string& path,
+                                const StateSnapshot& snapshot);
+
+}  // namespace cloud_kms::kmsp11
+
+#endif  // KMSP11_STATE_SNAPSHOT_H_
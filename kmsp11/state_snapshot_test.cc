@@ -0,0 +1,143 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/state_snapshot.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "common/kms_v1.h"
+#include "common/test/test_status_macros.h"
+#include "gmock/gmock.h"
+#include "kmsp11/test/matchers.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+StateSnapshot NewSnapshot() {
+  StateSnapshot snapshot;
+  snapshot.set_key_ring_name("projects/foo/locations/bar/keyRings/baz");
+  snapshot.set_config_digest("digest");
+
+  Key* key = snapshot.mutable_state()->add_keys();
+  key->mutable_crypto_key_version()->set_name(
+      "projects/foo/locations/bar/keyRings/baz/cryptoKeys/qux/"
+      "cryptoKeyVersions/1");
+  key->mutable_crypto_key_version()->set_algorithm(
+      kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+  key->set_public_key_der("public key");
+  key->set_public_key_handle(1001);
+  key->set_private_key_handle(1002);
+  return snapshot;
+}
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  return contents.str();
+}
+
+void WriteFile(const std::string& path, std::string_view contents) {
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+}
+
+class StateSnapshotTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = StateSnapshotPath(testing::TempDir(),
+                              "projects/foo/locations/bar/keyRings/baz");
+  }
+
+  std::string path_;
+};
+
+TEST_F(StateSnapshotTest, PathDoesNotContainKeyRingName) {
+  EXPECT_THAT(path_, Not(HasSubstr("keyRings")));
+}
+
+TEST_F(StateSnapshotTest, PathDiffersByKeyRing) {
+  EXPECT_NE(path_,
+            StateSnapshotPath(testing::TempDir(),
+                              "projects/foo/locations/bar/keyRings/qux"));
+}
+
+TEST_F(StateSnapshotTest, RoundTrip) {
+  StateSnapshot snapshot = NewSnapshot();
+  ASSERT_OK(WriteStateSnapshot(path_, snapshot));
+
+  EXPECT_THAT(ReadStateSnapshot(path_), IsOkAndHolds(EqualsProto(snapshot)));
+}
+
+TEST_F(StateSnapshotTest, WriteReplacesExistingSnapshot) {
+  ASSERT_OK(WriteStateSnapshot(path_, NewSnapshot()));
+
+  StateSnapshot updated = NewSnapshot();
+  updated.mutable_state()->clear_keys();
+  ASSERT_OK(WriteStateSnapshot(path_, updated));
+
+  EXPECT_THAT(ReadStateSnapshot(path_), IsOkAndHolds(EqualsProto(updated)));
+}
+
+TEST_F(StateSnapshotTest, MissingFileIsNotFound) {
+  EXPECT_THAT(ReadStateSnapshot(absl::StrCat(path_, ".missing")),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(StateSnapshotTest, CorruptPayloadFailsIntegrityCheck) {
+  ASSERT_OK(WriteStateSnapshot(path_, NewSnapshot()));
+  std::string contents = ReadFile(path_);
+  contents.back() ^= 0x01;
+  WriteFile(path_, contents);
+
+  EXPECT_THAT(ReadStateSnapshot(path_),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("digest mismatch")));
+}
+
+TEST_F(StateSnapshotTest, TruncatedFileIsRejected) {
+  ASSERT_OK(WriteStateSnapshot(path_, NewSnapshot()));
+  std::string contents = ReadFile(path_);
+  WriteFile(path_, contents.substr(0, contents.size() - 1));
+
+  EXPECT_THAT(ReadStateSnapshot(path_),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("unexpected length")));
+}
+
+TEST_F(StateSnapshotTest, UnknownFormatVersionIsRejected) {
+  ASSERT_OK(WriteStateSnapshot(path_, NewSnapshot()));
+  std::string contents = ReadFile(path_);
+  contents[8] = 0x7f;
+  WriteFile(path_, contents);
+
+  EXPECT_THAT(ReadStateSnapshot(path_),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("unsupported format version")));
+}
+
+TEST_F(StateSnapshotTest, FileWithoutHeaderIsRejected) {
+  ASSERT_OK(WriteStateSnapshot(path_, NewSnapshot()));
+  WriteFile(path_, NewSnapshot().SerializeAsString());
+
+  EXPECT_THAT(ReadStateSnapshot(path_),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("missing header")));
+}
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
@@ -0,0 +1,114 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the time taken by ObjectLoader::BuildState (which dominates
+// C_Initialize) as a function of the number of keys in the key ring, for both
+// serial and concurrent loading.
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "common/test/test_status_macros.h"
+#include "fakekms/cpp/fakekms.h"
+#include "kmsp11/object_loader.h"
+#include "kmsp11/test/resource_helpers.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+// Arguments: the number of keys in the key ring, and the maximum number of
+// concurrent loads.
+class BuildStateBenchmark : public benchmark::Fixture {
+ public:
+  // Creating thousands of keys takes far longer than the benchmark itself, so
+  // the key ring is kept for as long as the key count stays the same.
+  void SetUp(benchmark::State& state) override {
+    int key_count = state.range(0);
+    if (fake_server_ && key_count_ == key_count) {
+      return;
+    }
+    key_count_ = key_count;
+
+    absl::StatusOr<std::unique_ptr<fakekms::Server>> fake_server =
+        fakekms::Server::New();
+    CHECK_OK(fake_server);
+    fake_server_ = *std::move(fake_server);
+
+    std::unique_ptr<kms_v1::KeyManagementService::Stub> kms_stub =
+        fake_server_->NewClient();
+    key_ring_ = CreateKeyRingOrDie(kms_stub.get(), kTestLocation, RandomId(),
+                                   kms_v1::KeyRing());
+    client_ = std::make_unique<KmsClient>(
+        KmsClient::Options{.endpoint_address = fake_server_->listen_addr(),
+                           .rpc_timeout = absl::Seconds(30)});
+
+    for (int i = 0; i < key_count; i++) {
+      kms_v1::CryptoKey ck;
+      ck.set_purpose(kms_v1::CryptoKey::ASYMMETRIC_SIGN);
+      ck.mutable_version_template()->set_algorithm(
+          kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+      ck.mutable_version_template()->set_protection_level(kms_v1::HSM);
+      ck = CreateCryptoKeyOrDie(kms_stub.get(), key_ring_.name(),
+                                absl::StrCat("ck", i), ck, false);
+
+      kms_v1::CryptoKeyVersion ckv;
+      ckv = CreateCryptoKeyVersionOrDie(kms_stub.get(), ck.name(), ckv);
+      WaitForEnablement(kms_stub.get(), ckv);
+    }
+  }
+
+ protected:
+  std::unique_ptr<fakekms::Server> fake_server_;
+  int key_count_ = 0;
+  kms_v1::KeyRing key_ring_;
+  std::unique_ptr<KmsClient> client_;
+};
+
+// Each iteration is a BuildState call with an empty cache.
+BENCHMARK_DEFINE_F(BuildStateBenchmark, BuildState)(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    absl::StatusOr<std::unique_ptr<ObjectLoader>> loader =
+        ObjectLoader::New(key_ring_.name(), {}, true,
+                          /*allow_software_keys=*/false, state.range(1));
+    state.ResumeTiming();
+    if (!loader.ok()) {
+      state.SkipWithError(loader.status().ToString().c_str());
+      break;
+    }
+
+    absl::StatusOr<ObjectStoreState> store_state =
+        (*loader)->BuildState(*client_);
+    if (!store_state.ok()) {
+      state.SkipWithError(store_state.status().ToString().c_str());
+      break;
+    }
+    if (store_state->keys_size() != key_count_) {
+      state.SkipWithError(absl::StrFormat("got %d keys, want %d",
+                                          store_state->keys_size(), key_count_)
+                              .c_str());
+      break;
+    }
+  }
+}
+BENCHMARK_REGISTER_F(BuildStateBenchmark, BuildState)
+    ->ArgNames({"keys", "max_concurrent_loads"})
+    ->ArgsProduct({{10, 100, 1000},
+                   {1, 4, ObjectLoader::kDefaultMaxConcurrentLoads, 32}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
@@ -0,0 +1,85 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the cost of the CRC32C checksums on a 64 KiB RawEncrypt payload:
+// copying the plaintext into the request and checksumming it in two passes,
+// doing both in one pass, and verifying the checksum of the ciphertext.
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/crc32c.h"
+#include "common/kms_v1.h"
+
+namespace cloud_kms {
+namespace {
+
+constexpr size_t kPayloadSize = 64 * 1024;
+
+std::vector<uint8_t> Payload() {
+  std::vector<uint8_t> payload(kPayloadSize);
+  for (size_t i = 0; i < payload.size(); i++) {
+    payload[i] = static_cast<uint8_t>(i * 31 + 7);
+  }
+  return payload;
+}
+
+void BM_CopyThenChecksum(benchmark::State& state) {
+  std::vector<uint8_t> plaintext = Payload();
+  kms_v1::RawEncryptRequest req;
+  for (auto _ : state) {
+    req.set_plaintext(plaintext.data(), plaintext.size());
+    req.mutable_plaintext_crc32c()->set_value(ComputeCRC32C(req.plaintext()));
+  }
+  state.SetBytesProcessed(state.iterations() * kPayloadSize);
+}
+BENCHMARK(BM_CopyThenChecksum);
+
+void BM_CopyWithChecksum(benchmark::State& state) {
+  std::vector<uint8_t> plaintext = Payload();
+  kms_v1::RawEncryptRequest req;
+  for (auto _ : state) {
+    req.mutable_plaintext_crc32c()->set_value(
+        AssignWithCRC32C(plaintext, req.mutable_plaintext()));
+  }
+  state.SetBytesProcessed(state.iterations() * kPayloadSize);
+}
+BENCHMARK(BM_CopyWithChecksum);
+
+void BM_VerifyResponse(benchmark::State& state) {
+  std::vector<uint8_t> payload = Payload();
+  std::string ciphertext(payload.begin(), payload.end());
+  uint32_t crc32c = ComputeCRC32C(ciphertext);
+  for (auto _ : state) {
+    if (!CRC32CMatches(ciphertext, crc32c)) {
+      state.SkipWithError("checksum mismatch");
+      break;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kPayloadSize);
+}
+BENCHMARK(BM_VerifyResponse);
+
+// Records whether the checksums above were hardware accelerated.
+const bool kSupportRecorded = [] {
+  CRC32CSupport support = GetCRC32CSupport();
+  benchmark::AddCustomContext("crc32c_cpu_supported",
+                              support.cpu_supported ? "true" : "false");
+  benchmark::AddCustomContext("crc32c_build_enabled",
+                              support.build_enabled ? "true" : "false");
+  return true;
+}();
+
+}  // namespace
+}  // namespace cloud_kms
@@ -0,0 +1,187 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares ECDSA verification throughput with and without the precomputed
+// public key tables of EcVerifyTables, both calling a table directly and
+// through a registered key handle.
+
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "absl/log/absl_check.h"
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "common/test/test_status_macros.h"
+#include "kmsp11/util/crypto_utils.h"
+#include "kmsp11/util/ec_verify_tables.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+constexpr int kMessageCount = 64;
+
+const int kMaxThreads = std::max<int>(std::thread::hardware_concurrency(), 1);
+
+struct Curve {
+  int nid;
+  const EVP_MD* md;
+};
+
+// Benchmarks take an index into this list as their first argument.
+const Curve kCurves[] = {
+    {NID_X9_62_prime256v1, EVP_sha256()},
+    {NID_secp384r1, EVP_sha384()},
+};
+
+struct SignedMessage {
+  std::vector<uint8_t> digest;
+  std::vector<uint8_t> signature;
+};
+
+std::vector<SignedMessage> SignMessages(EC_KEY* key, const EVP_MD* md) {
+  std::vector<SignedMessage> messages;
+  size_t n_len = EcdsaSigLengthP1363(EC_KEY_get0_group(key)) / 2;
+  for (int i = 0; i < kMessageCount; i++) {
+    std::string data = absl::StrCat("message ", i);
+    SignedMessage message;
+    message.digest.resize(EVP_MD_size(md));
+    ABSL_CHECK(EVP_Digest(data.data(), data.size(), message.digest.data(),
+                          nullptr, md, nullptr));
+    bssl::UniquePtr<ECDSA_SIG> sig(
+        ECDSA_do_sign(message.digest.data(), message.digest.size(), key));
+    const BIGNUM* r;
+    const BIGNUM* s;
+    ECDSA_SIG_get0(sig.get(), &r, &s);
+    message.signature.resize(2 * n_len);
+    CHECK_OK(BignumToBinary(
+        r, absl::MakeSpan(message.signature).subspan(0, n_len)));
+    CHECK_OK(
+        BignumToBinary(s, absl::MakeSpan(message.signature).subspan(n_len)));
+    messages.push_back(std::move(message));
+  }
+  return messages;
+}
+
+class EcVerifyBenchmark : public benchmark::Fixture {
+ public:
+  // The key, messages and tables are shared by all threads, and are kept for
+  // as long as the curve stays the same.
+  void SetUp(benchmark::State& state) override {
+    if (state.thread_index() != 0 || (key_ && curve_ == state.range(0))) {
+      return;
+    }
+    curve_ = state.range(0);
+    md_ = kCurves[curve_].md;
+
+    key_.reset(EC_KEY_new_by_curve_name(kCurves[curve_].nid));
+    ABSL_CHECK(EC_KEY_generate_key(key_.get()));
+    messages_ = SignMessages(key_.get(), md_);
+
+    absl::StatusOr<std::unique_ptr<EcPublicKeyTable>> table =
+        EcPublicKeyTable::New(key_.get(), 8);
+    CHECK_OK(table);
+    table_ = *std::move(table);
+
+    EcVerifyTables::Options options;
+    options.min_uses = 0;
+    handle_ = nullptr;
+    tables_ = std::make_unique<EcVerifyTables>(options);
+    absl::StatusOr<std::shared_ptr<EcVerifyTables::Key>> handle =
+        tables_->Register(key_.get());
+    CHECK_OK(handle);
+    handle_ = *std::move(handle);
+  }
+
+ protected:
+  // Runs `verify` over the messages. Each thread starts at a message of its
+  // own.
+  template <typename Verify>
+  void VerifyMessages(benchmark::State& state, Verify verify) {
+    size_t i = state.thread_index();
+    for (auto _ : state) {
+      absl::Status result = verify(messages_[i++ % messages_.size()]);
+      if (!result.ok()) {
+        state.SkipWithError(result.ToString().c_str());
+        break;
+      }
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  int curve_ = 0;
+  const EVP_MD* md_ = nullptr;
+  bssl::UniquePtr<EC_KEY> key_;
+  std::vector<SignedMessage> messages_;
+  std::unique_ptr<EcPublicKeyTable> table_;
+  std::unique_ptr<EcVerifyTables> tables_;
+  std::shared_ptr<EcVerifyTables::Key> handle_;
+};
+
+BENCHMARK_DEFINE_F(EcVerifyBenchmark, Generic)(benchmark::State& state) {
+  VerifyMessages(state, [this](const SignedMessage& m) {
+    return EcdsaVerifyP1363(key_.get(), md_, m.digest, m.signature);
+  });
+}
+
+BENCHMARK_DEFINE_F(EcVerifyBenchmark, Precomputed)(benchmark::State& state) {
+  VerifyMessages(state, [this](const SignedMessage& m) {
+    return table_->Verify(md_, m.digest, m.signature);
+  });
+}
+
+BENCHMARK_DEFINE_F(EcVerifyBenchmark, Registered)(benchmark::State& state) {
+  VerifyMessages(state, [this](const SignedMessage& m) {
+    return tables_->Verify(handle_.get(), key_.get(), md_, m.digest,
+                           m.signature);
+  });
+}
+
+BENCHMARK_DEFINE_F(EcVerifyBenchmark, TableBuild)(benchmark::State& state) {
+  size_t memory_bytes = 0;
+  for (auto _ : state) {
+    absl::StatusOr<std::unique_ptr<EcPublicKeyTable>> table =
+        EcPublicKeyTable::New(key_.get(), 8);
+    if (!table.ok()) {
+      state.SkipWithError(table.status().ToString().c_str());
+      break;
+    }
+    memory_bytes = (*table)->memory_bytes();
+  }
+  state.counters["table_bytes"] = memory_bytes;
+}
+
+BENCHMARK_REGISTER_F(EcVerifyBenchmark, Generic)
+    ->ArgName("curve")
+    ->DenseRange(0, std::size(kCurves) - 1)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+BENCHMARK_REGISTER_F(EcVerifyBenchmark, Precomputed)
+    ->ArgName("curve")
+    ->DenseRange(0, std::size(kCurves) - 1)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+BENCHMARK_REGISTER_F(EcVerifyBenchmark, Registered)
+    ->ArgName("curve")
+    ->DenseRange(0, std::size(kCurves) - 1)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime();
+BENCHMARK_REGISTER_F(EcVerifyBenchmark, TableBuild)
+    ->ArgName("curve")
+    ->DenseRange(0, std::size(kCurves) - 1)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
@@ -0,0 +1,437 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the latency and throughput of Cryptoki functions against an
+// in-process fakekms, so that it can run without access to Cloud KMS. Each
+// operation that calls Cloud KMS is measured twice: once as is, and once with a
+// fixed delay (the delay_ms argument) injected into each of its RPCs. The
+// difference between the measured latency and the injected delay is the
+// library's own overhead.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "common/test/test_status_macros.h"
+#include "fakekms/cpp/fakekms.h"
+#include "fakekms/cpp/fault_helpers.h"
+#include "kmsp11/kmsp11.h"
+#include "kmsp11/main/bridge.h"
+#include "kmsp11/test/common_setup.h"
+#include "kmsp11/test/resource_helpers.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+constexpr int kInjectedDelayMs = 5;
+
+const int kMaxThreads = std::max<int>(std::thread::hardware_concurrency(), 1);
+
+std::unique_ptr<fakekms::Server> NewFakeServer() {
+  absl::StatusOr<std::unique_ptr<fakekms::Server>> fake_server =
+      fakekms::Server::New();
+  CHECK_OK(fake_server);
+  return *std::move(fake_server);
+}
+
+kms_v1::CryptoKeyVersion NewKey(
+    fakekms::Server* fake_server, const kms_v1::KeyRing& kr,
+    kms_v1::CryptoKey::CryptoKeyPurpose purpose,
+    kms_v1::CryptoKeyVersion::CryptoKeyVersionAlgorithm algorithm,
+    std::string key_id = RandomId()) {
+  auto client = fake_server->NewClient();
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(purpose);
+  ck.mutable_version_template()->set_algorithm(algorithm);
+  ck.mutable_version_template()->set_protection_level(kms_v1::HSM);
+  ck = CreateCryptoKeyOrDie(client.get(), kr.name(), key_id, ck, true);
+
+  kms_v1::CryptoKeyVersion ckv;
+  ckv = CreateCryptoKeyVersionOrDie(client.get(), ck.name(), ckv);
+  return WaitForEnablement(client.get(), ckv);
+}
+
+// A fakekms server, and a configuration file for a token over a key ring with
+// one key for each of the measured operations. It is shared by all
+// LibraryBenchmarks.
+struct Environment {
+  Environment() : fake_server(NewFakeServer()) {
+    kms_v1::KeyRing kr;
+    config_file = CreateConfigFileWithOneKeyring(fake_server.get(), &kr);
+    ec_p256 = NewKey(fake_server.get(), kr, kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+                     kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+    ec_p384 = NewKey(fake_server.get(), kr, kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+                     kms_v1::CryptoKeyVersion::EC_SIGN_P384_SHA384);
+    rsa_pkcs1 =
+        NewKey(fake_server.get(), kr, kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+               kms_v1::CryptoKeyVersion::RSA_SIGN_PKCS1_2048_SHA256);
+    rsa_pss = NewKey(fake_server.get(), kr, kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+                     kms_v1::CryptoKeyVersion::RSA_SIGN_PSS_2048_SHA256);
+    hmac = NewKey(fake_server.get(), kr, kms_v1::CryptoKey::MAC,
+                  kms_v1::CryptoKeyVersion::HMAC_SHA256);
+    aes_gcm = NewKey(fake_server.get(), kr,
+                     kms_v1::CryptoKey::RAW_ENCRYPT_DECRYPT,
+                     kms_v1::CryptoKeyVersion::AES_256_GCM);
+  }
+
+  ~Environment() { std::remove(config_file.c_str()); }
+
+  std::unique_ptr<fakekms::Server> fake_server;
+  std::string config_file;
+  kms_v1::CryptoKeyVersion ec_p256, ec_p384, rsa_pkcs1, rsa_pss, hmac,
+      aes_gcm;
+};
+
+Environment& GetEnvironment() {
+  static Environment environment;
+  return environment;
+}
+
+// Runs with the library initialized and a session for each thread. Subclasses
+// that measure an operation that calls Cloud KMS name the RPC method, and take
+// the delay to inject into it, in milliseconds, as their first argument.
+class LibraryBenchmark : public benchmark::Fixture {
+ public:
+  // The first thread to arrive sets up for all of them, so that each thread
+  // can use the library as soon as its SetUp returns.
+  void SetUp(benchmark::State& state) override {
+    absl::MutexLock lock(&mutex_);
+    if (set_up_) {
+      return;
+    }
+    set_up_ = true;
+    Environment& env = GetEnvironment();
+    CK_C_INITIALIZE_ARGS init_args = InitArgs(env.config_file.c_str());
+    CHECK_OK(Initialize(&init_args));
+
+    sessions_.resize(state.threads());
+    for (CK_SESSION_HANDLE& session : sessions_) {
+      CHECK_OK(OpenSession(0, CKF_SERIAL_SESSION, nullptr, nullptr, &session));
+    }
+
+    if (!rpc_method().empty() && state.range(0) > 0) {
+      fakekms::AddLatencyProfileOrDie(
+          *env.fake_server,
+          fakekms::FixedLatencyProfile(absl::Milliseconds(state.range(0))),
+          rpc_method());
+    }
+  }
+
+  // All threads have left the benchmark loop by the time thread 0 gets here.
+  void TearDown(benchmark::State& state) override {
+    if (state.thread_index() != 0) {
+      return;
+    }
+    absl::MutexLock lock(&mutex_);
+    set_up_ = false;
+    if (!rpc_method().empty()) {
+      fakekms::ClearShapingRulesOrDie(*GetEnvironment().fake_server);
+    }
+    CHECK_OK(Finalize(nullptr));
+  }
+
+ protected:
+  virtual std::string_view rpc_method() const { return ""; }
+
+  // Runs `op` on this thread's session until the benchmark ends. Each call of
+  // `op` counts as `items` items.
+  template <typename Operation>
+  void Run(benchmark::State& state, Operation op, int items = 1) {
+    for (auto _ : state) {
+      absl::Status result = op(sessions_[state.thread_index()]);
+      if (!result.ok()) {
+        state.SkipWithError(result.ToString().c_str());
+        break;
+      }
+    }
+    state.SetItemsProcessed(state.iterations() * items);
+  }
+
+  // Runs a C_SignInit/C_Sign pair on data of length `data_size`.
+  void RunSign(benchmark::State& state, CK_OBJECT_HANDLE key,
+               CK_MECHANISM mechanism, size_t data_size) {
+    std::vector<uint8_t> data(data_size);
+    Run(state, [&](CK_SESSION_HANDLE session) {
+      CK_MECHANISM mech = mechanism;
+      RETURN_IF_ERROR(SignInit(session, &mech, key));
+      uint8_t signature[512];
+      CK_ULONG signature_size = sizeof(signature);
+      return Sign(session, data.data(), data.size(), signature,
+                  &signature_size);
+    });
+  }
+
+  // Returns the handle of the key for `ckv`, looked up in this thread's
+  // session.
+  CK_OBJECT_HANDLE PrivateKey(const benchmark::State& state,
+                              const kms_v1::CryptoKeyVersion& ckv) {
+    absl::StatusOr<CK_OBJECT_HANDLE> key =
+        GetPrivateKeyObjectHandle(sessions_[state.thread_index()], ckv);
+    CHECK_OK(key);
+    return *key;
+  }
+
+  CK_OBJECT_HANDLE SecretKey(const benchmark::State& state,
+                             const kms_v1::CryptoKeyVersion& ckv) {
+    absl::StatusOr<CK_OBJECT_HANDLE> key =
+        GetSecretKeyObjectHandle(sessions_[state.thread_index()], ckv);
+    CHECK_OK(key);
+    return *key;
+  }
+
+  std::vector<CK_SESSION_HANDLE> sessions_;
+
+ private:
+  absl::Mutex mutex_;
+  bool set_up_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+class AsymmetricSignBenchmark : public LibraryBenchmark {
+ protected:
+  std::string_view rpc_method() const override { return "AsymmetricSign"; }
+};
+
+class MacSignBenchmark : public LibraryBenchmark {
+ protected:
+  std::string_view rpc_method() const override { return "MacSign"; }
+};
+
+class RawEncryptBenchmark : public LibraryBenchmark {
+ protected:
+  std::string_view rpc_method() const override { return "RawEncrypt"; }
+};
+
+class GenerateRandomBytesBenchmark : public LibraryBenchmark {
+ protected:
+  std::string_view rpc_method() const override {
+    return "GenerateRandomBytes";
+  }
+};
+
+void LocalArgs(benchmark::internal::Benchmark* b) {
+  b->ThreadRange(1, kMaxThreads)->UseRealTime()->Unit(benchmark::kMicrosecond);
+}
+
+void RpcArgs(benchmark::internal::Benchmark* b) {
+  b->ArgName("delay_ms")->Arg(0)->Arg(kInjectedDelayMs);
+  LocalArgs(b);
+}
+
+BENCHMARK_DEFINE_F(LibraryBenchmark, FindObjects)(benchmark::State& state) {
+  Run(state, [](CK_SESSION_HANDLE session) {
+    CK_OBJECT_CLASS object_class = CKO_PRIVATE_KEY;
+    CK_ATTRIBUTE attr = {CKA_CLASS, &object_class, sizeof(object_class)};
+    RETURN_IF_ERROR(FindObjectsInit(session, &attr, 1));
+    CK_OBJECT_HANDLE handles[16];
+    CK_ULONG found;
+    RETURN_IF_ERROR(FindObjects(session, handles, 16, &found));
+    return FindObjectsFinal(session);
+  });
+}
+BENCHMARK_REGISTER_F(LibraryBenchmark, FindObjects)->Apply(LocalArgs);
+
+BENCHMARK_DEFINE_F(LibraryBenchmark, GetAttributeValue)
+(benchmark::State& state) {
+  CK_OBJECT_HANDLE key = PrivateKey(state, GetEnvironment().ec_p256);
+  Run(state, [&](CK_SESSION_HANDLE session) {
+    CK_KEY_TYPE key_type;
+    uint8_t ec_params[64];
+    CK_ATTRIBUTE attrs[] = {
+        {CKA_KEY_TYPE, &key_type, sizeof(key_type)},
+        {CKA_EC_PARAMS, ec_params, sizeof(ec_params)},
+    };
+    return GetAttributeValue(session, key, attrs, 2);
+  });
+}
+BENCHMARK_REGISTER_F(LibraryBenchmark, GetAttributeValue)->Apply(LocalArgs);
+
+BENCHMARK_DEFINE_F(AsymmetricSignBenchmark, EcdsaP256)
+(benchmark::State& state) {
+  RunSign(state, PrivateKey(state, GetEnvironment().ec_p256),
+          {CKM_ECDSA, nullptr, 0}, 32);
+}
+BENCHMARK_REGISTER_F(AsymmetricSignBenchmark, EcdsaP256)->Apply(RpcArgs);
+
+BENCHMARK_DEFINE_F(AsymmetricSignBenchmark, EcdsaP384)
+(benchmark::State& state) {
+  RunSign(state, PrivateKey(state, GetEnvironment().ec_p384),
+          {CKM_ECDSA, nullptr, 0}, 48);
+}
+BENCHMARK_REGISTER_F(AsymmetricSignBenchmark, EcdsaP384)->Apply(RpcArgs);
+
+BENCHMARK_DEFINE_F(AsymmetricSignBenchmark, Sha256RsaPkcs)
+(benchmark::State& state) {
+  RunSign(state, PrivateKey(state, GetEnvironment().rsa_pkcs1),
+          {CKM_SHA256_RSA_PKCS, nullptr, 0}, 128);
+}
+BENCHMARK_REGISTER_F(AsymmetricSignBenchmark, Sha256RsaPkcs)->Apply(RpcArgs);
+
+BENCHMARK_DEFINE_F(AsymmetricSignBenchmark, Sha256RsaPss)
+(benchmark::State& state) {
+  static CK_RSA_PKCS_PSS_PARAMS pss_params = {CKM_SHA256, CKG_MGF1_SHA256, 32};
+  RunSign(state, PrivateKey(state, GetEnvironment().rsa_pss),
+          {CKM_SHA256_RSA_PKCS_PSS, &pss_params, sizeof(pss_params)}, 128);
+}
+BENCHMARK_REGISTER_F(AsymmetricSignBenchmark, Sha256RsaPss)->Apply(RpcArgs);
+
+BENCHMARK_DEFINE_F(MacSignBenchmark, Sha256Hmac)(benchmark::State& state) {
+  RunSign(state, SecretKey(state, GetEnvironment().hmac),
+          {CKM_SHA256_HMAC, nullptr, 0}, 128);
+}
+BENCHMARK_REGISTER_F(MacSignBenchmark, Sha256Hmac)->Apply(RpcArgs);
+
+// The next two benchmarks compare signing a set of digests one
+// C_SignInit/C_Sign pair at a time with signing them in a single
+// CKM_CLOUDKMS_BULK_SIGN operation. Each digest counts as an item.
+constexpr int kBulkDigests = 16;
+
+BENCHMARK_DEFINE_F(AsymmetricSignBenchmark, EcdsaOneAtATime)
+(benchmark::State& state) {
+  CK_OBJECT_HANDLE key = PrivateKey(state, GetEnvironment().ec_p256);
+  std::vector<uint8_t> digests(kBulkDigests * 32);
+  Run(
+      state,
+      [&](CK_SESSION_HANDLE session) -> absl::Status {
+        for (int i = 0; i < kBulkDigests; i++) {
+          CK_MECHANISM mechanism = {CKM_ECDSA, nullptr, 0};
+          RETURN_IF_ERROR(SignInit(session, &mechanism, key));
+          uint8_t signature[64];
+          CK_ULONG signature_size = sizeof(signature);
+          RETURN_IF_ERROR(Sign(session, &digests[i * 32], 32, signature,
+                               &signature_size));
+        }
+        return absl::OkStatus();
+      },
+      kBulkDigests);
+}
+BENCHMARK_REGISTER_F(AsymmetricSignBenchmark, EcdsaOneAtATime)
+    ->Apply(RpcArgs);
+
+BENCHMARK_DEFINE_F(AsymmetricSignBenchmark, EcdsaBulkSign)
+(benchmark::State& state) {
+  CK_OBJECT_HANDLE key = PrivateKey(state, GetEnvironment().ec_p256);
+  std::vector<uint8_t> digests(kBulkDigests * 32);
+  Run(
+      state,
+      [&](CK_SESSION_HANDLE session) {
+        CK_MECHANISM inner = {CKM_ECDSA, nullptr, 0};
+        CK_RV results[kBulkDigests];
+        CK_CLOUDKMS_BULK_SIGN_PARAMS params = {&inner, 32, kBulkDigests,
+                                               results};
+        CK_MECHANISM mechanism = {CKM_CLOUDKMS_BULK_SIGN, &params,
+                                  sizeof(params)};
+        RETURN_IF_ERROR(SignInit(session, &mechanism, key));
+        uint8_t signatures[kBulkDigests * 64];
+        CK_ULONG signatures_size = sizeof(signatures);
+        return Sign(session, digests.data(), digests.size(), signatures,
+                    &signatures_size);
+      },
+      kBulkDigests);
+}
+BENCHMARK_REGISTER_F(AsymmetricSignBenchmark, EcdsaBulkSign)->Apply(RpcArgs);
+
+BENCHMARK_DEFINE_F(RawEncryptBenchmark, AesGcm)(benchmark::State& state) {
+  CK_OBJECT_HANDLE key = SecretKey(state, GetEnvironment().aes_gcm);
+  Run(state, [&](CK_SESSION_HANDLE session) {
+    uint8_t iv[12] = {0};
+    CK_GCM_PARAMS params = {iv, sizeof(iv), 96, nullptr, 0, 128};
+    CK_MECHANISM mechanism = {CKM_CLOUDKMS_AES_GCM, &params, sizeof(params)};
+    RETURN_IF_ERROR(EncryptInit(session, &mechanism, key));
+    uint8_t plaintext[128] = {0};
+    uint8_t ciphertext[sizeof(plaintext) + 16];
+    CK_ULONG ciphertext_size = sizeof(ciphertext);
+    return Encrypt(session, plaintext, sizeof(plaintext), ciphertext,
+                   &ciphertext_size);
+  });
+}
+BENCHMARK_REGISTER_F(RawEncryptBenchmark, AesGcm)->Apply(RpcArgs);
+
+BENCHMARK_DEFINE_F(GenerateRandomBytesBenchmark, GenerateRandom32)
+(benchmark::State& state) {
+  Run(state, [](CK_SESSION_HANDLE session) {
+    uint8_t data[32];
+    return GenerateRandom(session, data, sizeof(data));
+  });
+}
+BENCHMARK_REGISTER_F(GenerateRandomBytesBenchmark, GenerateRandom32)
+    ->Apply(RpcArgs);
+
+// Measures C_Initialize as a function of the number of keys in the key ring,
+// which is its first argument.
+class InitializeBenchmark : public benchmark::Fixture {
+ public:
+  // Creating thousands of keys takes far longer than the benchmark itself, so
+  // the key ring is kept for as long as the key count stays the same.
+  void SetUp(benchmark::State& state) override {
+    int key_count = state.range(0);
+    if (fake_server_ && key_count_ == key_count) {
+      return;
+    }
+    if (!config_file_.empty()) {
+      std::remove(config_file_.c_str());
+    }
+    key_count_ = key_count;
+
+    fake_server_ = NewFakeServer();
+    kms_v1::KeyRing kr;
+    config_file_ = CreateConfigFileWithOneKeyring(fake_server_.get(), &kr);
+    for (int i = 0; i < key_count; i++) {
+      NewKey(fake_server_.get(), kr, kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+             kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256,
+             absl::StrCat("ck", i));
+    }
+  }
+
+  ~InitializeBenchmark() {
+    if (!config_file_.empty()) {
+      std::remove(config_file_.c_str());
+    }
+  }
+
+ protected:
+  std::unique_ptr<fakekms::Server> fake_server_;
+  int key_count_ = 0;
+  std::string config_file_;
+};
+
+BENCHMARK_DEFINE_F(InitializeBenchmark, Initialize)(benchmark::State& state) {
+  CK_C_INITIALIZE_ARGS init_args = InitArgs(config_file_.c_str());
+  for (auto _ : state) {
+    absl::Status result = Initialize(&init_args);
+    if (!result.ok()) {
+      state.SkipWithError(result.ToString().c_str());
+      break;
+    }
+    state.PauseTiming();
+    CHECK_OK(Finalize(nullptr));
+    state.ResumeTiming();
+  }
+}
+BENCHMARK_REGISTER_F(InitializeBenchmark, Initialize)
+    ->ArgName("keys")
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
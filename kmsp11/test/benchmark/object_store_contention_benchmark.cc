@@ -0,0 +1,86 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares ObjectStore lookup throughput under contention when the store is
+// guarded by a reader lock versus published through RcuPtr (as Token does).
+
+#include <algorithm>
+#include <thread>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "benchmark/benchmark.h"
+#include "common/test/test_status_macros.h"
+#include "kmsp11/object_store.h"
+#include "kmsp11/util/rcu.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+constexpr int kKeyCount = 1000;
+
+const int kMaxThreads = std::max<int>(std::thread::hardware_concurrency(), 1);
+
+std::unique_ptr<ObjectStore> NewStore() {
+  ObjectStoreState state;
+  for (int i = 0; i < kKeyCount; i++) {
+    Key* key = state.add_keys();
+    key->mutable_crypto_key_version()->set_name(
+        absl::StrCat("projects/foo/locations/bar/keyRings/baz/cryptoKeys/", i,
+                     "/cryptoKeyVersions/1"));
+    key->mutable_crypto_key_version()->set_algorithm(
+        kms_v1::CryptoKeyVersion::HMAC_SHA256);
+    key->set_secret_key_handle(i + 1);
+  }
+  absl::StatusOr<std::unique_ptr<ObjectStore>> store = ObjectStore::New(state);
+  CHECK_OK(store);
+  return *std::move(store);
+}
+
+// Looks up every handle in turn with `lookup`. Each thread starts at a handle
+// of its own.
+template <typename Lookup>
+void LookUpHandles(benchmark::State& state, Lookup lookup) {
+  CK_OBJECT_HANDLE handle = state.thread_index();
+  for (auto _ : state) {
+    handle = handle % kKeyCount + 1;
+    if (!lookup(handle)) {
+      state.SkipWithError(
+          absl::StrCat("lookup failed for handle ", handle).c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ReaderLock(benchmark::State& state) {
+  static ObjectStore* store = NewStore().release();
+  static absl::Mutex mutex;
+  LookUpHandles(state, [](CK_OBJECT_HANDLE handle) {
+    absl::ReaderMutexLock lock(&mutex);
+    return store->GetObject(handle).ok();
+  });
+}
+BENCHMARK(BM_ReaderLock)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+void BM_Rcu(benchmark::State& state) {
+  static RcuPtr<ObjectStore>* rcu = new RcuPtr<ObjectStore>(NewStore());
+  LookUpHandles(state, [](CK_OBJECT_HANDLE handle) {
+    return rcu->Read()->GetObject(handle).ok();
+  });
+}
+BENCHMARK(BM_Rcu)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
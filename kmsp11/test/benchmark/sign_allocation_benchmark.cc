@@ -0,0 +1,161 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Counts the heap allocations made by each KmsClient signing call, with the
+// messages on the heap and on a CallArena, and reports them per call in the
+// allocs counter. The counts cover operator new only, which is what protobuf
+// messages and strings use; gRPC's own allocations go through malloc and are
+// the same in both cases.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark/benchmark.h"
+#include "common/kms_client.h"
+#include "common/test/resource_helpers.h"
+#include "common/test/test_status_macros.h"
+#include "fakekms/cpp/fakekms.h"
+
+namespace {
+
+std::atomic<uint64_t> allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace cloud_kms {
+namespace {
+
+class SignAllocationBenchmark : public benchmark::Fixture {
+ public:
+  // The server and keys are created once, and shared by all benchmarks.
+  void SetUp(benchmark::State& state) override {
+    if (fake_server_) {
+      return;
+    }
+    absl::StatusOr<std::unique_ptr<fakekms::Server>> fake_server =
+        fakekms::Server::New();
+    CHECK_OK(fake_server);
+    fake_server_ = *std::move(fake_server);
+    client_ = std::make_unique<KmsClient>(
+        KmsClient::Options{.endpoint_address = fake_server_->listen_addr(),
+                           .rpc_timeout = absl::Seconds(5)});
+    kr_ = CreateKeyRingOrDie(client_->kms_stub(), kTestLocation, RandomId(),
+                             kr_);
+    ec_p256_ = NewKey(kms_v1::CryptoKey::ASYMMETRIC_SIGN,
+                      kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+    hmac_ = NewKey(kms_v1::CryptoKey::MAC,
+                   kms_v1::CryptoKeyVersion::HMAC_SHA256);
+  }
+
+ protected:
+  kms_v1::CryptoKeyVersion NewKey(
+      kms_v1::CryptoKey::CryptoKeyPurpose purpose,
+      kms_v1::CryptoKeyVersion::CryptoKeyVersionAlgorithm algorithm) {
+    kms_v1::CryptoKey ck;
+    ck.set_purpose(purpose);
+    ck.mutable_version_template()->set_algorithm(algorithm);
+    ck = CreateCryptoKeyOrDie(client_->kms_stub(), kr_.name(), RandomId(), ck,
+                              true);
+    kms_v1::CryptoKeyVersion ckv;
+    ckv = CreateCryptoKeyVersionOrDie(client_->kms_stub(), ck.name(), ckv);
+    return WaitForEnablement(client_->kms_stub(), ckv);
+  }
+
+  // Runs `call` until the benchmark ends, and reports the mean number of
+  // allocations it makes.
+  template <typename Call>
+  void CountAllocations(benchmark::State& state, Call call) {
+    uint64_t start = allocations.load();
+    for (auto _ : state) {
+      absl::Status result = call();
+      if (!result.ok()) {
+        state.SkipWithError(result.ToString().c_str());
+        break;
+      }
+    }
+    state.counters["allocs"] = benchmark::Counter(
+        allocations.load() - start, benchmark::Counter::kAvgIterations);
+  }
+
+  std::unique_ptr<fakekms::Server> fake_server_;
+  std::unique_ptr<KmsClient> client_;
+  kms_v1::KeyRing kr_;
+  kms_v1::CryptoKeyVersion ec_p256_;
+  kms_v1::CryptoKeyVersion hmac_;
+};
+
+BENCHMARK_DEFINE_F(SignAllocationBenchmark, AsymmetricSignHeap)
+(benchmark::State& state) {
+  std::string digest(32, 'd');
+  CountAllocations(state, [&] {
+    kms_v1::AsymmetricSignRequest req;
+    req.set_name(ec_p256_.name());
+    req.mutable_digest()->set_sha256(digest);
+    return client_->AsymmetricSign(req).status();
+  });
+}
+BENCHMARK_REGISTER_F(SignAllocationBenchmark, AsymmetricSignHeap);
+
+BENCHMARK_DEFINE_F(SignAllocationBenchmark, AsymmetricSignArena)
+(benchmark::State& state) {
+  std::string digest(32, 'd');
+  CountAllocations(state, [&] {
+    CallArena call_arena;
+    auto* req = call_arena.Create<kms_v1::AsymmetricSignRequest>();
+    req->set_name(ec_p256_.name());
+    req->mutable_digest()->set_sha256(digest);
+    return client_->AsymmetricSign(*req, call_arena.get()).status();
+  });
+}
+BENCHMARK_REGISTER_F(SignAllocationBenchmark, AsymmetricSignArena);
+
+BENCHMARK_DEFINE_F(SignAllocationBenchmark, MacSignHeap)
+(benchmark::State& state) {
+  std::string data(64, 'd');
+  CountAllocations(state, [&] {
+    kms_v1::MacSignRequest req;
+    req.set_name(hmac_.name());
+    req.set_data(data);
+    return client_->MacSign(req).status();
+  });
+}
+BENCHMARK_REGISTER_F(SignAllocationBenchmark, MacSignHeap);
+
+BENCHMARK_DEFINE_F(SignAllocationBenchmark, MacSignArena)
+(benchmark::State& state) {
+  std::string data(64, 'd');
+  CountAllocations(state, [&] {
+    CallArena call_arena;
+    auto* req = call_arena.Create<kms_v1::MacSignRequest>();
+    req->set_name(hmac_.name());
+    req->set_data(data);
+    return client_->MacSign(*req, call_arena.get()).status();
+  });
+}
+BENCHMARK_REGISTER_F(SignAllocationBenchmark, MacSignArena);
+
+}  // namespace
+}  // namespace cloud_kms
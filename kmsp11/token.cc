@@ -21,8 +21,10 @@
 #include "common/backoff.h"
 #include "common/kms_client.h"
 #include "common/status_macros.h"
+#include "glog/logging.h"
 #include "kmsp11/object_loader.h"
 #include "kmsp11/object_store_state.pb.h"
+#include "kmsp11/state_snapshot.h"
 #include "kmsp11/util/errors.h"
 #include "kmsp11/util/string_utils.h"
 
@@ -74,21 +76,62 @@ absl::StatusOr<CK_TOKEN_INFO> NewTokenInfo(std::string_view token_label) {
   return info;
 }
 
+// Reads the snapshot at `path` and verifies that it was produced for the same
+// key ring and configuration. On success, primes `loader` with the snapshot
+// state so that handles are retained across subsequent refreshes.
+absl::StatusOr<std::unique_ptr<ObjectStore>> LoadSnapshot(
+    const std::string& path, const StateSnapshot& snapshot_template,
+    ObjectLoader* loader) {
+  ASSIGN_OR_RETURN(StateSnapshot snapshot, ReadStateSnapshot(path));
+  if (snapshot.key_ring_name() != snapshot_template.key_ring_name() ||
+      snapshot.config_digest() != snapshot_template.config_digest()) {
+    return FailedPreconditionError(
+        "snapshot was written for a different configuration",
+        CKR_GENERAL_ERROR, SOURCE_LOCATION);
+  }
+
+  ASSIGN_OR_RETURN(std::unique_ptr<ObjectStore> store,
+                   ObjectStore::New(snapshot.state()));
+  loader->Prime(snapshot.state());
+  return store;
+}
+
 }  // namespace
 
-absl::StatusOr<std::unique_ptr<Token>> Token::New(CK_SLOT_ID slot_id,
-                                                  TokenConfig token_config,
-                                                  KmsClient* kms_client,
-                                                  bool generate_certs,
-                                                  bool allow_software_keys) {
+absl::StatusOr<std::unique_ptr<Token>> Token::New(
+    CK_SLOT_ID slot_id, TokenConfig token_config, KmsClient* kms_client,
+    bool generate_certs, bool allow_software_keys,
+    std::string_view state_cache_directory) {
   ASSIGN_OR_RETURN(CK_SLOT_INFO slot_info, NewSlotInfo());
   ASSIGN_OR_RETURN(CK_TOKEN_INFO token_info,
                    NewTokenInfo(token_config.label()));
 
   ASSIGN_OR_RETURN(
       std::unique_ptr<ObjectLoader> loader,
-      ObjectLoader::New(token_config.key_ring(),
-                        token_config.certs(), generate_certs, allow_software_keys));
+      ObjectLoader::New(token_config.key_ring(), token_config.certs(),
+                        generate_certs, allow_software_keys));
+
+  StateSnapshot snapshot_template;
+  snapshot_template.set_key_ring_name(token_config.key_ring());
+  snapshot_template.set_config_digest(
+      StateConfigDigest(token_config, generate_certs, allow_software_keys));
+  std::string snapshot_path;
+  if (!state_cache_directory.empty()) {
+    snapshot_path =
+        StateSnapshotPath(state_cache_directory, token_config.key_ring());
+    absl::StatusOr<std::unique_ptr<ObjectStore>> store =
+        LoadSnapshot(snapshot_path, snapshot_template, loader.get());
+    if (store.ok()) {
+      // using `new` to invoke a private constructor
+      return std::unique_ptr<Token>(
+          new Token(slot_id, slot_info, token_info, std::move(loader),
+                    *std::move(store), std::move(snapshot_template),
+                    std::move(snapshot_path), true));
+    }
+    LOG(INFO) << "INFO: state snapshot for key ring "
+              << token_config.key_ring() << " was not used: " << store.status();
+  }
+
   absl::StatusOr<ObjectStoreState> state_resp = loader->BuildState(*kms_client);
 
   // Exponential backoff to reduce errors at library initialization.
@@ -106,8 +149,11 @@ absl::StatusOr<std::unique_ptr<Token>> Token::New(CK_SLOT_ID slot_id,
   ASSIGN_OR_RETURN(std::unique_ptr<ObjectStore> store, ObjectStore::New(state));
 
   // using `new` to invoke a private constructor
-  return std::unique_ptr<Token>(new Token(slot_id, slot_info, token_info,
-                                          std::move(loader), std::move(store)));
+  std::unique_ptr<Token> token(new Token(
+      slot_id, slot_info, token_info, std::move(loader), std::move(store),
+      std::move(snapshot_template), std::move(snapshot_path), false));
+  token->WriteSnapshot(state);
+  return token;
 }
 
 bool Token::is_logged_in() const {
@@ -156,11 +202,35 @@ absl::Status Token::Logout() {
 
 absl::Status Token::RefreshState(const KmsClient& client) {
   ASSIGN_OR_RETURN(ObjectStoreState state, object_loader_->BuildState(client));
-  ASSIGN_OR_RETURN(std::unique_ptr<ObjectStore> store, ObjectStore::New(state));
 
-  absl::WriterMutexLock lock(&objects_mutex_);
-  objects_.swap(store);
+  std::vector<std::string> changed_keys;
+  ASSIGN_OR_RETURN(std::unique_ptr<ObjectStore> store,
+                   objects_.Read()->Update(state, &changed_keys));
+  objects_.Replace(std::move(store));
+  store_generation_.fetch_add(1, std::memory_order_release);
+
+  // Cached MAC verification results are only valid for as long as the key
+  // version remains in the state in which it was used.
+  for (const std::string& name : changed_keys) {
+    client.InvalidateMacVerifyCache(name);
+  }
+
+  WriteSnapshot(state);
   return absl::OkStatus();
 }
 
+void Token::WriteSnapshot(const ObjectStoreState& state) const {
+  if (snapshot_path_.empty()) {
+    return;
+  }
+
+  StateSnapshot snapshot = snapshot_template_;
+  *snapshot.mutable_state() = state;
+  absl::Status result = WriteStateSnapshot(snapshot_path_, snapshot);
+  if (!result.ok()) {
+    LOG(ERROR) << "error writing state snapshot for key ring "
+               << key_ring_name() << ": " << result;
+  }
+}
+
 }  // namespace cloud_kms::kmsp11
@@ -17,6 +17,8 @@
 #ifndef KMSP11_TOKEN_H_
 #define KMSP11_TOKEN_H_
 
+#include <atomic>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
@@ -26,6 +28,8 @@
 #include "kmsp11/object.h"
 #include "kmsp11/object_loader.h"
 #include "kmsp11/object_store.h"
+#include "kmsp11/object_store_state.pb.h"
+#include "kmsp11/util/rcu.h"
 
 namespace cloud_kms::kmsp11 {
 
@@ -37,7 +41,8 @@ class Token {
  public:
   static absl::StatusOr<std::unique_ptr<Token>> New(
       CK_SLOT_ID slot_id, TokenConfig token_config, KmsClient* kms_client,
-      bool generate_certs = false, bool allow_software_keys = false);
+      bool generate_certs = false, bool allow_software_keys = false,
+      std::string_view state_cache_directory = "");
 
   CK_SLOT_ID slot_id() const { return slot_id_; }
   const CK_SLOT_INFO& slot_info() const { return slot_info_; }
@@ -45,6 +50,9 @@ class Token {
   std::string_view key_ring_name() const {
     return object_loader_->key_ring_name();
   }
+  // True if this token's state was loaded from an on-disk snapshot, and
+  // therefore may be stale until the next call to RefreshState.
+  bool loaded_from_snapshot() const { return loaded_from_snapshot_; }
 
   bool is_logged_in() const;
   absl::Status Login(CK_USER_TYPE user_type);
@@ -52,48 +60,70 @@ class Token {
 
   inline absl::StatusOr<std::shared_ptr<Object>> GetObject(
       CK_OBJECT_HANDLE object_handle) const {
-    absl::ReaderMutexLock lock(&objects_mutex_);
-    return objects_->GetObject(object_handle);
+    return objects_.Read()->GetObject(object_handle);
   }
 
   inline absl::StatusOr<std::shared_ptr<Object>> GetKey(
       CK_OBJECT_HANDLE handle) const {
-    absl::ReaderMutexLock lock(&objects_mutex_);
-    return objects_->GetKey(handle);
+    return objects_.Read()->GetKey(handle);
   }
 
   inline std::vector<CK_OBJECT_HANDLE> FindObjects(
       std::function<bool(const Object&)> predicate) const {
-    absl::ReaderMutexLock lock(&objects_mutex_);
-    return objects_->Find(predicate);
+    return objects_.Read()->Find(predicate);
+  }
+
+  inline std::vector<CK_OBJECT_HANDLE> FindObjects(
+      absl::Span<const CK_ATTRIBUTE> attr_template) const {
+    return objects_.Read()->Find(attr_template);
   }
 
   inline absl::StatusOr<CK_OBJECT_HANDLE> FindSingleObject(
       std::function<bool(const Object&)> predicate) const {
-    absl::ReaderMutexLock lock(&objects_mutex_);
-    return objects_->FindSingle(predicate);
+    return objects_.Read()->FindSingle(predicate);
   }
 
   absl::Status RefreshState(const KmsClient& client);
 
+  // Incremented each time RefreshState publishes a new object store. Objects
+  // obtained before the generation changed may no longer be current.
+  uint64_t store_generation() const {
+    return store_generation_.load(std::memory_order_acquire);
+  }
+
  private:
   Token(CK_SLOT_ID slot_id, CK_SLOT_INFO slot_info, CK_TOKEN_INFO token_info,
         std::unique_ptr<ObjectLoader> object_loader,
-        std::unique_ptr<ObjectStore> objects)
+        std::unique_ptr<ObjectStore> objects, StateSnapshot snapshot_template,
+        std::string snapshot_path, bool loaded_from_snapshot)
       : slot_id_(slot_id),
         slot_info_(slot_info),
         token_info_(token_info),
+        snapshot_template_(std::move(snapshot_template)),
+        snapshot_path_(std::move(snapshot_path)),
+        loaded_from_snapshot_(loaded_from_snapshot),
         object_loader_(std::move(object_loader)),
         objects_(std::move(objects)),
         is_logged_in_(false) {}
 
+  // Writes `state` to this token's snapshot file, if snapshots are enabled.
+  void WriteSnapshot(const ObjectStoreState& state) const;
+
   const CK_SLOT_ID slot_id_;
   const CK_SLOT_INFO slot_info_;
   const CK_TOKEN_INFO token_info_;
 
+  // The snapshot identity (key ring name and config digest), without state.
+  const StateSnapshot snapshot_template_;
+  // The snapshot file path, or empty if snapshots are disabled.
+  const std::string snapshot_path_;
+  const bool loaded_from_snapshot_;
+
   std::unique_ptr<ObjectLoader> object_loader_;
-  mutable absl::Mutex objects_mutex_;
-  std::unique_ptr<ObjectStore> objects_ ABSL_GUARDED_BY(objects_mutex_);
+  // Lookups take no locks; RefreshState publishes a new store and retires the
+  // previous one once no lookup can still be using it.
+  RcuPtr<ObjectStore> objects_;
+  std::atomic<uint64_t> store_generation_ = 0;
 
   // All sessions with the same token have the same login state (rather than
   // login state being per-session, which seems like the more obvious choice.)
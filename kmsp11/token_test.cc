@@ -14,6 +14,8 @@
 
 #include "kmsp11/token.h"
 
+#include <filesystem>
+
 #include "common/kms_client.h"
 #include "common/test/test_status_macros.h"
 #include "fakekms/cpp/fakekms.h"
@@ -551,5 +553,124 @@ TEST_F(TokenTest, CertNotGeneratedWhenConfigIsUnset) {
               IsEmpty());
 }
 
+TEST_F(TokenTest, RefreshStateReusesUnchangedObjects) {
+  auto kms_client = fake_server_->NewClient();
+
+  kms_v1::CryptoKey ck;
+  ck.set_purpose(kms_v1::CryptoKey::ASYMMETRIC_SIGN);
+  ck.mutable_version_template()->set_algorithm(
+      kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+  ck.mutable_version_template()->set_protection_level(
+      kms_v1::ProtectionLevel::HSM);
+  ck = CreateCryptoKeyOrDie(kms_client.get(), key_ring_.name(), "ck", ck, true);
+
+  kms_v1::CryptoKeyVersion ckv1;
+  ckv1 = CreateCryptoKeyVersionOrDie(kms_client.get(), ck.name(), ckv1);
+  ckv1 = WaitForEnablement(kms_client.get(), ckv1);
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Token> token,
+                       Token::New(0, config_, client_.get()));
+  ASSERT_OK_AND_ASSIGN(CK_OBJECT_HANDLE handle,
+                       token->FindSingleObject([](const Object& o) -> bool {
+                         return o.object_class() == CKO_PRIVATE_KEY;
+                       }));
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<Object> original,
+                       token->GetObject(handle));
+
+  kms_v1::CryptoKeyVersion ckv2;
+  ckv2 = CreateCryptoKeyVersionOrDie(kms_client.get(), ck.name(), ckv2);
+  ckv2 = WaitForEnablement(kms_client.get(), ckv2);
+  ASSERT_OK(token->RefreshState(*client_));
+
+  EXPECT_THAT(token->GetObject(handle), IsOkAndHolds(original));
+  EXPECT_EQ(token->FindObjects([](const Object& o) -> bool { return true; })
+                .size(),
+            4);
+}
+
+TEST_F(TokenTest, RefreshStateIncrementsStoreGeneration) {
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Token> token,
+                       Token::New(0, config_, client_.get()));
+  uint64_t generation = token->store_generation();
+
+  ASSERT_OK(token->RefreshState(*client_));
+  EXPECT_EQ(token->store_generation(), generation + 1);
+}
+
+class TokenSnapshotTest : public TokenTest {
+ protected:
+  void SetUp() override {
+    TokenTest::SetUp();
+    cache_dir_ = absl::StrCat(testing::TempDir(), "/", RandomId());
+    std::filesystem::create_directory(cache_dir_);
+
+    auto kms_client = fake_server_->NewClient();
+    kms_v1::CryptoKey ck;
+    ck.set_purpose(kms_v1::CryptoKey::ASYMMETRIC_SIGN);
+    ck.mutable_version_template()->set_algorithm(
+        kms_v1::CryptoKeyVersion::EC_SIGN_P256_SHA256);
+    ck.mutable_version_template()->set_protection_level(
+        kms_v1::ProtectionLevel::HSM);
+    ck = CreateCryptoKeyOrDie(kms_client.get(), key_ring_.name(), "ck", ck,
+                              true);
+
+    kms_v1::CryptoKeyVersion ckv;
+    ckv = CreateCryptoKeyVersionOrDie(kms_client.get(), ck.name(), ckv);
+    WaitForEnablement(kms_client.get(), ckv);
+  }
+
+  std::vector<CK_OBJECT_HANDLE> AllHandles(const Token& token) {
+    return token.FindObjects([](const Object& o) -> bool { return true; });
+  }
+
+  std::string cache_dir_;
+};
+
+TEST_F(TokenSnapshotTest, FirstStartDoesNotUseSnapshot) {
+  ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Token> token,
+      Token::New(0, config_, client_.get(), false, false, cache_dir_));
+
+  EXPECT_FALSE(token->loaded_from_snapshot());
+  EXPECT_EQ(AllHandles(*token).size(), 2);
+}
+
+TEST_F(TokenSnapshotTest, SecondStartUsesSnapshot) {
+  ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Token> first,
+      Token::New(0, config_, client_.get(), false, false, cache_dir_));
+  ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Token> second,
+      Token::New(0, config_, client_.get(), false, false, cache_dir_));
+
+  EXPECT_TRUE(second->loaded_from_snapshot());
+  EXPECT_EQ(AllHandles(*second), AllHandles(*first));
+}
+
+TEST_F(TokenSnapshotTest, HandlesAreRetainedAfterRevalidation) {
+  ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Token> first,
+      Token::New(0, config_, client_.get(), false, false, cache_dir_));
+  ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Token> second,
+      Token::New(0, config_, client_.get(), false, false, cache_dir_));
+  ASSERT_TRUE(second->loaded_from_snapshot());
+
+  EXPECT_OK(second->RefreshState(*client_));
+  EXPECT_EQ(AllHandles(*second), AllHandles(*first));
+}
+
+TEST_F(TokenSnapshotTest, SnapshotIsNotUsedAfterConfigChange) {
+  ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Token> first,
+      Token::New(0, config_, client_.get(), false, false, cache_dir_));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Token> second,
+                       Token::New(0, config_, client_.get(),
+                                  /*generate_certs=*/true, false, cache_dir_));
+
+  EXPECT_FALSE(second->loaded_from_snapshot());
+  EXPECT_EQ(AllHandles(*second).size(), 3);
+}
+
 }  // namespace
 }  // namespace cloud_kms::kmsp11
@@ -235,9 +235,9 @@ int EcdsaSigLengthP1363(const EC_GROUP* group) {
   return 2 * BN_num_bytes(bn.get());
 }
 
-absl::Status EcdsaVerifyP1363(EC_KEY* public_key, const EVP_MD* hash,
-                              absl::Span<const uint8_t> digest,
-                              absl::Span<const uint8_t> signature) {
+absl::StatusOr<bssl::UniquePtr<ECDSA_SIG>> ParseEcdsaSigP1363(
+    const EC_GROUP* group, const EVP_MD* hash, absl::Span<const uint8_t> digest,
+    absl::Span<const uint8_t> signature) {
   if (digest.length() != EVP_MD_size(hash)) {
     return NewInvalidArgumentError(
         absl::StrFormat("digest length mismatches expected (got %d, want %d)",
@@ -253,7 +253,7 @@ absl::Status EcdsaVerifyP1363(EC_KEY* public_key, const EVP_MD* hash,
         CKR_SIGNATURE_LEN_RANGE, SOURCE_LOCATION);
   }
 
-  size_t max_len = EcdsaSigLengthP1363(EC_KEY_get0_group(public_key));
+  size_t max_len = EcdsaSigLengthP1363(group);
   if (signature.length() > max_len) {
     return NewInvalidArgumentError(
         absl::StrFormat(
@@ -274,6 +274,15 @@ absl::Status EcdsaVerifyP1363(EC_KEY* public_key, const EVP_MD* hash,
         absl::StrCat("error parsing signature component: ", SslErrorToString()),
         SOURCE_LOCATION);
   }
+  return sig;
+}
+
+absl::Status EcdsaVerifyP1363(EC_KEY* public_key, const EVP_MD* hash,
+                              absl::Span<const uint8_t> digest,
+                              absl::Span<const uint8_t> signature) {
+  ASSIGN_OR_RETURN(bssl::UniquePtr<ECDSA_SIG> sig,
+                   ParseEcdsaSigP1363(EC_KEY_get0_group(public_key), hash,
+                                      digest, signature));
 
   if (ECDSA_do_verify(digest.data(), digest.size(), sig.get(), public_key) !=
       1) {
@@ -53,6 +53,12 @@ absl::StatusOr<std::vector<uint8_t>> EcdsaSigAsn1ToP1363(
 // for the provided group.
 int EcdsaSigLengthP1363(const EC_GROUP* group);
 
+// Checks that the provided digest and signature in IEEE P-1363 format have
+// valid lengths for `hash` and `group`, and parses the signature.
+absl::StatusOr<bssl::UniquePtr<ECDSA_SIG>> ParseEcdsaSigP1363(
+    const EC_GROUP* group, const EVP_MD* hash, absl::Span<const uint8_t> digest,
+    absl::Span<const uint8_t> signature);
+
 // Verifies that the provided signature in IEEE P-1363 format is a valid
 // signature over digest.
 absl::Status EcdsaVerifyP1363(EC_KEY* public_key, const EVP_MD* hash,
@@ -0,0 +1,527 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/util/ec_verify_tables.h"
+
+#include <utility>
+#include <vector>
+
+#include "absl/base/const_init.h"
+#include "absl/strings/str_cat.h"
+#include "common/status_macros.h"
+#include "glog/logging.h"
+#include "kmsp11/util/crypto_utils.h"
+#include "kmsp11/util/errors.h"
+#include "kmsp11/util/rcu.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+// 8-bit windows need one point addition per byte of each scalar.
+constexpr int kWindowBits = 8;
+
+// Use counts are halved after this many verifications.
+constexpr uint64_t kDecayInterval = 1 << 16;
+
+// The approximate per-point overhead of an EC_POINT allocation, on top of its
+// three field elements.
+constexpr size_t kPointOverheadBytes = 128;
+
+absl::Status SslError(std::string_view operation) {
+  return NewInternalError(
+      absl::StrCat("error ", operation, ": ", SslErrorToString()),
+      SOURCE_LOCATION);
+}
+
+absl::Status InvalidSignature() {
+  return NewInvalidArgumentError("verification failed", CKR_SIGNATURE_INVALID,
+                                 SOURCE_LOCATION);
+}
+
+// Returns the curve and public point of `key` as a string, for use as a map
+// key.
+absl::StatusOr<std::string> PublicKeyId(const EC_KEY* key) {
+  const EC_GROUP* group = EC_KEY_get0_group(key);
+  const EC_POINT* point = EC_KEY_get0_public_key(key);
+  size_t len = EC_POINT_point2oct(group, point, POINT_CONVERSION_UNCOMPRESSED,
+                                  nullptr, 0, nullptr);
+  if (len == 0) {
+    return SslError("encoding public point");
+  }
+  std::string id = absl::StrCat(EC_GROUP_get_curve_name(group), ":");
+  size_t prefix_len = id.size();
+  id.resize(prefix_len + len);
+  if (EC_POINT_point2oct(group, point, POINT_CONVERSION_UNCOMPRESSED,
+                         reinterpret_cast<uint8_t*>(&id[prefix_len]), len,
+                         nullptr) != len) {
+    return SslError("encoding public point");
+  }
+  return id;
+}
+
+// Converts `digest` to an integer in the manner of ECDSA, keeping only as many
+// leftmost bits as there are in `order`.
+absl::StatusOr<bssl::UniquePtr<BIGNUM>> DigestToBignum(
+    absl::Span<const uint8_t> digest, const BIGNUM* order) {
+  int order_bits = BN_num_bits(order);
+  size_t len = std::min<size_t>(digest.size(), (order_bits + 7) / 8);
+  bssl::UniquePtr<BIGNUM> e(BN_bin2bn(digest.data(), len, nullptr));
+  if (!e) {
+    return SslError("parsing digest");
+  }
+  if (8 * len > static_cast<size_t>(order_bits) &&
+      !BN_rshift(e.get(), e.get(), 8 * len - order_bits)) {
+    return SslError("truncating digest");
+  }
+  return e;
+}
+
+}  // namespace
+
+// EcPointMultiples holds multiples of a point P, in rows of 2^window_bits - 1
+// points. points_[i * (2^window_bits - 1) + d - 1] is
+// d * 2^(window_bits * i) * P.
+class EcPointMultiples {
+ public:
+  static absl::StatusOr<std::shared_ptr<const EcPointMultiples>> New(
+      const EC_GROUP* group, const EC_POINT* point, int window_bits, int rows,
+      BN_CTX* ctx);
+
+  // Adds scalar * P to `sum`, where scalar has no more than
+  // window_bits * rows bits.
+  absl::Status AddMultiple(const EC_GROUP* group, const BIGNUM* scalar,
+                           EC_POINT* sum, BN_CTX* ctx) const;
+
+ private:
+  explicit EcPointMultiples(int window_bits) : window_bits_(window_bits) {}
+
+  const int window_bits_;
+  std::vector<bssl::UniquePtr<EC_POINT>> points_;
+};
+
+absl::StatusOr<std::shared_ptr<const EcPointMultiples>> EcPointMultiples::New(
+    const EC_GROUP* group, const EC_POINT* point, int window_bits, int rows,
+    BN_CTX* ctx) {
+  std::shared_ptr<EcPointMultiples> multiples(
+      new EcPointMultiples(window_bits));
+  int per_row = (1 << window_bits) - 1;
+  multiples->points_.reserve(rows * per_row);
+
+  // Row i holds 1..per_row multiples of `base`, which is 2^(window_bits * i)
+  // times `point`.
+  bssl::UniquePtr<EC_POINT> base(EC_POINT_dup(point, group));
+  if (!base) {
+    return SslError("copying point");
+  }
+  for (int i = 0; i < rows; i++) {
+    for (int d = 1; d <= per_row; d++) {
+      bssl::UniquePtr<EC_POINT> multiple(EC_POINT_new(group));
+      if (!multiple ||
+          (d == 1 ? !EC_POINT_copy(multiple.get(), base.get())
+                  : !EC_POINT_add(group, multiple.get(),
+                                  multiples->points_.back().get(), base.get(),
+                                  ctx))) {
+        return SslError("computing point multiple");
+      }
+      multiples->points_.push_back(std::move(multiple));
+    }
+    if (!EC_POINT_add(group, base.get(), multiples->points_.back().get(),
+                      base.get(), ctx)) {
+      return SslError("computing point multiple");
+    }
+  }
+
+#ifndef OPENSSL_IS_BORINGSSL
+  // OpenSSL adds affine points faster. BoringSSL doesn't expose this, and its
+  // point addition doesn't benefit from it.
+  std::vector<EC_POINT*> raw_points;
+  raw_points.reserve(multiples->points_.size());
+  for (bssl::UniquePtr<EC_POINT>& multiple : multiples->points_) {
+    raw_points.push_back(multiple.get());
+  }
+  if (!EC_POINTs_make_affine(group, raw_points.size(), raw_points.data(),
+                             ctx)) {
+    return SslError("normalizing point multiples");
+  }
+#endif
+
+  return multiples;
+}
+
+absl::Status EcPointMultiples::AddMultiple(const EC_GROUP* group,
+                                           const BIGNUM* scalar, EC_POINT* sum,
+                                           BN_CTX* ctx) const {
+  int per_row = (1 << window_bits_) - 1;
+  int rows = points_.size() / per_row;
+  for (int i = 0; i < rows; i++) {
+    int digit = 0;
+    for (int b = window_bits_ - 1; b >= 0; b--) {
+      digit = (digit << 1) | BN_is_bit_set(scalar, i * window_bits_ + b);
+    }
+    if (digit != 0 && !EC_POINT_add(group, sum, sum,
+                                    points_[i * per_row + digit - 1].get(),
+                                    ctx)) {
+      return SslError("adding point multiple");
+    }
+  }
+  return absl::OkStatus();
+}
+
+namespace {
+
+// Returns true if the crypto library multiplies the generator of `group` from
+// its own precomputed table, which is faster than EcPointMultiples.
+bool HasFastGeneratorMultiply(const EC_GROUP* group) {
+#ifdef OPENSSL_IS_BORINGSSL
+  return true;
+#else
+  return EC_GROUP_have_precompute_mult(group);
+#endif
+}
+
+// Returns the generator multiples for `group`, which are built once per curve,
+// or nullptr if they wouldn't make verification faster.
+absl::StatusOr<std::shared_ptr<const EcPointMultiples>> GeneratorMultiples(
+    const EC_GROUP* group, int window_bits, int rows, BN_CTX* ctx) {
+  if (HasFastGeneratorMultiply(group)) {
+    return nullptr;
+  }
+  static absl::Mutex mutex(absl::kConstInit);
+  static auto* cache =
+      new absl::flat_hash_map<std::pair<int, int>,
+                              std::shared_ptr<const EcPointMultiples>>();
+
+  int curve = EC_GROUP_get_curve_name(group);
+  if (curve == NID_undef) {
+    return EcPointMultiples::New(group, EC_GROUP_get0_generator(group),
+                                 window_bits, rows, ctx);
+  }
+  absl::MutexLock lock(&mutex);
+  std::shared_ptr<const EcPointMultiples>& multiples =
+      (*cache)[{curve, window_bits}];
+  if (!multiples) {
+    ASSIGN_OR_RETURN(
+        multiples, EcPointMultiples::New(group, EC_GROUP_get0_generator(group),
+                                         window_bits, rows, ctx));
+  }
+  return multiples;
+}
+
+}  // namespace
+
+size_t EcPublicKeyTable::EstimateMemoryBytes(const EC_GROUP* group,
+                                             int window_bits) {
+  bssl::UniquePtr<BIGNUM> order(BN_new());
+  CHECK_EQ(EC_GROUP_get_order(group, order.get(), nullptr), 1);
+  size_t rows = (BN_num_bits(order.get()) + window_bits - 1) / window_bits;
+  size_t points = rows * ((size_t{1} << window_bits) - 1);
+  size_t field_bytes = (EC_GROUP_get_degree(group) + 7) / 8;
+  return points * (3 * field_bytes + kPointOverheadBytes);
+}
+
+absl::StatusOr<std::unique_ptr<EcPublicKeyTable>> EcPublicKeyTable::New(
+    const EC_KEY* key, int window_bits) {
+  if (window_bits < 1 || window_bits > 8) {
+    return NewInternalError(
+        absl::StrCat("window size must be between 1 and 8, got ", window_bits),
+        SOURCE_LOCATION);
+  }
+  bssl::UniquePtr<EC_GROUP> group(EC_GROUP_dup(EC_KEY_get0_group(key)));
+  bssl::UniquePtr<BIGNUM> order(BN_new());
+  bssl::UniquePtr<BN_CTX> ctx(BN_CTX_new());
+  if (!group || !order || !ctx ||
+      !EC_GROUP_get_order(group.get(), order.get(), ctx.get())) {
+    return SslError("reading curve parameters");
+  }
+
+  int rows = (BN_num_bits(order.get()) + window_bits - 1) / window_bits;
+  ASSIGN_OR_RETURN(
+      std::shared_ptr<const EcPointMultiples> generator,
+      GeneratorMultiples(group.get(), window_bits, rows, ctx.get()));
+  ASSIGN_OR_RETURN(
+      std::shared_ptr<const EcPointMultiples> public_point,
+      EcPointMultiples::New(group.get(), EC_KEY_get0_public_key(key),
+                            window_bits, rows, ctx.get()));
+
+  size_t memory_bytes = EstimateMemoryBytes(group.get(), window_bits);
+  return std::unique_ptr<EcPublicKeyTable>(new EcPublicKeyTable(
+      std::move(group), std::move(order), memory_bytes, std::move(generator),
+      std::move(public_point)));
+}
+
+absl::Status EcPublicKeyTable::Verify(
+    const EVP_MD* hash, absl::Span<const uint8_t> digest,
+    absl::Span<const uint8_t> signature) const {
+  ASSIGN_OR_RETURN(bssl::UniquePtr<ECDSA_SIG> sig,
+                   ParseEcdsaSigP1363(group_.get(), hash, digest, signature));
+  const BIGNUM* r;
+  const BIGNUM* s;
+  ECDSA_SIG_get0(sig.get(), &r, &s);
+  if (BN_is_zero(r) || BN_is_zero(s) || BN_cmp(r, order_.get()) >= 0 ||
+      BN_cmp(s, order_.get()) >= 0) {
+    return InvalidSignature();
+  }
+
+  // All inputs are public, so none of this needs to run in constant time.
+  bssl::UniquePtr<BN_CTX> ctx(BN_CTX_new());
+  if (!ctx) {
+    return SslError("allocating context");
+  }
+  ASSIGN_OR_RETURN(bssl::UniquePtr<BIGNUM> e,
+                   DigestToBignum(digest, order_.get()));
+  bssl::UniquePtr<BIGNUM> w(
+      BN_mod_inverse(nullptr, s, order_.get(), ctx.get()));
+  bssl::UniquePtr<BIGNUM> u1(BN_new());
+  bssl::UniquePtr<BIGNUM> u2(BN_new());
+  if (!w || !u1 || !u2 ||
+      !BN_mod_mul(u1.get(), e.get(), w.get(), order_.get(), ctx.get()) ||
+      !BN_mod_mul(u2.get(), r, w.get(), order_.get(), ctx.get())) {
+    return SslError("computing verification scalars");
+  }
+
+  // R = u1 * G + u2 * Q
+  bssl::UniquePtr<EC_POINT> point(EC_POINT_new(group_.get()));
+  if (!point) {
+    return SslError("allocating point");
+  }
+  if (generator_) {
+    if (!EC_POINT_set_to_infinity(group_.get(), point.get())) {
+      return SslError("initializing point");
+    }
+    RETURN_IF_ERROR(generator_->AddMultiple(group_.get(), u1.get(),
+                                            point.get(), ctx.get()));
+  } else if (!EC_POINT_mul(group_.get(), point.get(), u1.get(), nullptr,
+                           nullptr, ctx.get())) {
+    return SslError("computing generator multiple");
+  }
+  RETURN_IF_ERROR(public_point_->AddMultiple(group_.get(), u2.get(),
+                                             point.get(), ctx.get()));
+  if (EC_POINT_is_at_infinity(group_.get(), point.get())) {
+    return InvalidSignature();
+  }
+
+  bssl::UniquePtr<BIGNUM> x(BN_new());
+  if (!x ||
+      !EC_POINT_get_affine_coordinates_GFp(group_.get(), point.get(), x.get(),
+                                           nullptr, ctx.get()) ||
+      !BN_nnmod(x.get(), x.get(), order_.get(), ctx.get())) {
+    return SslError("reading result coordinates");
+  }
+  if (BN_cmp(x.get(), r) != 0) {
+    return InvalidSignature();
+  }
+  return absl::OkStatus();
+}
+
+EcVerifyTables::Key::~Key() { delete table_.load(std::memory_order_acquire); }
+
+EcVerifyTables& EcVerifyTables::Global() {
+  static EcVerifyTables* tables = [] {
+    Options options;
+    options.max_memory_bytes = 0;
+    return new EcVerifyTables(options);
+  }();
+  return *tables;
+}
+
+void EcVerifyTables::Configure(Options options) {
+  std::vector<const EcPublicKeyTable*> discarded;
+  {
+    absl::MutexLock lock(&mutex_);
+    options_ = options;
+    enabled_.store(options.max_memory_bytes > 0, std::memory_order_relaxed);
+    min_uses_.store(options.min_uses, std::memory_order_relaxed);
+    generation_++;
+    memory_bytes_ = 0;
+    // Keys that are still registered keep their handle, and start over.
+    for (auto it = keys_.begin(); it != keys_.end();) {
+      Key& key = *it->second;
+      key.uses_.store(0, std::memory_order_relaxed);
+      key.building_.store(false, std::memory_order_relaxed);
+      if (const EcPublicKeyTable* table =
+              key.table_.exchange(nullptr, std::memory_order_acq_rel)) {
+        discarded.push_back(table);
+      }
+      if (it->second.use_count() == 1) {
+        keys_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+  }
+  DestroyTables(std::move(discarded));
+}
+
+absl::StatusOr<std::shared_ptr<EcVerifyTables::Key>> EcVerifyTables::Register(
+    const EC_KEY* public_key) {
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  ASSIGN_OR_RETURN(std::string id, PublicKeyId(public_key));
+  absl::MutexLock lock(&mutex_);
+  std::shared_ptr<Key>& key = keys_[id];
+  if (!key) {
+    key = std::make_shared<Key>();
+  }
+  return key;
+}
+
+absl::Status EcVerifyTables::Verify(Key* key, EC_KEY* public_key,
+                                    const EVP_MD* hash,
+                                    absl::Span<const uint8_t> digest,
+                                    absl::Span<const uint8_t> signature) {
+  if (!key || !enabled_.load(std::memory_order_relaxed)) {
+    return EcdsaVerifyP1363(public_key, hash, digest, signature);
+  }
+
+  uint64_t uses = key->uses_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (uses % kDecayInterval == 0) {
+    absl::MutexLock lock(&mutex_);
+    DecayUses();
+  }
+  {
+    RcuReadLock lock;
+    if (const EcPublicKeyTable* table =
+            key->table_.load(std::memory_order_acquire)) {
+      return table->Verify(hash, digest, signature);
+    }
+  }
+
+  if (uses >= min_uses_.load(std::memory_order_relaxed) &&
+      !key->building_.exchange(true, std::memory_order_acq_rel)) {
+    // Building a table takes a few milliseconds. Other verifications with
+    // this key use the slow path meanwhile.
+    BuildTable(key, public_key);
+  }
+  return EcdsaVerifyP1363(public_key, hash, digest, signature);
+}
+
+void EcVerifyTables::BuildTable(Key* key, const EC_KEY* public_key) {
+  const EC_GROUP* group = EC_KEY_get0_group(public_key);
+  uint64_t generation;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!CanFit(EcPublicKeyTable::EstimateMemoryBytes(group, kWindowBits),
+                key->uses_.load(std::memory_order_relaxed))) {
+      key->building_.store(false, std::memory_order_release);
+      return;
+    }
+    generation = generation_;
+  }
+
+  // The table is built without holding the lock.
+  absl::StatusOr<std::unique_ptr<EcPublicKeyTable>> built =
+      EcPublicKeyTable::New(public_key, kWindowBits);
+  std::vector<const EcPublicKeyTable*> evicted;
+  {
+    absl::MutexLock lock(&mutex_);
+    if (generation != generation_) {
+      return;
+    }
+    key->building_.store(false, std::memory_order_release);
+    if (built.ok()) {
+      Install(key, *std::move(built), &evicted);
+    } else {
+      LOG(WARNING) << "error building EC verification table: "
+                   << built.status();
+    }
+  }
+  DestroyTables(std::move(evicted));
+}
+
+size_t EcVerifyTables::table_count() const {
+  absl::MutexLock lock(&mutex_);
+  size_t count = 0;
+  for (const auto& [id, key] : keys_) {
+    count += key->table_.load(std::memory_order_relaxed) != nullptr;
+  }
+  return count;
+}
+
+size_t EcVerifyTables::memory_bytes() const {
+  absl::MutexLock lock(&mutex_);
+  return memory_bytes_;
+}
+
+bool EcVerifyTables::CanFit(size_t bytes, uint64_t uses) const {
+  size_t available = options_.max_memory_bytes - memory_bytes_;
+  for (const auto& [id, key] : keys_) {
+    if (available >= bytes) {
+      return true;
+    }
+    const EcPublicKeyTable* table = key->table_.load(std::memory_order_relaxed);
+    if (table && key->uses_.load(std::memory_order_relaxed) < uses) {
+      available += table->memory_bytes();
+    }
+  }
+  return available >= bytes;
+}
+
+bool EcVerifyTables::Install(Key* key,
+                             std::unique_ptr<const EcPublicKeyTable> table,
+                             std::vector<const EcPublicKeyTable*>* evicted) {
+  uint64_t uses = key->uses_.load(std::memory_order_relaxed);
+  size_t bytes = table->memory_bytes();
+  while (memory_bytes_ + bytes > options_.max_memory_bytes) {
+    Key* victim = nullptr;
+    uint64_t victim_uses = 0;
+    for (auto& [id, other] : keys_) {
+      uint64_t other_uses = other->uses_.load(std::memory_order_relaxed);
+      if (other.get() != key &&
+          other->table_.load(std::memory_order_relaxed) &&
+          (!victim || other_uses < victim_uses)) {
+        victim = other.get();
+        victim_uses = other_uses;
+      }
+    }
+    if (!victim || victim_uses >= uses) {
+      return false;
+    }
+    const EcPublicKeyTable* victim_table =
+        victim->table_.exchange(nullptr, std::memory_order_acq_rel);
+    memory_bytes_ -= victim_table->memory_bytes();
+    evicted->push_back(victim_table);
+  }
+  memory_bytes_ += bytes;
+  key->table_.store(table.release(), std::memory_order_release);
+  return true;
+}
+
+void EcVerifyTables::DecayUses() {
+  for (auto it = keys_.begin(); it != keys_.end();) {
+    Key& key = *it->second;
+    uint64_t uses = key.uses_.load(std::memory_order_relaxed) / 2;
+    key.uses_.store(uses, std::memory_order_relaxed);
+    // Keys that no verifier holds are forgotten once they fall out of use.
+    if (uses == 0 && it->second.use_count() == 1 &&
+        !key.table_.load(std::memory_order_relaxed)) {
+      keys_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void EcVerifyTables::DestroyTables(
+    std::vector<const EcPublicKeyTable*> tables) {
+  if (tables.empty()) {
+    return;
+  }
+  RcuSynchronize();
+  for (const EcPublicKeyTable* table : tables) {
+    delete table;
+  }
+}
+
+}  // namespace cloud_kms::kmsp11
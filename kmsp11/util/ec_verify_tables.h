@@ -0,0 +1,173 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KMSP11_UTIL_EC_VERIFY_TABLES_H_
+#define KMSP11_UTIL_EC_VERIFY_TABLES_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "common/openssl.h"
+
+namespace cloud_kms::kmsp11 {
+
+class EcPointMultiples;
+
+// EcPublicKeyTable holds precomputed multiples of an EC public point, which
+// replace the variable-base scalar multiplication in ECDSA verification with
+// point additions. Curves whose generator the crypto library doesn't
+// precompute also get generator multiples, which are shared by all tables for
+// the curve. A table is immutable once built, and may be used from any number
+// of threads.
+class EcPublicKeyTable {
+ public:
+  // Builds a table for `key`, with one row of 2^window_bits - 1 points for
+  // each window_bits-sized window of the group order.
+  static absl::StatusOr<std::unique_ptr<EcPublicKeyTable>> New(
+      const EC_KEY* key, int window_bits);
+
+  // Returns the approximate memory used by a table for `group`, excluding the
+  // shared generator multiples.
+  static size_t EstimateMemoryBytes(const EC_GROUP* group, int window_bits);
+
+  // Verifies that the provided signature in IEEE P-1363 format is a valid
+  // signature over digest. Errors are the same as those from EcdsaVerifyP1363.
+  absl::Status Verify(const EVP_MD* hash, absl::Span<const uint8_t> digest,
+                      absl::Span<const uint8_t> signature) const;
+
+  size_t memory_bytes() const { return memory_bytes_; }
+
+ private:
+  EcPublicKeyTable(bssl::UniquePtr<EC_GROUP> group,
+                   bssl::UniquePtr<BIGNUM> order, size_t memory_bytes,
+                   std::shared_ptr<const EcPointMultiples> generator,
+                   std::shared_ptr<const EcPointMultiples> public_point)
+      : group_(std::move(group)),
+        order_(std::move(order)),
+        memory_bytes_(memory_bytes),
+        generator_(std::move(generator)),
+        public_point_(std::move(public_point)) {}
+
+  bssl::UniquePtr<EC_GROUP> group_;
+  bssl::UniquePtr<BIGNUM> order_;
+  const size_t memory_bytes_;
+  // nullptr if the crypto library's generator multiplication is faster.
+  std::shared_ptr<const EcPointMultiples> generator_;
+  std::shared_ptr<const EcPointMultiples> public_point_;
+};
+
+// EcVerifyTables verifies ECDSA signatures, and builds an EcPublicKeyTable for
+// the most frequently used public keys. Keys are identified by their encoded
+// public point, so that objects for the same key share a table. Tables are
+// built once a key has been used `min_uses` times, and the least used tables
+// are evicted to keep the total within `max_memory_bytes`.
+//
+// Callers register a key once, and keep the returned handle for as long as
+// they verify with the key. Verification with a handle updates the key's use
+// count and reads its table without taking a lock.
+class EcVerifyTables {
+ public:
+  struct Options {
+    // The approximate memory that all tables may occupy, excluding the
+    // generator multiples that are shared by all tables for a curve. No tables
+    // are built when this is 0.
+    size_t max_memory_bytes = 32 << 20;
+    // The number of verifications with a key before a table is built for it.
+    // Use counts are halved periodically, so this is a measure of recent use.
+    uint64_t min_uses = 1000;
+  };
+
+  // The use count and table of a registered public key.
+  class Key {
+   public:
+    ~Key();
+
+   private:
+    friend class EcVerifyTables;
+
+    std::atomic<uint64_t> uses_ = 0;
+    std::atomic<bool> building_ = false;
+    // Owned by this key. A replaced table is destroyed once no verification
+    // can be using it.
+    std::atomic<const EcPublicKeyTable*> table_ = nullptr;
+  };
+
+  // Returns the process-wide instance, which builds no tables until it is
+  // configured.
+  static EcVerifyTables& Global();
+
+  explicit EcVerifyTables(Options options)
+      : enabled_(options.max_memory_bytes > 0),
+        min_uses_(options.min_uses),
+        options_(options) {}
+
+  // Replaces the options, and discards all tables and use counts.
+  void Configure(Options options);
+
+  // Returns the handle for `public_key`, which is shared by all callers that
+  // register the same curve and public point, or nullptr if no tables are
+  // built.
+  absl::StatusOr<std::shared_ptr<Key>> Register(const EC_KEY* public_key);
+
+  // Verifies that the provided signature in IEEE P-1363 format is a valid
+  // signature over digest, using a table for `public_key` if one exists.
+  // `key` is the handle that Register returned for `public_key`, and may be
+  // nullptr. Errors are the same as those from EcdsaVerifyP1363.
+  absl::Status Verify(Key* key, EC_KEY* public_key, const EVP_MD* hash,
+                      absl::Span<const uint8_t> digest,
+                      absl::Span<const uint8_t> signature);
+
+  size_t table_count() const;
+  size_t memory_bytes() const;
+
+ private:
+  // Builds a table for `key`, and installs it if it fits in the memory budget.
+  void BuildTable(Key* key, const EC_KEY* public_key);
+  // Returns true if a table of `bytes` fits in the memory budget, possibly
+  // after evicting tables with fewer than `uses` uses.
+  bool CanFit(size_t bytes, uint64_t uses) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Installs `table` for `key`, evicting less used tables to make room.
+  // Evicted tables are appended to `evicted`, and must be destroyed with
+  // DestroyTables. Returns false if `table` doesn't fit.
+  bool Install(Key* key, std::unique_ptr<const EcPublicKeyTable> table,
+               std::vector<const EcPublicKeyTable*>* evicted)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void DecayUses() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Destroys `tables` once no verification can be using them.
+  static void DestroyTables(std::vector<const EcPublicKeyTable*> tables);
+
+  // Mirror options_, so that verification doesn't take the lock.
+  std::atomic<bool> enabled_;
+  std::atomic<uint64_t> min_uses_;
+  mutable absl::Mutex mutex_;
+  Options options_ ABSL_GUARDED_BY(mutex_);
+  uint64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  size_t memory_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<std::string, std::shared_ptr<Key>> keys_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace cloud_kms::kmsp11
+
+#endif  // KMSP11_UTIL_EC_VERIFY_TABLES_H_
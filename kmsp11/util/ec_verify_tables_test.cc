@@ -0,0 +1,278 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/util/ec_verify_tables.h"
+
+#include <thread>
+
+#include "common/test/test_status_macros.h"
+#include "glog/logging.h"
+#include "gmock/gmock.h"
+#include "kmsp11/test/matchers.h"
+#include "kmsp11/util/crypto_utils.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+using ::testing::IsNull;
+using ::testing::Ne;
+
+bssl::UniquePtr<EC_KEY> NewKey(int curve) {
+  bssl::UniquePtr<EC_KEY> key(EC_KEY_new_by_curve_name(curve));
+  CHECK(EC_KEY_generate_key(key.get()));
+  return key;
+}
+
+std::vector<uint8_t> Digest(const EVP_MD* md, std::string_view data) {
+  std::vector<uint8_t> digest(EVP_MD_size(md));
+  CHECK(EVP_Digest(data.data(), data.size(), digest.data(), nullptr, md,
+                   nullptr));
+  return digest;
+}
+
+std::vector<uint8_t> SignP1363(EC_KEY* key, absl::Span<const uint8_t> digest) {
+  bssl::UniquePtr<ECDSA_SIG> sig(
+      ECDSA_do_sign(digest.data(), digest.size(), key));
+  CHECK(sig);
+  const BIGNUM* r;
+  const BIGNUM* s;
+  ECDSA_SIG_get0(sig.get(), &r, &s);
+  size_t n_len = EcdsaSigLengthP1363(EC_KEY_get0_group(key)) / 2;
+  std::vector<uint8_t> result(2 * n_len);
+  CHECK_OK(BignumToBinary(r, absl::MakeSpan(result).subspan(0, n_len)));
+  CHECK_OK(BignumToBinary(s, absl::MakeSpan(result).subspan(n_len)));
+  return result;
+}
+
+class EcPublicKeyTableTest
+    : public testing::TestWithParam<std::tuple<int, const EVP_MD*>> {};
+
+INSTANTIATE_TEST_SUITE_P(Curves, EcPublicKeyTableTest,
+                         testing::Values(std::make_tuple(NID_X9_62_prime256v1,
+                                                         EVP_sha256()),
+                                         std::make_tuple(NID_secp384r1,
+                                                         EVP_sha384()),
+                                         std::make_tuple(NID_secp256k1,
+                                                         EVP_sha256())));
+
+TEST_P(EcPublicKeyTableTest, VerifiesValidSignatures) {
+  auto [curve, md] = GetParam();
+  bssl::UniquePtr<EC_KEY> key = NewKey(curve);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EcPublicKeyTable> table,
+                       EcPublicKeyTable::New(key.get(), 4));
+
+  for (int i = 0; i < 20; i++) {
+    std::vector<uint8_t> digest = Digest(md, absl::StrCat("message ", i));
+    std::vector<uint8_t> sig = SignP1363(key.get(), digest);
+    EXPECT_OK(table->Verify(md, digest, sig));
+  }
+}
+
+TEST_P(EcPublicKeyTableTest, RejectsModifiedSignature) {
+  auto [curve, md] = GetParam();
+  bssl::UniquePtr<EC_KEY> key = NewKey(curve);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EcPublicKeyTable> table,
+                       EcPublicKeyTable::New(key.get(), 4));
+
+  std::vector<uint8_t> digest = Digest(md, "message");
+  std::vector<uint8_t> sig = SignP1363(key.get(), digest);
+  sig.back() ^= 1;
+  EXPECT_THAT(table->Verify(md, digest, sig),
+              StatusRvIs(CKR_SIGNATURE_INVALID));
+}
+
+TEST_P(EcPublicKeyTableTest, RejectsOtherKeySignature) {
+  auto [curve, md] = GetParam();
+  bssl::UniquePtr<EC_KEY> key = NewKey(curve);
+  bssl::UniquePtr<EC_KEY> other_key = NewKey(curve);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EcPublicKeyTable> table,
+                       EcPublicKeyTable::New(key.get(), 4));
+
+  std::vector<uint8_t> digest = Digest(md, "message");
+  EXPECT_THAT(table->Verify(md, digest, SignP1363(other_key.get(), digest)),
+              StatusRvIs(CKR_SIGNATURE_INVALID));
+}
+
+TEST(EcPublicKeyTableTest, RejectsOutOfRangeSignature) {
+  bssl::UniquePtr<EC_KEY> key = NewKey(NID_X9_62_prime256v1);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EcPublicKeyTable> table,
+                       EcPublicKeyTable::New(key.get(), 4));
+
+  std::vector<uint8_t> digest = Digest(EVP_sha256(), "message");
+  std::vector<uint8_t> zero(64, 0);
+  EXPECT_THAT(table->Verify(EVP_sha256(), digest, zero),
+              StatusRvIs(CKR_SIGNATURE_INVALID));
+  std::vector<uint8_t> max(64, 0xff);
+  EXPECT_THAT(table->Verify(EVP_sha256(), digest, max),
+              StatusRvIs(CKR_SIGNATURE_INVALID));
+}
+
+TEST(EcPublicKeyTableTest, RejectsWrongDigestLength) {
+  bssl::UniquePtr<EC_KEY> key = NewKey(NID_X9_62_prime256v1);
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<EcPublicKeyTable> table,
+                       EcPublicKeyTable::New(key.get(), 4));
+
+  uint8_t digest[31], sig[64];
+  EXPECT_THAT(table->Verify(EVP_sha256(), digest, sig),
+              StatusRvIs(CKR_DATA_LEN_RANGE));
+}
+
+TEST(EcVerifyTablesTest, BuildsTableAfterMinUses) {
+  bssl::UniquePtr<EC_KEY> key = NewKey(NID_X9_62_prime256v1);
+  std::vector<uint8_t> digest = Digest(EVP_sha256(), "message");
+  std::vector<uint8_t> sig = SignP1363(key.get(), digest);
+
+  EcVerifyTables::Options options;
+  options.min_uses = 3;
+  EcVerifyTables tables(options);
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<EcVerifyTables::Key> handle,
+                       tables.Register(key.get()));
+
+  for (int i = 0; i < 2; i++) {
+    EXPECT_OK(
+        tables.Verify(handle.get(), key.get(), EVP_sha256(), digest, sig));
+  }
+  EXPECT_EQ(tables.table_count(), 0);
+
+  EXPECT_OK(tables.Verify(handle.get(), key.get(), EVP_sha256(), digest, sig));
+  EXPECT_EQ(tables.table_count(), 1);
+  EXPECT_GT(tables.memory_bytes(), 0);
+
+  sig.back() ^= 1;
+  EXPECT_THAT(
+      tables.Verify(handle.get(), key.get(), EVP_sha256(), digest, sig),
+              StatusRvIs(CKR_SIGNATURE_INVALID));
+}
+
+TEST(EcVerifyTablesTest, SamePublicKeySharesHandle) {
+  bssl::UniquePtr<EC_KEY> key = NewKey(NID_X9_62_prime256v1);
+  bssl::UniquePtr<EC_KEY> copy(EC_KEY_dup(key.get()));
+  bssl::UniquePtr<EC_KEY> other = NewKey(NID_X9_62_prime256v1);
+
+  EcVerifyTables tables(EcVerifyTables::Options{});
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<EcVerifyTables::Key> handle,
+                       tables.Register(key.get()));
+  EXPECT_THAT(tables.Register(copy.get()), IsOkAndHolds(handle));
+  EXPECT_THAT(tables.Register(other.get()), IsOkAndHolds(Ne(handle)));
+}
+
+TEST(EcVerifyTablesTest, DisabledBuildsNoTables) {
+  bssl::UniquePtr<EC_KEY> key = NewKey(NID_X9_62_prime256v1);
+  std::vector<uint8_t> digest = Digest(EVP_sha256(), "message");
+  std::vector<uint8_t> sig = SignP1363(key.get(), digest);
+
+  EcVerifyTables::Options options;
+  options.max_memory_bytes = 0;
+  options.min_uses = 0;
+  EcVerifyTables tables(options);
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<EcVerifyTables::Key> handle,
+                       tables.Register(key.get()));
+  EXPECT_THAT(handle, IsNull());
+
+  EXPECT_OK(tables.Verify(handle.get(), key.get(), EVP_sha256(), digest, sig));
+  EXPECT_EQ(tables.table_count(), 0);
+}
+
+TEST(EcVerifyTablesTest, MoreUsedKeyEvictsLessUsedKey) {
+  bssl::UniquePtr<EC_KEY> cold_key = NewKey(NID_X9_62_prime256v1);
+  bssl::UniquePtr<EC_KEY> hot_key = NewKey(NID_X9_62_prime256v1);
+  std::vector<uint8_t> digest = Digest(EVP_sha256(), "message");
+  std::vector<uint8_t> cold_sig = SignP1363(cold_key.get(), digest);
+  std::vector<uint8_t> hot_sig = SignP1363(hot_key.get(), digest);
+
+  // Only one table fits.
+  EcVerifyTables::Options options;
+  options.max_memory_bytes = EcPublicKeyTable::EstimateMemoryBytes(
+      EC_KEY_get0_group(hot_key.get()), 8);
+  options.min_uses = 2;
+  EcVerifyTables tables(options);
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<EcVerifyTables::Key> cold_handle,
+                       tables.Register(cold_key.get()));
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<EcVerifyTables::Key> hot_handle,
+                       tables.Register(hot_key.get()));
+
+  for (int i = 0; i < 2; i++) {
+    EXPECT_OK(tables.Verify(cold_handle.get(), cold_key.get(), EVP_sha256(),
+                          digest, cold_sig));
+  }
+  EXPECT_EQ(tables.table_count(), 1);
+
+  // The hot key isn't promoted while it is used no more than the cold key.
+  for (int i = 0; i < 2; i++) {
+    EXPECT_OK(tables.Verify(hot_handle.get(), hot_key.get(), EVP_sha256(),
+                          digest, hot_sig));
+  }
+  EXPECT_EQ(tables.table_count(), 1);
+
+  EXPECT_OK(tables.Verify(hot_handle.get(), hot_key.get(), EVP_sha256(),
+                          digest, hot_sig));
+  EXPECT_EQ(tables.table_count(), 1);
+  EXPECT_EQ(tables.memory_bytes(), options.max_memory_bytes);
+
+  // Both keys still verify, whether or not they have a table.
+  EXPECT_OK(tables.Verify(cold_handle.get(), cold_key.get(), EVP_sha256(),
+                          digest, cold_sig));
+  EXPECT_OK(tables.Verify(hot_handle.get(), hot_key.get(), EVP_sha256(),
+                          digest, hot_sig));
+}
+
+TEST(EcVerifyTablesTest, ConfigureDiscardsTables) {
+  bssl::UniquePtr<EC_KEY> key = NewKey(NID_X9_62_prime256v1);
+  std::vector<uint8_t> digest = Digest(EVP_sha256(), "message");
+  std::vector<uint8_t> sig = SignP1363(key.get(), digest);
+
+  EcVerifyTables::Options options;
+  options.min_uses = 0;
+  EcVerifyTables tables(options);
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<EcVerifyTables::Key> handle,
+                       tables.Register(key.get()));
+  EXPECT_OK(tables.Verify(handle.get(), key.get(), EVP_sha256(), digest, sig));
+  EXPECT_EQ(tables.table_count(), 1);
+
+  tables.Configure(options);
+  EXPECT_EQ(tables.table_count(), 0);
+  EXPECT_EQ(tables.memory_bytes(), 0);
+}
+
+TEST(EcVerifyTablesTest, ConcurrentVerificationsBuildOneTable) {
+  bssl::UniquePtr<EC_KEY> key = NewKey(NID_X9_62_prime256v1);
+  std::vector<uint8_t> digest = Digest(EVP_sha256(), "message");
+  std::vector<uint8_t> sig = SignP1363(key.get(), digest);
+
+  EcVerifyTables::Options options;
+  options.min_uses = 8;
+  EcVerifyTables tables(options);
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<EcVerifyTables::Key> handle,
+                       tables.Register(key.get()));
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < 16; j++) {
+        EXPECT_OK(
+            tables.Verify(handle.get(), key.get(), EVP_sha256(), digest, sig));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(tables.table_count(), 1);
+  EXPECT_EQ(tables.memory_bytes(),
+            EcPublicKeyTable::EstimateMemoryBytes(
+                EC_KEY_get0_group(key.get()), 8));
+}
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
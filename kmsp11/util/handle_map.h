@@ -17,9 +17,14 @@
 #ifndef KMSP11_UTIL_HANDLE_MAP_H_
 #define KMSP11_UTIL_HANDLE_MAP_H_
 
+#include <array>
+#include <memory>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "kmsp11/cryptoki.h"
 #include "kmsp11/util/crypto_utils.h"
 #include "kmsp11/util/errors.h"
@@ -29,6 +34,10 @@ namespace cloud_kms::kmsp11 {
 // A HandleMap contains a set of items with assigned CK_ULONG handles.
 // It is intended for use with the PKCS #11 Session and Object types, both
 // of which are identified by a handle.
+//
+// Items are spread across a fixed number of independently locked shards,
+// selected by handle, so that concurrent lookups of different handles do not
+// contend on a single mutex.
 template <typename T>
 class HandleMap {
  public:
@@ -40,27 +49,30 @@ class HandleMap {
   // returns its handle.
   template <typename... Args>
   inline CK_ULONG Add(Args&&... args) {
-    absl::WriterMutexLock lock(&mutex_);
+    std::shared_ptr<T> item = std::make_shared<T>(std::forward<Args>(args)...);
 
     // Generate a new handle by picking a random handle and ensuring that it is
     // not already in use. Repeat this process until we have a useable handle.
-    CK_ULONG handle;
-    do {
-      handle = RandomHandle();
-    } while (items_.contains(handle));
-
-    items_.try_emplace(handle,
-                       std::make_shared<T>(std::forward<Args>(args)...));
-    return handle;
+    // Since a handle determines its shard, uniqueness within the shard implies
+    // uniqueness within the map.
+    while (true) {
+      CK_ULONG handle = RandomHandle();
+      Shard& shard = ShardFor(handle);
+      absl::WriterMutexLock lock(&shard.mutex);
+      if (shard.items.try_emplace(handle, item).second) {
+        return handle;
+      }
+    }
   }
 
   // Gets the map element with the provided handle, or returns NotFound if there
   // is no element with the provided handle.
   inline absl::StatusOr<std::shared_ptr<T>> Get(CK_ULONG handle) const {
-    absl::ReaderMutexLock lock(&mutex_);
+    const Shard& shard = ShardFor(handle);
+    absl::ReaderMutexLock lock(&shard.mutex);
 
-    auto it = items_.find(handle);
-    if (it == items_.end()) {
+    auto it = shard.items.find(handle);
+    if (it == shard.items.end()) {
       return HandleNotFoundError(handle, not_found_rv_, SOURCE_LOCATION);
     }
 
@@ -70,36 +82,71 @@ class HandleMap {
   // Removes the map element with the provided handle, or returns NotFound if
   // there is no element with the provided handle.
   inline absl::Status Remove(CK_ULONG handle) {
-    absl::WriterMutexLock lock(&mutex_);
-
-    auto it = items_.find(handle);
-    if (it == items_.end()) {
+    // Destroy the removed item (if this is its last reference) after the shard
+    // lock has been released.
+    std::shared_ptr<T> removed;
+    Shard& shard = ShardFor(handle);
+    absl::WriterMutexLock lock(&shard.mutex);
+
+    auto it = shard.items.find(handle);
+    if (it == shard.items.end()) {
       return HandleNotFoundError(handle, not_found_rv_, SOURCE_LOCATION);
     }
 
-    items_.erase(it);
+    removed = std::move(it->second);
+    shard.items.erase(it);
     return absl::OkStatus();
   }
 
-  // Removes all map elements that match the provided predicate.
-  inline void RemoveIf(absl::FunctionRef<bool(const T&)> predicate) {
-    absl::WriterMutexLock lock(&mutex_);
+  // Removes all map elements that match the provided predicate. All shards are
+  // locked for the duration of the call, so the removal is atomic with respect
+  // to concurrent Add, Get, and Remove calls.
+  inline void RemoveIf(absl::FunctionRef<bool(const T&)> predicate)
+      ABSL_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<std::shared_ptr<T>> removed;
+    for (Shard& shard : shards_) {
+      shard.mutex.WriterLock();
+    }
 
-    auto it = items_.begin();
-    while (it != items_.end()) {
-      if (predicate(*it->second)) {
-        items_.erase(it++);
-      } else {
-        it++;
+    for (Shard& shard : shards_) {
+      auto it = shard.items.begin();
+      while (it != shard.items.end()) {
+        if (predicate(*it->second)) {
+          removed.push_back(std::move(it->second));
+          shard.items.erase(it++);
+        } else {
+          it++;
+        }
       }
     }
+
+    for (auto it = shards_.rbegin(); it != shards_.rend(); it++) {
+      it->mutex.WriterUnlock();
+    }
   }
 
  private:
+  static constexpr size_t kShardCount = 16;
+
+  // Shards are aligned to (a typical) cache line size so that lock traffic on
+  // one shard does not invalidate its neighbors.
+  struct alignas(64) Shard {
+    mutable absl::Mutex mutex;
+    absl::flat_hash_map<CK_ULONG, std::shared_ptr<T>> items
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  // Handles are chosen uniformly at random, so their low bits are a suitable
+  // shard selector.
+  inline Shard& ShardFor(CK_ULONG handle) {
+    return shards_[handle % kShardCount];
+  }
+  inline const Shard& ShardFor(CK_ULONG handle) const {
+    return shards_[handle % kShardCount];
+  }
+
   CK_RV not_found_rv_;
-  mutable absl::Mutex mutex_;
-  absl::flat_hash_map<CK_ULONG, std::shared_ptr<T>> items_
-      ABSL_GUARDED_BY(mutex_);
+  std::array<Shard, kShardCount> shards_;
 };
 
 }  // namespace cloud_kms::kmsp11
@@ -14,6 +14,9 @@
 
 #include "kmsp11/util/handle_map.h"
 
+#include <thread>
+#include <vector>
+
 #include "common/test/test_status_macros.h"
 #include "gtest/gtest.h"
 #include "kmsp11/test/matchers.h"
@@ -96,5 +99,43 @@ TEST(HandleMapTest, RemoveIfRemovesOnPredicate) {
   EXPECT_THAT(map.Get(h4), StatusRvIs(CKR_SESSION_HANDLE_INVALID));
 }
 
+TEST(HandleMapTest, RemoveIfRemovesFromAllShards) {
+  HandleMap<int> map(CKR_SESSION_HANDLE_INVALID);
+  std::vector<CK_ULONG> handles;
+  for (int i = 0; i < 1000; i++) {
+    handles.push_back(map.Add(i));
+  }
+
+  map.RemoveIf([](const int& i) -> bool { return i % 2 == 0; });
+
+  for (int i = 0; i < 1000; i++) {
+    if (i % 2 == 0) {
+      EXPECT_THAT(map.Get(handles[i]), StatusRvIs(CKR_SESSION_HANDLE_INVALID));
+    } else {
+      EXPECT_THAT(map.Get(handles[i]), IsOkAndHolds(Pointee(i)));
+    }
+  }
+}
+
+TEST(HandleMapTest, ConcurrentAddGetRemove) {
+  HandleMap<int> map(CKR_SESSION_HANDLE_INVALID);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&map, t] {
+      for (int i = 0; i < 500; i++) {
+        int value = t * 1000 + i;
+        CK_ULONG handle = map.Add(value);
+        EXPECT_THAT(map.Get(handle), IsOkAndHolds(Pointee(value)));
+        EXPECT_OK(map.Remove(handle));
+        EXPECT_THAT(map.Get(handle), StatusRvIs(CKR_SESSION_HANDLE_INVALID));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
 }  // namespace
 }  // namespace cloud_kms::kmsp11
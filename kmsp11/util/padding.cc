@@ -33,6 +33,14 @@ std::vector<uint8_t> Pad(absl::Span<const uint8_t> data) {
   return padded_data;
 }
 
+void Pad(absl::Span<const uint8_t> data, std::string* dest) {
+  size_t padding_len = kCipherBlockSize - (data.size() % kCipherBlockSize);
+
+  dest->reserve(dest->size() + data.size() + padding_len);
+  dest->append(reinterpret_cast<const char*>(data.data()), data.size());
+  dest->append(padding_len, static_cast<char>(padding_len));
+}
+
 absl::StatusOr<absl::Span<const uint8_t>> Unpad(
     absl::Span<const uint8_t> data) {
   // Check that the last char is a valid padding value.
@@ -17,6 +17,9 @@
 #ifndef KMSP11_UTIL_PADDING_H_
 #define KMSP11_UTIL_PADDING_H_
 
+#include <string>
+#include <vector>
+
 #include "absl/status/statusor.h"
 
 namespace cloud_kms::kmsp11 {
@@ -25,6 +28,11 @@ namespace cloud_kms::kmsp11 {
 // The block size is hardcoded to 16 bytes.
 std::vector<uint8_t> Pad(absl::Span<const uint8_t> data);
 
+// Appends `data` with PKCS#7 padding to `dest`, so that it can be written
+// straight into a request message.
+// The block size is hardcoded to 16 bytes.
+void Pad(absl::Span<const uint8_t> data, std::string* dest);
+
 // Removes PKCS#7 padding.
 // The block size is hardcoded to 16 bytes.
 absl::StatusOr<absl::Span<const uint8_t>> Unpad(absl::Span<const uint8_t> data);
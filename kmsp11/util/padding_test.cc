@@ -18,6 +18,7 @@
 #include "gmock/gmock.h"
 #include "kmsp11/cryptoki.h"
 #include "kmsp11/test/matchers.h"
+#include "kmsp11/util/string_utils.h"
 
 namespace cloud_kms::kmsp11 {
 namespace {
@@ -37,6 +38,12 @@ TEST(PaddingTest, PaddingRightSizePlaintext) {
   EXPECT_EQ(padded_plaintext.back(), '\x10');
 }
 
+TEST(PaddingTest, PaddingIntoStringMatchesPaddingIntoVector) {
+  std::string padded_plaintext;
+  Pad(kPlaintext, &padded_plaintext);
+  EXPECT_EQ(padded_plaintext, StrFromBytes(Pad(kPlaintext)));
+}
+
 TEST(PaddingTest, InvalidPaddingValueGreaterThanBlockSize) {
   std::vector<uint8_t> invalid_padding_plaintext(17, '\x11');
   EXPECT_THAT(Unpad(invalid_padding_plaintext),
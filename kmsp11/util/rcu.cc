@@ -0,0 +1,160 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/util/rcu.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/time/clock.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+// This is epoch-based reclamation. Each thread that reads has a record that
+// holds the global epoch observed when its outermost critical section began,
+// or 0 when it is not in a critical section. A writer publishes its new value,
+// advances the global epoch, and then waits until no record holds an epoch
+// older than the new one.
+
+// Padded to a cache line, so that readers on different cores do not contend.
+struct alignas(64) ReaderRecord {
+  std::atomic<uint64_t> epoch{0};
+  int depth = 0;
+};
+
+// Records are owned by the registry and are never freed, so that a writer can
+// wait on a snapshot of them without holding the registry lock. The record of
+// an exited thread is reused by the next thread that registers.
+class Registry {
+ public:
+  ReaderRecord* Register() {
+    absl::MutexLock lock(&mutex_);
+    if (!free_records_.empty()) {
+      ReaderRecord* record = free_records_.back();
+      free_records_.pop_back();
+      return record;
+    }
+    records_.push_back(std::make_unique<ReaderRecord>());
+    return records_.back().get();
+  }
+
+  // The record must not be in a critical section.
+  void Unregister(ReaderRecord* record) {
+    absl::MutexLock lock(&mutex_);
+    free_records_.push_back(record);
+  }
+
+  void Synchronize() {
+    uint64_t target = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    // A thread that registers after the snapshot reads the advanced epoch
+    // when it enters its first critical section, so it need not be waited on.
+    std::vector<ReaderRecord*> records;
+    {
+      absl::MutexLock lock(&mutex_);
+      records.reserve(records_.size());
+      for (const std::unique_ptr<ReaderRecord>& record : records_) {
+        records.push_back(record.get());
+      }
+    }
+
+    for (ReaderRecord* record : records) {
+      for (int spins = 0;; spins++) {
+        uint64_t observed = record->epoch.load(std::memory_order_acquire);
+        if (observed == 0 || observed >= target) {
+          break;
+        }
+        if (spins > 100) {
+          absl::SleepFor(absl::Microseconds(50));
+        }
+      }
+    }
+  }
+
+  uint64_t epoch() const { return epoch_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> epoch_{1};
+  absl::Mutex mutex_;
+  std::vector<std::unique_ptr<ReaderRecord>> records_ ABSL_GUARDED_BY(mutex_);
+  std::vector<ReaderRecord*> free_records_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Registries are never destroyed, since threads may exit after static
+// destructors run. The registry is replaced in a child process after fork.
+std::atomic<Registry*> current_registry{new Registry};
+
+Registry& GetRegistry() {
+  return *current_registry.load(std::memory_order_acquire);
+}
+
+// Takes a record from the current registry on first use, and returns it when
+// the thread exits.
+class ThreadRecord {
+ public:
+  ~ThreadRecord() {
+    if (registry_ == &GetRegistry()) {
+      registry_->Unregister(record_);
+    }
+  }
+
+  ReaderRecord& record() {
+    Registry* registry = &GetRegistry();
+    if (registry_ != registry) {
+      record_ = registry->Register();
+      registry_ = registry;
+    }
+    return *record_;
+  }
+
+ private:
+  Registry* registry_ = nullptr;
+  ReaderRecord* record_ = nullptr;
+};
+
+ReaderRecord& CurrentThreadRecord() {
+  thread_local ThreadRecord thread_record;
+  return thread_record.record();
+}
+
+}  // namespace
+
+RcuReadLock::RcuReadLock() {
+  ReaderRecord& record = CurrentThreadRecord();
+  if (record.depth++ == 0) {
+    record.epoch.store(GetRegistry().epoch(), std::memory_order_relaxed);
+    // Order the announcement before any subsequent load of a published value.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+  }
+}
+
+RcuReadLock::~RcuReadLock() {
+  ReaderRecord& record = CurrentThreadRecord();
+  if (--record.depth == 0) {
+    record.epoch.store(0, std::memory_order_release);
+  }
+}
+
+void RcuSynchronize() { GetRegistry().Synchronize(); }
+
+void RcuResetAfterFork() {
+  // The previous registry may hold records for threads that do not exist in
+  // this process, or have its mutex held by one of them. Leak it.
+  current_registry.store(new Registry, std::memory_order_release);
+}
+
+}  // namespace cloud_kms::kmsp11
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef KMSP11_UTIL_RCU_H_
+#define KMSP11_UTIL_RCU_H_
+
+#include <atomic>
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+
+namespace cloud_kms::kmsp11 {
+
+// RcuReadLock marks a read-side critical section. While any RcuReadLock is
+// alive on a thread, values read from an RcuPtr on that thread remain valid.
+//
+// Entering and leaving a critical section takes no locks and writes only to
+// state owned by the current thread. Critical sections may be nested, and
+// should be short: RcuPtr::Replace waits for all critical sections that were
+// started before it to end.
+class RcuReadLock {
+ public:
+  RcuReadLock();
+  ~RcuReadLock();
+
+  RcuReadLock(const RcuReadLock&) = delete;
+  RcuReadLock& operator=(const RcuReadLock&) = delete;
+};
+
+// Waits until every read-side critical section that was active at the time of
+// the call has ended. Must not be called from within a critical section.
+void RcuSynchronize();
+
+// Discards reader state inherited from the parent process. Must be called in
+// the child process after fork, before any other RCU function.
+void RcuResetAfterFork();
+
+// RcuPtr publishes an immutable value to concurrent readers, in the style of
+// read-copy-update: readers see either the old value or the new value, and a
+// replaced value is destroyed only after no reader can observe it.
+template <typename T>
+class RcuPtr {
+ public:
+  // A handle to the current value. The value remains valid for the lifetime of
+  // the handle, which should be short.
+  class ReadHandle {
+   public:
+    const T& operator*() const { return *value_; }
+    const T* operator->() const { return value_; }
+
+   private:
+    friend class RcuPtr;
+    explicit ReadHandle(const std::atomic<const T*>& ptr)
+        : value_(ptr.load(std::memory_order_acquire)) {}
+
+    // Declared first so that the critical section is entered before the value
+    // is loaded.
+    RcuReadLock lock_;
+    const T* value_;
+  };
+
+  explicit RcuPtr(std::unique_ptr<const T> value) : ptr_(value.release()) {}
+  ~RcuPtr() { delete ptr_.load(std::memory_order_acquire); }
+
+  RcuPtr(const RcuPtr&) = delete;
+  RcuPtr& operator=(const RcuPtr&) = delete;
+
+  ReadHandle Read() const { return ReadHandle(ptr_); }
+
+  // Publishes `value`, then waits for readers of the previous value to finish
+  // before destroying it. Must not be called from within a critical section.
+  void Replace(std::unique_ptr<const T> value) {
+    absl::MutexLock lock(&writer_mutex_);
+    const T* previous =
+        ptr_.exchange(value.release(), std::memory_order_seq_cst);
+    RcuSynchronize();
+    delete previous;
+  }
+
+ private:
+  std::atomic<const T*> ptr_;
+  absl::Mutex writer_mutex_;
+};
+
+}  // namespace cloud_kms::kmsp11
+
+#endif  // KMSP11_UTIL_RCU_H_
@@ -0,0 +1,164 @@
+// Copyright 2025 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kmsp11/util/rcu.h"
+
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
+
+namespace cloud_kms::kmsp11 {
+namespace {
+
+// A value that records whether it has been destroyed.
+struct Tracked {
+  Tracked(int value, std::atomic<int>* destroyed)
+      : value(value), destroyed(destroyed) {}
+  ~Tracked() { destroyed->fetch_add(1); }
+
+  int value;
+  std::atomic<int>* destroyed;
+};
+
+TEST(RcuPtrTest, ReadReturnsInitialValue) {
+  std::atomic<int> destroyed = 0;
+  RcuPtr<Tracked> ptr(std::make_unique<Tracked>(1, &destroyed));
+
+  EXPECT_EQ(ptr.Read()->value, 1);
+}
+
+TEST(RcuPtrTest, ReadReturnsReplacedValue) {
+  std::atomic<int> destroyed = 0;
+  RcuPtr<Tracked> ptr(std::make_unique<Tracked>(1, &destroyed));
+
+  ptr.Replace(std::make_unique<Tracked>(2, &destroyed));
+
+  EXPECT_EQ(ptr.Read()->value, 2);
+  EXPECT_EQ(destroyed, 1);
+}
+
+TEST(RcuPtrTest, DestructorDestroysValue) {
+  std::atomic<int> destroyed = 0;
+  { RcuPtr<Tracked> ptr(std::make_unique<Tracked>(1, &destroyed)); }
+
+  EXPECT_EQ(destroyed, 1);
+}
+
+TEST(RcuPtrTest, NestedReadsAreAllowed) {
+  std::atomic<int> destroyed = 0;
+  RcuPtr<Tracked> ptr(std::make_unique<Tracked>(1, &destroyed));
+
+  RcuPtr<Tracked>::ReadHandle outer = ptr.Read();
+  {
+    RcuPtr<Tracked>::ReadHandle inner = ptr.Read();
+    EXPECT_EQ(inner->value, 1);
+  }
+  EXPECT_EQ(outer->value, 1);
+}
+
+TEST(RcuPtrTest, ReplaceWaitsForActiveReader) {
+  std::atomic<int> destroyed = 0;
+  RcuPtr<Tracked> ptr(std::make_unique<Tracked>(1, &destroyed));
+
+  absl::Notification reading, replaced, release_reader;
+  std::thread reader([&] {
+    RcuPtr<Tracked>::ReadHandle handle = ptr.Read();
+    reading.Notify();
+    release_reader.WaitForNotification();
+    // The old value must still be alive, even though it has been replaced.
+    EXPECT_EQ(handle->value, 1);
+    EXPECT_EQ(destroyed, 0);
+  });
+  reading.WaitForNotification();
+
+  std::thread writer([&] {
+    ptr.Replace(std::make_unique<Tracked>(2, &destroyed));
+    replaced.Notify();
+  });
+
+  EXPECT_FALSE(replaced.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+  // New readers see the new value while the old reader is still active.
+  EXPECT_EQ(ptr.Read()->value, 2);
+
+  release_reader.Notify();
+  reader.join();
+  writer.join();
+  EXPECT_TRUE(replaced.HasBeenNotified());
+  EXPECT_EQ(destroyed, 1);
+}
+
+TEST(RcuPtrTest, ThreadsStartAndExitWhileReplaceWaits) {
+  std::atomic<int> destroyed = 0;
+  RcuPtr<Tracked> ptr(std::make_unique<Tracked>(1, &destroyed));
+
+  absl::Notification reading, replaced, release_reader;
+  std::thread reader([&] {
+    RcuPtr<Tracked>::ReadHandle handle = ptr.Read();
+    reading.Notify();
+    release_reader.WaitForNotification();
+  });
+  reading.WaitForNotification();
+
+  std::thread writer([&] {
+    ptr.Replace(std::make_unique<Tracked>(2, &destroyed));
+    replaced.Notify();
+  });
+  EXPECT_FALSE(replaced.WaitForNotificationWithTimeout(absl::Milliseconds(50)));
+
+  // Threads that read for the first time, and threads that exit, must not wait
+  // for the writer's grace period to end.
+  for (int i = 0; i < 4; i++) {
+    std::thread([&] { EXPECT_EQ(ptr.Read()->value, 2); }).join();
+  }
+  EXPECT_FALSE(replaced.HasBeenNotified());
+
+  release_reader.Notify();
+  reader.join();
+  writer.join();
+  EXPECT_EQ(destroyed, 1);
+}
+
+TEST(RcuPtrTest, ConcurrentReadersAndWriter) {
+  std::atomic<int> destroyed = 0;
+  RcuPtr<Tracked> ptr(std::make_unique<Tracked>(0, &destroyed));
+
+  std::atomic<bool> done = false;
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&] {
+      int last = 0;
+      while (!done) {
+        int value = ptr.Read()->value;
+        EXPECT_GE(value, last);
+        last = value;
+      }
+    });
+  }
+
+  for (int i = 1; i <= 100; i++) {
+    ptr.Replace(std::make_unique<Tracked>(i, &destroyed));
+  }
+  done = true;
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(ptr.Read()->value, 100);
+  EXPECT_EQ(destroyed, 100);
+}
+
+}  // namespace
+}  // namespace cloud_kms::kmsp11
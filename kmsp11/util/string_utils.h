@@ -38,6 +38,13 @@ inline std::string StrFromBytes(absl::Span<const uint8_t> data) {
   return std::string(reinterpret_cast<const char*>(data.data()), data.size());
 }
 
+// Returns a span over the bytes of `data`, without copying them. This is the
+// inverse of StrFromBytes; `data` must outlive the returned span.
+inline absl::Span<const uint8_t> SpanFromStr(std::string_view data) {
+  return absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(data.data()),
+                             data.size());
+}
+
 // Replaces all content at `dest` by first copying the contents of `src`
 // and then filling any remaining bytes with `pad_char`. Returns OutOfRangeError
 // if `src.length()` is greater than `dest.length()`.